@@ -40,6 +40,8 @@
 #include "resources/bundle/KRBundle.h"
 #include "KRPresentationThread.h"
 #include "KRStreamerThread.h"
+#include "KRWorkerPool.h"
+#include "KRResourceLoader.h"
 
 #if defined(ANDROID)
 #include <chrono>
@@ -63,6 +65,9 @@ int KRContext::KRENGINE_TEXTURE_LQ_LOD = 4;
 // TODO - This should be configured per-scene?  Or auto/dynamic?
 int KRContext::KRENGINE_PRESTREAM_DISTANCE = 1000.0f;
 
+// Frame rate that imported animation curves are resampled to
+int KRContext::KRENGINE_ANIMATION_FRAME_RATE = 30;
+
 std::mutex KRContext::g_SurfaceInfoMutex;
 std::mutex KRContext::g_DeviceInfoMutex;
 
@@ -74,9 +79,13 @@ KRContext::KRContext(const KrInitializeInfo* initializeInfo)
   , m_resourceMap(nullptr)
   , m_nodeMapSize(initializeInfo->nodeMapSize)
   , m_nodeMap(nullptr)
+  , m_pipelineCacheDirectory(initializeInfo->pPipelineCacheDirectory ? initializeInfo->pPipelineCacheDirectory : "")
+  , m_vertexCacheSize(initializeInfo->vertexCacheSize ? (int)initializeInfo->vertexCacheSize : 16)
+  , m_spatialIndex(initializeInfo->spatialIndex)
 {
   m_presentationThread = std::make_unique<KRPresentationThread>(*this);
   m_streamerThread = std::make_unique<KRStreamerThread>(*this);
+  m_workerPool = std::make_unique<KRWorkerPool>();
   m_resourceMap = (KRResource**)malloc(sizeof(KRResource*) * m_resourceMapSize);
   memset(m_resourceMap, 0, m_resourceMapSize * sizeof(KRResource*));
   m_nodeMap = (KRNode**)malloc(sizeof(KRNode*) * m_nodeMapSize);
@@ -111,6 +120,7 @@ KRContext::KRContext(const KrInitializeInfo* initializeInfo)
   m_pUnknownManager = std::make_unique<KRUnknownManager>(*this);
   m_pShaderManager = std::make_unique<KRShaderManager>(*this);
   m_pSourceManager = std::make_unique<KRSourceManager>(*this);
+  m_resourceLoader = std::make_unique<KRResourceLoader>(*this);
   m_streamingEnabled = true;
 
   mimir::init();
@@ -123,6 +133,8 @@ KRContext::~KRContext()
 {
   m_presentationThread->stop();
   m_streamerThread->stop();
+  m_resourceLoader.reset();
+  m_workerPool.reset();
   m_pSceneManager.reset();
   m_pMeshManager.reset();
   m_pMaterialManager.reset();
@@ -260,6 +272,30 @@ KRUniformBufferManager* KRContext::getUniformBufferManager()
 {
   return m_uniformBufferManager.get();
 }
+KRWorkerPool* KRContext::getWorkerPool()
+{
+  return m_workerPool.get();
+}
+
+const std::string& KRContext::getPipelineCacheDirectory() const
+{
+  return m_pipelineCacheDirectory;
+}
+
+int KRContext::getVertexCacheSize() const
+{
+  return m_vertexCacheSize;
+}
+
+KrSpatialIndex KRContext::getSpatialIndex() const
+{
+  return m_spatialIndex;
+}
+
+KRResourceLoader* KRContext::getResourceLoader()
+{
+  return m_resourceLoader.get();
+}
 KRUnknownManager* KRContext::getUnknownManager()
 {
   return m_pUnknownManager.get();
@@ -367,7 +403,7 @@ KRResource* KRContext::loadResource(const std::string& file_name, Block* data)
     resource = m_pSoundManager->load(name.c_str(), extension, data);
   } else if (extension.compare("obj") == 0) {
     resource = KRResource::LoadObj(*this, file_name);
-  } else if (extension.compare("gltf") == 0) {
+  } else if (extension.compare("gltf") == 0 || extension.compare("glb") == 0) {
     resource = KRResource::LoadGltf(*this, file_name);
 #if !TARGET_OS_IPHONE
     /*
@@ -401,6 +437,21 @@ KrResult KRContext::loadResource(const KrLoadResourceInfo* loadResourceInfo)
   return KR_SUCCESS;
 }
 
+KrResult KRContext::loadResourceAsync(const KrLoadResourceInfo* loadResourceInfo, KrCompletionHandle* completionHandle)
+{
+  *completionHandle = 0;
+  if (loadResourceInfo->resourceHandle < 0 || loadResourceInfo->resourceHandle >= m_resourceMapSize) {
+    return KR_ERROR_OUT_OF_BOUNDS;
+  }
+  *completionHandle = m_resourceLoader->loadAsync(loadResourceInfo->pResourcePath, loadResourceInfo->resourceHandle);
+  return KR_SUCCESS;
+}
+
+KrResult KRContext::getCompletionStatus(KrCompletionHandle completionHandle, bool wait)
+{
+  return m_resourceLoader->getCompletionStatus(completionHandle, wait);
+}
+
 KrResult KRContext::unloadResource(const KrUnloadResourceInfo* unloadResourceInfo)
 {
   KRResource* resource = nullptr;
@@ -425,6 +476,10 @@ KrResult KRContext::mapResource(const KrMapResourceInfo* mapResourceInfo)
 
   KRResource* resource = nullptr;
 
+  if (m_resources.find(lowerName) == m_resources.end()) {
+    m_pBundleManager->loadDeferredResources(lowerName);
+  }
+
   std::pair<unordered_multimap<std::string, KRResource*>::iterator, unordered_multimap<std::string, KRResource*>::iterator> range = m_resources.equal_range(lowerName);
   for (unordered_multimap<std::string, KRResource*>::iterator itr_match = range.first; itr_match != range.second; itr_match++) {
     if (resource != nullptr) {
@@ -548,6 +603,17 @@ KrResult KRContext::compileAllShaders(const KrCompileAllShadersInfo* pCompileAll
   return KR_ERROR_SHADER_COMPILE_FAILED;
 }
 
+KrResult KRContext::bakeHRTFBank(const KrBakeHRTFBankInfo* pBakeHRTFBankInfo)
+{
+  KRBundle* bundle = nullptr;
+  KrResult res = getMappedResource<KRBundle>(pBakeHRTFBankInfo->bundleHandle, &bundle);
+  if (res != KR_SUCCESS) {
+    return res;
+  }
+
+  return m_pSoundManager->bakeHRTFBank(bundle);
+}
+
 KrResult KRContext::saveResource(const KrSaveResourceInfo* saveResourceInfo)
 {
   KRResource* resource = nullptr;
@@ -563,6 +629,7 @@ KrResult KRContext::saveResource(const KrSaveResourceInfo* saveResourceInfo)
 
 void KRContext::startFrame(float deltaTime)
 {
+  m_resourceLoader->registerCompleted();
   m_pTextureManager->startFrame(deltaTime);
   m_pAnimationManager->startFrame(deltaTime);
   m_pSoundManager->startFrame(deltaTime);
@@ -674,12 +741,21 @@ void KRContext::doStreaming()
 
     KRDeviceManager* deviceManager = getDeviceManager();
 
+    // Streamed handles are only swapped in once the transfers of the previous
+    // pass have completed.  Until then, the managers have no new work.
     for (auto deviceItr = deviceManager->getDevices().begin(); deviceItr != deviceManager->getDevices().end(); deviceItr++) {
       KRDevice& device = *(*deviceItr).second;
-      device.streamStart();
+      if (!device.isStreamComplete()) {
+        return;
+      }
     }
+    m_pMeshManager->finishStreaming();
+    m_pTextureManager->finishStreaming();
 
-    // TODO - Ensure that each iteration does not exhaust the currently fixed 256MB staging buffer
+    for (auto deviceItr = deviceManager->getDevices().begin(); deviceItr != deviceManager->getDevices().end(); deviceItr++) {
+      KRDevice& device = *(*deviceItr).second;
+      device.streamStart();
+    }
 
     long streaming_start_frame = m_current_frame;
 
@@ -709,7 +785,26 @@ void KRContext::receivedMemoryWarning()
 
 KrResult KRContext::findNodeByName(const KrFindNodeByNameInfo* pFindNodeByNameInfo)
 {
-  return KR_ERROR_NOT_IMPLEMENTED;
+  KRScene* scene = nullptr;
+  KrResult res = getMappedResource<KRScene>(pFindNodeByNameInfo->sceneHandle, &scene);
+  if (res != KR_SUCCESS) {
+    return res;
+  }
+  if (pFindNodeByNameInfo->nodeHandle < 0 || pFindNodeByNameInfo->nodeHandle >= m_nodeMapSize) {
+    return KR_ERROR_OUT_OF_BOUNDS;
+  }
+  if (pFindNodeByNameInfo->pName == nullptr) {
+    return KR_ERROR_UNEXPECTED;
+  }
+  const std::vector<KRNode*>& nodes = scene->getNodesByName(pFindNodeByNameInfo->pName);
+  if (nodes.empty()) {
+    return KR_ERROR_NOT_FOUND;
+  }
+  if (nodes.size() > 1) {
+    return KR_ERROR_AMBIGUOUS_MATCH;
+  }
+  m_nodeMap[pFindNodeByNameInfo->nodeHandle] = nodes.front();
+  return KR_SUCCESS;
 }
 
 KrResult KRContext::findAdjacentNodes(const KrFindAdjacentNodesInfo* pFindAdjacentNodesInfo)
@@ -915,6 +1010,15 @@ KrResult KRContext::getMappedResource(KrResourceMapIndex resourceHandle, KRResou
   return KR_SUCCESS;
 }
 
+KrResult KRContext::setMappedResource(KrResourceMapIndex resourceHandle, KRResource* resource)
+{
+  if (resourceHandle < 0 || resourceHandle >= m_resourceMapSize) {
+    return KR_ERROR_OUT_OF_BOUNDS;
+  }
+  m_resourceMap[resourceHandle] = resource;
+  return KR_SUCCESS;
+}
+
 
 bool KRContext::getShaderValue(const KRCamera* camera, ShaderValue value, float* output) const
 {
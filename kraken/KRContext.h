@@ -53,6 +53,8 @@
 class KRAudioManager;
 class KRPresentationThread;
 class KRStreamerThread;
+class KRWorkerPool;
+class KRResourceLoader;
 class KRDeviceManager;
 class KRUniformBufferManager;
 class KRSurfaceManager;
@@ -68,6 +70,7 @@ public:
   static int KRENGINE_PRESTREAM_DISTANCE;
   static int KRENGINE_TEXTURE_HQ_LOD;
   static int KRENGINE_TEXTURE_LQ_LOD;
+  static int KRENGINE_ANIMATION_FRAME_RATE;
 
 
   KRContext(const KrInitializeInfo* initializeInfo);
@@ -80,6 +83,8 @@ public:
   KrResult createBundle(const KrCreateBundleInfo* createBundleInfo);
   KrResult moveToBundle(const KrMoveToBundleInfo* moveToBundleInfo);
   KrResult loadResource(const KrLoadResourceInfo* loadResourceInfo);
+  KrResult loadResourceAsync(const KrLoadResourceInfo* loadResourceInfo, KrCompletionHandle* completionHandle);
+  KrResult getCompletionStatus(KrCompletionHandle completionHandle, bool wait);
   KrResult unloadResource(const KrUnloadResourceInfo* unloadResourceInfo);
   KrResult getResourceData(const KrGetResourceDataInfo* getResourceDataInfo, KrGetResourceDataCallback callback);
   KrResult mapResource(const KrMapResourceInfo* mapResourceInfo);
@@ -87,6 +92,7 @@ public:
   KrResult saveResource(const KrSaveResourceInfo* saveResourceInfo);
 
   KrResult compileAllShaders(const KrCompileAllShadersInfo* pCompileAllShadersInfo);
+  KrResult bakeHRTFBank(const KrBakeHRTFBankInfo* pBakeHRTFBankInfo);
 
   KrResult createScene(const KrCreateSceneInfo* createSceneInfo);
   KrResult findNodeByName(const KrFindNodeByNameInfo* pFindNodeByNameInfo);
@@ -102,6 +108,7 @@ public:
   // -=-=-=- Start: Helper functions for Public API Entry Points
   KrResult getMappedNode(KrSceneNodeMapIndex sceneNodeHandle, KRScene* scene, KRNode** node);
   KrResult getMappedResource(KrResourceMapIndex resourceHandle, KRResource** resource);
+  KrResult setMappedResource(KrResourceMapIndex resourceHandle, KRResource* resource);
 
   template<class T> KrResult getMappedResource(KrResourceMapIndex resourceHandle, T** resource)
   {
@@ -140,6 +147,14 @@ public:
   KRSurfaceManager* getSurfaceManager();
   KRDeviceManager* getDeviceManager();
   KRUniformBufferManager* getUniformBufferManager();
+  KRWorkerPool* getWorkerPool();
+  KRResourceLoader* getResourceLoader();
+
+  // Empty if the pipeline cache is not persisted
+  const std::string& getPipelineCacheDirectory() const;
+  // Post-transform vertex cache size that imported meshes are optimized for
+  int getVertexCacheSize() const;
+  KrSpatialIndex getSpatialIndex() const;
 
   void startFrame(float deltaTime);
   void endFrame(float deltaTime);
@@ -201,6 +216,10 @@ private:
   KRNode** m_nodeMap;
   size_t m_nodeMapSize;
 
+  std::string m_pipelineCacheDirectory;
+  int m_vertexCacheSize;
+  KrSpatialIndex m_spatialIndex;
+
   long m_current_frame; // TODO - Does this need to be atomic?
   long m_last_memory_warning_frame; // TODO - Does this need to be atomic?
   long m_last_fully_streamed_frame; // TODO - Does this need to be atomic?
@@ -221,6 +240,8 @@ private:
 
   std::unique_ptr<KRStreamerThread> m_streamerThread;
   std::unique_ptr<KRPresentationThread> m_presentationThread;
+  std::unique_ptr<KRWorkerPool> m_workerPool;
+  std::unique_ptr<KRResourceLoader> m_resourceLoader;
 
   unordered_map<KrSurfaceMapIndex, KrSurfaceHandle> m_surfaceHandleMap;
 
@@ -31,6 +31,7 @@
 
 #include "KRDevice.h"
 #include "KRDeviceManager.h"
+#include "KRGeometryHeap.h"
 
 using namespace mimir;
 using namespace hydra;
@@ -51,8 +52,13 @@ KRDevice::KRDevice(KRContext& context, const VkPhysicalDevice& device)
   , m_computeCommandPool(VK_NULL_HANDLE)
   , m_allocator(VK_NULL_HANDLE)
   , m_streamingStagingBuffer{}
+  , m_streamingSegment(0)
+  , m_streamingHead(0)
   , m_graphicsStagingBuffer{}
+  , m_skinPaletteBuffers{}
+  , m_skinPaletteFrame(-1)
   , m_descriptorPool(VK_NULL_HANDLE)
+  , m_pipelineCache(VK_NULL_HANDLE)
 {
 
 }
@@ -78,12 +84,32 @@ void KRDevice::StagingBufferInfo::destroy(VmaAllocator& allocator)
 
 void KRDevice::destroy()
 {
+  if (m_pipelineCache != VK_NULL_HANDLE) {
+    savePipelineCache();
+    vkDestroyPipelineCache(m_logicalDevice, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+  }
   if (m_descriptorPool != VK_NULL_HANDLE) {
     vkDestroyDescriptorPool(m_logicalDevice, m_descriptorPool, nullptr);
     m_descriptorPool = VK_NULL_HANDLE;
   }
+  m_geometryHeap.reset();
+  for (StreamingSegment& segment : m_streamingSegments) {
+    if (segment.fence != VK_NULL_HANDLE) {
+      if (segment.submitted) {
+        vkWaitForFences(m_logicalDevice, 1, &segment.fence, VK_TRUE, UINT64_MAX);
+      }
+      vkDestroyFence(m_logicalDevice, segment.fence, nullptr);
+    }
+  }
+  m_streamingSegments.clear();
+  m_streamingBufferCopies.clear();
   m_streamingStagingBuffer.destroy(m_allocator);
   m_graphicsStagingBuffer.destroy(m_allocator);
+  for (StagingBufferInfo& paletteBuffer : m_skinPaletteBuffers) {
+    paletteBuffer.destroy(m_allocator);
+  }
+  m_skinPaletteFrame = -1;
 
   if (m_graphicsCommandPool != VK_NULL_HANDLE) {
     vkDestroyCommandPool(m_logicalDevice, m_graphicsCommandPool, nullptr);
@@ -402,7 +428,7 @@ bool KRDevice::initStagingBuffers()
   // Start with a 256MB staging buffer.
   // TODO - Dynamically size staging buffer using heuristics
   size_t size = size_t(256) * 1024 * 1024;
-  if (!initStagingBuffer(size, &m_streamingStagingBuffer
+  if (!initStagingBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &m_streamingStagingBuffer
 #if KRENGINE_DEBUG_GPU_LABELS
     , "Streaming Staging Buffer"
 #endif // KRENGINE_DEBUG_GPU_LABELS
@@ -415,7 +441,7 @@ bool KRDevice::initStagingBuffers()
   // Start with a 256MB staging buffer.
   // TODO - Dynamically size staging buffer using heuristics
   size = size_t(256) * 1024 * 1024;
-  if (!initStagingBuffer(size,
+  if (!initStagingBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
     &m_graphicsStagingBuffer
 #if KRENGINE_DEBUG_GPU_LABELS
     , "Graphics Staging Buffer"
@@ -423,10 +449,25 @@ bool KRDevice::initStagingBuffers()
     )) {
     return false;
   }
+
+  // Create the skinning palette buffers, written by the CPU and read directly by shaders.
+  // 4MB holds 65536 bone matrices per frame.
+  // TODO - Dynamically size palette buffers using heuristics
+  size = size_t(4) * 1024 * 1024;
+  for (StagingBufferInfo& paletteBuffer : m_skinPaletteBuffers) {
+    if (!initStagingBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      &paletteBuffer
+#if KRENGINE_DEBUG_GPU_LABELS
+      , "Skin Palette Buffer"
+#endif // KRENGINE_DEBUG_GPU_LABELS
+      )) {
+      return false;
+    }
+  }
   return true;
 }
 
-bool KRDevice::initStagingBuffer(VkDeviceSize size, StagingBufferInfo* info
+bool KRDevice::initStagingBuffer(VkDeviceSize size, VkBufferUsageFlags usage, StagingBufferInfo* info
 #if KRENGINE_DEBUG_GPU_LABELS
   , const char* debug_label
 #endif // KRENGINE_DEBUG_GPU_LABELS
@@ -434,7 +475,7 @@ bool KRDevice::initStagingBuffer(VkDeviceSize size, StagingBufferInfo* info
 {
   if (!createBuffer(
     size,
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    usage,
     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
     &info->buffer,
     &info->allocation
@@ -451,6 +492,26 @@ bool KRDevice::initStagingBuffer(VkDeviceSize size, StagingBufferInfo* info
   return true;
 }
 
+bool KRDevice::initStreamingSegments()
+{
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  // One segment for each transfer command buffer
+  m_streamingSegments.resize(m_transferCommandBuffers.size(), StreamingSegment{});
+  for (size_t i = 0; i < m_streamingSegments.size(); i++) {
+    StreamingSegment& segment = m_streamingSegments[i];
+    segment.commandBuffer = m_transferCommandBuffers[i];
+    if (vkCreateFence(m_logicalDevice, &fenceInfo, nullptr, &segment.fence) != VK_SUCCESS) {
+      segment.fence = VK_NULL_HANDLE;
+      return false;
+    }
+  }
+  m_streamingSegment = 0;
+  m_streamingHead = 0;
+  return true;
+}
+
 bool KRDevice::initDescriptorPool()
 {
   // TODO - Vulkan Refactoring - These values need to be dynamic
@@ -459,16 +520,21 @@ bool KRDevice::initDescriptorPool()
   const size_t kMaxUniformBufferDescriptors = 1024;
   const size_t kMaxImageSamplerDescriptors = 1024;
 
-  VkDescriptorPoolSize poolSizes[2] = {};
+  const size_t kMaxStorageBufferDescriptors = 256;
+
+  VkDescriptorPoolSize poolSizes[3] = {};
   poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
   poolSizes[0].descriptorCount = static_cast<uint32_t>(kMaxUniformBufferDescriptors);
 
   poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
   poolSizes[1].descriptorCount = static_cast<uint32_t>(kMaxImageSamplerDescriptors);
 
+  poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  poolSizes[2].descriptorCount = static_cast<uint32_t>(kMaxStorageBufferDescriptors);
+
   VkDescriptorPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-  poolInfo.poolSizeCount = 2;
+  poolInfo.poolSizeCount = 3;
   poolInfo.pPoolSizes = poolSizes;
   poolInfo.maxSets = static_cast<uint32_t>(kMaxDescriptorSets);
 
@@ -478,6 +544,90 @@ bool KRDevice::initDescriptorPool()
   return true;
 }
 
+std::string KRDevice::getPipelineCachePath() const
+{
+  const std::string& directory = getContext().getPipelineCacheDirectory();
+  if (directory.empty()) {
+    return std::string();
+  }
+  // One file per physical device, so that a system with several GPUs does not
+  // discard its caches on every run.
+  char szFileName[64];
+  snprintf(szFileName, sizeof(szFileName), "pipeline_cache_%08x_%08x.bin", m_deviceProperties.vendorID, m_deviceProperties.deviceID);
+  return directory + "/" + szFileName;
+}
+
+bool KRDevice::isPipelineCacheCompatible(const void* data, size_t size) const
+{
+  // Drivers reject incompatible data themselves, but not all of them do so reliably.
+  // The pipelineCacheUUID changes with the driver version, so a driver update
+  // invalidates the file.
+  VkPipelineCacheHeaderVersionOne header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (header.headerSize < sizeof(header) || header.headerSize > size) {
+    return false;
+  }
+  if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+    return false;
+  }
+  if (header.vendorID != m_deviceProperties.vendorID || header.deviceID != m_deviceProperties.deviceID) {
+    return false;
+  }
+  return memcmp(header.pipelineCacheUUID, m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool KRDevice::initPipelineCache()
+{
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+  std::string path = getPipelineCachePath();
+  Block data;
+  if (!path.empty() && data.load(path)) {
+    data.lock();
+    if (isPipelineCacheCompatible(data.getStart(), data.getSize())) {
+      cacheInfo.initialDataSize = data.getSize();
+      cacheInfo.pInitialData = data.getStart();
+    } else {
+      KRContext::Log(KRContext::LOG_LEVEL_INFORMATION, "Discarding pipeline cache from another device or driver: %s", path.c_str());
+    }
+    VkResult result = vkCreatePipelineCache(m_logicalDevice, &cacheInfo, nullptr, &m_pipelineCache);
+    data.unlock();
+    if (result == VK_SUCCESS) {
+      return true;
+    }
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Failed to load pipeline cache: %s", path.c_str());
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = nullptr;
+  }
+
+  return vkCreatePipelineCache(m_logicalDevice, &cacheInfo, nullptr, &m_pipelineCache) == VK_SUCCESS;
+}
+
+void KRDevice::savePipelineCache()
+{
+  std::string path = getPipelineCachePath();
+  if (path.empty()) {
+    return;
+  }
+  size_t size = 0;
+  if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+    return;
+  }
+  std::vector<uint8_t> cacheData(size);
+  if (vkGetPipelineCacheData(m_logicalDevice, m_pipelineCache, &size, cacheData.data()) != VK_SUCCESS) {
+    return;
+  }
+  Block data;
+  data.append(cacheData.data(), size);
+  if (!data.save(path)) {
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Failed to save pipeline cache: %s", path.c_str());
+  }
+}
+
 void KRDevice::createDescriptorSets(const std::vector<VkDescriptorSetLayout>& layouts, std::vector<VkDescriptorSet>& descriptorSets)
 {
   VkDescriptorSetAllocateInfo allocInfo{};
@@ -527,14 +677,31 @@ bool KRDevice::initialize(const std::vector<const char*>& deviceExtensions)
     return false;
   }
 
+  if (!initStreamingSegments()) {
+    destroy();
+    return false;
+  }
+
   if (!initDescriptorPool()) {
     destroy();
     return false;
   }
 
+  if (!initPipelineCache()) {
+    destroy();
+    return false;
+  }
+
+  m_geometryHeap = std::make_unique<KRGeometryHeap>(*this);
+
   return true;
 }
 
+KRGeometryHeap* KRDevice::getGeometryHeap()
+{
+  return m_geometryHeap.get();
+}
+
 VmaAllocator KRDevice::getAllocator()
 {
   assert(m_allocator != VK_NULL_HANDLE);
@@ -712,66 +879,100 @@ KrResult KRDevice::selectPresentMode(VkSurfaceKHR& surface, VkPresentModeKHR& se
 void KRDevice::streamStart()
 {
   if (!m_streamingStagingBuffer.started) {
+    StreamingSegment& segment = m_streamingSegments[m_streamingSegment];
+    // The segment's command buffer is reused once its last submission has completed
+    if (segment.submitted) {
+      vkWaitForFences(m_logicalDevice, 1, &segment.fence, VK_TRUE, UINT64_MAX);
+      retireStreamingSegment(segment);
+    }
+
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-    vkBeginCommandBuffer(m_transferCommandBuffers[0], &beginInfo);
+    vkBeginCommandBuffer(segment.commandBuffer, &beginInfo);
 
+    segment.begin = m_streamingHead;
+    m_streamingStagingBuffer.usage = 0;
     m_streamingStagingBuffer.started = true;
   }
 }
 
-void KRDevice::streamUpload(Block& data, VkBuffer destination)
+void* KRDevice::streamReserve(size_t size, size_t* stagingOffset)
 {
-  data.lock();
-  streamUpload(data.getStart(), data.getSize(), destination);
-  data.unlock();
+  // Satisfies buffer to image copy alignment for all formats
+  const uint64_t kStagingAlignment = 16;
+  const uint64_t ringSize = m_streamingStagingBuffer.size;
+  assert(m_streamingStagingBuffer.started);
+  assert(size <= ringSize);
+
+  uint64_t start = (m_streamingHead + kStagingAlignment - 1) / kStagingAlignment * kStagingAlignment;
+  if (start % ringSize + size > ringSize) {
+    // Reservations do not wrap around the end of the ring
+    start += ringSize - start % ringSize;
+  }
+
+  while (start + size - getStreamingTail() > ringSize) {
+    if (waitForOldestStreamingSegment()) {
+      continue;
+    }
+    if (m_streamingStagingBuffer.usage == 0) {
+      // Nothing is in use; the batch being recorded can start here
+      m_streamingHead = start;
+      m_streamingSegments[m_streamingSegment].begin = start;
+    } else {
+      // The batch being recorded fills the ring.  Submit it so it can be waited on.
+      streamEnd();
+      streamStart();
+    }
+  }
+
+  m_streamingHead = start + size;
+  m_streamingStagingBuffer.usage = m_streamingHead - m_streamingSegments[m_streamingSegment].begin;
+  *stagingOffset = start % ringSize;
+  return (uint8_t*)m_streamingStagingBuffer.data + *stagingOffset;
 }
 
-void KRDevice::graphicsUpload(VkCommandBuffer& commandBuffer, Block& data, VkBuffer destination)
+void KRDevice::streamCopy(size_t stagingOffset, size_t size, VkBuffer destination, VkDeviceSize destinationOffset)
 {
-  data.lock();
-  graphicsUpload(commandBuffer, data.getStart(), data.getSize(), destination);
-  data.unlock();
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = stagingOffset;
+  copyRegion.dstOffset = destinationOffset;
+  copyRegion.size = size;
+  m_streamingBufferCopies[destination].push_back(copyRegion);
 }
 
-void KRDevice::checkFlushStreamBuffer(size_t size)
+void KRDevice::streamUpload(Block& data, VkBuffer destination, VkDeviceSize destinationOffset)
 {
-  // Flush the buffers if we would run out of space
-  if (m_streamingStagingBuffer.usage + size > m_streamingStagingBuffer.size) {
-    // If we hit this often, then we need a larger staging buffer.
-    // TODO - Dynamically allocate more/larger staging buffers.
-    assert(size < m_streamingStagingBuffer.size);
-    streamEnd();
-    streamStart();
-  }
+  size_t stagingOffset = 0;
+  void* staging = streamReserve(data.getSize(), &stagingOffset);
+  data.copy(staging, 0, data.getSize());
+  streamCopy(stagingOffset, data.getSize(), destination, destinationOffset);
 }
 
-void KRDevice::streamUpload(void* data, size_t size, VkBuffer destination)
+void KRDevice::graphicsUpload(VkCommandBuffer& commandBuffer, Block& data, VkBuffer destination, VkDeviceSize destinationOffset)
 {
-  checkFlushStreamBuffer(size);
-  memcpy((uint8_t*)m_streamingStagingBuffer.data + m_streamingStagingBuffer.usage, data, size);
-
-  // TODO - Beneficial to batch many regions in a single call?
-  VkBufferCopy copyRegion{};
-  copyRegion.srcOffset = m_streamingStagingBuffer.usage;
-  copyRegion.dstOffset = 0; // Optional
-  copyRegion.size = size;
-  vkCmdCopyBuffer(m_transferCommandBuffers[0], m_streamingStagingBuffer.buffer, destination, 1, &copyRegion);
+  data.lock();
+  graphicsUpload(commandBuffer, data.getStart(), data.getSize(), destination, destinationOffset);
+  data.unlock();
+}
 
-  // TODO - Assert on any needed alignment?
-  m_streamingStagingBuffer.usage += size;
+void KRDevice::streamUpload(void* data, size_t size, VkBuffer destination, VkDeviceSize destinationOffset)
+{
+  size_t stagingOffset = 0;
+  void* staging = streamReserve(size, &stagingOffset);
+  memcpy(staging, data, size);
+  streamCopy(stagingOffset, size, destination, destinationOffset);
 }
 
-void KRDevice::graphicsUpload(VkCommandBuffer& commandBuffer, void* data, size_t size, VkBuffer destination)
+void KRDevice::graphicsUpload(VkCommandBuffer& commandBuffer, void* data, size_t size, VkBuffer destination, VkDeviceSize destinationOffset)
 {
   memcpy((uint8_t*)m_graphicsStagingBuffer.data + m_graphicsStagingBuffer.usage, data, size);
 
   // TODO - Beneficial to batch many regions in a single call?
   VkBufferCopy copyRegion{};
   copyRegion.srcOffset = m_graphicsStagingBuffer.usage;
-  copyRegion.dstOffset = 0; // Optional
+  copyRegion.dstOffset = destinationOffset;
   copyRegion.size = size;
   vkCmdCopyBuffer(commandBuffer, m_graphicsStagingBuffer.buffer, destination, 1, &copyRegion);
 
@@ -779,17 +980,54 @@ void KRDevice::graphicsUpload(VkCommandBuffer& commandBuffer, void* data, size_t
   m_graphicsStagingBuffer.usage += size;
 }
 
-void KRDevice::streamUpload(void* data, size_t size, VkImage destination, VkBufferImageCopy* regions, int regionCount)
+bool KRDevice::uploadSkinPalette(const float* matrices, size_t matrixCount, VkBuffer* buffer, VkDeviceSize* offset)
 {
-  checkFlushStreamBuffer(size);
+  long frame = getContext().getCurrentFrame();
+  StagingBufferInfo& paletteBuffer = m_skinPaletteBuffers[frame % KRENGINE_MAX_FRAMES_IN_FLIGHT];
+  if (frame != m_skinPaletteFrame) {
+    // The GPU is done with the palettes last written to this buffer
+    paletteBuffer.usage = 0;
+    m_skinPaletteFrame = frame;
+  }
+
+  VkDeviceSize alignment = m_deviceProperties.limits.minStorageBufferOffsetAlignment;
+  if (alignment == 0) {
+    alignment = 1;
+  }
+  size_t start = (size_t)((paletteBuffer.usage + alignment - 1) / alignment * alignment);
+  size_t size = matrixCount * 16 * sizeof(float);
+  if (paletteBuffer.data == nullptr || start + size > paletteBuffer.size) {
+    return false;
+  }
+
+  memcpy((uint8_t*)paletteBuffer.data + start, matrices, size);
+  vmaFlushAllocation(m_allocator, paletteBuffer.allocation, start, size);
+  paletteBuffer.usage = start + size;
 
-  memcpy((uint8_t*)m_streamingStagingBuffer.data + m_streamingStagingBuffer.usage, data, size);
-  
-  streamUploadImpl(size, destination, regions, regionCount);
+  *buffer = paletteBuffer.buffer;
+  *offset = start;
+  return true;
+}
+
+void KRDevice::streamUpload(void* data, size_t size, VkImage destination, VkBufferImageCopy* regions, int regionCount)
+{
+  size_t stagingOffset = 0;
+  void* staging = streamReserve(size, &stagingOffset);
+  memcpy(staging, data, size);
+  streamCopy(stagingOffset, destination, regions, regionCount);
 }
 
-void KRDevice::streamUploadImpl(size_t size, VkImage destination, VkBufferImageCopy* regions, int regionCount)
+void KRDevice::streamCopy(size_t stagingOffset, VkImage destination, VkBufferImageCopy* regions, int regionCount)
 {
+  assert(m_streamingStagingBuffer.started);
+  VkCommandBuffer commandBuffer = m_streamingSegments[m_streamingSegment].commandBuffer;
+
+  // Regions are relative to the reserved staging memory
+  std::vector<VkBufferImageCopy> stagingRegions(regions, regions + regionCount);
+  for (VkBufferImageCopy& region : stagingRegions) {
+    region.bufferOffset += stagingOffset;
+  }
+
   // TODO - Refactor memory barriers into helper functions
   VkPipelineStageFlags sourceStage;
   VkPipelineStageFlags destinationStage;
@@ -814,7 +1052,7 @@ void KRDevice::streamUploadImpl(size_t size, VkImage destination, VkBufferImageC
   destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
   vkCmdPipelineBarrier(
-    m_transferCommandBuffers[0],
+    commandBuffer,
     sourceStage, destinationStage,
     0,
     0, nullptr,
@@ -823,12 +1061,12 @@ void KRDevice::streamUploadImpl(size_t size, VkImage destination, VkBufferImageC
   );
 
   vkCmdCopyBufferToImage(
-    m_transferCommandBuffers[0],
+    commandBuffer,
     m_streamingStagingBuffer.buffer,
     destination,
     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-    regionCount,
-    regions
+    (uint32_t)stagingRegions.size(),
+    stagingRegions.data()
   );
 
   barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -841,16 +1079,13 @@ void KRDevice::streamUploadImpl(size_t size, VkImage destination, VkBufferImageC
   destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 
   vkCmdPipelineBarrier(
-    m_transferCommandBuffers[0],
+    commandBuffer,
     sourceStage, destinationStage,
     0,
     0, nullptr,
     0, nullptr,
     1, &barrier
   );
-
-  // TODO - Assert on any needed alignment?
-  m_streamingStagingBuffer.usage += size;
 }
 
 void KRDevice::streamEnd()
@@ -858,22 +1093,97 @@ void KRDevice::streamEnd()
   if (m_streamingStagingBuffer.usage == 0) {
     return;
   }
-  vkEndCommandBuffer(m_transferCommandBuffers[0]);
+  StreamingSegment& segment = m_streamingSegments[m_streamingSegment];
 
-  if (m_streamingStagingBuffer.usage > 0) {
-    VkResult res = vmaFlushAllocation(m_allocator, m_streamingStagingBuffer.allocation, 0, m_streamingStagingBuffer.usage);
-    assert(res == VK_SUCCESS);
-    m_streamingStagingBuffer.usage = 0;
+  for (auto& itr : m_streamingBufferCopies) {
+    vkCmdCopyBuffer(segment.commandBuffer, m_streamingStagingBuffer.buffer, itr.first, (uint32_t)itr.second.size(), itr.second.data());
   }
+  m_streamingBufferCopies.clear();
+
+  vkEndCommandBuffer(segment.commandBuffer);
+
+  segment.end = m_streamingHead;
+  flushStreamingRange(segment.begin, segment.end);
 
-  // TODO - Should double buffer and use a fence rather than block the thread
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &m_transferCommandBuffers[0];
+  submitInfo.pCommandBuffers = &segment.commandBuffer;
 
-  vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(m_transferQueue);
+  vkQueueSubmit(m_transferQueue, 1, &submitInfo, segment.fence);
+  segment.submitted = true;
 
+  m_streamingSegment = (m_streamingSegment + 1) % (int)m_streamingSegments.size();
+  m_streamingStagingBuffer.usage = 0;
   m_streamingStagingBuffer.started = false;
 }
+
+bool KRDevice::isStreamComplete()
+{
+  bool complete = true;
+  for (StreamingSegment& segment : m_streamingSegments) {
+    if (segment.submitted) {
+      if (vkGetFenceStatus(m_logicalDevice, segment.fence) == VK_SUCCESS) {
+        retireStreamingSegment(segment);
+      } else {
+        complete = false;
+      }
+    }
+  }
+  return complete;
+}
+
+uint64_t KRDevice::getStreamingTail() const
+{
+  // Segments are submitted in ring order, so the oldest in-flight segment
+  // holds the lowest position.
+  uint64_t tail = m_streamingHead;
+  for (const StreamingSegment& segment : m_streamingSegments) {
+    if (segment.submitted) {
+      tail = std::min(tail, segment.begin);
+    }
+  }
+  if (m_streamingStagingBuffer.started) {
+    tail = std::min(tail, m_streamingSegments[m_streamingSegment].begin);
+  }
+  return tail;
+}
+
+bool KRDevice::waitForOldestStreamingSegment()
+{
+  StreamingSegment* oldest = nullptr;
+  for (StreamingSegment& segment : m_streamingSegments) {
+    if (segment.submitted && (oldest == nullptr || segment.begin < oldest->begin)) {
+      oldest = &segment;
+    }
+  }
+  if (oldest == nullptr) {
+    return false;
+  }
+  vkWaitForFences(m_logicalDevice, 1, &oldest->fence, VK_TRUE, UINT64_MAX);
+  retireStreamingSegment(*oldest);
+  return true;
+}
+
+void KRDevice::retireStreamingSegment(StreamingSegment& segment)
+{
+  vkResetFences(m_logicalDevice, 1, &segment.fence);
+  segment.submitted = false;
+}
+
+void KRDevice::flushStreamingRange(uint64_t begin, uint64_t end)
+{
+  const uint64_t ringSize = m_streamingStagingBuffer.size;
+  uint64_t offset = begin % ringSize;
+  uint64_t size = end - begin;
+  VkResult res = VK_SUCCESS;
+  if (offset + size <= ringSize) {
+    res = vmaFlushAllocation(m_allocator, m_streamingStagingBuffer.allocation, offset, size);
+  } else {
+    res = vmaFlushAllocation(m_allocator, m_streamingStagingBuffer.allocation, offset, ringSize - offset);
+    if (res == VK_SUCCESS) {
+      res = vmaFlushAllocation(m_allocator, m_streamingStagingBuffer.allocation, 0, size - (ringSize - offset));
+    }
+  }
+  assert(res == VK_SUCCESS);
+}
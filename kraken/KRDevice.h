@@ -37,6 +37,7 @@
 namespace mimir {
 class Block;
 }
+class KRGeometryHeap;
 
 class KRDevice : public KRContextObject
 {
@@ -72,13 +73,26 @@ public:
   KrResult selectPresentMode(VkSurfaceKHR& surface, VkPresentModeKHR& selectedPresentMode) const;
 
   void streamStart();
-  void streamUpload(mimir::Block& data, VkBuffer destination);
-  void streamUpload(void* data, size_t size, VkBuffer destination);
+  // Reserves streaming staging memory to be written directly, such as by
+  // decoding into it, before a matching streamCopy in the same streamStart() / streamEnd() batch.
+  void* streamReserve(size_t size, size_t* stagingOffset);
+  void streamCopy(size_t stagingOffset, size_t size, VkBuffer destination, VkDeviceSize destinationOffset);
+  void streamCopy(size_t stagingOffset, VkImage destination, VkBufferImageCopy* regions, int regionCount);
+  void streamUpload(mimir::Block& data, VkBuffer destination, VkDeviceSize destinationOffset = 0);
+  void streamUpload(void* data, size_t size, VkBuffer destination, VkDeviceSize destinationOffset = 0);
   void streamUpload(void* data, size_t size, VkImage destination, VkBufferImageCopy* regions, int regionCount);
   void streamEnd();
+  // Returns true once all submitted streaming transfers have completed
+  bool isStreamComplete();
 
-  void graphicsUpload(VkCommandBuffer& commandBuffer, mimir::Block& data, VkBuffer destination);
-  void graphicsUpload(VkCommandBuffer& commandBuffer, void* data, size_t size, VkBuffer destination);
+  void graphicsUpload(VkCommandBuffer& commandBuffer, mimir::Block& data, VkBuffer destination, VkDeviceSize destinationOffset = 0);
+  void graphicsUpload(VkCommandBuffer& commandBuffer, void* data, size_t size, VkBuffer destination, VkDeviceSize destinationOffset = 0);
+
+  // Copies a skinning palette of 4x4 matrices into this frame's palette buffer.
+  // The returned range stays valid until the frame is reused.
+  bool uploadSkinPalette(const float* matrices, size_t matrixCount, VkBuffer* buffer, VkDeviceSize* offset);
+
+  KRGeometryHeap* getGeometryHeap();
 
   void createDescriptorSets(const std::vector<VkDescriptorSetLayout>& layouts, std::vector<VkDescriptorSet>& descriptorSets);
 
@@ -101,6 +115,10 @@ public:
   VmaAllocator m_allocator;
   VkDescriptorPool m_descriptorPool;
 
+  // Shared by all pipelines created on this device.  Persisted in the context's
+  // pipeline cache directory, if one was given.
+  VkPipelineCache m_pipelineCache;
+
   struct StagingBufferInfo
   {
     VkBuffer buffer;
@@ -115,17 +133,47 @@ public:
 
   // Staging buffer for uploading with the transfer queue
   // This will be used for asynchronous asset streaming in the streamer thread.
-  // TODO - We should allocate at least two of these and double-buffer for increased CPU-GPU concurrency
+  // It is used as a ring, with each streamStart() / streamEnd() batch as a segment
+  // that is submitted with its own fence rather than waited on.
   StagingBufferInfo m_streamingStagingBuffer;
 
+  struct StreamingSegment
+  {
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    // Ring positions, counted in bytes since initialization
+    uint64_t begin;
+    uint64_t end;
+    bool submitted;
+  };
+  std::vector<StreamingSegment> m_streamingSegments;
+  int m_streamingSegment;
+  uint64_t m_streamingHead;
+
+  // Buffer copies are batched by destination and recorded at streamEnd()
+  unordered_map<VkBuffer, std::vector<VkBufferCopy>> m_streamingBufferCopies;
+
   // Staging buffer for uploading with the graphics queue
   // This will be used for uploading assets procedurally generated while recording the graphics command buffer.
   // TODO - We should allocate at least two of these and double-buffer for increased CPU-GPU concurrency
   StagingBufferInfo m_graphicsStagingBuffer;
 
+  // Host-visible storage buffers for skinning palettes, one per frame in flight
+  StagingBufferInfo m_skinPaletteBuffers[KRENGINE_MAX_FRAMES_IN_FLIGHT];
+  long m_skinPaletteFrame;
+
+  // Device-local vertex and index data for all meshes
+  std::unique_ptr<KRGeometryHeap> m_geometryHeap;
+
   void getQueueFamiliesForSharing(uint32_t* queueFamilyIndices, uint32_t* familyCount, VkSharingMode* sharingMode);
 private:
-  void checkFlushStreamBuffer(size_t size);
+  std::string getPipelineCachePath() const;
+  bool isPipelineCacheCompatible(const void* data, size_t size) const;
+  void savePipelineCache();
+  uint64_t getStreamingTail() const;
+  bool waitForOldestStreamingSegment();
+  void retireStreamingSegment(StreamingSegment& segment);
+  void flushStreamingRange(uint64_t begin, uint64_t end);
 
   // Initialization helper functions
   bool getAndCheckDeviceCapabilities(const std::vector<const char*>& deviceExtensions);
@@ -135,11 +183,12 @@ private:
   bool initCommandBuffers();
   bool initAllocator();
   bool initStagingBuffers();
-  bool initStagingBuffer(VkDeviceSize size, StagingBufferInfo* info
+  bool initStreamingSegments();
+  bool initStagingBuffer(VkDeviceSize size, VkBufferUsageFlags usage, StagingBufferInfo* info
 #if KRENGINE_DEBUG_GPU_LABELS
     , const char* debug_label
 #endif // KRENGINE_DEBUG_GPU_LABELS
   );
   bool initDescriptorPool();
-  void streamUploadImpl(size_t size, VkImage destination, VkBufferImageCopy* regions, int regionCount);
+  bool initPipelineCache();
 };
@@ -0,0 +1,238 @@
+//
+//  KRGeometryHeap.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+
+#include "KRGeometryHeap.h"
+#include "KRDevice.h"
+#include "KRContext.h"
+
+KRGeometryHeap::KRGeometryHeap(KRDevice& device)
+  : m_device(device)
+{
+
+}
+
+KRGeometryHeap::~KRGeometryHeap()
+{
+  for (Page& page : m_pages) {
+    destroyPage(page);
+  }
+  m_pages.clear();
+  m_retiredRanges.clear();
+}
+
+bool KRGeometryHeap::allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation, uint32_t pageLimit)
+{
+  assert(size > 0);
+  assert(alignment > 0);
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  uint32_t pageCount = std::min((uint32_t)m_pages.size(), pageLimit);
+  for (uint32_t pageIndex = 0; pageIndex < pageCount; pageIndex++) {
+    if (allocateFromPage(pageIndex, size, alignment, allocation)) {
+      return true;
+    }
+  }
+
+  if (pageLimit != UINT32_MAX) {
+    // Relocations only move data into existing pages
+    return false;
+  }
+
+  uint32_t pageIndex = 0;
+  if (!createPage(std::max(size, KRENGINE_GEOMETRY_HEAP_PAGE_SIZE), &pageIndex)) {
+    return false;
+  }
+  return allocateFromPage(pageIndex, size, alignment, allocation);
+}
+
+bool KRGeometryHeap::allocateFromPage(uint32_t pageIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation)
+{
+  Page& page = m_pages[pageIndex];
+  if (page.buffer == VK_NULL_HANDLE || page.size - page.used < size) {
+    return false;
+  }
+
+  // First fit
+  for (auto itr = page.freeRanges.begin(); itr != page.freeRanges.end(); itr++) {
+    VkDeviceSize rangeStart = itr->first;
+    VkDeviceSize rangeEnd = itr->first + itr->second;
+    VkDeviceSize start = (rangeStart + alignment - 1) / alignment * alignment;
+    if (start + size > rangeEnd) {
+      continue;
+    }
+
+    page.freeRanges.erase(itr);
+    if (start > rangeStart) {
+      page.freeRanges[rangeStart] = start - rangeStart;
+    }
+    if (start + size < rangeEnd) {
+      page.freeRanges[start + size] = rangeEnd - (start + size);
+    }
+    page.used += size;
+
+    allocation->buffer = page.buffer;
+    allocation->offset = start;
+    allocation->size = size;
+    allocation->page = pageIndex;
+    return true;
+  }
+  return false;
+}
+
+void KRGeometryHeap::free(Allocation& allocation)
+{
+  if (allocation.buffer == VK_NULL_HANDLE) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  assert(allocation.page < m_pages.size());
+  assert(m_pages[allocation.page].buffer == allocation.buffer);
+
+  RetiredRange range;
+  range.page = allocation.page;
+  range.offset = allocation.offset;
+  range.size = allocation.size;
+  range.frame = m_device.getContext().getCurrentFrame();
+  m_retiredRanges.push_back(range);
+
+  memset(&allocation, 0, sizeof(Allocation));
+}
+
+void KRGeometryHeap::releaseRange(const RetiredRange& range)
+{
+  Page& page = m_pages[range.page];
+  VkDeviceSize start = range.offset;
+  VkDeviceSize end = range.offset + range.size;
+
+  // Coalesce with the adjacent free ranges
+  auto next = page.freeRanges.lower_bound(start);
+  if (next != page.freeRanges.end() && next->first == end) {
+    end += next->second;
+    next = page.freeRanges.erase(next);
+  }
+  if (next != page.freeRanges.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == start) {
+      start = prev->first;
+      page.freeRanges.erase(prev);
+    }
+  }
+  page.freeRanges[start] = end - start;
+  page.used -= range.size;
+}
+
+bool KRGeometryHeap::isSparse(uint32_t page)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (page == 0 || page >= m_pages.size()) {
+    return false;
+  }
+  return m_pages[page].used * 4 < m_pages[page].size;
+}
+
+void KRGeometryHeap::trim()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  long currentFrame = m_device.getContext().getCurrentFrame();
+  while (!m_retiredRanges.empty() && m_retiredRanges.front().frame + KRENGINE_MAX_FRAMES_IN_FLIGHT < currentFrame) {
+    releaseRange(m_retiredRanges.front());
+    m_retiredRanges.pop_front();
+  }
+
+  // Retired ranges are still counted as used, so a page is only released once
+  // no frame in flight can refer to it
+  for (size_t pageIndex = 1; pageIndex < m_pages.size(); pageIndex++) {
+    Page& page = m_pages[pageIndex];
+    if (page.buffer != VK_NULL_HANDLE && page.used == 0) {
+      destroyPage(page);
+    }
+  }
+  // Page indices are held by allocations, so only released pages at the end are removed
+  while (m_pages.size() > 1 && m_pages.back().buffer == VK_NULL_HANDLE) {
+    m_pages.pop_back();
+  }
+}
+
+bool KRGeometryHeap::createPage(VkDeviceSize size, uint32_t* pageIndex)
+{
+  // Reuse the slot of a released page, if any
+  uint32_t index = 0;
+  while (index < m_pages.size() && m_pages[index].buffer != VK_NULL_HANDLE) {
+    index++;
+  }
+  if (index == m_pages.size()) {
+    m_pages.emplace_back();
+  }
+  Page& page = m_pages[index];
+
+#if KRENGINE_DEBUG_GPU_LABELS
+  char debug_label[KRENGINE_DEBUG_GPU_LABEL_MAX_LEN];
+  snprintf(debug_label, KRENGINE_DEBUG_GPU_LABEL_MAX_LEN, "Geometry Heap Page %i", (int)index);
+#endif // KRENGINE_DEBUG_GPU_LABELS
+
+  if (!m_device.createBuffer(
+    size,
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    &page.buffer,
+    &page.allocation
+#if KRENGINE_DEBUG_GPU_LABELS
+    , debug_label
+#endif // KRENGINE_DEBUG_GPU_LABELS
+  )) {
+    page.buffer = VK_NULL_HANDLE;
+    page.allocation = VK_NULL_HANDLE;
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to allocate a %llu byte geometry heap page.", (unsigned long long)size);
+    return false;
+  }
+
+  page.size = size;
+  page.used = 0;
+  page.freeRanges.clear();
+  page.freeRanges[0] = size;
+  *pageIndex = index;
+  return true;
+}
+
+void KRGeometryHeap::destroyPage(Page& page)
+{
+  if (page.buffer != VK_NULL_HANDLE) {
+    vmaDestroyBuffer(m_device.getAllocator(), page.buffer, page.allocation);
+  }
+  page.buffer = VK_NULL_HANDLE;
+  page.allocation = VK_NULL_HANDLE;
+  page.size = 0;
+  page.used = 0;
+  page.freeRanges.clear();
+}
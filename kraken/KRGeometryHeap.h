@@ -0,0 +1,107 @@
+//
+//  KRGeometryHeap.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+
+#pragma once
+
+#include "KREngine-common.h"
+
+class KRDevice;
+
+// Sub-allocates vertex and index data from a small number of large,
+// device-local buffers so that many meshes can share one binding.
+class KRGeometryHeap
+{
+public:
+  static constexpr VkDeviceSize KRENGINE_GEOMETRY_HEAP_PAGE_SIZE = 64 * 1024 * 1024;
+
+  struct Allocation
+  {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    uint32_t page;
+  };
+
+  KRGeometryHeap(KRDevice& device);
+  ~KRGeometryHeap();
+
+  KRGeometryHeap(const KRGeometryHeap&) = delete;
+  KRGeometryHeap& operator=(const KRGeometryHeap&) = delete;
+
+  // Allocates from the first page with a large enough free range, creating a
+  // new page if none fits.  When pageLimit is given, only existing pages below
+  // it are considered.
+  bool allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation, uint32_t pageLimit = UINT32_MAX);
+
+  // Retires the allocation.  Frames still in flight may read from it, so the
+  // range is only returned to its page by trim(), once they have completed.
+  void free(Allocation& allocation);
+
+  // Returns true if the page is lightly used and its contents should be
+  // relocated to earlier pages so that it can be released.
+  bool isSparse(uint32_t page);
+
+  // Returns ranges retired more than KRENGINE_MAX_FRAMES_IN_FLIGHT frames ago
+  // to their pages, then releases pages with no remaining allocations, other
+  // than the first.
+  void trim();
+
+private:
+  struct Page
+  {
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    VkDeviceSize size;
+    VkDeviceSize used;
+    // Free ranges, keyed by offset
+    std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+  };
+
+  struct RetiredRange
+  {
+    uint32_t page;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    long frame; // Frame in which the range was freed
+  };
+
+  bool allocateFromPage(uint32_t pageIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation);
+  bool createPage(VkDeviceSize size, uint32_t* pageIndex);
+  void releaseRange(const RetiredRange& range);
+  void destroyPage(Page& page);
+
+  KRDevice& m_device;
+  std::vector<Page> m_pages;
+  // Freed ranges that are still counted as used, in the order they were freed
+  std::deque<RetiredRange> m_retiredRanges;
+  std::mutex m_mutex;
+};
@@ -0,0 +1,426 @@
+//
+//  KRInflate.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+
+#include "KRInflate.h"
+
+namespace {
+
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const uint8_t kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+} // anonymous namespace
+
+KRInflate::KRInflate()
+  : m_segmentIndex(0)
+  , m_input(nullptr)
+  , m_inputEnd(nullptr)
+  , m_bitBuffer(0)
+  , m_bitCount(0)
+  , m_state(State::zlibHeader)
+  , m_finalBlock(false)
+  , m_storedRemaining(0)
+  , m_matchRemaining(0)
+  , m_matchDistance(0)
+  , m_totalOut(0)
+  , m_output(nullptr)
+{
+  m_window.resize(kWindowSize);
+}
+
+KRInflate::~KRInflate()
+{
+}
+
+void KRInflate::addInput(const uint8_t* data, size_t length)
+{
+  if (length > 0) {
+    m_segments.push_back(std::make_pair(data, length));
+  }
+}
+
+bool KRInflate::finished() const
+{
+  return m_state == State::done;
+}
+
+bool KRInflate::failed() const
+{
+  return m_state == State::error;
+}
+
+bool KRInflate::nextSegment()
+{
+  if (m_segmentIndex >= m_segments.size()) {
+    return false;
+  }
+  m_input = m_segments[m_segmentIndex].first;
+  m_inputEnd = m_input + m_segments[m_segmentIndex].second;
+  m_segmentIndex++;
+  return true;
+}
+
+void KRInflate::refill()
+{
+  while (m_bitCount <= 56) {
+    if (m_inputEnd - m_input >= 8) {
+      // Load a whole word; bits beyond m_bitCount are reloaded identically by the next refill
+      uint64_t word;
+      memcpy(&word, m_input, sizeof(word));
+      m_bitBuffer |= word << m_bitCount;
+      m_input += (63 - m_bitCount) >> 3;
+      m_bitCount |= 56;
+      return;
+    }
+    if (m_input == m_inputEnd) {
+      if (!nextSegment()) {
+        return;
+      }
+      continue;
+    }
+    m_bitBuffer |= (uint64_t)*m_input++ << m_bitCount;
+    m_bitCount += 8;
+  }
+}
+
+bool KRInflate::getBits(int count, uint32_t* bits)
+{
+  if (m_bitCount < count) {
+    refill();
+    if (m_bitCount < count) {
+      return false;
+    }
+  }
+  *bits = (uint32_t)(m_bitBuffer & ((1ull << count) - 1));
+  m_bitBuffer >>= count;
+  m_bitCount -= count;
+  return true;
+}
+
+bool KRInflate::build(Huffman& huffman, const uint8_t* lengths, int symbolCount)
+{
+  memset(huffman.count, 0, sizeof(huffman.count));
+  for (int i = 0; i < symbolCount; i++) {
+    huffman.count[lengths[i]]++;
+  }
+  huffman.count[0] = 0;
+
+  // Reject over-subscribed codes.  Incomplete codes are permitted.
+  int left = 1;
+  for (int length = 1; length < 16; length++) {
+    left <<= 1;
+    left -= huffman.count[length];
+    if (left < 0) {
+      return false;
+    }
+  }
+
+  uint16_t offsets[16];
+  uint16_t nextCode[16];
+  offsets[1] = 0;
+  nextCode[1] = 0;
+  for (int length = 1; length < 15; length++) {
+    offsets[length + 1] = offsets[length] + huffman.count[length];
+    nextCode[length + 1] = (nextCode[length] + huffman.count[length]) << 1;
+  }
+
+  memset(huffman.fast, 0, sizeof(huffman.fast));
+  for (int i = 0; i < symbolCount; i++) {
+    int length = lengths[i];
+    if (length == 0) {
+      continue;
+    }
+    huffman.symbol[offsets[length]++] = (uint16_t)i;
+    uint32_t code = nextCode[length]++;
+    if (length <= kFastBits) {
+      // Deflate packs codes most significant bit first
+      uint32_t reversed = 0;
+      for (int bit = 0; bit < length; bit++) {
+        reversed = (reversed << 1) | ((code >> bit) & 1);
+      }
+      for (uint32_t entry = reversed; entry < (1u << kFastBits); entry += 1u << length) {
+        huffman.fast[entry] = (uint16_t)((i << 4) | length);
+      }
+    }
+  }
+  return true;
+}
+
+int KRInflate::decode(const Huffman& huffman)
+{
+  if (m_bitCount < 15) {
+    refill();
+  }
+  uint16_t entry = huffman.fast[m_bitBuffer & ((1 << kFastBits) - 1)];
+  if (entry) {
+    int length = entry & 15;
+    if (length > m_bitCount) {
+      return -1;
+    }
+    m_bitBuffer >>= length;
+    m_bitCount -= length;
+    return entry >> 4;
+  }
+
+  // Canonical decode, one bit at a time, for codes longer than kFastBits
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int length = 1; length < 16 && length <= m_bitCount; length++) {
+    code |= (int)((m_bitBuffer >> (length - 1)) & 1);
+    int count = huffman.count[length];
+    if (code - first < count) {
+      m_bitBuffer >>= length;
+      m_bitCount -= length;
+      return huffman.symbol[index + code - first];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+bool KRInflate::readZlibHeader()
+{
+  uint32_t cmf, flg;
+  if (!getBits(8, &cmf) || !getBits(8, &flg)) {
+    return false;
+  }
+  if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0) {
+    return false;
+  }
+  if (flg & 0x20) {
+    return false; // Preset dictionaries are not supported
+  }
+  return true;
+}
+
+bool KRInflate::readDynamicTables()
+{
+  uint32_t literalCount, distanceCount, codeLengthCount;
+  if (!getBits(5, &literalCount) || !getBits(5, &distanceCount) || !getBits(4, &codeLengthCount)) {
+    return false;
+  }
+  literalCount += 257;
+  distanceCount += 1;
+  codeLengthCount += 4;
+  if (literalCount > 286 || distanceCount > 30) {
+    return false;
+  }
+
+  uint8_t lengths[286 + 30] = {};
+  for (uint32_t i = 0; i < codeLengthCount; i++) {
+    uint32_t length;
+    if (!getBits(3, &length)) {
+      return false;
+    }
+    lengths[kCodeLengthOrder[i]] = (uint8_t)length;
+  }
+  Huffman& codeLengths = m_distances; // Scratch, rebuilt below
+  if (!build(codeLengths, lengths, 19)) {
+    return false;
+  }
+
+  memset(lengths, 0, 19);
+  uint32_t index = 0;
+  while (index < literalCount + distanceCount) {
+    int symbol = decode(codeLengths);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[index++] = (uint8_t)symbol;
+      continue;
+    }
+    uint8_t value = 0;
+    uint32_t repeat;
+    if (symbol == 16) {
+      if (index == 0 || !getBits(2, &repeat)) {
+        return false;
+      }
+      value = lengths[index - 1];
+      repeat += 3;
+    } else if (symbol == 17) {
+      if (!getBits(3, &repeat)) {
+        return false;
+      }
+      repeat += 3;
+    } else {
+      if (!getBits(7, &repeat)) {
+        return false;
+      }
+      repeat += 11;
+    }
+    if (index + repeat > literalCount + distanceCount) {
+      return false;
+    }
+    while (repeat--) {
+      lengths[index++] = value;
+    }
+  }
+
+  if (lengths[256] == 0) {
+    return false; // No end of block code
+  }
+  return build(m_literals, lengths, literalCount) && build(m_distances, lengths + literalCount, distanceCount);
+}
+
+bool KRInflate::readBlockHeader()
+{
+  uint32_t final, type;
+  if (!getBits(1, &final) || !getBits(2, &type)) {
+    return false;
+  }
+  m_finalBlock = final != 0;
+
+  switch (type) {
+  case 0:
+  {
+    // Stored blocks start on a byte boundary
+    uint32_t unused, length, complement;
+    if (!getBits(m_bitCount & 7, &unused) || !getBits(16, &length) || !getBits(16, &complement)) {
+      return false;
+    }
+    if ((length ^ 0xffff) != complement) {
+      return false;
+    }
+    m_storedRemaining = length;
+    m_state = State::stored;
+    return true;
+  }
+  case 1:
+  {
+    uint8_t lengths[288 + 30];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    memset(lengths + 288, 5, 30);
+    build(m_literals, lengths, 288);
+    build(m_distances, lengths + 288, 30);
+    m_state = State::huffman;
+    return true;
+  }
+  case 2:
+    if (!readDynamicTables()) {
+      return false;
+    }
+    m_state = State::huffman;
+    return true;
+  default:
+    return false;
+  }
+}
+
+void KRInflate::emit(uint8_t value)
+{
+  *m_output++ = value;
+  m_window[m_totalOut++ & (kWindowSize - 1)] = value;
+}
+
+size_t KRInflate::read(uint8_t* output, size_t length)
+{
+  m_output = output;
+  uint8_t* outputEnd = output + length;
+
+  while (m_output < outputEnd) {
+    if (m_matchRemaining > 0) {
+      size_t count = std::min<size_t>(m_matchRemaining, outputEnd - m_output);
+      m_matchRemaining -= (uint32_t)count;
+      while (count--) {
+        emit(m_window[(m_totalOut - m_matchDistance) & (kWindowSize - 1)]);
+      }
+      continue;
+    }
+
+    switch (m_state) {
+    case State::zlibHeader:
+      m_state = readZlibHeader() ? State::blockHeader : State::error;
+      break;
+    case State::blockHeader:
+      if (!readBlockHeader()) {
+        m_state = State::error;
+      }
+      break;
+    case State::stored:
+      if (m_storedRemaining == 0) {
+        m_state = m_finalBlock ? State::done : State::blockHeader;
+        break;
+      }
+      {
+        uint32_t value;
+        if (!getBits(8, &value)) {
+          m_state = State::error;
+          break;
+        }
+        emit((uint8_t)value);
+        m_storedRemaining--;
+      }
+      break;
+    case State::huffman:
+    {
+      int symbol = decode(m_literals);
+      if (symbol < 0) {
+        m_state = State::error;
+      } else if (symbol < 256) {
+        emit((uint8_t)symbol);
+      } else if (symbol == 256) {
+        m_state = m_finalBlock ? State::done : State::blockHeader;
+      } else {
+        symbol -= 257;
+        uint32_t lengthExtra, distanceExtra;
+        if (symbol >= 29 || !getBits(kLengthExtra[symbol], &lengthExtra)) {
+          m_state = State::error;
+          break;
+        }
+        int distanceSymbol = decode(m_distances);
+        if (distanceSymbol < 0 || distanceSymbol >= 30 || !getBits(kDistanceExtra[distanceSymbol], &distanceExtra)) {
+          m_state = State::error;
+          break;
+        }
+        m_matchRemaining = kLengthBase[symbol] + lengthExtra;
+        m_matchDistance = kDistanceBase[distanceSymbol] + distanceExtra;
+        if (m_matchDistance > m_totalOut) {
+          m_matchRemaining = 0;
+          m_state = State::error;
+        }
+      }
+      break;
+    }
+    case State::done:
+    case State::error:
+      return m_output - output;
+    }
+  }
+  return m_output - output;
+}
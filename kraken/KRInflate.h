@@ -0,0 +1,107 @@
+//
+//  KRInflate.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+
+#pragma once
+
+#include "KREngine-common.h"
+
+// Streaming decoder for zlib (RFC 1950) wrapped deflate (RFC 1951) data.
+// The compressed stream may be split across non-contiguous segments, such as
+// the IDAT chunks of a PNG file.  Output is pulled in pieces of any size, so
+// callers can decode directly into their destination.
+class KRInflate
+{
+public:
+  KRInflate();
+  ~KRInflate();
+
+  // The segment must remain valid until decoding is complete
+  void addInput(const uint8_t* data, size_t length);
+
+  // Decompresses up to length bytes into output, returning the number of bytes written.
+  // Fewer than length bytes are returned only at the end of the stream or on error.
+  size_t read(uint8_t* output, size_t length);
+
+  bool finished() const;
+  bool failed() const;
+
+private:
+  static const int kFastBits = 10;
+  static const size_t kWindowSize = 32768;
+
+  struct Huffman
+  {
+    // (symbol << 4) | length for codes of up to kFastBits bits, 0 for longer codes
+    uint16_t fast[1 << kFastBits];
+    uint16_t count[16];
+    uint16_t symbol[288];
+  };
+
+  enum class State
+  {
+    zlibHeader,
+    blockHeader,
+    stored,
+    huffman,
+    done,
+    error
+  };
+
+  bool build(Huffman& huffman, const uint8_t* lengths, int symbolCount);
+  bool readZlibHeader();
+  bool readBlockHeader();
+  bool readDynamicTables();
+  int decode(const Huffman& huffman);
+
+  void refill();
+  bool nextSegment();
+  bool getBits(int count, uint32_t* bits);
+  void emit(uint8_t value);
+
+  std::vector<std::pair<const uint8_t*, size_t>> m_segments;
+  size_t m_segmentIndex;
+  const uint8_t* m_input;
+  const uint8_t* m_inputEnd;
+  uint64_t m_bitBuffer;
+  int m_bitCount;
+
+  State m_state;
+  bool m_finalBlock;
+  uint32_t m_storedRemaining;
+  uint32_t m_matchRemaining;
+  uint32_t m_matchDistance;
+
+  std::vector<uint8_t> m_window;
+  size_t m_totalOut;
+  uint8_t* m_output;
+
+  Huffman m_literals;
+  Huffman m_distances;
+};
@@ -0,0 +1,593 @@
+//
+//  KRLinearOctree.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KRLinearOctree.h"
+#include "nodes/KRNode.h"
+#include "nodes/KRCollider.h"
+#include "KRViewport.h"
+#include "KRWorkerPool.h"
+
+#include <bit>
+
+using namespace hydra;
+
+namespace {
+
+// Depth of the finest octree cell; MortonCode() supports up to 10 bits per axis
+const int KRENGINE_LINEAR_OCTREE_MAX_DEPTH = 10;
+const uint32_t KRENGINE_LINEAR_OCTREE_GRID_SIZE = 1 << KRENGINE_LINEAR_OCTREE_MAX_DEPTH;
+const size_t KRENGINE_LINEAR_OCTREE_CAST_CHUNK_SIZE = 64;
+
+} // anonymous namespace
+
+KRLinearOctree::KRLinearOctree()
+  : m_rootBounds(AABB::Zero())
+  , m_removedCount(0)
+  , m_refitCount(0)
+  , m_revision(0)
+{
+}
+
+KRLinearOctree::~KRLinearOctree()
+{
+}
+
+void KRLinearOctree::add(KRNode* pNode)
+{
+  m_revision++;
+  AABB nodeBounds = pNode->getBounds();
+  if (nodeBounds == AABB::Zero()) {
+    // This item is not visible, don't add it to the octree or outer scene nodes
+  } else if (nodeBounds == AABB::Infinite()) {
+    // This item is infinitely large; we track it separately
+    m_outerSceneNodes.insert(pNode);
+  } else {
+    addPending(pNode, nodeBounds);
+  }
+}
+
+void KRLinearOctree::remove(KRNode* pNode)
+{
+  m_revision++;
+  if (!m_outerSceneNodes.erase(pNode)) {
+    removeItem(pNode);
+  }
+}
+
+void KRLinearOctree::update(KRNode* pNode)
+{
+  std::unordered_map<KRNode*, Location>::iterator itr = m_locations.find(pNode);
+  if (itr != m_locations.end()) {
+    AABB nodeBounds = pNode->getBounds();
+    if (!(nodeBounds == AABB::Zero()) && !(nodeBounds == AABB::Infinite())) {
+      if (itr->second.pending) {
+        m_pending[itr->second.index].bounds = nodeBounds;
+        m_revision++;
+        return;
+      }
+
+      Item& item = m_items[itr->second.index];
+      uint64_t key;
+      int level;
+      if (getCell(nodeBounds, key, level) && key == item.key && level == item.level) {
+        // Still within the same cell; grow the bounds of the enclosing octree nodes.
+        // They will be tightened again on the next rebuild.
+        item.bounds = nodeBounds;
+        m_revision++;
+        for (uint32_t i = item.octreeNode; i != kInvalidIndex; i = m_nodes[i].parent) {
+          m_nodes[i].bounds.encapsulate(nodeBounds);
+        }
+        m_refitCount++;
+        return;
+      }
+    }
+  }
+
+  remove(pNode);
+  add(pNode);
+}
+
+std::set<KRNode*>& KRLinearOctree::getOuterSceneNodes()
+{
+  return m_outerSceneNodes;
+}
+
+size_t KRLinearOctree::getSceneNodeCount() const
+{
+  return m_outerSceneNodes.size() + m_locations.size();
+}
+
+AABB KRLinearOctree::getBounds() const
+{
+  bool has_bounds = !m_nodes.empty();
+  AABB bounds = has_bounds ? m_nodes[0].bounds : AABB::Zero();
+  for (const Item& item : m_pending) {
+    if (has_bounds) {
+      bounds.encapsulate(item.bounds);
+    } else {
+      bounds = item.bounds;
+      has_bounds = true;
+    }
+  }
+  return bounds;
+}
+
+uint64_t KRLinearOctree::getRevision() const
+{
+  return m_revision;
+}
+
+void KRLinearOctree::addPending(KRNode* pNode, const AABB& bounds)
+{
+  Item item;
+  item.node = pNode;
+  item.collider = dynamic_cast<KRCollider*>(pNode);
+  item.bounds = bounds;
+  item.key = 0;
+  item.level = 0;
+  item.octreeNode = kInvalidIndex;
+  m_locations[pNode] = Location{ true, (uint32_t)m_pending.size() };
+  m_pending.push_back(item);
+}
+
+void KRLinearOctree::removeItem(KRNode* pNode)
+{
+  std::unordered_map<KRNode*, Location>::iterator itr = m_locations.find(pNode);
+  if (itr == m_locations.end()) {
+    return;
+  }
+  Location location = itr->second;
+  m_locations.erase(itr);
+
+  if (location.pending) {
+    if (location.index != m_pending.size() - 1) {
+      m_pending[location.index] = m_pending.back();
+      m_locations[m_pending[location.index].node].index = location.index;
+    }
+    m_pending.pop_back();
+  } else {
+    // Leave a hole in the item range of the octree node until the next rebuild
+    m_items[location.index].node = nullptr;
+    m_items[location.index].collider = nullptr;
+    m_removedCount++;
+  }
+}
+
+bool KRLinearOctree::getCell(const AABB& bounds, uint64_t& key, int& level) const
+{
+  if (bounds.min.x < m_rootBounds.min.x || bounds.min.y < m_rootBounds.min.y || bounds.min.z < m_rootBounds.min.z ||
+      bounds.max.x > m_rootBounds.max.x || bounds.max.y > m_rootBounds.max.y || bounds.max.z > m_rootBounds.max.z) {
+    return false;
+  }
+
+  float scale = (float)KRENGINE_LINEAR_OCTREE_GRID_SIZE / m_rootBounds.size().x;
+  auto quantize = [scale](float v, float root_min) {
+    float f = (v - root_min) * scale;
+    if (f < 0.0f) {
+      return 0u;
+    }
+    if (f >= (float)KRENGINE_LINEAR_OCTREE_GRID_SIZE) {
+      return KRENGINE_LINEAR_OCTREE_GRID_SIZE - 1;
+    }
+    return (uint32_t)f;
+  };
+  uint32_t x0 = quantize(bounds.min.x, m_rootBounds.min.x);
+  uint32_t y0 = quantize(bounds.min.y, m_rootBounds.min.y);
+  uint32_t z0 = quantize(bounds.min.z, m_rootBounds.min.z);
+  uint32_t x1 = quantize(bounds.max.x, m_rootBounds.min.x);
+  uint32_t y1 = quantize(bounds.max.y, m_rootBounds.min.y);
+  uint32_t z1 = quantize(bounds.max.z, m_rootBounds.min.z);
+
+  // The deepest cell that contains both corners is found from the highest bit in which
+  // their grid coordinates differ
+  int bits = std::bit_width((x0 ^ x1) | (y0 ^ y1) | (z0 ^ z1));
+  level = KRENGINE_LINEAR_OCTREE_MAX_DEPTH - bits;
+  key = KROctree::MortonCode(x0 >> bits << bits, y0 >> bits << bits, z0 >> bits << bits);
+  return true;
+}
+
+void KRLinearOctree::rebuild()
+{
+  m_revision++;
+  std::vector<Item> items;
+  items.reserve(m_items.size() - m_removedCount + m_pending.size());
+  for (const Item& item : m_items) {
+    if (item.node) {
+      items.push_back(item);
+    }
+  }
+  items.insert(items.end(), m_pending.begin(), m_pending.end());
+
+  m_items.clear();
+  m_pending.clear();
+  m_nodes.clear();
+  m_locations.clear();
+  m_removedCount = 0;
+  m_refitCount = 0;
+
+  if (items.empty()) {
+    m_rootBounds = AABB::Zero();
+    return;
+  }
+
+  // The root is a cube around all scene nodes, padded so that small movements
+  // can be handled in place
+  AABB bounds = items[0].bounds;
+  for (const Item& item : items) {
+    bounds.encapsulate(item.bounds);
+  }
+  Vector3 size = bounds.size();
+  float extent = std::max(size.x, std::max(size.y, size.z));
+  extent = extent > 0.0f ? extent * 1.25f : 1.0f;
+  Vector3 center = bounds.center();
+  m_rootBounds = AABB::Create(center - Vector3::Create(extent * 0.5f), center + Vector3::Create(extent * 0.5f));
+
+  for (Item& item : items) {
+    if (!getCell(item.bounds, item.key, item.level)) {
+      // Only reachable through floating point rounding at the root boundary
+      item.key = 0;
+      item.level = 0;
+    }
+  }
+
+  // Sorting by Morton code, then by level, places each cell's scene nodes before those of its
+  // descendants, giving a depth-first order
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+    if (a.key != b.key) {
+      return a.key < b.key;
+    }
+    if (a.level != b.level) {
+      return a.level < b.level;
+    }
+    return std::less<KRNode*>()(a.node, b.node);
+  });
+
+  m_items = std::move(items);
+  m_nodes.reserve(m_items.size() * 2);
+  build(0, m_items.size(), 0, kInvalidIndex);
+
+  for (uint32_t i = 0; i < m_items.size(); i++) {
+    m_locations[m_items[i].node] = Location{ false, i };
+  }
+}
+
+uint32_t KRLinearOctree::build(size_t begin, size_t end, int level, uint32_t parent)
+{
+  auto childOctant = [](const Item& item, int level) {
+    return (item.key >> (3 * (KRENGINE_LINEAR_OCTREE_MAX_DEPTH - level - 1))) & 7;
+  };
+
+  // Collapse cells that contain no scene nodes of their own and have only one occupied child
+  while (level < KRENGINE_LINEAR_OCTREE_MAX_DEPTH && m_items[begin].level > level && childOctant(m_items[begin], level) == childOctant(m_items[end - 1], level)) {
+    level++;
+  }
+
+  uint32_t index = (uint32_t)m_nodes.size();
+  m_nodes.push_back(Node{});
+
+  size_t i = begin;
+  while (i < end && m_items[i].level == level) {
+    m_items[i].octreeNode = index;
+    i++;
+  }
+  size_t own_end = i;
+
+  bool has_bounds = false;
+  AABB bounds = AABB::Zero();
+  for (size_t j = begin; j < i; j++) {
+    if (has_bounds) {
+      bounds.encapsulate(m_items[j].bounds);
+    } else {
+      bounds = m_items[j].bounds;
+      has_bounds = true;
+    }
+  }
+
+  while (i < end) {
+    uint64_t octant = childOctant(m_items[i], level);
+    size_t j = i + 1;
+    while (j < end && childOctant(m_items[j], level) == octant) {
+      j++;
+    }
+    uint32_t child = build(i, j, level + 1, index);
+    if (has_bounds) {
+      bounds.encapsulate(m_nodes[child].bounds);
+    } else {
+      bounds = m_nodes[child].bounds;
+      has_bounds = true;
+    }
+    i = j;
+  }
+
+  Node& node = m_nodes[index];
+  node.bounds = bounds;
+  node.parent = parent;
+  node.skip = (uint32_t)m_nodes.size();
+  node.itemBegin = (uint32_t)begin;
+  node.itemEnd = (uint32_t)own_end;
+  return index;
+}
+
+void KRLinearOctree::refresh()
+{
+  size_t threshold = std::max<size_t>(64, m_items.size() / 8);
+  if (m_pending.size() > threshold || m_removedCount > threshold || m_refitCount > m_items.size() + threshold) {
+    rebuild();
+  }
+}
+
+void KRLinearOctree::prepareCollidersForCasts()
+{
+  for (KRNode* node : m_outerSceneNodes) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      collider->prepareForCasts();
+    }
+  }
+  for (const Item& item : m_items) {
+    if (item.collider) {
+      item.collider->prepareForCasts();
+    }
+  }
+  for (const Item& item : m_pending) {
+    if (item.collider) {
+      item.collider->prepareForCasts();
+    }
+  }
+}
+
+void KRLinearOctree::findVisible(const KRViewport& viewport, std::vector<KRNode*>& visible)
+{
+  findNodes([&viewport](const AABB* bounds, size_t count, uint8_t* mask) {
+    viewport.visibleBatch(bounds, count, mask);
+  }, visible);
+}
+
+void KRLinearOctree::findIntersecting(const AABB& bounds, std::vector<KRNode*>& nodes)
+{
+  findNodes([&bounds](const AABB* candidates, size_t count, uint8_t* mask) {
+    for (size_t i = 0; i < count; i++) {
+      mask[i] = candidates[i].intersects(bounds) ? 1 : 0;
+    }
+  }, nodes);
+}
+
+void KRLinearOctree::findNodes(const std::function<void(const AABB* bounds, size_t count, uint8_t* mask)>& cull, std::vector<KRNode*>& nodes)
+{
+  refresh();
+
+  // Items are gathered into contiguous bounds and culled as a batch
+  std::vector<AABB> bounds;
+  std::vector<uint8_t> mask;
+  auto cullItems = [&](const Item* items, size_t count) {
+    bounds.resize(count);
+    mask.resize(count);
+    for (size_t j = 0; j < count; j++) {
+      bounds[j] = items[j].bounds;
+    }
+    cull(bounds.data(), count, mask.data());
+    for (size_t j = 0; j < count; j++) {
+      if (mask[j] && items[j].node) {
+        nodes.push_back(items[j].node);
+      }
+    }
+  };
+
+  cullItems(m_pending.data(), m_pending.size());
+
+  size_t i = 0;
+  while (i < m_nodes.size()) {
+    const Node& node = m_nodes[i];
+    uint8_t node_visible = 0;
+    cull(&node.bounds, 1, &node_visible);
+    if (!node_visible) {
+      i = node.skip;
+      continue;
+    }
+    cullItems(m_items.data() + node.itemBegin, node.itemEnd - node.itemBegin);
+    i++;
+  }
+}
+
+bool KRLinearOctree::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  refresh();
+  return lineCastNoRefresh(v0, v1, hitinfo, layer_mask);
+}
+
+bool KRLinearOctree::rayCast(const Vector3& v0, const Vector3& dir, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  refresh();
+  return rayCastNoRefresh(v0, dir, hitinfo, layer_mask);
+}
+
+bool KRLinearOctree::sphereCast(const Vector3& v0, const Vector3& v1, float radius, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  refresh();
+  return sphereCastNoRefresh(v0, v1, radius, hitinfo, layer_mask);
+}
+
+bool KRLinearOctree::lineCastNoRefresh(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  bool hit_found = false;
+  for (KRNode* node : m_outerSceneNodes) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      if (collider->lineCast(v0, v1, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+  for (const Item& item : m_pending) {
+    if (item.collider) {
+      if (item.collider->lineCast(v0, v1, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+
+  size_t i = 0;
+  while (i < m_nodes.size()) {
+    const Node& node = m_nodes[i];
+    // Optimization: If we already have a hit, only search for hits that are closer
+    Vector3 end = hitinfo.didHit() ? hitinfo.getPosition() : v1;
+    if (!node.bounds.intersectsLine(v0, end)) {
+      i = node.skip;
+      continue;
+    }
+    for (uint32_t j = node.itemBegin; j < node.itemEnd; j++) {
+      KRCollider* collider = m_items[j].collider;
+      if (collider) {
+        if (collider->lineCast(v0, end, hitinfo, layer_mask)) hit_found = true;
+      }
+    }
+    i++;
+  }
+  return hit_found;
+}
+
+bool KRLinearOctree::rayCastNoRefresh(const Vector3& v0, const Vector3& dir, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  bool hit_found = false;
+  for (KRNode* node : m_outerSceneNodes) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      if (collider->rayCast(v0, dir, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+  for (const Item& item : m_pending) {
+    if (item.collider) {
+      if (item.collider->rayCast(v0, dir, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+
+  size_t i = 0;
+  while (i < m_nodes.size()) {
+    const Node& node = m_nodes[i];
+    // Once there is a hit, only search for hits that are closer; this becomes a lineCast
+    bool as_line = hitinfo.didHit();
+    Vector3 end = as_line ? hitinfo.getPosition() : v0;
+    if (as_line ? !node.bounds.intersectsLine(v0, end) : !node.bounds.intersectsRay(v0, dir)) {
+      i = node.skip;
+      continue;
+    }
+    for (uint32_t j = node.itemBegin; j < node.itemEnd; j++) {
+      KRCollider* collider = m_items[j].collider;
+      if (collider) {
+        if (as_line) {
+          if (collider->lineCast(v0, end, hitinfo, layer_mask)) hit_found = true;
+        } else {
+          if (collider->rayCast(v0, dir, hitinfo, layer_mask)) hit_found = true;
+        }
+      }
+    }
+    i++;
+  }
+  return hit_found;
+}
+
+bool KRLinearOctree::sphereCastNoRefresh(const Vector3& v0, const Vector3& v1, float radius, HitInfo& hitinfo, unsigned int layer_mask)
+{
+  bool hit_found = false;
+  for (KRNode* node : m_outerSceneNodes) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      if (collider->sphereCast(v0, v1, radius, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+  for (const Item& item : m_pending) {
+    if (item.collider) {
+      if (item.collider->sphereCast(v0, v1, radius, hitinfo, layer_mask)) hit_found = true;
+    }
+  }
+
+  AABB swept_bounds = AABB::Create(Vector3::Create(std::min(v0.x, v1.x) - radius, std::min(v0.y, v1.y) - radius, std::min(v0.z, v1.z) - radius), Vector3::Create(std::max(v0.x, v1.x) + radius, std::max(v0.y, v1.y) + radius, std::max(v0.z, v1.z) + radius));
+  size_t i = 0;
+  while (i < m_nodes.size()) {
+    const Node& node = m_nodes[i];
+    if (!node.bounds.intersects(swept_bounds)) {
+      i = node.skip;
+      continue;
+    }
+    for (uint32_t j = node.itemBegin; j < node.itemEnd; j++) {
+      KRCollider* collider = m_items[j].collider;
+      if (collider) {
+        if (collider->sphereCast(v0, v1, radius, hitinfo, layer_mask)) hit_found = true;
+      }
+    }
+    i++;
+  }
+  return hit_found;
+}
+
+size_t KRLinearOctree::castBatch(size_t count, KRWorkerPool* pool, const std::function<bool(size_t)>& cast)
+{
+  refresh();
+  prepareCollidersForCasts();
+
+  // Each query writes only its own result, so the outcome does not depend on scheduling
+  std::vector<uint8_t> hits(count, 0);
+  size_t chunk_count = (count + KRENGINE_LINEAR_OCTREE_CAST_CHUNK_SIZE - 1) / KRENGINE_LINEAR_OCTREE_CAST_CHUNK_SIZE;
+  auto castChunk = [&](size_t chunk) {
+    size_t chunk_end = std::min(count, (chunk + 1) * KRENGINE_LINEAR_OCTREE_CAST_CHUNK_SIZE);
+    for (size_t i = chunk * KRENGINE_LINEAR_OCTREE_CAST_CHUNK_SIZE; i < chunk_end; i++) {
+      hits[i] = cast(i) ? 1 : 0;
+    }
+  };
+  if (pool) {
+    pool->parallelFor(chunk_count, castChunk);
+  } else {
+    for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+      castChunk(chunk);
+    }
+  }
+  return std::count(hits.begin(), hits.end(), 1);
+}
+
+size_t KRLinearOctree::lineCastBatch(std::span<const KROctree::Line> lines, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= lines.size());
+  return castBatch(lines.size(), pool, [&](size_t i) {
+    return lineCastNoRefresh(lines[i].v0, lines[i].v1, hitinfo[i], layer_mask);
+  });
+}
+
+size_t KRLinearOctree::rayCastBatch(std::span<const KROctree::Ray> rays, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= rays.size());
+  return castBatch(rays.size(), pool, [&](size_t i) {
+    return rayCastNoRefresh(rays[i].v0, rays[i].dir, hitinfo[i], layer_mask);
+  });
+}
+
+size_t KRLinearOctree::sphereCastBatch(std::span<const KROctree::SweptSphere> spheres, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= spheres.size());
+  return castBatch(spheres.size(), pool, [&](size_t i) {
+    return sphereCastNoRefresh(spheres[i].v0, spheres[i].v1, spheres[i].radius, hitinfo[i], layer_mask);
+  });
+}
@@ -0,0 +1,155 @@
+//
+//  KRLinearOctree.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+#include "KROctree.h"
+
+#include <functional>
+
+class KRNode;
+class KRCollider;
+class KRViewport;
+class KRWorkerPool;
+
+// A Morton-ordered linear octree, offering the same add / remove / update / cast interface as
+// KROctree.  Nodes are stored contiguously in depth-first order, each with a skip index to the
+// end of its subtree and a contiguous range of scene nodes, so that traversal is a linear
+// scan with no pointer chasing.
+//
+// Structural changes are deferred: added and moved scene nodes are held in a pending list
+// that queries test linearly, and the tree is rebuilt once enough changes accumulate.
+// Scene nodes that move within their octree cell are updated in place.
+class KRLinearOctree
+{
+public:
+  KRLinearOctree();
+  ~KRLinearOctree();
+
+  void add(KRNode* pNode);
+  void remove(KRNode* pNode);
+  void update(KRNode* pNode);
+
+  std::set<KRNode*>& getOuterSceneNodes();
+  size_t getSceneNodeCount() const;
+  // Bounds of the scene nodes, excluding the outer scene nodes.  Zero when there are none.
+  hydra::AABB getBounds() const;
+
+  // Changes whenever a scene node is added, removed or moved
+  uint64_t getRevision() const;
+
+  bool lineCast(const hydra::Vector3& v0, const hydra::Vector3& v1, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+  bool rayCast(const hydra::Vector3& v0, const hydra::Vector3& dir, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+  bool sphereCast(const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+
+  size_t lineCastBatch(std::span<const KROctree::Line> lines, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+  size_t rayCastBatch(std::span<const KROctree::Ray> rays, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+  size_t sphereCastBatch(std::span<const KROctree::SweptSphere> spheres, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+
+  // Appends the scene nodes whose bounds intersect the viewport.  Outer scene nodes are
+  // not included.
+  void findVisible(const KRViewport& viewport, std::vector<KRNode*>& visible);
+  // Appends the scene nodes whose bounds intersect bounds.  Outer scene nodes are not included.
+  void findIntersecting(const hydra::AABB& bounds, std::vector<KRNode*>& nodes);
+
+  // Visits every scene node, including the outer scene nodes
+  template <typename F> void forEach(F fn)
+  {
+    for (KRNode* node : m_outerSceneNodes) {
+      fn(*node);
+    }
+    for (const Item& item : m_items) {
+      if (item.node) {
+        fn(*item.node);
+      }
+    }
+    for (const Item& item : m_pending) {
+      fn(*item.node);
+    }
+  }
+
+  // Forces any deferred changes into the tree
+  void rebuild();
+
+private:
+  static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+  struct Item
+  {
+    KRNode* node; // nullptr once removed, until the next rebuild
+    KRCollider* collider;
+    hydra::AABB bounds;
+    uint64_t key; // Morton code of the cell's minimum corner, at the deepest level
+    int level;
+    uint32_t octreeNode;
+  };
+
+  struct Node
+  {
+    hydra::AABB bounds; // Bounds of all scene nodes in this subtree
+    uint32_t parent;
+    uint32_t skip; // Index of the next node that is not a descendant
+    uint32_t itemBegin;
+    uint32_t itemEnd;
+  };
+
+  struct Location
+  {
+    bool pending;
+    uint32_t index;
+  };
+
+  std::vector<Node> m_nodes;
+  std::vector<Item> m_items;
+  std::vector<Item> m_pending;
+  std::unordered_map<KRNode*, Location> m_locations;
+  std::set<KRNode*> m_outerSceneNodes;
+
+  hydra::AABB m_rootBounds;
+  size_t m_removedCount;
+  size_t m_refitCount;
+  uint64_t m_revision;
+
+  bool getCell(const hydra::AABB& bounds, uint64_t& key, int& level) const;
+  uint32_t build(size_t begin, size_t end, int level, uint32_t parent);
+  void addPending(KRNode* pNode, const hydra::AABB& bounds);
+  void removeItem(KRNode* pNode);
+  void refresh();
+  void prepareCollidersForCasts();
+  // cull writes 1 to mask[i] for each of count bounds that may contain nodes of interest
+  void findNodes(const std::function<void(const hydra::AABB* bounds, size_t count, uint8_t* mask)>& cull, std::vector<KRNode*>& nodes);
+  size_t castBatch(size_t count, KRWorkerPool* pool, const std::function<bool(size_t)>& cast);
+
+  bool lineCastNoRefresh(const hydra::Vector3& v0, const hydra::Vector3& v1, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+  bool rayCastNoRefresh(const hydra::Vector3& v0, const hydra::Vector3& dir, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+  bool sphereCastNoRefresh(const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo, unsigned int layer_mask);
+};
@@ -53,6 +53,11 @@ KRModelView::~KRModelView()
 
 }
 
+bool KRModelView::hasConditionalShaderValues() const
+{
+  return true;
+}
+
 bool KRModelView::getShaderValue(const KRCamera* camera, ShaderValue value, Vector3* output) const
 {
   if (m_directionalLight) {
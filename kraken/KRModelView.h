@@ -49,6 +49,8 @@ public:
 
   bool getShaderValue(const KRCamera* camera, ShaderValue value, hydra::Vector3* output) const final;
   bool getShaderValue(const KRCamera* camera, ShaderValue value, hydra::Matrix4* output) const final;
+  // Light directions and shadow matrices are only supplied when there is a directional light
+  bool hasConditionalShaderValues() const final;
 
 private:
   const KRViewport* m_viewport;
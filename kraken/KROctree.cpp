@@ -33,12 +33,259 @@
 #include "KROctree.h"
 #include "nodes/KRNode.h"
 #include "nodes/KRCollider.h"
+#include "nodes/KRPointLight.h"
+#include "nodes/KRDirectionalLight.h"
+#include "nodes/KRSpotLight.h"
+#include "KRWorkerPool.h"
 
 using namespace hydra;
 
+namespace {
+
+const size_t KRENGINE_CAST_PACKET_SIZE = 32;
+
+enum class CastType
+{
+  Line,
+  Ray,
+  Sphere
+};
+
+struct CastQuery
+{
+  Vector3 v0;
+  Vector3 v1; // Direction for rays
+  float radius;
+  AABB swept_bounds;
+  HitInfo* hitinfo;
+  bool hit_found;
+};
+
+struct CastPacket
+{
+  CastType type;
+  unsigned int layer_mask;
+  CastQuery queries[KRENGINE_CAST_PACKET_SIZE];
+  size_t count;
+
+  // Tests the colliders of one octree node against the active queries, then recurses into
+  // the children.  For each query, this visits colliders in the same order and with the same
+  // arguments as KROctreeNode::lineCast, rayCast and sphereCast.
+  void cast(KROctreeNode* octree_node, const uint8_t* active, size_t active_count)
+  {
+    uint8_t inside[KRENGINE_CAST_PACKET_SIZE];
+    Vector3 line_end[KRENGINE_CAST_PACKET_SIZE];
+    bool as_line[KRENGINE_CAST_PACKET_SIZE];
+    size_t inside_count = 0;
+
+    AABB bounds = octree_node->getBounds();
+    for (size_t i = 0; i < active_count; i++) {
+      CastQuery& query = queries[active[i]];
+      bool intersects = false;
+      switch (type) {
+      case CastType::Sphere:
+        intersects = bounds.intersects(query.swept_bounds);
+        break;
+      case CastType::Ray:
+        if (query.hitinfo->didHit()) {
+          // Once a ray has a hit, only search for closer hits
+          as_line[inside_count] = true;
+          line_end[inside_count] = query.hitinfo->getPosition();
+          intersects = bounds.intersectsLine(query.v0, line_end[inside_count]);
+        } else {
+          as_line[inside_count] = false;
+          intersects = bounds.intersectsRay(query.v0, query.v1);
+        }
+        break;
+      case CastType::Line:
+        as_line[inside_count] = true;
+        line_end[inside_count] = query.hitinfo->didHit() ? query.hitinfo->getPosition() : query.v1;
+        intersects = bounds.intersectsLine(query.v0, line_end[inside_count]);
+        break;
+      }
+      if (intersects) {
+        inside[inside_count++] = active[i];
+      }
+    }
+
+    if (inside_count == 0) {
+      return;
+    }
+
+    for (KRNode* node : octree_node->getSceneNodes()) {
+      KRCollider* collider = dynamic_cast<KRCollider*>(node);
+      if (collider) {
+        for (size_t i = 0; i < inside_count; i++) {
+          CastQuery& query = queries[inside[i]];
+          bool hit = false;
+          if (type == CastType::Sphere) {
+            hit = collider->sphereCast(query.v0, query.v1, query.radius, *query.hitinfo, layer_mask);
+          } else if (as_line[i]) {
+            hit = collider->lineCast(query.v0, line_end[i], *query.hitinfo, layer_mask);
+          } else {
+            hit = collider->rayCast(query.v0, query.v1, *query.hitinfo, layer_mask);
+          }
+          if (hit) {
+            query.hit_found = true;
+          }
+        }
+      }
+    }
+
+    for (int i = 0; i < 8; i++) {
+      if (octree_node->getChildren()[i]) {
+        cast(octree_node->getChildren()[i], inside, inside_count);
+      }
+    }
+  }
+};
+
+// Orders queries by direction octant, then by the Morton code of their origin, so that each
+// packet holds queries that tend to visit the same octree nodes and colliders.
+std::vector<size_t> SortCastQueries(const std::vector<CastQuery>& queries, CastType type)
+{
+  AABB origin_bounds = AABB::Create(queries[0].v0, queries[0].v0);
+  for (const CastQuery& query : queries) {
+    origin_bounds.encapsulate(query.v0);
+  }
+  Vector3 size = origin_bounds.size();
+  Vector3 scale = Vector3::Create(
+    size.x > 0.0f ? 1023.0f / size.x : 0.0f,
+    size.y > 0.0f ? 1023.0f / size.y : 0.0f,
+    size.z > 0.0f ? 1023.0f / size.z : 0.0f);
+
+  std::vector<std::pair<uint64_t, size_t>> keys(queries.size());
+  for (size_t i = 0; i < queries.size(); i++) {
+    const CastQuery& query = queries[i];
+    Vector3 dir = type == CastType::Ray ? query.v1 : query.v1 - query.v0;
+    uint64_t octant = (dir.x < 0.0f ? 1 : 0) | (dir.y < 0.0f ? 2 : 0) | (dir.z < 0.0f ? 4 : 0);
+    uint32_t x = (uint32_t)((query.v0.x - origin_bounds.min.x) * scale.x);
+    uint32_t y = (uint32_t)((query.v0.y - origin_bounds.min.y) * scale.y);
+    uint32_t z = (uint32_t)((query.v0.z - origin_bounds.min.z) * scale.z);
+    keys[i] = std::make_pair(octant << 30 | KROctree::MortonCode(x, y, z), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<size_t> order(queries.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    order[i] = keys[i].second;
+  }
+  return order;
+}
+
+void PrepareCollidersForCasts(KROctreeNode* octree_node)
+{
+  for (KRNode* node : octree_node->getSceneNodes()) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      collider->prepareForCasts();
+    }
+  }
+  for (int i = 0; i < 8; i++) {
+    if (octree_node->getChildren()[i]) {
+      PrepareCollidersForCasts(octree_node->getChildren()[i]);
+    }
+  }
+}
+
+size_t CastBatch(CastType type, std::vector<CastQuery>& queries, std::vector<KRNode*>& outer_nodes, KROctreeNode* root_node, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  if (queries.empty()) {
+    return 0;
+  }
+
+  // Colliders lazily bind their meshes and model matrices; resolve these before any
+  // worker threads touch them.
+  std::vector<KRCollider*> outer_colliders;
+  for (KRNode* node : outer_nodes) {
+    KRCollider* collider = dynamic_cast<KRCollider*>(node);
+    if (collider) {
+      collider->prepareForCasts();
+      outer_colliders.push_back(collider);
+    }
+  }
+  if (root_node) {
+    PrepareCollidersForCasts(root_node);
+  }
+
+  std::vector<size_t> order = SortCastQueries(queries, type);
+  size_t packet_count = (queries.size() + KRENGINE_CAST_PACKET_SIZE - 1) / KRENGINE_CAST_PACKET_SIZE;
+
+  auto castPacket = [&](size_t packet_index) {
+    CastPacket packet;
+    packet.type = type;
+    packet.layer_mask = layer_mask;
+    packet.count = std::min(KRENGINE_CAST_PACKET_SIZE, queries.size() - packet_index * KRENGINE_CAST_PACKET_SIZE);
+    uint8_t active[KRENGINE_CAST_PACKET_SIZE];
+    for (size_t i = 0; i < packet.count; i++) {
+      packet.queries[i] = queries[order[packet_index * KRENGINE_CAST_PACKET_SIZE + i]];
+      active[i] = (uint8_t)i;
+    }
+
+    for (KRCollider* collider : outer_colliders) {
+      for (size_t i = 0; i < packet.count; i++) {
+        CastQuery& query = packet.queries[i];
+        bool hit = false;
+        switch (type) {
+        case CastType::Line:
+          hit = collider->lineCast(query.v0, query.v1, *query.hitinfo, layer_mask);
+          break;
+        case CastType::Ray:
+          hit = collider->rayCast(query.v0, query.v1, *query.hitinfo, layer_mask);
+          break;
+        case CastType::Sphere:
+          hit = collider->sphereCast(query.v0, query.v1, query.radius, *query.hitinfo, layer_mask);
+          break;
+        }
+        if (hit) {
+          query.hit_found = true;
+        }
+      }
+    }
+
+    if (root_node) {
+      packet.cast(root_node, active, packet.count);
+    }
+
+    for (size_t i = 0; i < packet.count; i++) {
+      queries[order[packet_index * KRENGINE_CAST_PACKET_SIZE + i]].hit_found = packet.queries[i].hit_found;
+    }
+  };
+
+  if (pool) {
+    pool->parallelFor(packet_count, castPacket);
+  } else {
+    for (size_t i = 0; i < packet_count; i++) {
+      castPacket(i);
+    }
+  }
+
+  size_t hit_count = 0;
+  for (const CastQuery& query : queries) {
+    if (query.hit_found) {
+      hit_count++;
+    }
+  }
+  return hit_count;
+}
+
+void TrimOctreeNode(KROctreeNode* octree_node)
+{
+  for (int i = 0; i < 8; i++) {
+    if (octree_node->getChildren()[i]) {
+      TrimOctreeNode(octree_node->getChildren()[i]);
+    }
+  }
+  octree_node->trim();
+}
+
+} // anonymous namespace
+
 KROctree::KROctree()
 {
   m_pRootNode = NULL;
+  m_traversalDepth = 0;
+  m_revision = 0;
 }
 
 KROctree::~KROctree()
@@ -50,12 +297,28 @@ KROctree::~KROctree()
 
 void KROctree::add(KRNode* pNode)
 {
+  m_revision++;
   AABB nodeBounds = pNode->getBounds();
   if (nodeBounds == AABB::Zero()) {
     // This item is not visible, don't add it to the octree or outer scene nodes
   } else if (nodeBounds == AABB::Infinite()) {
     // This item is infinitely large; we track it separately
-    m_outerSceneNodes.insert(pNode);
+    if (std::find(m_outerSceneNodes.begin(), m_outerSceneNodes.end(), pNode) == m_outerSceneNodes.end()) {
+      m_outerSceneNodes.push_back(pNode);
+
+      KRPointLight* point_light = dynamic_cast<KRPointLight*>(pNode);
+      if (point_light) {
+        m_outerPointLights.push_back(point_light);
+      }
+      KRDirectionalLight* directional_light = dynamic_cast<KRDirectionalLight*>(pNode);
+      if (directional_light) {
+        m_outerDirectionalLights.push_back(directional_light);
+      }
+      KRSpotLight* spot_light = dynamic_cast<KRSpotLight*>(pNode);
+      if (spot_light) {
+        m_outerSpotLights.push_back(spot_light);
+      }
+    }
   } else {
     if (m_pRootNode == NULL) {
       // First item inserted, create a node large enough to fit it
@@ -82,10 +345,36 @@ void KROctree::add(KRNode* pNode)
 
 void KROctree::remove(KRNode* pNode)
 {
-  if (!m_outerSceneNodes.erase(pNode)) {
-    if (m_pRootNode) {
-      pNode->removeFromOctreeNodes();
+  std::vector<KRNode*>::iterator outer_itr = std::find(m_outerSceneNodes.begin(), m_outerSceneNodes.end(), pNode);
+  if (outer_itr != m_outerSceneNodes.end()) {
+    if (m_traversalDepth > 0) {
+      *outer_itr = nullptr;
+    } else {
+      m_outerSceneNodes.erase(outer_itr);
+    }
+    std::erase(m_outerPointLights, pNode);
+    std::erase(m_outerDirectionalLights, pNode);
+    std::erase(m_outerSpotLights, pNode);
+  } else if (m_pRootNode) {
+    for (KROctreeNode* octree_node : pNode->getOctreeNodes()) {
+      octree_node->remove(pNode);
+      if (m_traversalDepth > 0) {
+        // Compacted and trimmed in endTraversal
+        m_removedDuringTraversal.push_back(octree_node);
+        continue;
+      }
+      octree_node->compact();
+      m_revision++;
+      while (octree_node) {
+        octree_node->trim();
+        if (octree_node->isEmpty()) {
+          octree_node = octree_node->getParent();
+        } else {
+          octree_node = NULL;
+        }
+      }
     }
+    pNode->getOctreeNodes().clear();
   }
 
   shrink();
@@ -101,6 +390,10 @@ void KROctree::update(KRNode* pNode)
 
 void KROctree::shrink()
 {
+  if (m_traversalDepth > 0) {
+    // Octree nodes may be in use by the traversal
+    return;
+  }
   if (m_pRootNode) {
     while (m_pRootNode->canShrinkRoot()) {
       KROctreeNode* newRoot = m_pRootNode->stripChild();
@@ -116,18 +409,64 @@ KROctreeNode* KROctree::getRootNode()
   return m_pRootNode;
 }
 
-std::set<KRNode*>& KROctree::getOuterSceneNodes()
+std::vector<KRNode*>& KROctree::getOuterSceneNodes()
 {
   return m_outerSceneNodes;
 }
 
+const std::vector<KRPointLight*>& KROctree::getOuterPointLights() const
+{
+  return m_outerPointLights;
+}
+
+const std::vector<KRDirectionalLight*>& KROctree::getOuterDirectionalLights() const
+{
+  return m_outerDirectionalLights;
+}
+
+const std::vector<KRSpotLight*>& KROctree::getOuterSpotLights() const
+{
+  return m_outerSpotLights;
+}
+
+uint64_t KROctree::getRevision() const
+{
+  return m_revision;
+}
+
+void KROctree::beginTraversal()
+{
+  m_traversalDepth++;
+}
+
+void KROctree::endTraversal()
+{
+  assert(m_traversalDepth > 0);
+  if (--m_traversalDepth > 0) {
+    return;
+  }
+
+  std::erase(m_outerSceneNodes, nullptr);
+  if (!m_removedDuringTraversal.empty()) {
+    for (KROctreeNode* octree_node : m_removedDuringTraversal) {
+      octree_node->compact();
+    }
+    m_removedDuringTraversal.clear();
+    m_revision++;
+    if (m_pRootNode) {
+      TrimOctreeNode(m_pRootNode);
+    }
+    shrink();
+  }
+}
+
 
 bool KROctree::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo, unsigned int layer_mask)
 {
   bool hit_found = false;
   std::vector<KRCollider*> outer_colliders;
 
-  for (std::set<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
+  for (std::vector<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
     KRCollider* collider = dynamic_cast<KRCollider*>(*outer_nodes_itr);
     if (collider) {
       outer_colliders.push_back(collider);
@@ -146,7 +485,7 @@ bool KROctree::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo,
 bool KROctree::rayCast(const Vector3& v0, const Vector3& dir, HitInfo& hitinfo, unsigned int layer_mask)
 {
   bool hit_found = false;
-  for (std::set<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
+  for (std::vector<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
     KRCollider* collider = dynamic_cast<KRCollider*>(*outer_nodes_itr);
     if (collider) {
       if (collider->rayCast(v0, dir, hitinfo, layer_mask)) hit_found = true;
@@ -163,7 +502,7 @@ bool KROctree::sphereCast(const Vector3& v0, const Vector3& v1, float radius, Hi
   bool hit_found = false;
   std::vector<KRCollider*> outer_colliders;
 
-  for (std::set<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
+  for (std::vector<KRNode*>::iterator outer_nodes_itr = m_outerSceneNodes.begin(); outer_nodes_itr != m_outerSceneNodes.end(); outer_nodes_itr++) {
     KRCollider* collider = dynamic_cast<KRCollider*>(*outer_nodes_itr);
     if (collider) {
       outer_colliders.push_back(collider);
@@ -179,6 +518,65 @@ bool KROctree::sphereCast(const Vector3& v0, const Vector3& v1, float radius, Hi
   return hit_found;
 }
 
+size_t KROctree::lineCastBatch(std::span<const Line> lines, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= lines.size());
+  std::vector<CastQuery> queries(lines.size());
+  for (size_t i = 0; i < lines.size(); i++) {
+    queries[i].v0 = lines[i].v0;
+    queries[i].v1 = lines[i].v1;
+    queries[i].hitinfo = &hitinfo[i];
+    queries[i].hit_found = false;
+  }
+  return CastBatch(CastType::Line, queries, m_outerSceneNodes, m_pRootNode, layer_mask, pool);
+}
+
+size_t KROctree::rayCastBatch(std::span<const Ray> rays, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= rays.size());
+  std::vector<CastQuery> queries(rays.size());
+  for (size_t i = 0; i < rays.size(); i++) {
+    queries[i].v0 = rays[i].v0;
+    queries[i].v1 = rays[i].dir;
+    queries[i].hitinfo = &hitinfo[i];
+    queries[i].hit_found = false;
+  }
+  return CastBatch(CastType::Ray, queries, m_outerSceneNodes, m_pRootNode, layer_mask, pool);
+}
+
+size_t KROctree::sphereCastBatch(std::span<const SweptSphere> spheres, std::span<HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool)
+{
+  assert(hitinfo.size() >= spheres.size());
+  std::vector<CastQuery> queries(spheres.size());
+  for (size_t i = 0; i < spheres.size(); i++) {
+    const SweptSphere& sphere = spheres[i];
+    queries[i].v0 = sphere.v0;
+    queries[i].v1 = sphere.v1;
+    queries[i].radius = sphere.radius;
+    // Matches the swept bounds tested by KROctreeNode::sphereCast
+    queries[i].swept_bounds = AABB::Create(
+      Vector3::Create(std::min(sphere.v0.x, sphere.v1.x) - sphere.radius, std::min(sphere.v0.y, sphere.v1.y) - sphere.radius, std::min(sphere.v0.z, sphere.v1.z) - sphere.radius),
+      Vector3::Create(std::max(sphere.v0.x, sphere.v1.x) + sphere.radius, std::max(sphere.v0.y, sphere.v1.y) + sphere.radius, std::max(sphere.v0.z, sphere.v1.z) + sphere.radius));
+    queries[i].hitinfo = &hitinfo[i];
+    queries[i].hit_found = false;
+  }
+  return CastBatch(CastType::Sphere, queries, m_outerSceneNodes, m_pRootNode, layer_mask, pool);
+}
+
+/* static */
+uint32_t KROctree::MortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+  auto expand = [](uint32_t v) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+  };
+  return expand(x) | expand(y) << 1 | expand(z) << 2;
+}
+
 KROctree::Iterator KROctree::begin()
 {
   return Iterator(this, false);
@@ -34,7 +34,13 @@
 #include "KREngine-common.h"
 #include "KROctreeNode.h"
 
+#include <span>
+
 class KRNode;
+class KRPointLight;
+class KRDirectionalLight;
+class KRSpotLight;
+class KRWorkerPool;
 
 class KROctree
 {
@@ -47,12 +53,56 @@ public:
   void update(KRNode* pNode);
 
   KROctreeNode* getRootNode();
-  std::set<KRNode*>& getOuterSceneNodes();
+  // May contain nullptr entries for scene nodes removed during a traversal
+  std::vector<KRNode*>& getOuterSceneNodes();
+  const std::vector<KRPointLight*>& getOuterPointLights() const;
+  const std::vector<KRDirectionalLight*>& getOuterDirectionalLights() const;
+  const std::vector<KRSpotLight*>& getOuterSpotLights() const;
+
+  // Between beginTraversal and endTraversal, removed scene nodes are replaced by nullptr
+  // in the scene node lists and empty octree nodes are kept, so that callers can iterate by
+  // index while scene nodes are rendered, added or deleted.  Scene nodes added during a
+  // traversal may or may not be visited.  Calls may be nested.
+  void beginTraversal();
+  void endTraversal();
+
+  // Changes whenever octree nodes may have been created or destroyed
+  uint64_t getRevision() const;
 
   bool lineCast(const hydra::Vector3& v0, const hydra::Vector3& v1, hydra::HitInfo& hitinfo, unsigned int layer_mask);
   bool rayCast(const hydra::Vector3& v0, const hydra::Vector3& dir, hydra::HitInfo& hitinfo, unsigned int layer_mask);
   bool sphereCast(const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo, unsigned int layer_mask);
 
+  struct Line
+  {
+    hydra::Vector3 v0;
+    hydra::Vector3 v1;
+  };
+
+  struct Ray
+  {
+    hydra::Vector3 v0;
+    hydra::Vector3 dir;
+  };
+
+  struct SweptSphere
+  {
+    hydra::Vector3 v0;
+    hydra::Vector3 v1;
+    float radius;
+  };
+
+  // Batched casts.  Queries are sorted for coherence and walked through the octree in packets,
+  // spread over pool when it is not null.  Each hitinfo[i] receives exactly the result of the
+  // equivalent single cast given the same initial hitinfo[i].
+  // Returns the number of queries for which a hit was found.
+  size_t lineCastBatch(std::span<const Line> lines, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+  size_t rayCastBatch(std::span<const Ray> rays, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+  size_t sphereCastBatch(std::span<const SweptSphere> spheres, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask, KRWorkerPool* pool);
+
+  // Interleaves the low 10 bits of x, y and z into a 30 bit Morton code
+  static uint32_t MortonCode(uint32_t x, uint32_t y, uint32_t z);
+
   class Iterator
   {
   public:
@@ -63,9 +113,9 @@ public:
     KRNode& operator*();
   private:
     KROctree* octree;
-    std::set<KRNode*>::iterator outerNodeItr;
+    std::vector<KRNode*>::iterator outerNodeItr;
     std::queue<KROctreeNode*> octreeStack;
-    std::set<KRNode*>::iterator nextNodeItr;
+    std::vector<KRNode*>::iterator nextNodeItr;
   };
 
   Iterator begin();
@@ -73,7 +123,14 @@ public:
 
 private:
   KROctreeNode* m_pRootNode;
-  std::set<KRNode*> m_outerSceneNodes;
+  std::vector<KRNode*> m_outerSceneNodes;
+  std::vector<KRPointLight*> m_outerPointLights;
+  std::vector<KRDirectionalLight*> m_outerDirectionalLights;
+  std::vector<KRSpotLight*> m_outerSpotLights;
+
+  int m_traversalDepth;
+  uint64_t m_revision;
+  std::vector<KROctreeNode*> m_removedDuringTraversal;
 
   void shrink();
 };
@@ -32,6 +32,9 @@
 #include "KROctreeNode.h"
 #include "nodes/KRNode.h"
 #include "nodes/KRCollider.h"
+#include "nodes/KRPointLight.h"
+#include "nodes/KRDirectionalLight.h"
+#include "nodes/KRSpotLight.h"
 
 using namespace hydra;
 
@@ -75,8 +78,22 @@ void KROctreeNode::add(KRNode* pNode)
 {
   int iChild = getChildIndex(pNode);
   if (iChild == -1) {
-    m_sceneNodes.insert(pNode);
+    m_sceneNodes.push_back(pNode);
     pNode->addToOctreeNode(this);
+
+    // Lights are classified once here, rather than on every traversal
+    KRPointLight* point_light = dynamic_cast<KRPointLight*>(pNode);
+    if (point_light) {
+      m_pointLights.push_back(point_light);
+    }
+    KRDirectionalLight* directional_light = dynamic_cast<KRDirectionalLight*>(pNode);
+    if (directional_light) {
+      m_directionalLights.push_back(directional_light);
+    }
+    KRSpotLight* spot_light = dynamic_cast<KRSpotLight*>(pNode);
+    if (spot_light) {
+      m_spotLights.push_back(spot_light);
+    }
   } else {
     if (m_children[iChild] == NULL) {
       m_children[iChild] = new KROctreeNode(this, getChildBounds(iChild));
@@ -125,7 +142,17 @@ void KROctreeNode::trim()
 
 void KROctreeNode::remove(KRNode* pNode)
 {
-  m_sceneNodes.erase(pNode);
+  std::replace(m_sceneNodes.begin(), m_sceneNodes.end(), pNode, (KRNode*)nullptr);
+
+  // Light lists are not iterated while scene nodes are rendered, so they can be updated immediately
+  std::erase(m_pointLights, pNode);
+  std::erase(m_directionalLights, pNode);
+  std::erase(m_spotLights, pNode);
+}
+
+void KROctreeNode::compact()
+{
+  std::erase(m_sceneNodes, nullptr);
 }
 
 void KROctreeNode::update(KRNode* pNode)
@@ -180,11 +207,26 @@ KROctreeNode** KROctreeNode::getChildren()
   return m_children;
 }
 
-std::set<KRNode*>& KROctreeNode::getSceneNodes()
+std::vector<KRNode*>& KROctreeNode::getSceneNodes()
 {
   return m_sceneNodes;
 }
 
+const std::vector<KRPointLight*>& KROctreeNode::getPointLights() const
+{
+  return m_pointLights;
+}
+
+const std::vector<KRDirectionalLight*>& KROctreeNode::getDirectionalLights() const
+{
+  return m_directionalLights;
+}
+
+const std::vector<KRSpotLight*>& KROctreeNode::getSpotLights() const
+{
+  return m_spotLights;
+}
+
 
 bool KROctreeNode::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo, unsigned int layer_mask)
 {
@@ -194,7 +236,7 @@ bool KROctreeNode::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitin
     hit_found = lineCast(v0, hitinfo.getPosition(), hitinfo, layer_mask);
   } else {
     if (getBounds().intersectsLine(v0, v1)) {
-      for (std::set<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
+      for (std::vector<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
         KRCollider* collider = dynamic_cast<KRCollider*>(*nodes_itr);
         if (collider) {
           if (collider->lineCast(v0, v1, hitinfo, layer_mask)) hit_found = true;
@@ -222,7 +264,7 @@ bool KROctreeNode::rayCast(const Vector3& v0, const Vector3& dir, HitInfo& hitin
     hit_found = lineCast(v0, hitinfo.getPosition(), hitinfo, layer_mask); // Note: This is purposefully lineCast as opposed to RayCast
   } else {
     if (getBounds().intersectsRay(v0, dir)) {
-      for (std::set<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
+      for (std::vector<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
         KRCollider* collider = dynamic_cast<KRCollider*>(*nodes_itr);
         if (collider) {
           if (collider->rayCast(v0, dir, hitinfo, layer_mask)) hit_found = true;
@@ -258,7 +300,7 @@ bool KROctreeNode::sphereCast(const Vector3& v0, const Vector3& v1, float radius
   // FINDME, TODO - Investigate AABB - swept sphere intersections or OBB - AABB intersections: "if(getBounds().intersectsSweptSphere(v0, v1, radius)) {"
   if (getBounds().intersects(swept_bounds)) {
 
-    for (std::set<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
+    for (std::vector<KRNode*>::iterator nodes_itr = m_sceneNodes.begin(); nodes_itr != m_sceneNodes.end(); nodes_itr++) {
       KRCollider* collider = dynamic_cast<KRCollider*>(*nodes_itr);
       if (collider) {
         if (collider->sphereCast(v0, v1, radius, hitinfo, layer_mask)) hit_found = true;
@@ -35,6 +35,9 @@
 #include "hitinfo.h"
 
 class KRNode;
+class KRPointLight;
+class KRDirectionalLight;
+class KRSpotLight;
 
 class KROctreeNode
 {
@@ -44,11 +47,17 @@ public:
   ~KROctreeNode();
 
   KROctreeNode** getChildren();
-  std::set<KRNode*>& getSceneNodes();
+  // May contain nullptr entries for scene nodes removed during a traversal; see KROctree::beginTraversal
+  std::vector<KRNode*>& getSceneNodes();
+  const std::vector<KRPointLight*>& getPointLights() const;
+  const std::vector<KRDirectionalLight*>& getDirectionalLights() const;
+  const std::vector<KRSpotLight*>& getSpotLights() const;
 
   void add(KRNode* pNode);
+  // Leaves a nullptr in place of the scene node, so that indices stay valid.  Call compact() to reclaim it.
   void remove(KRNode* pNode);
   void update(KRNode* pNode);
+  void compact();
 
   hydra::AABB getBounds();
 
@@ -73,5 +82,8 @@ private:
   KROctreeNode* m_parent;
   KROctreeNode* m_children[8];
 
-  std::set<KRNode*>m_sceneNodes;
+  std::vector<KRNode*> m_sceneNodes;
+  std::vector<KRPointLight*> m_pointLights;
+  std::vector<KRDirectionalLight*> m_directionalLights;
+  std::vector<KRSpotLight*> m_spotLights;
 };
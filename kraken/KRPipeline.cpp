@@ -59,16 +59,22 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   m_descriptorSetLayout = nullptr;
   m_pipelineLayout = nullptr;
   m_graphicsPipeline = nullptr;
+  m_ready = false;
   m_descriptorSets.reserve(KRENGINE_MAX_FRAMES_IN_FLIGHT);
 
   // TODO - Handle device removal
 
   strcpy(m_szKey, szKey);
 
-  const int kMaxStages = 4;
-  VkPipelineShaderStageCreateInfo stages[kMaxStages];
+  // The create info is retained until compile() is called on the pipeline manager's compile thread
+  m_createState = std::make_unique<CreateState>();
+  CreateState& state = *m_createState;
+  state.device = device->m_logicalDevice;
+  state.pipelineCache = device->m_pipelineCache;
+
+  VkPipelineShaderStageCreateInfo* stages = state.stages;
   memset(static_cast<void*>(stages), 0, sizeof(VkPipelineShaderStageCreateInfo) * kMaxStages);
-  size_t stage_count = 0;
+  uint32_t& stage_count = state.stageCount;
 
   std::vector<VkDescriptorSetLayoutBinding> uboLayoutBindings;
 
@@ -82,7 +88,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   uboLayoutBindings.reserve(layout_binding_count);
 
   for (KRShader* shader : shaders) {
-    VkShaderModule shaderModule;
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
     if (!shader->createShaderModule(device->m_logicalDevice, shaderModule)) {
       // failed! TODO - Error handling
     }
@@ -154,13 +160,13 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
     stageInfo.pName = "main";
   }
 
-  VkVertexInputBindingDescription bindingDescription{};
+  VkVertexInputBindingDescription& bindingDescription = state.bindingDescription;
   bindingDescription.binding = 0;
   bindingDescription.stride = (uint32_t)layout->vertexSize;
   bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
   uint32_t vertexAttributeCount = 0;
-  VkVertexInputAttributeDescription vertexAttributeDescriptions[kMaxAttributes]{};
+  VkVertexInputAttributeDescription* vertexAttributeDescriptions = state.vertexAttributeDescriptions;
 
   for (int i = 0; i < kMaxAttributes; i++) {
     VertexAttributeInfo attrib = layout->attributes[i];
@@ -177,14 +183,14 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
     desc.offset = (uint32_t)info.layout->offsets[i];
   }
 
-  VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+  VkPipelineVertexInputStateCreateInfo& vertexInputInfo = state.vertexInputInfo;
   vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
   vertexInputInfo.vertexBindingDescriptionCount = 1;
   vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
   vertexInputInfo.vertexAttributeDescriptionCount = vertexAttributeCount;
   vertexInputInfo.pVertexAttributeDescriptions = vertexAttributeDescriptions;
 
-  VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+  VkPipelineInputAssemblyStateCreateInfo& inputAssembly = state.inputAssembly;
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
   switch (info.layout->topology) {
   case Topology::Points:
@@ -209,7 +215,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
 
   inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-  VkViewport viewport{};
+  VkViewport& viewport = state.viewport;
   viewport.x = 0.0f;
   viewport.y = 0.0f;
   viewport.width = static_cast<float>(viewport_size.x);
@@ -217,19 +223,19 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   viewport.minDepth = 0.0f;
   viewport.maxDepth = 1.0f;
 
-  VkRect2D scissor{};
+  VkRect2D& scissor = state.scissor;
   scissor.offset = { 0, 0 };
   scissor.extent.width = scissor_size.x;
   scissor.extent.height = scissor_size.y;
 
-  VkPipelineViewportStateCreateInfo viewportState{};
+  VkPipelineViewportStateCreateInfo& viewportState = state.viewportState;
   viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
   viewportState.viewportCount = 1;
   viewportState.pViewports = &viewport;
   viewportState.scissorCount = 1;
   viewportState.pScissors = &scissor;
 
-  VkPipelineRasterizationStateCreateInfo rasterizer{};
+  VkPipelineRasterizationStateCreateInfo& rasterizer = state.rasterizer;
   rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
   rasterizer.depthClampEnable = VK_FALSE;
   rasterizer.rasterizerDiscardEnable = VK_FALSE;
@@ -252,7 +258,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   rasterizer.depthBiasClamp = 0.0f;
   rasterizer.depthBiasSlopeFactor = 0.0f;
 
-  VkPipelineMultisampleStateCreateInfo multisampling{};
+  VkPipelineMultisampleStateCreateInfo& multisampling = state.multisampling;
   multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
   multisampling.sampleShadingEnable = VK_FALSE;
   multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -261,7 +267,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   multisampling.alphaToCoverageEnable = VK_FALSE;
   multisampling.alphaToOneEnable = VK_FALSE;
 
-  VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+  VkPipelineColorBlendAttachmentState& colorBlendAttachment = state.colorBlendAttachment;
   colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
   switch (info.rasterMode) {
@@ -293,7 +299,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
   colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
-  VkPipelineColorBlendStateCreateInfo colorBlending{};
+  VkPipelineColorBlendStateCreateInfo& colorBlending = state.colorBlending;
   colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
   colorBlending.logicOpEnable = VK_FALSE;
   colorBlending.logicOp = VK_LOGIC_OP_COPY;
@@ -357,7 +363,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
     iStage++;
   }
 
-  VkPipelineDepthStencilStateCreateInfo depthStencil{};
+  VkPipelineDepthStencilStateCreateInfo& depthStencil = state.depthStencil;
   depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
   switch (info.rasterMode) {
   case RasterMode::kOpaque:
@@ -395,7 +401,7 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   depthStencil.front = {};
   depthStencil.back = {};
 
-  VkGraphicsPipelineCreateInfo pipelineInfo{};
+  VkGraphicsPipelineCreateInfo& pipelineInfo = state.pipelineInfo;
   pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
   pipelineInfo.stageCount = stage_count;
   pipelineInfo.pStages = stages;
@@ -412,14 +418,48 @@ KRPipeline::KRPipeline(KRContext& context, KrDeviceHandle deviceHandle, const KR
   pipelineInfo.subpass = 0;
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
   pipelineInfo.basePipelineIndex = -1;
+}
 
-  if (vkCreateGraphicsPipelines(device->m_logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
-    // Failed! TODO - Error handling
+void KRPipeline::compile()
+{
+  if (!m_createState) {
+    return;
+  }
+  CreateState& state = *m_createState;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (vkCreateGraphicsPipelines(state.device, state.pipelineCache, 1, &state.pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+    // Draws using this pipeline will continue to be skipped
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Failed to create pipeline: %s", m_szKey);
+  }
+  destroyCreateState();
+  if (pipeline != VK_NULL_HANDLE) {
+    m_graphicsPipeline = pipeline;
+    m_ready.store(true, std::memory_order_release);
   }
 }
 
+bool KRPipeline::isReady() const
+{
+  return m_ready.load(std::memory_order_acquire);
+}
+
+void KRPipeline::destroyCreateState()
+{
+  if (!m_createState) {
+    return;
+  }
+  CreateState& state = *m_createState;
+  for (uint32_t i = 0; i < state.stageCount; i++) {
+    if (state.stages[i].module != VK_NULL_HANDLE) {
+      vkDestroyShaderModule(state.device, state.stages[i].module, nullptr);
+    }
+  }
+  m_createState.reset();
+}
+
 KRPipeline::~KRPipeline()
 {
+  destroyCreateState();
   if (m_graphicsPipeline) {
     // TODO: vkDestroyPipeline(device, m_graphicsPipeline, nullptr);
   }
@@ -498,6 +538,12 @@ void KRPipeline::initPushConstantStage(ShaderStage stage, const SpvReflectShader
             }
           }
         }
+
+        for (int iUniform = 0; iUniform < kPushConstantCount; iUniform++) {
+          if (pushConstants.size[iUniform] != 0) {
+            m_pushConstantPlanner.addPushConstant(static_cast<ShaderValue>(iUniform), pushConstants.type[iUniform], pushConstants.buffer + pushConstants.offset[iUniform]);
+          }
+        }
       }
     }
   }
@@ -531,6 +577,15 @@ void KRPipeline::initDescriptorSetStage(ShaderStage stage, const SpvReflectShade
           bufferInfo.buffer = nullptr;
         }
         break;
+      case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        {
+          StorageBufferDescriptorInfo& bufferInfo = descriptorQuery.emplace<StorageBufferDescriptorInfo>();
+          bufferInfo.name = binding.name;
+          bufferInfo.buffer = VK_NULL_HANDLE;
+          bufferInfo.offset = 0;
+          bufferInfo.range = 0;
+        }
+        break;
       default:
         // Not supported
         // TODO - Error handling
@@ -552,7 +607,7 @@ bool KRPipeline::hasPushConstant(ShaderValue location) const
 }
 
 
-bool KRPipeline::setImageBindings(const std::vector<const KRReflectedObject*> objects)
+bool KRPipeline::setImageBindings(const std::vector<const KRReflectedObject*>& objects)
 {
   bool success = true;
 
@@ -588,30 +643,9 @@ bool KRPipeline::setImageBindings(const std::vector<const KRReflectedObject*> ob
   return success;
 }
 
-bool KRPipeline::setPushConstants(const KRCamera* camera, const std::vector<const KRReflectedObject*> objects)
+bool KRPipeline::setPushConstants(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects)
 {
-  bool success = true;
-  for (StageInfo& stageInfo : m_stages) {
-    PushConstantInfo& pushConstants = stageInfo.pushConstants;
-    for (int i = 0; i < kPushConstantCount; i++) {
-      size_t size = pushConstants.size[static_cast<size_t>(i)];
-      if (size != 0) {
-        void* constant = (pushConstants.buffer + pushConstants.offset[static_cast<size_t>(i)]);
-        bool found = false;
-        for (const KRReflectedObject* object : objects) {
-          if (object->getShaderValue(camera, static_cast<ShaderValue>(i), pushConstants.type[static_cast<size_t>(i)], constant)) {
-            found = true;
-            break;
-          }
-        }
-        if (!found) {
-          success = false;
-          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Push constant not found: %s", getShaderValueName(i));
-        }
-      }
-    }
-  }
-  return success;
+  return m_pushConstantPlanner.write(camera, objects);
 }
 
 void KRPipeline::updateDescriptorBinding()
@@ -638,6 +672,12 @@ bool KRPipeline::updatePushConstants(KRNode::RenderInfo& ri, const Matrix4& matM
 
 bool KRPipeline::bind(KRNode::RenderInfo& ri, const Matrix4& matModel)
 {
+  if (!isReady()) {
+    // Still compiling; the draw is skipped
+    clearStorageBuffers();
+    return false;
+  }
+
   bool success = true;
   KRDirectionalLight* directionalLight = nullptr;
   if (ri.renderPass->getType() != RenderPassType::RENDER_PASS_DEFERRED_LIGHTS && ri.renderPass->getType() != RenderPassType::RENDER_PASS_DEFERRED_GBUFFER && ri.renderPass->getType() != RenderPassType::RENDER_PASS_DEFERRED_OPAQUE && ri.renderPass->getType() != RenderPassType::RENDER_PASS_SHADOWMAP) {
@@ -660,6 +700,10 @@ bool KRPipeline::bind(KRNode::RenderInfo& ri, const Matrix4& matModel)
     success = setImageBindings(ri.reflectedObjects);
   }
 
+  if (success) {
+    success = checkStorageBuffers();
+  }
+
   if (success) {
     updateDescriptorBinding();
     updateDescriptorSets();
@@ -675,9 +719,61 @@ bool KRPipeline::bind(KRNode::RenderInfo& ri, const Matrix4& matModel)
   ri.reflectedObjects.pop_back();
   ri.reflectedObjects.pop_back();
 
+  clearStorageBuffers();
+
+  return success;
+}
+
+bool KRPipeline::setStorageBuffer(const char* name, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+  bool found = false;
+  for (StageInfo& stageInfo : m_stages) {
+    for (DescriptorSetInfo& descriptorSetInfo : stageInfo.descriptorSets) {
+      for (DescriptorBinding& binding : descriptorSetInfo.bindings) {
+        StorageBufferDescriptorInfo* storageBuffer = std::get_if<StorageBufferDescriptorInfo>(&binding);
+        if (storageBuffer && storageBuffer->name == name) {
+          storageBuffer->buffer = buffer;
+          storageBuffer->offset = offset;
+          storageBuffer->range = range;
+          found = true;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+bool KRPipeline::checkStorageBuffers()
+{
+  bool success = true;
+  for (StageInfo& stageInfo : m_stages) {
+    for (DescriptorSetInfo& descriptorSetInfo : stageInfo.descriptorSets) {
+      for (DescriptorBinding& binding : descriptorSetInfo.bindings) {
+        StorageBufferDescriptorInfo* storageBuffer = std::get_if<StorageBufferDescriptorInfo>(&binding);
+        if (storageBuffer && storageBuffer->buffer == VK_NULL_HANDLE) {
+          success = false;
+          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Storage buffer not bound: %s", storageBuffer->name.c_str());
+        }
+      }
+    }
+  }
   return success;
 }
 
+void KRPipeline::clearStorageBuffers()
+{
+  for (StageInfo& stageInfo : m_stages) {
+    for (DescriptorSetInfo& descriptorSetInfo : stageInfo.descriptorSets) {
+      for (DescriptorBinding& binding : descriptorSetInfo.bindings) {
+        StorageBufferDescriptorInfo* storageBuffer = std::get_if<StorageBufferDescriptorInfo>(&binding);
+        if (storageBuffer) {
+          storageBuffer->buffer = VK_NULL_HANDLE;
+        }
+      }
+    }
+  }
+}
+
 void KRPipeline::updateDescriptorSets()
 {
   if (m_descriptorSetLayout == VK_NULL_HANDLE) {
@@ -710,6 +806,17 @@ void KRPipeline::updateDescriptorSets()
   std::vector<VkDescriptorBufferInfo> buffers;
   std::vector<VkDescriptorImageInfo> images;
 
+  // The writes point into buffers and images, so they must not reallocate
+  size_t bindingCount = 0;
+  for (const StageInfo& stageInfo : m_stages) {
+    for (const DescriptorSetInfo& descriptorSetInfo : stageInfo.descriptorSets) {
+      bindingCount += descriptorSetInfo.bindings.size();
+    }
+  }
+  descriptorWrites.reserve(bindingCount);
+  buffers.reserve(bindingCount);
+  images.reserve(bindingCount);
+
   for (int stage = 0; stage < static_cast<size_t>(ShaderStage::ShaderStageCount); stage++) {
     StageInfo& stageInfo = m_stages[stage];
     for (DescriptorSetInfo& descriptorSetInfo : stageInfo.descriptorSets) {
@@ -718,8 +825,23 @@ void KRPipeline::updateDescriptorSets()
       int bindingIndex = 0;
       for (DescriptorBinding& binding : descriptorSetInfo.bindings) {
         UniformBufferDescriptorInfo* buffer = std::get_if<UniformBufferDescriptorInfo>(&binding);
+        StorageBufferDescriptorInfo* storageBuffer = std::get_if<StorageBufferDescriptorInfo>(&binding);
         ImageDescriptorInfo* image = std::get_if<ImageDescriptorInfo>(&binding);
-        if (buffer) {
+        if (storageBuffer) {
+          VkDescriptorBufferInfo& bufferInfo = buffers.emplace_back(VkDescriptorBufferInfo{});
+          bufferInfo.buffer = storageBuffer->buffer;
+          bufferInfo.offset = storageBuffer->offset;
+          bufferInfo.range = storageBuffer->range;
+
+          VkWriteDescriptorSet& descriptorWrite = descriptorWrites.emplace_back(VkWriteDescriptorSet{});
+          descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+          descriptorWrite.dstSet = descriptorSet;
+          descriptorWrite.dstBinding = bindingIndex;
+          descriptorWrite.dstArrayElement = 0;
+          descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+          descriptorWrite.descriptorCount = 1;
+          descriptorWrite.pBufferInfo = &bufferInfo;
+        } else if (buffer) {
           VkDescriptorBufferInfo& bufferInfo = buffers.emplace_back(VkDescriptorBufferInfo{});
           bufferInfo.buffer = buffer->buffer->getBuffer();
           bufferInfo.offset = 0;
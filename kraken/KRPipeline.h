@@ -221,13 +221,21 @@ public:
   virtual ~KRPipeline();
   const char* getKey() const;
 
+  // Returns false, and binds nothing, until the pipeline has been compiled
   bool bind(KRNode::RenderInfo& ri, const hydra::Matrix4& matModel);
 
+  // Creates the VkPipeline.  Called once, from the pipeline manager's compile thread.
+  void compile();
+  bool isReady() const;
+
   static const size_t kPushConstantCount = static_cast<size_t>(ShaderValue::NUM_SHADER_VALUES);
 
-  bool setImageBindings(const std::vector<const KRReflectedObject*> objects);
-  bool setPushConstants(const KRCamera* camera, const std::vector<const KRReflectedObject*> objects);
+  bool setImageBindings(const std::vector<const KRReflectedObject*>& objects);
+  bool setPushConstants(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects);
   bool hasPushConstant(ShaderValue location) const;
+  // Binds a storage buffer, by its name in the shader, for the next bind() only.
+  // Returns false if the pipeline has no such storage buffer.
+  bool setStorageBuffer(const char* name, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
 
   VkPipeline& getPipeline();
   void bindDescriptorSets(VkCommandBuffer& commandBuffer);
@@ -235,6 +243,8 @@ public:
 private:
   void updateDescriptorBinding();
   void updateDescriptorSets();
+  bool checkStorageBuffers();
+  void clearStorageBuffers();
   bool updatePushConstants(KRNode::RenderInfo& ri, const hydra::Matrix4& matModel);
 
   struct PushConstantInfo
@@ -260,7 +270,15 @@ private:
     std::string name;
   };
 
-  typedef std::variant<ImageDescriptorInfo, UniformBufferDescriptorInfo> DescriptorBinding;
+  struct StorageBufferDescriptorInfo
+  {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize range;
+    std::string name;
+  };
+
+  typedef std::variant<ImageDescriptorInfo, UniformBufferDescriptorInfo, StorageBufferDescriptorInfo> DescriptorBinding;
   typedef std::vector<DescriptorBinding> DescriptorSetBinding;
 
   struct DescriptorSetInfo
@@ -279,11 +297,40 @@ private:
 
   StageInfo m_stages[static_cast<size_t>(ShaderStage::ShaderStageCount)];
 
+  KRPushConstantPlanner m_pushConstantPlanner;
+
   char m_szKey[256];
 
+  static const int kMaxStages = 4;
+
+  // State referenced by the VkGraphicsPipelineCreateInfo, kept until compile()
+  struct CreateState
+  {
+    VkDevice device;
+    VkPipelineCache pipelineCache;
+    VkPipelineShaderStageCreateInfo stages[kMaxStages];
+    uint32_t stageCount;
+    VkVertexInputBindingDescription bindingDescription;
+    VkVertexInputAttributeDescription vertexAttributeDescriptions[kMaxAttributes];
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo;
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+    VkViewport viewport;
+    VkRect2D scissor;
+    VkPipelineViewportStateCreateInfo viewportState;
+    VkPipelineRasterizationStateCreateInfo rasterizer;
+    VkPipelineMultisampleStateCreateInfo multisampling;
+    VkPipelineColorBlendAttachmentState colorBlendAttachment;
+    VkPipelineColorBlendStateCreateInfo colorBlending;
+    VkPipelineDepthStencilStateCreateInfo depthStencil;
+    VkGraphicsPipelineCreateInfo pipelineInfo;
+  };
+  std::unique_ptr<CreateState> m_createState;
+  void destroyCreateState();
+
   VkDescriptorSetLayout m_descriptorSetLayout;
   VkPipelineLayout m_pipelineLayout;
   VkPipeline m_graphicsPipeline;
+  std::atomic<bool> m_ready;
   std::vector<VkDescriptorSet> m_descriptorSets;
   KrDeviceHandle m_deviceHandle;
 
@@ -46,6 +46,9 @@
 using namespace std;
 
 KRPipelineManager::KRPipelineManager(KRContext& context) : KRContextObject(context)
+  , m_pipelineCount(0)
+  , m_compilePending(0)
+  , m_compileStop(false)
 {
   m_active_pipeline = NULL;
 #ifndef ANDROID
@@ -60,6 +63,14 @@ KRPipelineManager::KRPipelineManager(KRContext& context) : KRContextObject(conte
 
 KRPipelineManager::~KRPipelineManager()
 {
+  {
+    std::lock_guard<std::mutex> lock(m_compileMutex);
+    m_compileStop = true;
+  }
+  m_compileWake.notify_all();
+  if (m_compileThread.joinable()) {
+    m_compileThread.join();
+  }
 #ifndef ANDROID
   glslang::FinalizeProcess();
 #endif // ANDROID
@@ -67,19 +78,21 @@ KRPipelineManager::~KRPipelineManager()
 
 KRPipeline* KRPipelineManager::getPipeline(KRSurface& surface, const PipelineInfo& info)
 {
-  const char* szShaderName = info.shader_name->c_str();
-  std::vector<std::byte> key;
-  key.insert(key.begin(), (std::byte*)szShaderName, (std::byte*)szShaderName + strlen(szShaderName) + 1); // purposefully include the zero terminator
-  key.insert(key.begin(), (std::byte*)&surface.m_deviceHandle, (std::byte*)&surface.m_deviceHandle + sizeof(surface.m_deviceHandle));
-  key.insert(key.begin(), (std::byte*)&surface.m_swapChain->m_imageFormat, (std::byte*)&surface.m_swapChain->m_imageFormat + sizeof(surface.m_swapChain->m_imageFormat));
-  key.insert(key.begin(), (std::byte*)&surface.m_swapChain->m_extent.width, (std::byte*)&surface.m_swapChain->m_extent.width + sizeof(surface.m_swapChain->m_extent.width));
-  key.insert(key.begin(), (std::byte*)&surface.m_swapChain->m_extent.height, (std::byte*)&surface.m_swapChain->m_extent.height + sizeof(surface.m_swapChain->m_extent.height));
-  key.insert(key.begin(), (std::byte*)info.layout, (std::byte*)info.layout + sizeof(*info.layout));
-  
-  // TODO - Add renderPass unique identifier to key
-  PipelineMap::iterator itr = m_pipelines.find(key);
-  if (itr != m_pipelines.end()) {
-    return itr->second;
+  PipelineKey key;
+  key.renderPassId = info.renderPass->getId();
+  key.deviceHandle = surface.m_deviceHandle;
+  key.shaderId = internShader(*info.shader_name);
+  key.layoutId = internLayout(info.layout);
+  key.width = surface.m_swapChain->m_extent.width;
+  key.height = surface.m_swapChain->m_extent.height;
+  key.imageFormat = surface.m_swapChain->m_imageFormat;
+  key.rasterMode = info.rasterMode;
+  key.cullMode = info.cullMode;
+  key.updateHash();
+
+  PipelineSlot* slot = &findPipelineSlot(key);
+  if (slot->pipeline) {
+    return slot->pipeline;
   }
 
   std::vector<std::string> shaderNames;
@@ -98,11 +111,167 @@ KRPipeline* KRPipelineManager::getPipeline(KRSurface& surface, const PipelineInf
 
   KRPipeline* pipeline = new KRPipeline(*m_pContext, surface.m_deviceHandle, info.renderPass, surface.getDimensions(), surface.getDimensions(), info, info.shader_name->c_str(), shaders, info.layout);
 
-  m_pipelines[key] = pipeline;
+  if ((m_pipelineCount + 1) * 2 > m_pipelineSlots.size()) {
+    growPipelineSlots();
+    slot = &findPipelineSlot(key);
+  }
+  slot->key = key;
+  slot->pipeline = pipeline;
+  m_pipelineCount++;
+  queueCompile(pipeline);
 
   return pipeline;
 }
 
+void KRPipelineManager::PipelineKey::updateHash()
+{
+  // 64-bit FNV-1a, a word at a time, followed by the MurmurHash3 finalizer so that the
+  // low bits used to index the slots depend on every field
+  uint64_t h = 0xcbf29ce484222325ULL;
+  uint64_t words[] = {
+    renderPassId,
+    (uint64_t)(uint32_t)deviceHandle << 32 | shaderId,
+    (uint64_t)layoutId << 32 | (uint32_t)imageFormat,
+    (uint64_t)width << 32 | height,
+    (uint64_t)rasterMode << 32 | (uint32_t)cullMode
+  };
+  for (uint64_t word : words) {
+    h = (h ^ word) * 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  hash = h;
+}
+
+bool KRPipelineManager::PipelineKey::operator==(const PipelineKey& other) const
+{
+  return hash == other.hash
+    && renderPassId == other.renderPassId
+    && deviceHandle == other.deviceHandle
+    && shaderId == other.shaderId
+    && layoutId == other.layoutId
+    && width == other.width
+    && height == other.height
+    && imageFormat == other.imageFormat
+    && rasterMode == other.rasterMode
+    && cullMode == other.cullMode;
+}
+
+KRPipelineManager::PipelineSlot& KRPipelineManager::findPipelineSlot(const PipelineKey& key)
+{
+  if (m_pipelineSlots.empty()) {
+    growPipelineSlots();
+  }
+  size_t mask = m_pipelineSlots.size() - 1;
+  size_t i = key.hash & mask;
+  while (m_pipelineSlots[i].pipeline && !(m_pipelineSlots[i].key == key)) {
+    i = (i + 1) & mask;
+  }
+  return m_pipelineSlots[i];
+}
+
+void KRPipelineManager::growPipelineSlots()
+{
+  std::vector<PipelineSlot> slots(std::max<size_t>(m_pipelineSlots.size() * 2, 64), PipelineSlot{});
+  m_pipelineSlots.swap(slots);
+  for (const PipelineSlot& slot : slots) {
+    if (slot.pipeline) {
+      findPipelineSlot(slot.key) = slot;
+    }
+  }
+}
+
+uint32_t KRPipelineManager::internShader(const std::string& name)
+{
+  unordered_map<std::string, uint32_t>::iterator itr = m_shaderIds.find(name);
+  if (itr != m_shaderIds.end()) {
+    return itr->second;
+  }
+  uint32_t id = (uint32_t)m_shaderIds.size();
+  m_shaderIds[name] = id;
+  return id;
+}
+
+uint32_t KRPipelineManager::internLayout(const VertexBufferLayout* layout)
+{
+  // Layouts are looked up by address, then verified in case the address
+  // has been reused by a different layout
+  unordered_map<const VertexBufferLayout*, uint32_t>::iterator itr = m_layoutIds.find(layout);
+  if (itr != m_layoutIds.end() && memcmp(&m_layouts[itr->second], layout, sizeof(VertexBufferLayout)) == 0) {
+    return itr->second;
+  }
+
+  uint32_t id = 0;
+  while (id < m_layouts.size() && memcmp(&m_layouts[id], layout, sizeof(VertexBufferLayout)) != 0) {
+    id++;
+  }
+  if (id == m_layouts.size()) {
+    // Copied bytewise, so that padding compares equal as well
+    memcpy(&m_layouts.emplace_back(), layout, sizeof(VertexBufferLayout));
+  }
+  m_layoutIds[layout] = id;
+  return id;
+}
+
+void KRPipelineManager::prewarm(KRSurface& surface, const std::vector<PipelineInfo>& infos)
+{
+  for (const PipelineInfo& info : infos) {
+    getPipeline(surface, info);
+  }
+}
+
+size_t KRPipelineManager::getPendingPipelineCount()
+{
+  std::lock_guard<std::mutex> lock(m_compileMutex);
+  return m_compilePending;
+}
+
+void KRPipelineManager::queueCompile(KRPipeline* pipeline)
+{
+  std::lock_guard<std::mutex> lock(m_compileMutex);
+  if (!m_compileThread.joinable()) {
+    m_compileThread = std::thread(&KRPipelineManager::runCompile, this);
+  }
+  m_compileQueue.push(pipeline);
+  m_compilePending++;
+  m_compileWake.notify_one();
+}
+
+void KRPipelineManager::runCompile()
+{
+#if defined(ANDROID)
+  // TODO - Set thread names on Android
+#elif defined(_WIN32) || defined(_WIN64)
+  // TODO - Set thread names on windows
+#else
+  pthread_setname_np("Kraken - Pipelines");
+#endif
+
+  while (true) {
+    KRPipeline* pipeline = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_compileMutex);
+      m_compileWake.wait(lock, [this] { return m_compileStop || !m_compileQueue.empty(); });
+      if (m_compileStop) {
+        return;
+      }
+      pipeline = m_compileQueue.front();
+      m_compileQueue.pop();
+    }
+
+    // Pipelines are not destroyed while the compile thread is running
+    pipeline->compile();
+
+    {
+      std::lock_guard<std::mutex> lock(m_compileMutex);
+      m_compilePending--;
+    }
+  }
+}
+
 /*
 // TODO - Vulkan Refactoring, merge with Vulkan version
 KRPipeline *KRPipelineManager::getPipeline(KRSurface& surface, const PipelineInfo &info) {
@@ -308,5 +477,5 @@ KRPipeline *KRPipelineManager::getPipeline(KRSurface& surface, const PipelineInf
 
 size_t KRPipelineManager::getPipelineHandlesUsed()
 {
-  return m_pipelines.size();
+  return m_pipelineCount;
 }
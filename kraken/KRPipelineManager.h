@@ -44,6 +44,9 @@ using std::vector;
 
 #include "KRPipeline.h"
 
+#include <thread>
+#include <condition_variable>
+
 class KRPipeline;
 class PipelineInfo;
 class KRCamera;
@@ -55,13 +58,69 @@ public:
   KRPipelineManager(KRContext& context);
   virtual ~KRPipelineManager();
 
+  // Returns the pipeline for info, queueing it to be compiled on the compile thread the
+  // first time it is requested.  Until it is ready, KRPipeline::bind() returns false so
+  // that the draw is skipped rather than stalling the frame.
   KRPipeline* getPipeline(KRSurface& surface, const PipelineInfo& info);
 
+  // Queues compilation of pipelines expected to be used, such as while loading a scene,
+  // so that they are ready before their first draw.
+  void prewarm(KRSurface& surface, const std::vector<PipelineInfo>& infos);
+
+  // Number of pipelines queued or being compiled
+  size_t getPendingPipelineCount();
+
   size_t getPipelineHandlesUsed();
 
   KRPipeline* m_active_pipeline;
 
 private:
-  typedef std::map<std::vector<std::byte>, KRPipeline* > PipelineMap;
-  PipelineMap m_pipelines;
+  // Identifies everything a KRPipeline is created from.  Shader names and vertex
+  // layouts are interned to small IDs so that keys can be built and compared
+  // without allocating, once per draw.
+  struct PipelineKey
+  {
+    uint64_t hash;
+    uint64_t renderPassId;
+    KrDeviceHandle deviceHandle;
+    uint32_t shaderId;
+    uint32_t layoutId;
+    uint32_t width;
+    uint32_t height;
+    VkFormat imageFormat;
+    RasterMode rasterMode;
+    CullMode cullMode;
+
+    void updateHash();
+    bool operator==(const PipelineKey& other) const;
+  };
+
+  // Open-addressed with linear probing.  A null pipeline marks an empty slot.
+  struct PipelineSlot
+  {
+    PipelineKey key;
+    KRPipeline* pipeline;
+  };
+  std::vector<PipelineSlot> m_pipelineSlots;
+  size_t m_pipelineCount;
+
+  PipelineSlot& findPipelineSlot(const PipelineKey& key);
+  void growPipelineSlots();
+
+  unordered_map<std::string, uint32_t> m_shaderIds;
+  std::vector<VertexBufferLayout> m_layouts; // Indexed by layout ID
+  unordered_map<const VertexBufferLayout*, uint32_t> m_layoutIds;
+
+  uint32_t internShader(const std::string& name);
+  uint32_t internLayout(const VertexBufferLayout* layout);
+
+  std::thread m_compileThread;
+  std::mutex m_compileMutex;
+  std::condition_variable m_compileWake;
+  std::queue<KRPipeline*> m_compileQueue;
+  size_t m_compilePending;
+  bool m_compileStop;
+
+  void queueCompile(KRPipeline* pipeline);
+  void runCompile();
 };
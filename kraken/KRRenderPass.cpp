@@ -40,6 +40,7 @@ KRRenderPass::KRRenderPass(KRContext& context)
   : KRContextObject(context)
   , m_renderPass(VK_NULL_HANDLE)
   , m_info{}
+  , m_id(0)
 {
 
 }
@@ -54,6 +55,9 @@ void KRRenderPass::create(KRDevice& device, const RenderPassInfo& info, const Vk
   assert(m_renderPass == VK_NULL_HANDLE);
   m_info = info;
 
+  static std::atomic<uint64_t> s_nextId(1);
+  m_id = s_nextId++;
+
   if (vkCreateRenderPass(device.m_logicalDevice, &createInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
     // failed! TODO - Error handling
   }
@@ -128,3 +132,8 @@ bool KRRenderPass::isFinal() const
 {
   return m_info.finalPass;
 }
+
+uint64_t KRRenderPass::getId() const
+{
+  return m_id;
+}
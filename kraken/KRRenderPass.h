@@ -90,8 +90,11 @@ public:
   
   RenderPassType getType() const;
   bool isFinal() const;
+  // Unique for each create(), including after the render pass is recreated
+  uint64_t getId() const;
 
   // private:
   VkRenderPass m_renderPass;
   RenderPassInfo m_info;
+  uint64_t m_id;
 };
@@ -0,0 +1,324 @@
+//
+//  KRResourceLoader.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KREngine-common.h"
+
+#include "KRResourceLoader.h"
+#include "KRContext.h"
+#include "KRWorkerPool.h"
+#include "resources/mesh/KRMesh.h"
+#include "resources/texture/KRTextureKTX.h"
+#include "resources/texture/KRTextureKTX2.h"
+#include "mimir.h"
+
+using namespace mimir;
+
+namespace {
+// Resources constructed by decode() on this thread, registered with the context later
+thread_local std::vector<KRResource*>* t_decodedResources = nullptr;
+} // anonymous namespace
+
+KRResourceLoader::KRResourceLoader(KRContext& context)
+  : KRContextObject(context)
+  , m_stop(false)
+  , m_nextCompletionHandle(1)
+{
+}
+
+KRResourceLoader::~KRResourceLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  for (std::unique_ptr<AsyncRequest>& asyncRequest : m_asyncRequests) {
+    for (KRResource* resource : asyncRequest->request.decoded) {
+      delete resource;
+    }
+    delete asyncRequest->request.data;
+  }
+}
+
+bool KRResourceLoader::DeferRegistration(KRResource* resource)
+{
+  if (t_decodedResources == nullptr) {
+    return false;
+  }
+  t_decodedResources->push_back(resource);
+  return true;
+}
+
+void KRResourceLoader::load(std::vector<Request>& requests)
+{
+  getContext().getWorkerPool()->parallelFor(requests.size(), [&](size_t i) {
+    decode(requests[i]);
+  });
+  for (Request& request : requests) {
+    registerResource(request);
+  }
+}
+
+void KRResourceLoader::decode(Request& request)
+{
+  std::string name = util::GetFileBase(request.fileName);
+  std::string extension = util::GetFileExtension(request.fileName);
+  if (extension.compare("krscene") == 0 || extension.compare("kranimation") == 0) {
+    std::string xml_string = request.data->getString();
+    request.xml = std::make_unique<tinyxml2::XMLDocument>();
+    request.xml->Parse(xml_string.c_str());
+  } else if (IsConstructedType(extension)) {
+    t_decodedResources = &request.decoded;
+    construct(request, name, extension);
+    t_decodedResources = nullptr;
+    request.constructed = true;
+  }
+}
+
+bool KRResourceLoader::IsConstructedType(const std::string& extension)
+{
+  return extension.compare("krmesh") == 0
+    || extension.compare("kranimationcurve") == 0
+    || extension.compare("mtl") == 0
+    || extension.compare("krmaterial") == 0
+    || extension.compare("ktx") == 0
+    || extension.compare("ktx2") == 0;
+}
+
+void KRResourceLoader::construct(Request& request, const std::string& name, const std::string& extension)
+{
+  // Corrupt data is rejected here, as resources must not be destroyed on this thread
+  if (extension.compare("krmesh") == 0) {
+    if (KRMesh::ValidatePack(request.data)) {
+      new KRMesh(getContext(), name, request.data);
+      request.data = nullptr;
+    }
+  } else if (extension.compare("kranimationcurve") == 0) {
+    if (KRAnimationCurve::ValidateData(request.data)) {
+      KRAnimationCurve::Load(getContext(), name, request.data);
+      request.data = nullptr;
+    }
+  } else if (extension.compare("mtl") == 0) {
+    KRMaterialManager::ParseMtl(getContext(), request.data);
+    request.data = nullptr;
+  } else if (extension.compare("krmaterial") == 0) {
+    new KRMaterial(getContext(), name, request.data);
+  } else if (extension.compare("ktx") == 0) {
+    new KRTextureKTX(getContext(), request.data, name);
+    request.data = nullptr;
+  } else if (extension.compare("ktx2") == 0) {
+    new KRTextureKTX2(getContext(), request.data, name);
+    request.data = nullptr;
+  }
+}
+
+void KRResourceLoader::publish(Request& request)
+{
+  std::string extension = util::GetFileExtension(request.fileName);
+  for (KRResource* resource : request.decoded) {
+    getContext().addResource(resource, resource->getName());
+    if (extension.compare("krmesh") == 0) {
+      getContext().getMeshManager()->addMesh(static_cast<KRMesh*>(resource));
+    } else if (extension.compare("kranimationcurve") == 0) {
+      getContext().getAnimationCurveManager()->addAnimationCurve(static_cast<KRAnimationCurve*>(resource));
+    } else if (extension.compare("mtl") == 0 || extension.compare("krmaterial") == 0) {
+      getContext().getMaterialManager()->add(static_cast<KRMaterial*>(resource));
+    } else {
+      getContext().getTextureManager()->addTexture(static_cast<KRTexture*>(resource));
+    }
+  }
+  // An mtl file returns the last material it defines
+  request.resource = request.decoded.empty() ? nullptr : request.decoded.back();
+  if (request.resource == nullptr) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to load %s: Invalid or corrupt data.", request.fileName.c_str());
+  }
+  request.decoded.clear();
+  delete request.data;
+  request.data = nullptr;
+}
+
+void KRResourceLoader::registerResource(Request& request)
+{
+  if (request.constructed) {
+    publish(request);
+    return;
+  }
+  if (!request.xml) {
+    request.resource = getContext().loadResource(request.fileName, request.data);
+    request.data = nullptr;
+    return;
+  }
+
+  std::string name = util::GetFileBase(request.fileName);
+  std::string extension = util::GetFileExtension(request.fileName);
+  if (request.xml->Error() || request.xml->RootElement() == nullptr) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to parse %s: %s", request.fileName.c_str(), request.xml->GetErrorStr1() ? request.xml->GetErrorStr1() : "");
+    request.resource = nullptr;
+  } else if (extension.compare("krscene") == 0) {
+    request.resource = getContext().getSceneManager()->loadScene(name, *request.xml);
+  } else {
+    request.resource = getContext().getAnimationManager()->loadAnimation(name.c_str(), *request.xml);
+  }
+  request.xml.reset();
+  delete request.data;
+  request.data = nullptr;
+}
+
+KrCompletionHandle KRResourceLoader::loadAsync(const std::string& path, KrResourceMapIndex resourceHandle)
+{
+  std::unique_ptr<AsyncRequest> asyncRequest = std::make_unique<AsyncRequest>();
+  asyncRequest->path = path;
+  asyncRequest->resourceHandle = resourceHandle;
+  asyncRequest->request.fileName = path;
+  asyncRequest->request.data = nullptr;
+  asyncRequest->request.resource = nullptr;
+  asyncRequest->decoded = false;
+  asyncRequest->result = KR_NOT_READY;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_thread.joinable()) {
+    m_thread = std::thread(&KRResourceLoader::run, this);
+  }
+  asyncRequest->completionHandle = m_nextCompletionHandle++;
+  KrCompletionHandle completionHandle = asyncRequest->completionHandle;
+  m_decodeQueue.push(asyncRequest.get());
+  m_asyncRequests.push_back(std::move(asyncRequest));
+  m_wake.notify_one();
+  return completionHandle;
+}
+
+void KRResourceLoader::run()
+{
+#if defined(ANDROID)
+  // TODO - Set thread names on Android
+#elif defined(_WIN32) || defined(_WIN64)
+  // TODO - Set thread names on windows
+#else
+  pthread_setname_np("Kraken - Loader");
+#endif
+
+  while (true) {
+    AsyncRequest* asyncRequest = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this] { return m_stop || !m_decodeQueue.empty(); });
+      if (m_stop) {
+        return;
+      }
+      asyncRequest = m_decodeQueue.front();
+      m_decodeQueue.pop();
+    }
+
+    // Requests are only removed once decoded, so asyncRequest remains valid here
+    Block* data = new Block();
+    KrResult result = KR_SUCCESS;
+    if (data->load(asyncRequest->path)) {
+      asyncRequest->request.data = data;
+      decode(asyncRequest->request);
+    } else {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "KRResourceLoader - Failed to open file: %s", asyncRequest->path.c_str());
+      delete data;
+      result = KR_ERROR_UNEXPECTED;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      asyncRequest->result = result;
+      asyncRequest->decoded = true;
+    }
+    m_decoded.notify_all();
+  }
+}
+
+void KRResourceLoader::registerCompleted()
+{
+  while (true) {
+    std::unique_ptr<AsyncRequest> asyncRequest;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Register in request order, so the result does not depend on decoding times
+      if (m_asyncRequests.empty() || !m_asyncRequests.front()->decoded) {
+        return;
+      }
+      asyncRequest = std::move(m_asyncRequests.front());
+      m_asyncRequests.pop_front();
+    }
+
+    KrResult result = asyncRequest->result;
+    if (result == KR_SUCCESS) {
+      registerResource(asyncRequest->request);
+      if (asyncRequest->request.resource == nullptr) {
+        result = KR_ERROR_UNEXPECTED;
+      } else {
+        result = getContext().setMappedResource(asyncRequest->resourceHandle, asyncRequest->request.resource);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_completed[asyncRequest->completionHandle] = result;
+  }
+}
+
+KrResult KRResourceLoader::getCompletionStatus(KrCompletionHandle completionHandle, bool wait)
+{
+  while (true) {
+    registerCompleted();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    unordered_map<KrCompletionHandle, KrResult>::iterator itr = m_completed.find(completionHandle);
+    if (itr != m_completed.end()) {
+      KrResult result = itr->second;
+      m_completed.erase(itr);
+      return result;
+    }
+    if (completionHandle == 0 || completionHandle >= m_nextCompletionHandle) {
+      return KR_ERROR_NOT_FOUND;
+    }
+    bool pending = false;
+    for (const std::unique_ptr<AsyncRequest>& asyncRequest : m_asyncRequests) {
+      if (asyncRequest->completionHandle == completionHandle) {
+        pending = true;
+        break;
+      }
+    }
+    if (!pending) {
+      return KR_ERROR_NOT_FOUND; // Result has already been returned
+    }
+    if (!wait) {
+      return KR_NOT_READY;
+    }
+    // Wait for the next request in order to finish decoding, then register it
+    m_decoded.wait(lock, [this] { return m_asyncRequests.front()->decoded; });
+  }
+}
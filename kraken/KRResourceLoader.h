@@ -0,0 +1,116 @@
+//
+//  KRResourceLoader.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+#include "KRContextObject.h"
+#include "block.h"
+#include "public/kraken.h"
+
+#include <thread>
+#include <condition_variable>
+
+class KRResource;
+
+// Loads resources in two phases.  Decoding does not touch the resource managers, so it runs
+// in parallel on the worker pool, or on the loader thread for asynchronous requests.
+// Decoded resources are then registered with their resource managers one at a time,
+// in the order they were requested.
+//
+// Meshes, materials, animation curves and KTX textures are constructed while decoding.
+// Their registration with the context is deferred, so registering only publishes them.
+class KRResourceLoader : public KRContextObject
+{
+public:
+  KRResourceLoader(KRContext& context);
+  ~KRResourceLoader();
+
+  struct Request
+  {
+    std::string fileName;
+    mimir::Block* data;
+    std::unique_ptr<tinyxml2::XMLDocument> xml; // Parsed document, for XML resource types
+    std::vector<KRResource*> decoded; // Resources constructed by decode(), not yet registered
+    bool constructed = false; // True if decode() constructed the resources for this request
+    KRResource* resource;
+  };
+
+  // Decodes the requests on the worker pool, then registers them in order.
+  // Takes ownership of each request's data.
+  void load(std::vector<Request>& requests);
+
+  // Queues a resource file to be read and decoded on the loader thread.  The resource
+  // is registered and mapped to resourceHandle by a later call to registerCompleted().
+  KrCompletionHandle loadAsync(const std::string& path, KrResourceMapIndex resourceHandle);
+
+  // Registers resources that have finished decoding.  Must be called on the thread
+  // that owns the resource managers.
+  void registerCompleted();
+
+  // Returns KR_NOT_READY until the request has completed, then the result of the load.
+  // The completion handle is released once the result has been returned.
+  KrResult getCompletionStatus(KrCompletionHandle completionHandle, bool wait);
+
+  // Called when a resource is constructed.  Returns true if the resource is being constructed
+  // by decode(), in which case it is registered with the context along with its request.
+  static bool DeferRegistration(KRResource* resource);
+
+private:
+  typedef struct
+  {
+    KrCompletionHandle completionHandle;
+    std::string path;
+    KrResourceMapIndex resourceHandle;
+    Request request;
+    bool decoded;
+    KrResult result;
+  } AsyncRequest;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_decoded;
+  bool m_stop;
+
+  std::deque<std::unique_ptr<AsyncRequest>> m_asyncRequests; // In the order they were requested
+  std::queue<AsyncRequest*> m_decodeQueue; // Requests waiting for the loader thread
+  KrCompletionHandle m_nextCompletionHandle;
+  unordered_map<KrCompletionHandle, KrResult> m_completed;
+
+  void run();
+  void decode(Request& request);
+  void construct(Request& request, const std::string& name, const std::string& extension);
+  void registerResource(Request& request);
+  void publish(Request& request);
+
+  static bool IsConstructedType(const std::string& extension);
+};
@@ -249,6 +249,141 @@ bool KRReflectedObject::getShaderValue(const KRCamera* camera, ShaderValue value
   }
 }
 
+template<typename T>
+bool KRReflectedObject::writeShaderValue(const KRReflectedObject* object, const KRCamera* camera, ShaderValue value, void* output)
+{
+  return object->getShaderValue(camera, value, static_cast<T*>(output));
+}
+
+bool KRReflectedObject::hasConditionalShaderValues() const
+{
+  return false;
+}
+
+void KRPushConstantPlanner::addPushConstant(ShaderValue value, ShaderValueType type, void* output)
+{
+  PushConstant& pushConstant = m_pushConstants.emplace_back();
+  pushConstant.writer = KRReflectedObject::getShaderValueWriter(type);
+  pushConstant.output = output;
+  pushConstant.value = value;
+  m_plans.clear();
+}
+
+bool KRPushConstantPlanner::write(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects)
+{
+  bool success = true;
+  const Plan& plan = getPlan(camera, objects);
+  for (size_t i = 0; i < m_pushConstants.size(); i++) {
+    if (!writePushConstant(plan, i, camera, objects)) {
+      success = false;
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Push constant not found: %s", getShaderValueName(static_cast<int>(m_pushConstants[i].value)));
+    }
+  }
+  return success;
+}
+
+bool KRPushConstantPlanner::writePushConstant(const Plan& plan, size_t index, const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects) const
+{
+  const PushConstant& pushConstant = m_pushConstants[index];
+  if (pushConstant.writer == nullptr) {
+    return false;
+  }
+  // Objects ahead of the supplier declined when the plan was made.  Only those with
+  // conditional shader values may supply the value now.
+  size_t supplier = plan.suppliers[index];
+  for (size_t objectIndex : plan.conditionalObjects) {
+    if (objectIndex >= supplier) {
+      break;
+    }
+    if (pushConstant.writer(objects[objectIndex], camera, pushConstant.value, pushConstant.output)) {
+      return true;
+    }
+  }
+  if (supplier == kNoSupplier) {
+    return false;
+  }
+  if (pushConstant.writer(objects[supplier], camera, pushConstant.value, pushConstant.output)) {
+    return true;
+  }
+  // The supplier is conditional and declined, so the objects after it were never checked
+  return findSupplier(pushConstant, supplier + 1, camera, objects) != kNoSupplier;
+}
+
+size_t KRPushConstantPlanner::findSupplier(const PushConstant& pushConstant, size_t first, const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects) const
+{
+  if (pushConstant.writer == nullptr) {
+    return kNoSupplier;
+  }
+  for (size_t i = first; i < objects.size(); i++) {
+    if (pushConstant.writer(objects[i], camera, pushConstant.value, pushConstant.output)) {
+      return i;
+    }
+  }
+  return kNoSupplier;
+}
+
+const KRPushConstantPlanner::Plan& KRPushConstantPlanner::getPlan(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects)
+{
+  // The same draw call sites pass the same sequence of object types each frame,
+  // so a pipeline only sees a handful of signatures.
+  for (const Plan& plan : m_plans) {
+    if (plan.signature.size() != objects.size()) {
+      continue;
+    }
+    size_t i = 0;
+    while (i < objects.size() && *plan.signature[i] == typeid(*objects[i])) {
+      i++;
+    }
+    if (i == objects.size()) {
+      return plan;
+    }
+  }
+
+  Plan& plan = m_plans.emplace_back();
+  plan.signature.reserve(objects.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    plan.signature.push_back(&typeid(*objects[i]));
+    if (objects[i]->hasConditionalShaderValues()) {
+      plan.conditionalObjects.push_back(i);
+    }
+  }
+  plan.suppliers.reserve(m_pushConstants.size());
+  for (const PushConstant& pushConstant : m_pushConstants) {
+    plan.suppliers.push_back(findSupplier(pushConstant, 0, camera, objects));
+  }
+  return plan;
+}
+
+KRReflectedObject::ShaderValueWriter KRReflectedObject::getShaderValueWriter(ShaderValueType type)
+{
+  switch (type) {
+  case ShaderValueType::type_bool:
+    return &writeShaderValue<bool>;
+  case ShaderValueType::type_int32:
+    return &writeShaderValue<int32_t>;
+  case ShaderValueType::type_int64:
+    return &writeShaderValue<int64_t>;
+  case ShaderValueType::type_float32:
+    return &writeShaderValue<float>;
+  case ShaderValueType::type_float64:
+    return &writeShaderValue<double>;
+  case ShaderValueType::type_vector2:
+    return &writeShaderValue<Vector2>;
+  case ShaderValueType::type_vector3:
+    return &writeShaderValue<Vector3>;
+  case ShaderValueType::type_vector4:
+    return &writeShaderValue<Vector4>;
+  case ShaderValueType::type_matrix2:
+    return &writeShaderValue<Matrix2>;
+  case ShaderValueType::type_matrix2x3:
+    return &writeShaderValue<Matrix2x3>;
+  case ShaderValueType::type_matrix4:
+    return &writeShaderValue<Matrix4>;
+  default:
+    return nullptr;
+  }
+}
+
 bool KRReflectedObject::getShaderValue(const KRCamera* camera, ShaderValue value, bool* output) const
 {
   return false;
@@ -32,8 +32,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <typeinfo>
+#include <vector>
 #include "hydra.h"
 
 class KRResourceBinding;
@@ -226,6 +229,15 @@ class KRReflectedObject
 public:
   bool getShaderValue(const KRCamera* camera, ShaderValue value, ShaderValueType type, void* output) const;
   virtual bool getImageBinding(const std::string& name, const KRTextureBinding** binding, KRSampler** sample) const;
+
+  // Equivalent to getShaderValue() for a fixed type, so that the type
+  // dispatch can be resolved once rather than for every value written.
+  typedef bool (*ShaderValueWriter)(const KRReflectedObject* object, const KRCamera* camera, ShaderValue value, void* output);
+  static ShaderValueWriter getShaderValueWriter(ShaderValueType type);
+
+  // Returns true if the object supplies some values only in some states, such as when a
+  // light is present, rather than always supplying the same set of values for its type.
+  virtual bool hasConditionalShaderValues() const;
 protected:
   virtual bool getShaderValue(const KRCamera* camera, ShaderValue value, bool* output) const;
   virtual bool getShaderValue(const KRCamera* camera, ShaderValue value, int32_t* output) const;
@@ -239,4 +251,44 @@ protected:
   virtual bool getShaderValue(const KRCamera* camera, ShaderValue value, hydra::Matrix2x3* output) const;
   virtual bool getShaderValue(const KRCamera* camera, ShaderValue value, hydra::Matrix4* output) const;
   virtual bool getShaderValue(const KRCamera* camera, ShaderValue value, KRResourceBinding* output) const;
+private:
+  template<typename T>
+  static bool writeShaderValue(const KRReflectedObject* object, const KRCamera* camera, ShaderValue value, void* output);
+};
+
+// Writes push constants from a sequence of reflected objects, taking each value from the
+// first object that supplies it.  Which object that is only depends on the types of the
+// objects, so it is resolved once for each sequence of types.  Objects with conditional
+// shader values are checked again on each write.
+class KRPushConstantPlanner
+{
+public:
+  // Adds a value that write() stores at output
+  void addPushConstant(ShaderValue value, ShaderValueType type, void* output);
+  // Returns false, after logging the values that were not found, if any value was not supplied
+  bool write(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects);
+
+private:
+  struct PushConstant
+  {
+    KRReflectedObject::ShaderValueWriter writer;
+    void* output;
+    ShaderValue value;
+  };
+  std::vector<PushConstant> m_pushConstants;
+
+  static const size_t kNoSupplier = SIZE_MAX;
+
+  // Push constant suppliers resolved for one sequence of reflected object types
+  struct Plan
+  {
+    std::vector<const std::type_info*> signature;
+    std::vector<size_t> conditionalObjects; // Indexes of objects with conditional shader values
+    std::vector<size_t> suppliers; // Object that supplied each push constant, or kNoSupplier
+  };
+  std::vector<Plan> m_plans;
+
+  const Plan& getPlan(const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects);
+  bool writePushConstant(const Plan& plan, size_t index, const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects) const;
+  size_t findSupplier(const PushConstant& pushConstant, size_t first, const KRCamera* camera, const std::vector<const KRReflectedObject*>& objects) const;
 };
@@ -38,6 +38,22 @@ const long KRENGINE_OCCLUSION_TEST_EXPIRY = 10;
 
 using namespace hydra;
 
+namespace {
+
+// A box is outside a plane when all 8 of its corners are.  The corner
+// furthest along the plane normal is found per axis, so boxes need not
+// have min <= max to match the per-corner test.
+bool BoxOutsidePlane(const Vector4& plane, const AABB& b)
+{
+  float d = plane.w;
+  d += std::max(plane.x * b.min.x, plane.x * b.max.x);
+  d += std::max(plane.y * b.min.y, plane.y * b.max.y);
+  d += std::max(plane.z * b.min.z, plane.z * b.max.z);
+  return d < 0.0f;
+}
+
+} // anonymous namespace
+
 KRViewport::KRViewport()
 {
   m_size = Vector2::One();
@@ -181,6 +197,14 @@ void KRViewport::calculateDerivedValues()
   m_cameraPosition = Matrix4::Dot(m_matInverseView, Vector3::Zero());
   m_cameraDirection = Matrix4::Dot(m_matInverseView, Vector3::Create(0.0, 0.0, 1.0)) - Matrix4::Dot(m_matInverseView, Vector3::Create(0.0, 0.0, 0.0));
 
+  // Clip space components are the columns of m_matViewProjection dotted with
+  // the world space position.  -w <= x <= w gives the planes x + w >= 0 and w - x >= 0.
+  const float* m = m_matViewProjection.c;
+  for (int axis = 0; axis < 3; axis++) {
+    m_frustumPlanes[axis] = Vector4::Create(m[axis] + m[3], m[4 + axis] + m[7], m[8 + axis] + m[11], m[12 + axis] + m[15]);
+    m_frustumPlanes[axis + 3] = Vector4::Create(m[3] - m[axis], m[7] - m[4 + axis], m[11] - m[8 + axis], m[15] - m[12 + axis]);
+  }
+
   for (int i = 0; i < 8; i++) {
     m_frontToBackOrder[i] = i;
   }
@@ -269,43 +293,93 @@ bool KRViewport::visible(const AABB& b) const
 {
   // test if bounding box would be within the visible range of the clip space transformed by matViewProjection
   // This is used for view frustrum culling
+  for (int iPlane = 0; iPlane < 6; iPlane++) {
+    if (BoxOutsidePlane(m_frustumPlanes[iPlane], b)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  int outside_count[6] = { 0, 0, 0, 0, 0, 0 };
-
-  for (int iCorner = 0; iCorner < 8; iCorner++) {
-    Vector4 sourceCornerVertex = Vector4::Create(
-                                             (iCorner & 1) == 0 ? b.min.x : b.max.x,
-                                             (iCorner & 2) == 0 ? b.min.y : b.max.y,
-                                             (iCorner & 4) == 0 ? b.min.z : b.max.z, 1.0f);
-
-    Vector4 cornerVertex = Matrix4::Dot4(m_matViewProjection, sourceCornerVertex);
-
-    if (cornerVertex.x < -cornerVertex.w) {
-      outside_count[0]++;
+void KRViewport::visibleBatch(const AABB* boxes, size_t count, uint8_t* outMask) const
+{
+  size_t i = 0;
+#if defined(KRAKEN_ARCH_X86_64)
+  __m128 plane[6][4];
+  for (int iPlane = 0; iPlane < 6; iPlane++) {
+    for (int c = 0; c < 4; c++) {
+      plane[iPlane][c] = _mm_set1_ps(m_frustumPlanes[iPlane].c[c]);
+    }
+  }
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    // Transpose four boxes to one register per component
+    const AABB* b = boxes + i;
+    __m128 min_x = _mm_setr_ps(b[0].min.x, b[1].min.x, b[2].min.x, b[3].min.x);
+    __m128 min_y = _mm_setr_ps(b[0].min.y, b[1].min.y, b[2].min.y, b[3].min.y);
+    __m128 min_z = _mm_setr_ps(b[0].min.z, b[1].min.z, b[2].min.z, b[3].min.z);
+    __m128 max_x = _mm_setr_ps(b[0].max.x, b[1].max.x, b[2].max.x, b[3].max.x);
+    __m128 max_y = _mm_setr_ps(b[0].max.y, b[1].max.y, b[2].max.y, b[3].max.y);
+    __m128 max_z = _mm_setr_ps(b[0].max.z, b[1].max.z, b[2].max.z, b[3].max.z);
+
+    __m128 outside = _mm_setzero_ps();
+    for (int iPlane = 0; iPlane < 6; iPlane++) {
+      __m128 d = plane[iPlane][3];
+      d = _mm_add_ps(d, _mm_max_ps(_mm_mul_ps(plane[iPlane][0], min_x), _mm_mul_ps(plane[iPlane][0], max_x)));
+      d = _mm_add_ps(d, _mm_max_ps(_mm_mul_ps(plane[iPlane][1], min_y), _mm_mul_ps(plane[iPlane][1], max_y)));
+      d = _mm_add_ps(d, _mm_max_ps(_mm_mul_ps(plane[iPlane][2], min_z), _mm_mul_ps(plane[iPlane][2], max_z)));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
     }
-    if (cornerVertex.y < -cornerVertex.w) {
-      outside_count[1]++;
+    int outside_bits = _mm_movemask_ps(outside);
+    for (int lane = 0; lane < 4; lane++) {
+      outMask[i + lane] = (outside_bits & (1 << lane)) ? 0 : 1;
     }
-    if (cornerVertex.z < -cornerVertex.w) {
-      outside_count[2]++;
+  }
+#else
+  float32x4_t plane[6][4];
+  for (int iPlane = 0; iPlane < 6; iPlane++) {
+    for (int c = 0; c < 4; c++) {
+      plane[iPlane][c] = vdupq_n_f32(m_frustumPlanes[iPlane].c[c]);
     }
-    if (cornerVertex.x > cornerVertex.w) {
-      outside_count[3]++;
+  }
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (; i + 4 <= count; i += 4) {
+    // Transpose four boxes to one register per component
+    const AABB* b = boxes + i;
+    float lanes[6][4];
+    for (int lane = 0; lane < 4; lane++) {
+      lanes[0][lane] = b[lane].min.x;
+      lanes[1][lane] = b[lane].min.y;
+      lanes[2][lane] = b[lane].min.z;
+      lanes[3][lane] = b[lane].max.x;
+      lanes[4][lane] = b[lane].max.y;
+      lanes[5][lane] = b[lane].max.z;
     }
-    if (cornerVertex.y > cornerVertex.w) {
-      outside_count[4]++;
+    float32x4_t min_x = vld1q_f32(lanes[0]);
+    float32x4_t min_y = vld1q_f32(lanes[1]);
+    float32x4_t min_z = vld1q_f32(lanes[2]);
+    float32x4_t max_x = vld1q_f32(lanes[3]);
+    float32x4_t max_y = vld1q_f32(lanes[4]);
+    float32x4_t max_z = vld1q_f32(lanes[5]);
+
+    uint32x4_t outside = vdupq_n_u32(0);
+    for (int iPlane = 0; iPlane < 6; iPlane++) {
+      float32x4_t d = plane[iPlane][3];
+      d = vaddq_f32(d, vmaxq_f32(vmulq_f32(plane[iPlane][0], min_x), vmulq_f32(plane[iPlane][0], max_x)));
+      d = vaddq_f32(d, vmaxq_f32(vmulq_f32(plane[iPlane][1], min_y), vmulq_f32(plane[iPlane][1], max_y)));
+      d = vaddq_f32(d, vmaxq_f32(vmulq_f32(plane[iPlane][2], min_z), vmulq_f32(plane[iPlane][2], max_z)));
+      outside = vorrq_u32(outside, vcltq_f32(d, zero));
     }
-    if (cornerVertex.z > cornerVertex.w) {
-      outside_count[5]++;
+    uint32_t outside_lanes[4];
+    vst1q_u32(outside_lanes, outside);
+    for (int lane = 0; lane < 4; lane++) {
+      outMask[i + lane] = outside_lanes[lane] ? 0 : 1;
     }
   }
+#endif
 
-  bool is_visible = true;
-  for (int iFace = 0; iFace < 6; iFace++) {
-    if (outside_count[iFace] == 8) {
-      is_visible = false;
-    }
+  // Remaining boxes
+  for (; i < count; i++) {
+    outMask[i] = visible(boxes[i]) ? 1 : 0;
   }
-
-  return is_visible;
 }
@@ -73,6 +73,8 @@ public:
   void setVisibleLights(const std::set<KRLight*> visibleLights);
 
   bool visible(const hydra::AABB& b) const;
+  // Writes 1 to outMask[i] if boxes[i] may be visible, or 0 if it is outside the view frustum
+  void visibleBatch(const hydra::AABB* boxes, size_t count, uint8_t* outMask) const;
   float coverage(const hydra::AABB& b) const;
 
 private:
@@ -89,6 +91,9 @@ private:
   hydra::Vector3 m_cameraDirection;
   hydra::Vector3 m_cameraPosition;
 
+  // Clip space planes (-x, -y, -z, +x, +y, +z) in world space, as ax + by + cz + d >= 0 inside
+  hydra::Vector4 m_frustumPlanes[6];
+
   int m_frontToBackOrder[8];
   int m_backToFrontOrder[8];
 
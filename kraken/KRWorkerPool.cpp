@@ -0,0 +1,147 @@
+//
+//  KRWorkerPool.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KREngine-common.h"
+
+#include "KRWorkerPool.h"
+
+namespace {
+thread_local bool t_insideJob = false;
+} // anonymous namespace
+
+KRWorkerPool::KRWorkerPool(size_t worker_count)
+  : m_job(nullptr)
+  , m_jobCount(0)
+  , m_nextIndex(0)
+  , m_activeWorkers(0)
+  , m_generation(0)
+  , m_stop(false)
+{
+  if (worker_count == 0) {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+  }
+  m_threads.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; i++) {
+    m_threads.emplace_back(&KRWorkerPool::run, this);
+  }
+}
+
+KRWorkerPool::~KRWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+}
+
+size_t KRWorkerPool::getThreadCount() const
+{
+  return m_threads.size() + 1;
+}
+
+void KRWorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+  if (count == 0) {
+    return;
+  }
+  if (m_threads.empty() || count == 1 || t_insideJob) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> dispatch_lock(m_dispatchMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_job = &fn;
+    m_jobCount = count;
+    m_nextIndex = 0;
+    m_generation++;
+  }
+  m_wake.notify_all();
+
+  drain(fn, count);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [this] { return m_activeWorkers == 0; });
+  // Workers that wake after this point will see no job and go back to sleep
+  m_job = nullptr;
+  m_jobCount = 0;
+}
+
+void KRWorkerPool::drain(const std::function<void(size_t)>& fn, size_t count)
+{
+  t_insideJob = true;
+  size_t i;
+  while ((i = m_nextIndex.fetch_add(1)) < count) {
+    fn(i);
+  }
+  t_insideJob = false;
+}
+
+void KRWorkerPool::run()
+{
+#if defined(__APPLE__)
+  pthread_setname_np("Kraken - Worker");
+#else
+  // TODO - Set thread names on other platforms
+#endif
+
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_wake.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+    if (m_stop) {
+      return;
+    }
+    generation = m_generation;
+    if (m_job == nullptr) {
+      continue;
+    }
+    const std::function<void(size_t)>* job = m_job;
+    size_t count = m_jobCount;
+    m_activeWorkers++;
+    lock.unlock();
+
+    drain(*job, count);
+
+    lock.lock();
+    if (--m_activeWorkers == 0) {
+      m_done.notify_all();
+    }
+  }
+}
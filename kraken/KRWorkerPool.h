@@ -0,0 +1,74 @@
+//
+//  KRWorkerPool.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+// A fixed set of worker threads for fork-join jobs that must complete
+// within the calling function, such as batched scene queries.
+class KRWorkerPool
+{
+public:
+  // worker_count of 0 selects one worker per hardware thread, minus one for the calling thread
+  KRWorkerPool(size_t worker_count = 0);
+  ~KRWorkerPool();
+
+  // Number of threads that participate in a job, including the calling thread
+  size_t getThreadCount() const;
+
+  // Calls fn(i) for every i in [0, count) and returns once all calls have completed.
+  // The calling thread participates.  Calls made from within a job run serially.
+  void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_dispatchMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+
+  const std::function<void(size_t)>* m_job;
+  size_t m_jobCount;
+  std::atomic<size_t> m_nextIndex;
+  size_t m_activeWorkers;
+  uint64_t m_generation;
+  bool m_stop;
+
+  void run();
+  void drain(const std::function<void(size_t)>& fn, size_t count);
+};
@@ -0,0 +1,806 @@
+//
+//  KRZstdDecoder.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+
+#include "KRZstdDecoder.h"
+
+#include <bit>
+
+namespace {
+
+const uint32_t kZstdMagic = 0xFD2FB528;
+
+const int16_t kDefaultLiteralLengthCounts[36] = {
+  4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+  -1, -1, -1, -1
+};
+const int16_t kDefaultMatchLengthCounts[53] = {
+  1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+  -1, -1, -1, -1, -1
+};
+const int16_t kDefaultOffsetCounts[29] = {
+  1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+};
+
+const uint32_t kLiteralLengthBase[36] = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+  16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+  8192, 16384, 32768, 65536
+};
+const uint8_t kLiteralLengthBits[36] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+  13, 14, 15, 16
+};
+const uint32_t kMatchLengthBase[53] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+  19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+  35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+  4099, 8195, 16387, 32771, 65539
+};
+const uint8_t kMatchLengthBits[53] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+  12, 13, 14, 15, 16
+};
+
+inline uint32_t ReadLE32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline int HighBit(uint32_t value)
+{
+  return std::bit_width(value) - 1;
+}
+
+// Reads a bitstream from its end towards its start, as Zstandard entropy coded data is written.
+// Bits read beyond the start of the stream are zero, and flag an overflow.
+class BackwardBitReader
+{
+public:
+  bool init(const uint8_t* data, size_t length)
+  {
+    m_data = data;
+    m_length = length;
+    if (length == 0 || data[length - 1] == 0) {
+      return false;
+    }
+    // The highest set bit of the last byte marks the end of the stream
+    m_position = (int64_t)(length - 1) * 8 + HighBit(data[length - 1]);
+    return true;
+  }
+
+  uint64_t peek(int64_t position, int count) const
+  {
+    if (count <= 0) {
+      return 0;
+    }
+    if (position < 0) {
+      return peek(0, count + (int)position) << -position;
+    }
+    size_t byte = (size_t)(position >> 3);
+    uint64_t word = 0;
+    if (byte + 8 <= m_length) {
+      memcpy(&word, m_data + byte, 8);
+    } else {
+      for (size_t i = byte; i < m_length; i++) {
+        word |= (uint64_t)m_data[i] << ((i - byte) * 8);
+      }
+    }
+    return (word >> (position & 7)) & ((1ull << count) - 1);
+  }
+
+  uint64_t read(int count)
+  {
+    m_position -= count;
+    return peek(m_position, count);
+  }
+
+  int64_t position() const
+  {
+    return m_position;
+  }
+
+  void consume(int count)
+  {
+    m_position -= count;
+  }
+
+  bool overflowed() const
+  {
+    return m_position < 0;
+  }
+
+private:
+  const uint8_t* m_data;
+  size_t m_length;
+  int64_t m_position;
+};
+
+} // anonymous namespace
+
+KRZstdDecoder::KRZstdDecoder()
+  : m_literalCount(0)
+  , m_huffmanBits(0)
+  , m_huffmanValid(false)
+  , m_literalLengthsValid(false)
+  , m_offsetsValid(false)
+  , m_matchLengthsValid(false)
+{
+  m_literals.resize(kMaxBlockSize);
+  m_repeatOffsets[0] = 1;
+  m_repeatOffsets[1] = 4;
+  m_repeatOffsets[2] = 8;
+}
+
+KRZstdDecoder::~KRZstdDecoder()
+{
+}
+
+bool KRZstdDecoder::decompress(const uint8_t* input, size_t inputLength, uint8_t* output, size_t outputLength, size_t* decompressedLength)
+{
+  const uint8_t* inputEnd = input + inputLength;
+  uint8_t* outputStart = output;
+  uint8_t* outputEnd = output + outputLength;
+  while (input < inputEnd) {
+    if (inputEnd - input < 8) {
+      return false;
+    }
+    uint32_t magic = ReadLE32(input);
+    if ((magic & 0xFFFFFFF0) == 0x184D2A50) {
+      // Skippable frame
+      uint32_t frameLength = ReadLE32(input + 4);
+      if (frameLength > (size_t)(inputEnd - input - 8)) {
+        return false;
+      }
+      input += 8 + frameLength;
+      continue;
+    }
+    if (magic != kZstdMagic || !decompressFrame(input, inputEnd, output, outputEnd)) {
+      return false;
+    }
+  }
+  *decompressedLength = output - outputStart;
+  return true;
+}
+
+bool KRZstdDecoder::decompressFrame(const uint8_t*& input, const uint8_t* inputEnd, uint8_t*& output, uint8_t* outputEnd)
+{
+  input += 4; // Magic number
+  uint8_t descriptor = *input++;
+  int contentSizeFlag = descriptor >> 6;
+  bool singleSegment = (descriptor & 0x20) != 0;
+  bool hasChecksum = (descriptor & 0x04) != 0;
+  int dictionaryIdFlag = descriptor & 0x03;
+  if (descriptor & 0x08) {
+    return false; // Reserved bit
+  }
+
+  const int dictionaryIdSizes[4] = { 0, 1, 2, 4 };
+  const int contentSizeSizes[4] = { singleSegment ? 1 : 0, 2, 4, 8 };
+  size_t headerLength = (singleSegment ? 0 : 1) + dictionaryIdSizes[dictionaryIdFlag] + contentSizeSizes[contentSizeFlag];
+  if ((size_t)(inputEnd - input) < headerLength) {
+    return false;
+  }
+  if (!singleSegment) {
+    input++; // Window descriptor.  The whole frame is decoded in place, so the window size is not needed.
+  }
+  uint32_t dictionaryId = 0;
+  for (int i = 0; i < dictionaryIdSizes[dictionaryIdFlag]; i++) {
+    dictionaryId |= (uint32_t)input[i] << (i * 8);
+  }
+  if (dictionaryId != 0) {
+    return false;
+  }
+  input += dictionaryIdSizes[dictionaryIdFlag] + contentSizeSizes[contentSizeFlag];
+
+  // Entropy tables and repeat offsets only carry over between blocks of the same frame
+  m_huffmanValid = false;
+  m_literalLengthsValid = false;
+  m_offsetsValid = false;
+  m_matchLengthsValid = false;
+  m_repeatOffsets[0] = 1;
+  m_repeatOffsets[1] = 4;
+  m_repeatOffsets[2] = 8;
+
+  uint8_t* frameStart = output;
+  bool lastBlock = false;
+  while (!lastBlock) {
+    if (inputEnd - input < 3) {
+      return false;
+    }
+    uint32_t blockHeader = input[0] | (input[1] << 8) | (input[2] << 16);
+    input += 3;
+    lastBlock = (blockHeader & 1) != 0;
+    int blockType = (blockHeader >> 1) & 3;
+    size_t blockSize = blockHeader >> 3;
+
+    switch (blockType) {
+    case 0: // Raw
+      if ((size_t)(inputEnd - input) < blockSize || (size_t)(outputEnd - output) < blockSize) {
+        return false;
+      }
+      memcpy(output, input, blockSize);
+      input += blockSize;
+      output += blockSize;
+      break;
+    case 1: // RLE
+      if (input == inputEnd || (size_t)(outputEnd - output) < blockSize) {
+        return false;
+      }
+      memset(output, *input, blockSize);
+      input++;
+      output += blockSize;
+      break;
+    case 2: // Compressed
+      if ((size_t)(inputEnd - input) < blockSize || blockSize > kMaxBlockSize) {
+        return false;
+      }
+      if (!decompressBlock(input, blockSize, output, outputEnd, frameStart)) {
+        return false;
+      }
+      input += blockSize;
+      break;
+    default:
+      return false;
+    }
+  }
+
+  if (hasChecksum) {
+    // The xxHash64 content checksum is not verified
+    if (inputEnd - input < 4) {
+      return false;
+    }
+    input += 4;
+  }
+  return true;
+}
+
+bool KRZstdDecoder::decompressBlock(const uint8_t* input, size_t length, uint8_t*& output, uint8_t* outputEnd, const uint8_t* frameStart)
+{
+  const uint8_t* inputEnd = input + length;
+  if (!decodeLiterals(input, inputEnd)) {
+    return false;
+  }
+  return decodeSequences(input, inputEnd, output, outputEnd, frameStart);
+}
+
+bool KRZstdDecoder::decodeLiterals(const uint8_t*& input, const uint8_t* inputEnd)
+{
+  if (input == inputEnd) {
+    return false;
+  }
+  int type = input[0] & 3;
+  int sizeFormat = (input[0] >> 2) & 3;
+
+  if (type == 0 || type == 1) {
+    // Raw or RLE literals
+    size_t headerLength;
+    size_t size;
+    if ((sizeFormat & 1) == 0) {
+      headerLength = 1;
+      size = input[0] >> 3;
+    } else if (sizeFormat == 1) {
+      headerLength = 2;
+      if (inputEnd - input < 2) {
+        return false;
+      }
+      size = (input[0] >> 4) | (input[1] << 4);
+    } else {
+      headerLength = 3;
+      if (inputEnd - input < 3) {
+        return false;
+      }
+      size = (input[0] >> 4) | (input[1] << 4) | (input[2] << 12);
+    }
+    input += headerLength;
+    if (size > kMaxBlockSize) {
+      return false;
+    }
+    if (type == 0) {
+      if ((size_t)(inputEnd - input) < size) {
+        return false;
+      }
+      memcpy(m_literals.data(), input, size);
+      input += size;
+    } else {
+      if (input == inputEnd) {
+        return false;
+      }
+      memset(m_literals.data(), *input, size);
+      input++;
+    }
+    m_literalCount = size;
+    return true;
+  }
+
+  // Huffman compressed literals, with a new table or the previous one
+  size_t headerLength = sizeFormat < 2 ? 3 : sizeFormat == 2 ? 4 : 5;
+  if ((size_t)(inputEnd - input) < headerLength) {
+    return false;
+  }
+  uint64_t header = 0;
+  for (size_t i = 0; i < headerLength; i++) {
+    header |= (uint64_t)input[i] << (i * 8);
+  }
+  int sizeBits = sizeFormat < 2 ? 10 : sizeFormat == 2 ? 14 : 18;
+  size_t regeneratedSize = (size_t)((header >> 4) & ((1u << sizeBits) - 1));
+  size_t compressedSize = (size_t)((header >> (4 + sizeBits)) & ((1u << sizeBits) - 1));
+  int streamCount = sizeFormat == 0 ? 1 : 4;
+  input += headerLength;
+  if ((size_t)(inputEnd - input) < compressedSize || regeneratedSize > kMaxBlockSize) {
+    return false;
+  }
+  const uint8_t* literalsEnd = input + compressedSize;
+
+  if (type == 2) {
+    if (!readHuffmanTable(input, literalsEnd)) {
+      return false;
+    }
+  } else if (!m_huffmanValid) {
+    return false;
+  }
+
+  if (streamCount == 1) {
+    if (!decodeHuffmanStream(input, literalsEnd - input, m_literals.data(), regeneratedSize)) {
+      return false;
+    }
+  } else {
+    if (literalsEnd - input < 6) {
+      return false;
+    }
+    size_t streamSizes[4];
+    streamSizes[0] = input[0] | (input[1] << 8);
+    streamSizes[1] = input[2] | (input[3] << 8);
+    streamSizes[2] = input[4] | (input[5] << 8);
+    input += 6;
+    size_t totalSize = literalsEnd - input;
+    if (streamSizes[0] + streamSizes[1] + streamSizes[2] > totalSize) {
+      return false;
+    }
+    streamSizes[3] = totalSize - streamSizes[0] - streamSizes[1] - streamSizes[2];
+
+    size_t segmentSize = (regeneratedSize + 3) / 4;
+    size_t offset = 0;
+    for (int i = 0; i < 4; i++) {
+      size_t count = i < 3 ? std::min(segmentSize, regeneratedSize - offset) : regeneratedSize - offset;
+      if (!decodeHuffmanStream(input, streamSizes[i], m_literals.data() + offset, count)) {
+        return false;
+      }
+      input += streamSizes[i];
+      offset += count;
+    }
+  }
+  input = literalsEnd;
+  m_literalCount = regeneratedSize;
+  return true;
+}
+
+bool KRZstdDecoder::readHuffmanTable(const uint8_t*& input, const uint8_t* inputEnd)
+{
+  if (input == inputEnd) {
+    return false;
+  }
+  uint8_t weights[256] = {};
+  int weightCount = 0;
+  uint8_t header = *input++;
+
+  if (header >= 128) {
+    // Weights stored directly, 4 bits each
+    weightCount = header - 127;
+    size_t length = (weightCount + 1) / 2;
+    if ((size_t)(inputEnd - input) < length) {
+      return false;
+    }
+    for (int i = 0; i < weightCount; i++) {
+      weights[i] = (i & 1) ? (input[i / 2] & 15) : (input[i / 2] >> 4);
+    }
+    input += length;
+  } else {
+    // Weights compressed with FSE, decoded with two interleaved states
+    if ((size_t)(inputEnd - input) < header) {
+      return false;
+    }
+    const uint8_t* weightsStart = input;
+    const uint8_t* weightsEnd = input + header;
+    int16_t counts[256];
+    int maxSymbol = 255;
+    int accuracyLog = 0;
+    FSETable table;
+    if (!readNormalizedCounts(input, weightsEnd, counts, &maxSymbol, &accuracyLog, 6) || !buildFSETable(table, counts, maxSymbol, accuracyLog)) {
+      return false;
+    }
+    BackwardBitReader bits;
+    if (!bits.init(input, weightsEnd - input)) {
+      return false;
+    }
+    uint32_t state1 = (uint32_t)bits.read(accuracyLog);
+    uint32_t state2 = (uint32_t)bits.read(accuracyLog);
+    while (true) {
+      if (weightCount >= 254) {
+        return false;
+      }
+      const FSEEntry& entry1 = table.entries[state1];
+      weights[weightCount++] = entry1.symbol;
+      state1 = entry1.newState + (uint32_t)bits.read(entry1.bits);
+      if (bits.overflowed()) {
+        weights[weightCount++] = table.entries[state2].symbol;
+        break;
+      }
+      const FSEEntry& entry2 = table.entries[state2];
+      weights[weightCount++] = entry2.symbol;
+      state2 = entry2.newState + (uint32_t)bits.read(entry2.bits);
+      if (bits.overflowed()) {
+        weights[weightCount++] = table.entries[state1].symbol;
+        break;
+      }
+    }
+    input = weightsStart + header;
+  }
+
+  // The weight of the last symbol is implied by the others summing to a power of two
+  uint32_t total = 0;
+  for (int i = 0; i < weightCount; i++) {
+    if (weights[i] > kMaxHuffmanBits) {
+      return false;
+    }
+    if (weights[i] > 0) {
+      total += 1u << (weights[i] - 1);
+    }
+  }
+  if (total == 0) {
+    return false;
+  }
+  int maxBits = HighBit(total) + 1;
+  uint32_t remainder = (1u << maxBits) - total;
+  if (maxBits > kMaxHuffmanBits || (remainder & (remainder - 1)) != 0) {
+    return false;
+  }
+  weights[weightCount++] = (uint8_t)(HighBit(remainder) + 1);
+
+  // Symbols with the lowest weight take the lowest codes, in symbol order
+  uint32_t position = 0;
+  for (int weight = 1; weight <= maxBits; weight++) {
+    uint32_t span = 1u << (weight - 1);
+    for (int symbol = 0; symbol < weightCount; symbol++) {
+      if (weights[symbol] != weight) {
+        continue;
+      }
+      for (uint32_t i = 0; i < span; i++) {
+        m_huffman[position + i].symbol = (uint8_t)symbol;
+        m_huffman[position + i].bits = (uint8_t)(maxBits + 1 - weight);
+      }
+      position += span;
+    }
+  }
+  if (position != (1u << maxBits)) {
+    return false;
+  }
+  m_huffmanBits = maxBits;
+  m_huffmanValid = true;
+  return true;
+}
+
+bool KRZstdDecoder::decodeHuffmanStream(const uint8_t* input, size_t length, uint8_t* output, size_t count)
+{
+  BackwardBitReader bits;
+  if (!bits.init(input, length)) {
+    return false;
+  }
+  int maxBits = m_huffmanBits;
+  for (size_t i = 0; i < count; i++) {
+    const HuffmanEntry& entry = m_huffman[bits.peek(bits.position() - maxBits, maxBits)];
+    output[i] = entry.symbol;
+    bits.consume(entry.bits);
+  }
+  // Each stream must be consumed exactly
+  return bits.position() == 0;
+}
+
+bool KRZstdDecoder::readNormalizedCounts(const uint8_t*& input, const uint8_t* inputEnd, int16_t* counts, int* maxSymbol, int* accuracyLog, int maxAccuracyLog)
+{
+  size_t length = inputEnd - input;
+  auto peek = [&](size_t bitPosition) -> uint32_t {
+    size_t byte = bitPosition >> 3;
+    uint32_t word = 0;
+    for (size_t i = 0; i < 4 && byte + i < length; i++) {
+      word |= (uint32_t)input[byte + i] << (i * 8);
+    }
+    return word >> (bitPosition & 7);
+  };
+
+  if (length == 0) {
+    return false;
+  }
+  size_t bitPosition = 0;
+  int log = (peek(0) & 15) + 5;
+  bitPosition += 4;
+  if (log > maxAccuracyLog) {
+    return false;
+  }
+
+  int remaining = (1 << log) + 1;
+  int threshold = 1 << log;
+  int bitCount = log + 1;
+  int symbol = 0;
+  bool previousZero = false;
+  while (remaining > 1 && symbol <= *maxSymbol) {
+    if (previousZero) {
+      // Runs of zero probabilities are encoded as 2-bit repeat counts
+      int zeroEnd = symbol;
+      while (true) {
+        int repeat = peek(bitPosition) & 3;
+        bitPosition += 2;
+        zeroEnd += repeat;
+        if (repeat != 3) {
+          break;
+        }
+      }
+      if (zeroEnd > *maxSymbol) {
+        return false;
+      }
+      while (symbol < zeroEnd) {
+        counts[symbol++] = 0;
+      }
+    }
+
+    int max = (2 * threshold - 1) - remaining;
+    uint32_t value = peek(bitPosition);
+    int count;
+    if ((int)(value & (threshold - 1)) < max) {
+      count = value & (threshold - 1);
+      bitPosition += bitCount - 1;
+    } else {
+      count = value & (2 * threshold - 1);
+      if (count >= threshold) {
+        count -= max;
+      }
+      bitPosition += bitCount;
+    }
+    count--; // -1 is a "less than one" probability
+    remaining -= count < 0 ? -count : count;
+    counts[symbol++] = (int16_t)count;
+    previousZero = count == 0;
+    while (remaining < threshold) {
+      bitCount--;
+      threshold >>= 1;
+    }
+  }
+  if (remaining != 1 || (bitPosition + 7) / 8 > length) {
+    return false;
+  }
+  *maxSymbol = symbol - 1;
+  *accuracyLog = log;
+  input += (bitPosition + 7) / 8;
+  return true;
+}
+
+bool KRZstdDecoder::buildFSETable(FSETable& table, const int16_t* counts, int maxSymbol, int accuracyLog)
+{
+  uint32_t size = 1u << accuracyLog;
+  uint32_t highThreshold = size - 1;
+  uint32_t next[256];
+
+  // "Less than one" probabilities take single cells at the end of the table
+  for (int symbol = 0; symbol <= maxSymbol; symbol++) {
+    if (counts[symbol] == -1) {
+      table.entries[highThreshold--].symbol = (uint8_t)symbol;
+      next[symbol] = 1;
+    } else {
+      next[symbol] = counts[symbol];
+    }
+  }
+
+  uint32_t mask = size - 1;
+  uint32_t step = (size >> 1) + (size >> 3) + 3;
+  uint32_t position = 0;
+  for (int symbol = 0; symbol <= maxSymbol; symbol++) {
+    for (int i = 0; i < counts[symbol]; i++) {
+      table.entries[position].symbol = (uint8_t)symbol;
+      do {
+        position = (position + step) & mask;
+      } while (position > highThreshold);
+    }
+  }
+  if (position != 0) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < size; i++) {
+    FSEEntry& entry = table.entries[i];
+    uint32_t state = next[entry.symbol]++;
+    int bits = accuracyLog - HighBit(state);
+    entry.bits = (uint8_t)bits;
+    entry.newState = (uint16_t)((state << bits) - size);
+  }
+  table.accuracyLog = accuracyLog;
+  return true;
+}
+
+bool KRZstdDecoder::readSequenceTable(const uint8_t*& input, const uint8_t* inputEnd, int mode, FSETable& table, bool& tableValid, const int16_t* defaultCounts, int defaultMaxSymbol, int defaultAccuracyLog, int maxSymbol, int maxAccuracyLog)
+{
+  switch (mode) {
+  case 0: // Predefined
+    tableValid = buildFSETable(table, defaultCounts, defaultMaxSymbol, defaultAccuracyLog);
+    return tableValid;
+  case 1: // RLE
+    if (input == inputEnd || *input > maxSymbol) {
+      return false;
+    }
+    table.entries[0].symbol = *input++;
+    table.entries[0].bits = 0;
+    table.entries[0].newState = 0;
+    table.accuracyLog = 0;
+    tableValid = true;
+    return true;
+  case 2: // FSE compressed
+  {
+    int16_t counts[256];
+    int tableMaxSymbol = maxSymbol;
+    int accuracyLog = 0;
+    tableValid = readNormalizedCounts(input, inputEnd, counts, &tableMaxSymbol, &accuracyLog, maxAccuracyLog) && buildFSETable(table, counts, tableMaxSymbol, accuracyLog);
+    return tableValid;
+  }
+  default: // Repeat the table from the previous block
+    return tableValid;
+  }
+}
+
+bool KRZstdDecoder::decodeSequences(const uint8_t* input, const uint8_t* inputEnd, uint8_t*& output, uint8_t* outputEnd, const uint8_t* frameStart)
+{
+  if (input == inputEnd) {
+    return false;
+  }
+  size_t sequenceCount = input[0];
+  if (sequenceCount < 128) {
+    input += 1;
+  } else if (sequenceCount < 255) {
+    if (inputEnd - input < 2) {
+      return false;
+    }
+    sequenceCount = ((sequenceCount - 128) << 8) + input[1];
+    input += 2;
+  } else {
+    if (inputEnd - input < 3) {
+      return false;
+    }
+    sequenceCount = input[1] + (input[2] << 8) + 0x7F00;
+    input += 3;
+  }
+
+  const uint8_t* literal = m_literals.data();
+  const uint8_t* literalEnd = literal + m_literalCount;
+
+  if (sequenceCount > 0) {
+    if (input == inputEnd) {
+      return false;
+    }
+    uint8_t modes = *input++;
+    if ((modes & 3) != 0) {
+      return false;
+    }
+    if (!readSequenceTable(input, inputEnd, modes >> 6, m_literalLengths, m_literalLengthsValid, kDefaultLiteralLengthCounts, 35, 6, 35, 9)
+      || !readSequenceTable(input, inputEnd, (modes >> 4) & 3, m_offsets, m_offsetsValid, kDefaultOffsetCounts, 28, 5, 31, 8)
+      || !readSequenceTable(input, inputEnd, (modes >> 2) & 3, m_matchLengths, m_matchLengthsValid, kDefaultMatchLengthCounts, 52, 6, 52, 9)) {
+      return false;
+    }
+
+    BackwardBitReader bits;
+    if (!bits.init(input, inputEnd - input)) {
+      return false;
+    }
+    uint32_t literalLengthState = (uint32_t)bits.read(m_literalLengths.accuracyLog);
+    uint32_t offsetState = (uint32_t)bits.read(m_offsets.accuracyLog);
+    uint32_t matchLengthState = (uint32_t)bits.read(m_matchLengths.accuracyLog);
+
+    for (size_t sequence = 0; sequence < sequenceCount; sequence++) {
+      const FSEEntry& literalLengthEntry = m_literalLengths.entries[literalLengthState];
+      const FSEEntry& offsetEntry = m_offsets.entries[offsetState];
+      const FSEEntry& matchLengthEntry = m_matchLengths.entries[matchLengthState];
+      if (literalLengthEntry.symbol > 35 || matchLengthEntry.symbol > 52 || offsetEntry.symbol > 31) {
+        return false;
+      }
+
+      uint32_t offsetValue = (1u << offsetEntry.symbol) + (uint32_t)bits.read(offsetEntry.symbol);
+      size_t matchLength = kMatchLengthBase[matchLengthEntry.symbol] + (size_t)bits.read(kMatchLengthBits[matchLengthEntry.symbol]);
+      size_t literalLength = kLiteralLengthBase[literalLengthEntry.symbol] + (size_t)bits.read(kLiteralLengthBits[literalLengthEntry.symbol]);
+
+      uint32_t offset;
+      if (offsetValue > 3) {
+        offset = offsetValue - 3;
+        m_repeatOffsets[2] = m_repeatOffsets[1];
+        m_repeatOffsets[1] = m_repeatOffsets[0];
+        m_repeatOffsets[0] = offset;
+      } else {
+        // Repeat offsets shift by one when there are no literals
+        if (literalLength == 0) {
+          offsetValue++;
+        }
+        if (offsetValue == 1) {
+          offset = m_repeatOffsets[0];
+        } else {
+          offset = offsetValue == 4 ? m_repeatOffsets[0] - 1 : m_repeatOffsets[offsetValue - 1];
+          if (offsetValue != 2) {
+            m_repeatOffsets[2] = m_repeatOffsets[1];
+          }
+          m_repeatOffsets[1] = m_repeatOffsets[0];
+          m_repeatOffsets[0] = offset;
+        }
+      }
+
+      if (sequence + 1 < sequenceCount) {
+        literalLengthState = literalLengthEntry.newState + (uint32_t)bits.read(literalLengthEntry.bits);
+        matchLengthState = matchLengthEntry.newState + (uint32_t)bits.read(matchLengthEntry.bits);
+        offsetState = offsetEntry.newState + (uint32_t)bits.read(offsetEntry.bits);
+      }
+      if (bits.overflowed()) {
+        return false;
+      }
+
+      // Execute the sequence
+      if ((size_t)(literalEnd - literal) < literalLength || (size_t)(outputEnd - output) < literalLength + matchLength) {
+        return false;
+      }
+      memcpy(output, literal, literalLength);
+      literal += literalLength;
+      output += literalLength;
+
+      if (offset == 0 || offset > (size_t)(output - frameStart)) {
+        return false;
+      }
+      const uint8_t* match = output - offset;
+      if (offset >= matchLength) {
+        memcpy(output, match, matchLength);
+        output += matchLength;
+      } else {
+        for (size_t i = 0; i < matchLength; i++) {
+          *output++ = *match++;
+        }
+      }
+    }
+    if (bits.position() != 0) {
+      return false;
+    }
+  }
+
+  // Trailing literals
+  size_t remaining = literalEnd - literal;
+  if ((size_t)(outputEnd - output) < remaining) {
+    return false;
+  }
+  memcpy(output, literal, remaining);
+  output += remaining;
+  return true;
+}
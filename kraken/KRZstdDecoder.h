@@ -0,0 +1,97 @@
+//
+//  KRZstdDecoder.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+
+#pragma once
+
+#include "KREngine-common.h"
+
+// Decoder for Zstandard (RFC 8878) compressed data, used for KTX2 supercompression.
+// Decompresses directly into caller-provided memory, such as a streaming staging buffer.
+// Dictionaries are not supported.
+class KRZstdDecoder
+{
+public:
+  KRZstdDecoder();
+  ~KRZstdDecoder();
+
+  // Decompresses all frames in input.  Returns false if the data is corrupt, requires a
+  // dictionary, or would overflow output.
+  bool decompress(const uint8_t* input, size_t inputLength, uint8_t* output, size_t outputLength, size_t* decompressedLength);
+
+private:
+  static const int kMaxHuffmanBits = 11;
+  static const size_t kMaxBlockSize = 128 * 1024;
+
+  struct FSEEntry
+  {
+    uint16_t newState;
+    uint8_t symbol;
+    uint8_t bits;
+  };
+
+  struct FSETable
+  {
+    FSEEntry entries[512];
+    int accuracyLog;
+  };
+
+  struct HuffmanEntry
+  {
+    uint8_t symbol;
+    uint8_t bits;
+  };
+
+  bool decompressFrame(const uint8_t*& input, const uint8_t* inputEnd, uint8_t*& output, uint8_t* outputEnd);
+  bool decompressBlock(const uint8_t* input, size_t length, uint8_t*& output, uint8_t* outputEnd, const uint8_t* frameStart);
+  bool decodeLiterals(const uint8_t*& input, const uint8_t* inputEnd);
+  bool readHuffmanTable(const uint8_t*& input, const uint8_t* inputEnd);
+  bool decodeHuffmanStream(const uint8_t* input, size_t length, uint8_t* output, size_t count);
+  bool readSequenceTable(const uint8_t*& input, const uint8_t* inputEnd, int mode, FSETable& table, bool& tableValid, const int16_t* defaultCounts, int defaultMaxSymbol, int defaultAccuracyLog, int maxSymbol, int maxAccuracyLog);
+  bool decodeSequences(const uint8_t* input, const uint8_t* inputEnd, uint8_t*& output, uint8_t* outputEnd, const uint8_t* frameStart);
+
+  static bool readNormalizedCounts(const uint8_t*& input, const uint8_t* inputEnd, int16_t* counts, int* maxSymbol, int* accuracyLog, int maxAccuracyLog);
+  static bool buildFSETable(FSETable& table, const int16_t* counts, int maxSymbol, int accuracyLog);
+
+  std::vector<uint8_t> m_literals;
+  size_t m_literalCount;
+
+  HuffmanEntry m_huffman[1 << kMaxHuffmanBits];
+  int m_huffmanBits;
+  bool m_huffmanValid;
+
+  FSETable m_literalLengths;
+  FSETable m_offsets;
+  FSETable m_matchLengths;
+  bool m_literalLengthsValid;
+  bool m_offsetsValid;
+  bool m_matchLengthsValid;
+
+  uint32_t m_repeatOffsets[3];
+};
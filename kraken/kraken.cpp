@@ -97,6 +97,30 @@ KrResult KrLoadResource(const KrLoadResourceInfo* pLoadResourceInfo)
   return sContext->loadResource(pLoadResourceInfo);
 }
 
+KrResult KrLoadResourceAsync(const KrLoadResourceInfo* pLoadResourceInfo, KrCompletionHandle* pCompletionHandle)
+{
+  if (!sContext) {
+    return KR_ERROR_NOT_INITIALIZED;
+  }
+  return sContext->loadResourceAsync(pLoadResourceInfo, pCompletionHandle);
+}
+
+KrResult KrGetCompletionStatus(KrCompletionHandle completionHandle)
+{
+  if (!sContext) {
+    return KR_ERROR_NOT_INITIALIZED;
+  }
+  return sContext->getCompletionStatus(completionHandle, false);
+}
+
+KrResult KrWaitForCompletion(KrCompletionHandle completionHandle)
+{
+  if (!sContext) {
+    return KR_ERROR_NOT_INITIALIZED;
+  }
+  return sContext->getCompletionStatus(completionHandle, true);
+}
+
 KrResult KrUnloadResource(const KrUnloadResourceInfo* pUnloadResourceInfo)
 {
   if (!sContext) {
@@ -162,6 +186,14 @@ KrResult KrCompileAllShaders(const KrCompileAllShadersInfo* pCompileAllShadersIn
   return sContext->compileAllShaders(pCompileAllShadersInfo);
 }
 
+KrResult KrBakeHRTFBank(const KrBakeHRTFBankInfo* pBakeHRTFBankInfo)
+{
+  if (!sContext) {
+    return KR_ERROR_NOT_INITIALIZED;
+  }
+  return sContext->bakeHRTFBank(pBakeHRTFBankInfo);
+}
+
 KrResult KrCreateScene(const KrCreateSceneInfo* pCreateSceneInfo)
 {
   if (!sContext) {
@@ -111,3 +111,45 @@ const Matrix4& KRBone::getBindPose()
 {
   return m_bind_pose;
 }
+
+// out = a * b, with the same row-major layout and summation order as hydra::Matrix4
+static void MultiplyMatrix4(const float* a, const float* b, float* out)
+{
+#if defined(KRAKEN_ARCH_X86_64)
+  __m128 b0 = _mm_loadu_ps(b);
+  __m128 b1 = _mm_loadu_ps(b + 4);
+  __m128 b2 = _mm_loadu_ps(b + 8);
+  __m128 b3 = _mm_loadu_ps(b + 12);
+  for (int i = 0; i < 4; i++) {
+    const float* row = a + i * 4;
+    __m128 r = _mm_mul_ps(_mm_set1_ps(row[0]), b0);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(row[1]), b1));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(row[2]), b2));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(row[3]), b3));
+    _mm_storeu_ps(out + i * 4, r);
+  }
+#else
+  float32x4_t b0 = vld1q_f32(b);
+  float32x4_t b1 = vld1q_f32(b + 4);
+  float32x4_t b2 = vld1q_f32(b + 8);
+  float32x4_t b3 = vld1q_f32(b + 12);
+  for (int i = 0; i < 4; i++) {
+    const float* row = a + i * 4;
+    float32x4_t r = vmulq_n_f32(b0, row[0]);
+    r = vaddq_f32(r, vmulq_n_f32(b1, row[1]));
+    r = vaddq_f32(r, vmulq_n_f32(b2, row[2]));
+    r = vaddq_f32(r, vmulq_n_f32(b3, row[3]));
+    vst1q_f32(out + i * 4, r);
+  }
+#endif
+}
+
+void KRBone::getSkinMatrix(const Matrix4& inverseBindPose, float* out)
+{
+  MultiplyMatrix4(inverseBindPose.c, getActivePoseMatrix().c, out);
+}
+
+size_t KRSkinPalette::getBoneCount() const
+{
+  return matrices.size() / 16;
+}
@@ -36,6 +36,22 @@
 
 class RenderInfo;
 
+// Skinning matrices for the bones of a mesh, in the mesh's bone order.  Built
+// once per frame and shared by every pass and submesh that draws the mesh.
+struct KRSkinPalette
+{
+  std::vector<float> matrices; // 16 floats per bone
+  long frame;
+  int lod;
+  KrDeviceHandle deviceHandle;
+
+  // Location of the matrices in the frame's skin palette storage buffer
+  VkBuffer buffer;
+  VkDeviceSize offset;
+
+  size_t getBoneCount() const;
+};
+
 class KRBone : public KRNode
 {
 public:
@@ -52,6 +68,10 @@ public:
 
   void setBindPose(const hydra::Matrix4& pose);
   const hydra::Matrix4& getBindPose();
+
+  // Writes inverseBindPose multiplied by the active pose to out (16 floats).
+  // The inverse bind pose comes from the skinned mesh's pack_bone entry.
+  void getSkinMatrix(const hydra::Matrix4& inverseBindPose, float* out);
 private:
   hydra::Matrix4 m_bind_pose;
 };
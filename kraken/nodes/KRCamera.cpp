@@ -99,7 +99,7 @@ KRCamera::KRCamera(KRScene& scene, std::string name)
   m_debug_text_vbo_layout.attributes[0] = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::position };
   m_debug_text_vbo_layout.attributes[1] = { ComponentType::float32, DataType::vec2, Normalization::none, VertexAttribute::texcoord };
 
-  m_debug_text_vbo_data.init(m_pContext->getMeshManager(), &m_debug_text_vertices, nullptr, &m_debug_text_vbo_layout, true, KRMeshManager::KRVBOData::IMMEDIATE
+  m_debug_text_vbo_data.init(m_pContext->getMeshManager(), &m_debug_text_vertices, nullptr, IndexFormat::uint16, &m_debug_text_vbo_layout, true, KRMeshManager::KRVBOData::IMMEDIATE
 #if KRENGINE_DEBUG_GPU_LABELS
     , "Debug Text"
 #endif
@@ -175,7 +175,7 @@ void KRCamera::render(KRNode::RenderInfo& ri)
       if (pPipeline && pPipeline->bind(ri, Matrix4())) {
         // Render a full screen quad
         m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &getContext().getMeshManager()->KRENGINE_VBO_DATA_2D_SQUARE_VERTICES, 1.0f);
-        vkCmdDraw(ri.commandBuffer, 4, 1, 0, 0);
+        vkCmdDraw(ri.commandBuffer, 4, 1, getContext().getMeshManager()->KRENGINE_VBO_DATA_2D_SQUARE_VERTICES.getBaseVertex(), 0);
       }
 
       GL_POP_GROUP_MARKER;
@@ -633,7 +633,7 @@ void KRCamera::renderDebug(RenderInfo& ri)
     
     m_debug_text_vbo_data.bind(ri.commandBuffer);
     
-    vkCmdDraw(ri.commandBuffer, vertex_count, 1, 0, 0);
+    vkCmdDraw(ri.commandBuffer, vertex_count, 1, m_debug_text_vbo_data.getBaseVertex(), 0);
   }
 
   m_debug_text_vertices.unlock();
@@ -177,6 +177,13 @@ bool KRCollider::sphereCast(const Vector3& v0, const Vector3& v1, float radius,
   return false;
 }
 
+void KRCollider::prepareForCasts()
+{
+  loadModel();
+  getModelMatrix();
+  getInverseModelMatrix();
+}
+
 unsigned int KRCollider::getLayerMask()
 {
   return m_layer_mask;
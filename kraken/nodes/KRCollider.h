@@ -65,6 +65,9 @@ public:
   bool rayCast(const hydra::Vector3& v0, const hydra::Vector3& v1, hydra::HitInfo& hitinfo, unsigned int layer_mask);
   bool sphereCast(const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo, unsigned int layer_mask);
 
+  // Resolves lazily evaluated state so that casts may be run from multiple threads
+  void prepareForCasts();
+
   unsigned int getLayerMask();
   void setLayerMask(unsigned int layer_mask);
 
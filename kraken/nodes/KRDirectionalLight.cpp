@@ -165,7 +165,7 @@ void KRDirectionalLight::render(RenderInfo& ri)
     if (pShader && pShader->bind(ri, getModelMatrix())) { // TODO: Need to pass in the light index to the shader
       // Render a full screen quad
       m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &vertices, 1.0f);
-      vkCmdDraw(ri.commandBuffer, 4, 1, 0, 0);
+      vkCmdDraw(ri.commandBuffer, 4, 1, vertices.getBaseVertex(), 0);
     }
   }
 
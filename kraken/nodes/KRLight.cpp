@@ -242,7 +242,7 @@ void KRLight::render(RenderInfo& ri)
         KRPipeline* pParticleShader = m_pContext->getPipelineManager()->getPipeline(*ri.surface, info);
         if (pParticleShader && pParticleShader->bind(ri, getParticleModelMatrix(*ri.viewport))) { // TODO: Pass light index to shader
           m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &m_pContext->getMeshManager()->KRENGINE_VBO_DATA_RANDOM_PARTICLES, 1.0f);
-          vkCmdDraw(ri.commandBuffer, getParticleCount() *3, 1, 0, 0);
+          vkCmdDraw(ri.commandBuffer, getParticleCount() *3, 1, m_pContext->getMeshManager()->KRENGINE_VBO_DATA_RANDOM_PARTICLES.getBaseVertex(), 0);
         }
       }
     }
@@ -283,7 +283,7 @@ void KRLight::render(RenderInfo& ri)
     if (pFogShader) {
       if (pFogShader->bind(ri, Matrix4())) { // TODO: Pass indexes of lights to shader
         m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &m_pContext->getMeshManager()->KRENGINE_VBO_DATA_VOLUMETRIC_LIGHTING, 1.0f);
-        vkCmdDraw(ri.commandBuffer, getSliceCount(ri.camera) * 6, 1, 0, 0);
+        vkCmdDraw(ri.commandBuffer, getSliceCount(ri.camera) * 6, 1, m_pContext->getMeshManager()->KRENGINE_VBO_DATA_VOLUMETRIC_LIGHTING.getBaseVertex(), 0);
       }
     }
 
@@ -365,7 +365,7 @@ void KRLight::render(RenderInfo& ri)
           KRPipeline* pShader = getContext().getPipelineManager()->getPipeline(*ri.surface, info);
           if (pShader && pShader->bind(ri, getModelMatrix())) {
             m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &vertices, 1.0f);
-            vkCmdDraw(ri.commandBuffer, 4, 1, 0, 0);
+            vkCmdDraw(ri.commandBuffer, 4, 1, vertices.getBaseVertex(), 0);
           }
         }
       }
@@ -576,6 +576,11 @@ bool KRLight::getShaderValue(const KRCamera* camera, ShaderValue value, hydra::V
   }
 }
 
+bool KRLight::hasConditionalShaderValues() const
+{
+  return true;
+}
+
 bool KRLight::getImageBinding(const std::string& name, const KRTextureBinding** binding, KRSampler** sample) const
 {
   if (name == "flareTexture") {
@@ -73,6 +73,8 @@ public:
   int* getShadowTextures();
   KRViewport* getShadowViewports();
 
+  // slice_depth_scale is only supplied when there is a camera
+  bool hasConditionalShaderValues() const override;
 
 protected:
   KRLight(KRScene& scene, std::string name);
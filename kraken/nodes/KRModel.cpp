@@ -73,6 +73,12 @@ KRModel::KRModel(KRScene& scene, std::string name)
   m_boundsCachedMat.c[13] = -1.0f;
   m_boundsCachedMat.c[14] = -1.0f;
   m_boundsCachedMat.c[15] = -1.0f;
+
+  m_skinPalette.frame = -1;
+  m_skinPalette.lod = -1;
+  m_skinPalette.deviceHandle = 0;
+  m_skinPalette.buffer = VK_NULL_HANDLE;
+  m_skinPalette.offset = 0;
 }
 
 KRModel::~KRModel()
@@ -187,6 +193,12 @@ std::string KRModel::getLightMap()
   return m_lightMap.val.getName();
 }
 
+void KRModel::setMesh(const std::string& name, int lod)
+{
+  assert(lod >= 0 && lod < kMeshLODCount);
+  m_meshes[lod].val.set(name);
+}
+
 void KRModel::loadModel()
 {
   bool meshChanged = false;
@@ -282,12 +294,45 @@ void KRModel::render(KRNode::RenderInfo& ri)
           matModel = Quaternion::Create(Vector3::Forward(), Vector3::Normalize(camera_pos - model_center)).rotationMatrix() * matModel;
         }
 
-        pModel->render(ri, getName(), matModel, m_lightMap.val.get(), m_bones[bestLOD], lod_coverage);
+        pModel->render(ri, getName(), matModel, m_lightMap.val.get(), getSkinPalette(ri, bestLOD), lod_coverage);
       }
     }
   }
 }
 
+const KRSkinPalette* KRModel::getSkinPalette(KRNode::RenderInfo& ri, int lod)
+{
+  const std::vector<KRBone*>& bones = m_bones[lod];
+  if (bones.empty()) {
+    return nullptr;
+  }
+
+  long frame = getContext().getCurrentFrame();
+  if (m_skinPalette.frame != frame || m_skinPalette.lod != lod || m_skinPalette.deviceHandle != ri.surface->m_deviceHandle) {
+    m_skinPalette.frame = frame;
+    m_skinPalette.lod = lod;
+    m_skinPalette.deviceHandle = ri.surface->m_deviceHandle;
+    KRMesh* mesh = m_meshes[lod].val.get();
+    m_skinPalette.matrices.resize(bones.size() * 16);
+    float* matrix = m_skinPalette.matrices.data();
+    for (int bone_index = 0; bone_index < (int)bones.size(); bone_index++) {
+      bones[bone_index]->getSkinMatrix(mesh->getBoneInverseBindPose(bone_index), matrix);
+      matrix += 16;
+    }
+
+    std::unique_ptr<KRDevice>& device = getContext().getDeviceManager()->getDevice(ri.surface->m_deviceHandle);
+    if (!device->uploadSkinPalette(m_skinPalette.matrices.data(), bones.size(), &m_skinPalette.buffer, &m_skinPalette.offset)) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Skin palette buffer is full, drawing %s without skinning.", getName().c_str());
+      m_skinPalette.buffer = VK_NULL_HANDLE;
+    }
+  }
+
+  if (m_skinPalette.buffer == VK_NULL_HANDLE) {
+    return nullptr;
+  }
+  return &m_skinPalette;
+}
+
 void KRModel::getResourceBindings(std::list<KRResourceBinding*>& bindings)
 {
   KRNode::getResourceBindings(bindings);
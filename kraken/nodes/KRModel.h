@@ -76,6 +76,8 @@ public:
   void setLightMap(const std::string& name);
   std::string getLightMap();
 
+  void setMesh(const std::string& name, int lod = 0);
+
   virtual kraken_stream_level getStreamLevel(const KRViewport& viewport) override;
 
 private:
@@ -89,10 +91,12 @@ private:
   KRNODE_PROPERTY(hydra::Vector3, m_rim_color, hydra::Vector3({ 0.f, 0.f, 0.f }), "rim_color");
 
   std::array<std::vector<KRBone*>, kMeshLODCount> m_bones; // Connects model to set of bones
+  KRSkinPalette m_skinPalette;
   hydra::Matrix4 m_boundsCachedMat;
   hydra::AABB m_boundsCached;
 
   void loadModel();
+  const KRSkinPalette* getSkinPalette(KRNode::RenderInfo& ri, int lod);
   
 
 private:
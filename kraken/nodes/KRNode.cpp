@@ -121,6 +121,7 @@ KRNode::KRNode(KRScene& scene, std::string name) : KRContextObject(scene.getCont
   m_lastChildNode = nullptr;
 
   m_pScene = &scene;
+  scene.indexNode(this);
   m_modelMatrixValid = false;
   m_inverseModelMatrixValid = false;
   m_bindPoseMatrixValid = false;
@@ -179,6 +180,7 @@ KRNode::~KRNode()
   m_behaviors.clear();
 
   getScene().notify_sceneGraphDelete(this);
+  getScene().unindexNode(this);
 }
 
 void KRNode::setScaleCompensation(bool scale_compensation)
@@ -343,7 +345,11 @@ KrResult KRNode::createNode(const KrCreateNodeInfo* pCreateNodeInfo, KRScene* sc
 
 void KRNode::loadXML(tinyxml2::XMLElement* e)
 {
+  std::string previous_name = m_name;
   m_name = e->Attribute("name");
+  if (m_name != previous_name) {
+    getScene().notify_sceneGraphRename(this, previous_name);
+  }
   m_localTranslation.load(e);
   m_localScale = kraken::getXMLAttribute("scale", e, Vector3::One());
   m_localRotation.load(e);
@@ -693,6 +699,26 @@ const std::string& KRNode::getName() const
   return m_name;
 }
 
+bool KRNode::isInSubtree(const KRNode* root) const
+{
+  for (const KRNode* node = this; node != nullptr; node = node->m_parentNode) {
+    if (node == root) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const std::vector<KRNode*>& KRNode::getSceneNodesByName(const std::string& name)
+{
+  return getScene().getNodesByName(name);
+}
+
+const KRNodeTypeIndex& KRNode::getSceneNodesByType()
+{
+  return getScene().getNodesByType();
+}
+
 KRScene& KRNode::getScene()
 {
   return *m_pScene;
@@ -1087,23 +1113,9 @@ bool KRNode::getAnimationEnabled(node_attribute_type attrib) const
   return !m_animation_mask[attrib];
 }
 
-void KRNode::removeFromOctreeNodes()
+std::set<KROctreeNode*>& KRNode::getOctreeNodes()
 {
-  for (std::set<KROctreeNode*>::iterator itr = m_octree_nodes.begin(); itr != m_octree_nodes.end(); itr++) {
-    KROctreeNode* octree_node = *itr;
-    octree_node->remove(this);
-
-    // FINDME, TODO - This should be moved to the KROctree class
-    while (octree_node) {
-      octree_node->trim();
-      if (octree_node->isEmpty()) {
-        octree_node = octree_node->getParent();
-      } else {
-        octree_node = NULL;
-      }
-    }
-  }
-  m_octree_nodes.clear();
+  return m_octree_nodes;
 }
 
 void KRNode::addToOctreeNode(KROctreeNode* octree_node)
@@ -40,6 +40,8 @@
 #include "KRShaderReflection.h"
 #include "KRNodeProperty.h"
 #include <type_traits>
+#include <typeindex>
+#include <unordered_set>
 
 using namespace kraken;
 
@@ -59,6 +61,8 @@ class KRSurface;
 class KRResourceBinding;
 
 class KRNode;
+// Nodes grouped by their dynamic type, as maintained by KRScene
+typedef std::unordered_map<std::type_index, std::unordered_set<KRNode*>> KRNodeTypeIndex;
 class KRPointLight;
 class KRSpotLight;
 class KRDirectionalLight;
@@ -336,11 +340,56 @@ public:
     }
     return NULL;
   }
-  void removeFromOctreeNodes();
+  std::set<KROctreeNode*>& getOctreeNodes();
   void addToOctreeNode(KROctreeNode* octree_node);
   void childRemoved(KRNode* child_node);
 
   template <class T> T* find()
+  {
+    // Candidates come from the scene's type index.  When several nodes in this
+    // subtree match, search it so that the first in depth-first order is returned.
+    T* match = NULL;
+    for (auto& bucket : getSceneNodesByType()) {
+      // All nodes in a bucket share a dynamic type, so one cast rejects the whole bucket
+      if (bucket.second.empty() || dynamic_cast<T*>(*bucket.second.begin()) == NULL) {
+        continue;
+      }
+      for (KRNode* node : bucket.second) {
+        if (node->isInSubtree(this)) {
+          if (match) {
+            return searchSubtree<T>();
+          }
+          match = dynamic_cast<T*>(node);
+        }
+      }
+    }
+    return match;
+  }
+
+  template <class T> T* find(const std::string& name)
+  {
+    // Candidates come from the scene's name index.  When several nodes in this
+    // subtree match, search it so that the first in depth-first order is returned.
+    T* match = NULL;
+    for (KRNode* node : getSceneNodesByName(name)) {
+      T* candidate = dynamic_cast<T*>(node);
+      if (candidate && node->isInSubtree(this)) {
+        if (match) {
+          return searchSubtree<T>(name);
+        }
+        match = candidate;
+      }
+    }
+    return match;
+  }
+
+  bool isInSubtree(const KRNode* root) const;
+
+private:
+  const std::vector<KRNode*>& getSceneNodesByName(const std::string& name);
+  const KRNodeTypeIndex& getSceneNodesByType();
+
+  template <class T> T* searchSubtree()
   {
     T* match = dynamic_cast<T*>(this);
     if (match) {
@@ -348,7 +397,7 @@ public:
     }
 
     for (KRNode* child = m_firstChildNode; child != nullptr; child = child->m_nextNode) {
-      match = child->find<T>();
+      match = child->searchSubtree<T>();
       if (match) {
         return match;
       }
@@ -357,9 +406,8 @@ public:
     return NULL;
   }
 
-  template <class T> T* find(const std::string& name)
+  template <class T> T* searchSubtree(const std::string& name)
   {
-    // TODO - KRScene should maintain a global node-name map for rapid searching
     T* match = dynamic_cast<T*>(this);
     if (match) {
       if (name.compare(match->getName()) == 0) {
@@ -368,7 +416,7 @@ public:
     }
 
     for (KRNode* child = m_firstChildNode; child != nullptr; child = child->m_nextNode) {
-      match = child->find<T>(name);
+      match = child->searchSubtree<T>(name);
       if (match) {
         return match;
       }
@@ -104,7 +104,7 @@ void KRParticleSystemNewtonian::render(RenderInfo& ri)
       if (pParticleShader && pParticleShader->bind(ri, getModelMatrix())) {
         m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &m_pContext->getMeshManager()->KRENGINE_VBO_DATA_RANDOM_PARTICLES, 1.0f);
         
-        vkCmdDraw(ri.commandBuffer, particle_count * 3, 1, 0, 0);
+        vkCmdDraw(ri.commandBuffer, particle_count * 3, 1, m_pContext->getMeshManager()->KRENGINE_VBO_DATA_RANDOM_PARTICLES.getBaseVertex(), 0);
       }
     }
   }
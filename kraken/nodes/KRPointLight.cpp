@@ -127,7 +127,7 @@ void KRPointLight::render(RenderInfo& ri)
         if (bInsideLight) {
           // Render a full screen quad
           m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &m_pContext->getMeshManager()->KRENGINE_VBO_DATA_2D_SQUARE_VERTICES, 1.0f);
-          vkCmdDraw(ri.commandBuffer, 4, 1, 0, 0);
+          vkCmdDraw(ri.commandBuffer, 4, 1, m_pContext->getMeshManager()->KRENGINE_VBO_DATA_2D_SQUARE_VERTICES.getBaseVertex(), 0);
         } else {
           // Render sphere of light's influence
           generateMesh();
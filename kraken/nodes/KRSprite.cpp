@@ -137,7 +137,7 @@ void KRSprite::render(RenderInfo& ri)
       KRPipeline* pShader = getContext().getPipelineManager()->getPipeline(*ri.surface, info);
       if (pShader && pShader->bind(ri, getModelMatrix())) {
         m_pContext->getMeshManager()->bindVBO(ri.commandBuffer, &vertices, 1.0f);
-        vkCmdDraw(ri.commandBuffer, 4, 1, 0, 0);
+        vkCmdDraw(ri.commandBuffer, 4, 1, vertices.getBaseVertex(), 0);
       }
     }
   }
@@ -54,6 +54,7 @@ typedef enum
   KR_ERROR_VULKAN_DEPTHBUFFER,
   KR_ERROR_NO_DEVICE,
   KR_ERROR_SHADER_COMPILE_FAILED,
+  KR_NOT_READY,
   KR_ERROR_UNEXPECTED = 0x10000000,
   KR_RESULT_MAX_ENUM = 0x7FFFFFFF
 } KrResult;
@@ -76,6 +77,7 @@ typedef enum
   KR_STRUCTURE_TYPE_MOVE_TO_BUNDLE,
 
   KR_STRUCTURE_TYPE_COMPILE_ALL_SHADERS,
+  KR_STRUCTURE_TYPE_BAKE_HRTF_BANK,
 
   KR_STRUCTURE_TYPE_CREATE_SCENE = 0x00020000,
 
@@ -117,15 +119,26 @@ typedef enum
   KR_SCENE_NODE_INSERT_MAX_ENUM
 } KrSceneNodeInsertLocation;
 
+typedef enum
+{
+  KR_SPATIAL_INDEX_OCTREE = 0,
+  KR_SPATIAL_INDEX_LINEAR_OCTREE,
+  KR_SPATIAL_INDEX_MAX_ENUM = 0x7FFFFFFF
+} KrSpatialIndex;
+
 typedef int KrResourceMapIndex;
 typedef int KrSceneNodeMapIndex;
 typedef int KrSurfaceMapIndex;
+typedef uint64_t KrCompletionHandle;
 
 typedef struct
 {
   KrStructureType sType;
   size_t resourceMapSize;
   size_t nodeMapSize;
+  const char* pPipelineCacheDirectory; // Optional. Compiled pipelines are persisted here between runs.
+  uint32_t vertexCacheSize; // Optional. Post-transform vertex cache size that imported meshes are optimized for.  Defaults to 16.
+  KrSpatialIndex spatialIndex; // Optional. Spatial index used by scenes.  Defaults to KR_SPATIAL_INDEX_OCTREE.
 } KrInitializeInfo;
 
 typedef struct
@@ -210,6 +223,12 @@ typedef struct
   KrResourceMapIndex logHandle;
 } KrCompileAllShadersInfo;
 
+typedef struct
+{
+  KrStructureType sType;
+  KrResourceMapIndex bundleHandle;
+} KrBakeHRTFBankInfo;
+
 typedef struct
 {
   KrStructureType sType;
@@ -432,6 +451,9 @@ KrResult KrCreateWindowSurface(const KrCreateWindowSurfaceInfo* pCreateWindowSur
 KrResult KrDeleteWindowSurface(const KrDeleteWindowSurfaceInfo* pDeleteWindowSurfaceInfo);
 
 KrResult KrLoadResource(const KrLoadResourceInfo* pLoadResourceInfo);
+KrResult KrLoadResourceAsync(const KrLoadResourceInfo* pLoadResourceInfo, KrCompletionHandle* pCompletionHandle);
+KrResult KrGetCompletionStatus(KrCompletionHandle completionHandle);
+KrResult KrWaitForCompletion(KrCompletionHandle completionHandle);
 KrResult KrUnloadResource(const KrUnloadResourceInfo* pUnloadResourceInfo);
 KrResult KrGetResourceData(const KrGetResourceDataInfo* pGetResourceDataInfo, KrGetResourceDataCallback callback);
 KrResult KrSaveResource(const KrSaveResourceInfo* pSaveResourceInfo);
@@ -442,6 +464,7 @@ KrResult KrMoveToBundle(const KrMoveToBundleInfo* pMoveToBundleInfo);
 KrResult KrInitNodeInfo(KrNodeInfo* pNodeInfo, KrStructureType nodeType);
 
 KrResult KrCompileAllShaders(const KrCompileAllShadersInfo* pCompileAllShadersInfo);
+KrResult KrBakeHRTFBank(const KrBakeHRTFBankInfo* pBakeHRTFBankInfo);
 
 KrResult KrCreateScene(const KrCreateSceneInfo* pCreateSceneInfo);
 KrResult KrFindNodeByName(const KrFindNodeByNameInfo* pFindNodeByNameInfo);
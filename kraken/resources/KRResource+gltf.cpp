@@ -32,12 +32,21 @@
 #include "KREngine-common.h"
 
 #include "KRResource.h"
+#include "KRWorkerPool.h"
 #include "bundle/KRBundle.h"
+#include "resources/mesh/KRMesh.h"
+#include "resources/animation/KRAnimation.h"
+#include "resources/animation/KRAnimationManager.h"
+#include "resources/animation_curve/KRAnimationCurveManager.h"
 #include "scene/KRScene.h"
+#include "nodes/KRBone.h"
+#include "nodes/KRModel.h"
 
 #include "mimir.h"
 
+#include <charconv>
 #include <format>
+#include <functional>
 
 using namespace mimir;
 using namespace hydra;
@@ -45,7 +54,1874 @@ using namespace hydra;
 #include "simdjson.h"
 using namespace simdjson;
 
-KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std::vector<Block>& buffers, const std::string& baseName)
+namespace {
+
+const uint32_t kGlbMagic = 0x46546C67; // "glTF"
+const uint32_t kGlbChunkJson = 0x4E4F534A; // "JSON"
+const uint32_t kGlbChunkBin = 0x004E4942; // "BIN"
+
+// Vertexes and indexes decoded by each job when a primitive is split across the worker pool
+const size_t kDecodeChunkSize = 0x10000;
+
+enum GltfComponentType
+{
+  GLTF_BYTE = 5120,
+  GLTF_UNSIGNED_BYTE = 5121,
+  GLTF_SHORT = 5122,
+  GLTF_UNSIGNED_SHORT = 5123,
+  GLTF_UNSIGNED_INT = 5125,
+  GLTF_FLOAT = 5126
+};
+
+struct BufferViewInfo
+{
+  int buffer = -1;
+  size_t byteOffset = 0;
+  size_t byteLength = 0;
+  size_t byteStride = 0;
+};
+
+struct AccessorInfo
+{
+  int bufferView = -1;
+  size_t byteOffset = 0;
+  int componentType = 0;
+  int componentCount = 0;
+  bool normalized = false;
+  size_t count = 0;
+
+  bool hasBounds = false;
+  float min[4] = {};
+  float max[4] = {};
+
+  size_t sparseCount = 0;
+  int sparseIndicesView = -1;
+  size_t sparseIndicesOffset = 0;
+  int sparseIndicesComponentType = 0;
+  int sparseValuesView = -1;
+  size_t sparseValuesOffset = 0;
+};
+
+// A strided run of accessor elements within a locked buffer.  A stream without a start
+// reads as zero, as required for sparse accessors without a bufferView.
+struct ElementStream
+{
+  const unsigned char* start = nullptr;
+  size_t stride = 0;
+  int componentType = GLTF_FLOAT;
+  int componentCount = 0;
+  bool normalized = false;
+};
+
+struct GltfPrimitive
+{
+  int mode = 4; // TRIANGLES
+  int material = -1;
+  int indices = -1;
+  int position = -1;
+  int normal = -1;
+  int tangent = -1;
+  int texcoord[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+  int color[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+  int joints = -1;
+  int weights = -1;
+};
+
+struct GltfMesh
+{
+  std::string name;
+  std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfSkin
+{
+  std::vector<int> joints;
+  int inverseBindMatrices = -1;
+};
+
+struct GltfNode
+{
+  std::string name;
+  int mesh = -1;
+  int skin = -1;
+  int parent = -1;
+  std::vector<int> children;
+  hydra::Vector3 translation{ 0.f, 0.f, 0.f };
+  hydra::Vector4 rotation{ 0.f, 0.f, 0.f, 1.f };
+  hydra::Vector3 scale{ 1.f, 1.f, 1.f };
+  bool hasMatrix = false;
+  float matrix[16] = {};
+  bool created = false;
+};
+
+// A mesh whose pack has been allocated and is waiting for its decode jobs to complete
+struct PendingMesh
+{
+  struct Attribute
+  {
+    int accessor;
+    unsigned char* dest; // The attribute of the first vertex
+    size_t vertexCount;
+    VertexAttributeInfo info;
+  };
+
+  // A triangle primitive without normals.  Its vertexes are decoded here, then expanded to
+  // one vertex per triangle corner with flat normals and tangents by finish().
+  struct FlatPrimitive
+  {
+    int mode;
+    ElementStream indexes; // start is null when the primitive is not indexed
+    size_t vertexCount;
+    size_t triangleCount;
+    size_t firstVertex; // Of the expanded vertexes in the pack
+    std::vector<unsigned char> vertexes;
+  };
+
+  KRMesh* mesh = nullptr;
+  KRMesh::PackData pack = {};
+  int vertexSize = 0;
+  int64_t vertexCount = 0;
+  int normalOffset = -1;
+  int tangentOffset = -1;
+  int texcoordOffset = -1;
+  std::vector<Attribute> attributes;
+  std::vector<FlatPrimitive> flatPrimitives;
+  hydra::AABB extents;
+  bool hasExtents = false;
+};
+
+enum GltfInterpolation
+{
+  GLTF_INTERPOLATION_LINEAR,
+  GLTF_INTERPOLATION_STEP,
+  GLTF_INTERPOLATION_CUBICSPLINE
+};
+
+enum GltfAnimationPath
+{
+  GLTF_PATH_TRANSLATION,
+  GLTF_PATH_ROTATION,
+  GLTF_PATH_SCALE
+};
+
+struct GltfAnimationSampler
+{
+  int input = -1;
+  int output = -1;
+  GltfInterpolation interpolation = GLTF_INTERPOLATION_LINEAR;
+
+  bool valid = false;
+  int componentCount = 0;
+  std::vector<float> times;
+  std::vector<float> values;
+};
+
+struct GltfAnimationChannel
+{
+  int sampler = -1;
+  int node = -1;
+  GltfAnimationPath path = GLTF_PATH_TRANSLATION;
+
+  // Resampled x, y and z curves, stored one after another
+  bool valid = false;
+  int frameStart = 0;
+  int frameCount = 0;
+  std::vector<float> frames;
+};
+
+struct GltfAnimation
+{
+  std::string name;
+  std::vector<GltfAnimationSampler> samplers;
+  std::vector<GltfAnimationChannel> channels;
+};
+
+size_t GetComponentSize(int componentType)
+{
+  switch (componentType) {
+  case GLTF_BYTE:
+  case GLTF_UNSIGNED_BYTE:
+    return 1;
+  case GLTF_SHORT:
+  case GLTF_UNSIGNED_SHORT:
+    return 2;
+  case GLTF_UNSIGNED_INT:
+  case GLTF_FLOAT:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+int GetTypeComponentCount(std::string_view type)
+{
+  if (type == "SCALAR") {
+    return 1;
+  } else if (type == "VEC2") {
+    return 2;
+  } else if (type == "VEC3") {
+    return 3;
+  } else if (type == "VEC4" || type == "MAT2") {
+    return 4;
+  } else if (type == "MAT3") {
+    return 9;
+  } else if (type == "MAT4") {
+    return 16;
+  }
+  return 0;
+}
+
+float ReadComponent(const unsigned char* p, int componentType, bool normalized)
+{
+  switch (componentType) {
+  case GLTF_BYTE:
+  {
+    int8_t v;
+    memcpy(&v, p, sizeof(v));
+    return normalized ? std::max(v / 127.f, -1.f) : (float)v;
+  }
+  case GLTF_UNSIGNED_BYTE:
+  {
+    uint8_t v;
+    memcpy(&v, p, sizeof(v));
+    return normalized ? v / 255.f : (float)v;
+  }
+  case GLTF_SHORT:
+  {
+    int16_t v;
+    memcpy(&v, p, sizeof(v));
+    return normalized ? std::max(v / 32767.f, -1.f) : (float)v;
+  }
+  case GLTF_UNSIGNED_SHORT:
+  {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return normalized ? v / 65535.f : (float)v;
+  }
+  case GLTF_UNSIGNED_INT:
+  {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (float)v;
+  }
+  case GLTF_FLOAT:
+  {
+    float v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  default:
+    return 0.f;
+  }
+}
+
+uint32_t ReadIndex(const unsigned char* p, int componentType)
+{
+  switch (componentType) {
+  case GLTF_UNSIGNED_BYTE:
+    return *p;
+  case GLTF_UNSIGNED_SHORT:
+  {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  case GLTF_UNSIGNED_INT:
+  {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  default:
+    return 0;
+  }
+}
+
+void WriteAttribute(const VertexAttributeInfo& info, unsigned char* dest, const float* value)
+{
+  int componentCount = DataTypeComponentCount[(int)info.type];
+  switch (info.component) {
+  case ComponentType::float32:
+    memcpy(dest, value, componentCount * sizeof(float));
+    break;
+  case ComponentType::uint8:
+    for (int i = 0; i < componentCount; i++) {
+      if (info.normalization == Normalization::normalized) {
+        dest[i] = (uint8_t)std::lround(std::clamp(value[i], 0.f, 1.f) * 255.f);
+      } else {
+        dest[i] = (uint8_t)value[i];
+      }
+    }
+    break;
+  case ComponentType::uint16:
+    for (int i = 0; i < componentCount; i++) {
+      uint16_t v = (uint16_t)value[i];
+      memcpy(dest + i * sizeof(uint16_t), &v, sizeof(v));
+    }
+    break;
+  default:
+    assert(false); // Not used by the glTF importer
+    break;
+  }
+}
+
+// Decodes elements [first, first + count) of a stream into a vertex attribute.  Float
+// sources that match the destination are copied directly.
+void DecodeAttribute(const ElementStream& src, size_t first, size_t count, unsigned char* dest, size_t destStride, const VertexAttributeInfo& info)
+{
+  int destComponents = DataTypeComponentCount[(int)info.type];
+  if (src.start && src.componentType == GLTF_FLOAT && info.component == ComponentType::float32 && src.componentCount >= destComponents) {
+    const unsigned char* p = src.start + first * src.stride;
+    size_t size = destComponents * sizeof(float);
+    for (size_t i = 0; i < count; i++) {
+      memcpy(dest, p, size);
+      p += src.stride;
+      dest += destStride;
+    }
+    return;
+  }
+
+  size_t componentSize = GetComponentSize(src.componentType);
+  int srcComponents = std::min(src.componentCount, destComponents);
+  for (size_t i = 0; i < count; i++) {
+    // Colors without an alpha channel are opaque, and missing colors are white
+    float value[4] = { 0.f, 0.f, 0.f, 0.f };
+    if (info.attribute == VertexAttribute::color) {
+      value[3] = 1.f;
+      if (!src.start) {
+        value[0] = value[1] = value[2] = 1.f;
+      }
+    }
+    if (src.start) {
+      const unsigned char* p = src.start + (first + i) * src.stride;
+      for (int c = 0; c < srcComponents; c++) {
+        value[c] = ReadComponent(p + c * componentSize, src.componentType, src.normalized);
+      }
+    }
+    WriteAttribute(info, dest, value);
+    dest += destStride;
+  }
+}
+
+// Returns the number of triangles drawn by count indexes of a TRIANGLES, TRIANGLE_STRIP or
+// TRIANGLE_FAN primitive
+size_t GetTriangleCount(int mode, size_t count)
+{
+  if (mode == 4) {
+    return count / 3;
+  }
+  return count >= 3 ? count - 2 : 0;
+}
+
+// Expands a primitive without normals to a triangle list in the pack.  Each triangle gets
+// its own vertexes so that they can carry its face normal, as glTF requires when NORMAL is
+// missing.  Any tangents in the source are ignored in that case and replaced as well.
+void ExpandFlatPrimitive(const PendingMesh& pending, const PendingMesh::FlatPrimitive& flat, size_t* invalidIndexes)
+{
+  int vertexSize = pending.vertexSize;
+  auto sourceVertex = [&](size_t i) {
+    size_t index = i;
+    if (flat.indexes.start) {
+      index = ReadIndex(flat.indexes.start + i * flat.indexes.stride, flat.indexes.componentType);
+    }
+    if (index >= flat.vertexCount) {
+      index = 0;
+      (*invalidIndexes)++;
+    }
+    return flat.vertexes.data() + index * vertexSize;
+  };
+
+  unsigned char* dest = pending.pack.vertexes + flat.firstVertex * vertexSize;
+  for (size_t triangle = 0; triangle < flat.triangleCount; triangle++) {
+    // Corner order from the glTF specification, which keeps the winding of every triangle
+    size_t corners[3];
+    if (flat.mode == 5) { // TRIANGLE_STRIP
+      corners[0] = triangle;
+      corners[1] = triangle + 1 + (triangle % 2);
+      corners[2] = triangle + 2 - (triangle % 2);
+    } else if (flat.mode == 6) { // TRIANGLE_FAN
+      corners[0] = triangle + 1;
+      corners[1] = triangle + 2;
+      corners[2] = 0;
+    } else {
+      corners[0] = triangle * 3;
+      corners[1] = triangle * 3 + 1;
+      corners[2] = triangle * 3 + 2;
+    }
+
+    unsigned char* vertexes[3];
+    Vector3 p[3];
+    for (int i = 0; i < 3; i++) {
+      vertexes[i] = dest + (triangle * 3 + i) * vertexSize;
+      memcpy(vertexes[i], sourceVertex(corners[i]), vertexSize);
+      // The position is always the first attribute
+      float position[3];
+      memcpy(position, vertexes[i], sizeof(position));
+      p[i] = Vector3::Create(position[0], position[1], position[2]);
+    }
+    Vector3 v1 = p[1] - p[0];
+    Vector3 v2 = p[2] - p[0];
+
+    Vector3 normal = Vector3::Cross(v1, v2);
+    if (normal.sqrMagnitude() > 0.0f) {
+      normal.normalize();
+    }
+    float n[3] = { normal.x, normal.y, normal.z };
+    for (int i = 0; i < 3; i++) {
+      memcpy(vertexes[i] + pending.normalOffset, n, sizeof(n));
+    }
+
+    if (pending.tangentOffset < 0) {
+      continue;
+    }
+    // Tangents follow the first texture coordinate set, as in KRMesh::LoadData
+    Vector3 tangent = Vector3::Zero();
+    if (pending.texcoordOffset >= 0) {
+      float uv[3][2];
+      for (int i = 0; i < 3; i++) {
+        memcpy(uv[i], vertexes[i] + pending.texcoordOffset, sizeof(uv[i]));
+      }
+      Vector2 st1 = Vector2::Create(uv[1][0] - uv[0][0], uv[1][1] - uv[0][1]);
+      Vector2 st2 = Vector2::Create(uv[2][0] - uv[0][0], uv[2][1] - uv[0][1]);
+      float determinant = st1.x * st2.y - st2.x * st1.y;
+      if (determinant != 0.0f) {
+        float coef = 1.0f / determinant;
+        tangent = Vector3::Create(
+          coef * ((v1.x * st2.y) + (v2.x * -st1.y)),
+          coef * ((v1.y * st2.y) + (v2.y * -st1.y)),
+          coef * ((v1.z * st2.y) + (v2.z * -st1.y)));
+        tangent = tangent - normal * Vector3::Dot(normal, tangent);
+      }
+    }
+    if (!(tangent.sqrMagnitude() > 0.0f)) {
+      // Without usable texture coordinates, any direction in the plane of the face will do
+      tangent = Vector3::Cross(normal, fabsf(normal.x) < 0.9f ? Vector3::Create(1.0f, 0.0f, 0.0f) : Vector3::Create(0.0f, 1.0f, 0.0f));
+    }
+    if (tangent.sqrMagnitude() > 0.0f) {
+      tangent.normalize();
+    }
+    float t[3] = { tangent.x, tangent.y, tangent.z };
+    for (int i = 0; i < 3; i++) {
+      memcpy(vertexes[i] + pending.tangentOffset, t, sizeof(t));
+    }
+  }
+}
+
+bool DecodeBase64(std::string_view text, Block& data)
+{
+  std::vector<unsigned char> decoded;
+  decoded.reserve(text.size() / 4 * 3);
+  uint32_t bits = 0;
+  int bitCount = 0;
+  for (char ch : text) {
+    int value;
+    if (ch >= 'A' && ch <= 'Z') {
+      value = ch - 'A';
+    } else if (ch >= 'a' && ch <= 'z') {
+      value = ch - 'a' + 26;
+    } else if (ch >= '0' && ch <= '9') {
+      value = ch - '0' + 52;
+    } else if (ch == '+') {
+      value = 62;
+    } else if (ch == '/') {
+      value = 63;
+    } else if (ch == '=') {
+      break;
+    } else {
+      return false;
+    }
+    bits = (bits << 6) | value;
+    bitCount += 6;
+    if (bitCount >= 8) {
+      bitCount -= 8;
+      decoded.push_back((unsigned char)(bits >> bitCount));
+    }
+  }
+  data.append(decoded.data(), decoded.size());
+  return true;
+}
+
+std::string DecodeUri(std::string_view uri)
+{
+  std::string path;
+  path.reserve(uri.size());
+  for (size_t i = 0; i < uri.size(); i++) {
+    if (uri[i] == '%' && i + 2 < uri.size() && isxdigit(uri[i + 1]) && isxdigit(uri[i + 2])) {
+      path.push_back((char)std::stoi(std::string(uri.substr(i + 1, 2)), nullptr, 16));
+      i += 2;
+    } else {
+      path.push_back(uri[i]);
+    }
+  }
+  return path;
+}
+
+void NormalizeQuaternion(float* q)
+{
+  float length = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  if (length > 0.f) {
+    for (int i = 0; i < 4; i++) {
+      q[i] /= length;
+    }
+  }
+}
+
+void Slerp(const float* q0, const float* q1, float t, float* result)
+{
+  float d = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+  float sign = 1.f;
+  if (d < 0.f) {
+    // Take the shortest path
+    d = -d;
+    sign = -1.f;
+  }
+  float w0 = 1.f - t;
+  float w1 = t;
+  if (d < 0.9995f) {
+    float theta = acosf(d);
+    float s = sinf(theta);
+    w0 = sinf(w0 * theta) / s;
+    w1 = sinf(w1 * theta) / s;
+  }
+  w1 *= sign;
+  for (int i = 0; i < 4; i++) {
+    result[i] = w0 * q0[i] + w1 * q1[i];
+  }
+  NormalizeQuaternion(result);
+}
+
+// Evaluates a sampler's keys at frameCount frames, starting at frameStart.  The frames are
+// evaluated in increasing time, so the keys are walked with a cursor rather than searched.
+void ResampleKeys(const GltfAnimationSampler& sampler, bool quaternion, int frameStart, int frameCount, float frameRate, float* out)
+{
+  int componentCount = sampler.componentCount;
+  size_t keyCount = sampler.times.size();
+  // Cubic spline keys hold an in-tangent, a value and an out-tangent
+  bool cubic = sampler.interpolation == GLTF_INTERPOLATION_CUBICSPLINE;
+  int keyStride = cubic ? componentCount * 3 : componentCount;
+  int valueOffset = cubic ? componentCount : 0;
+
+  size_t key = 0;
+  for (int frame = 0; frame < frameCount; frame++) {
+    float time = (frameStart + frame) / frameRate;
+    float* result = out + frame * componentCount;
+    while (key + 1 < keyCount && sampler.times[key + 1] <= time) {
+      key++;
+    }
+    const float* v0 = sampler.values.data() + key * keyStride + valueOffset;
+    if (key + 1 >= keyCount || time <= sampler.times[key] || sampler.interpolation == GLTF_INTERPOLATION_STEP) {
+      memcpy(result, v0, sizeof(float) * componentCount);
+      continue;
+    }
+
+    const float* v1 = v0 + keyStride;
+    float dt = sampler.times[key + 1] - sampler.times[key];
+    float t = (time - sampler.times[key]) / dt;
+    if (cubic) {
+      const float* m0 = v0 + componentCount; // Out-tangent of the first key
+      const float* m1 = v1 - componentCount; // In-tangent of the second key
+      float t2 = t * t;
+      float t3 = t2 * t;
+      float h00 = 2.f * t3 - 3.f * t2 + 1.f;
+      float h10 = (t3 - 2.f * t2 + t) * dt;
+      float h01 = -2.f * t3 + 3.f * t2;
+      float h11 = (t3 - t2) * dt;
+      for (int c = 0; c < componentCount; c++) {
+        result[c] = h00 * v0[c] + h10 * m0[c] + h01 * v1[c] + h11 * m1[c];
+      }
+      if (quaternion) {
+        NormalizeQuaternion(result);
+      }
+    } else if (quaternion) {
+      Slerp(v0, v1, t, result);
+    } else {
+      for (int c = 0; c < componentCount; c++) {
+        result[c] = v0[c] + (v1[c] - v0[c]) * t;
+      }
+    }
+  }
+}
+
+// Converts an [x, y, z, w] quaternion to the XYZ euler angles, in degrees, used by
+// KRNode::SetAttribute
+Vector3 QuaternionToEulerDegrees(const float* q)
+{
+  return Quaternion::Create(q[3], q[0], q[1], q[2]).eulerXYZ() * (180.f / (float)M_PI);
+}
+
+class GltfImporter
+{
+public:
+  GltfImporter(KRContext& context, std::vector<Block*>& buffers, const std::string& baseName)
+    : m_context(context)
+    , m_buffers(buffers)
+    , m_baseName(baseName)
+    , m_invalidIndexes(0)
+  {
+  }
+
+  bool parseBufferViews(simdjson::ondemand::object& jsonRoot);
+  bool parseAccessors(simdjson::ondemand::object& jsonRoot);
+  bool parseMeshes(simdjson::ondemand::object& jsonRoot);
+  bool parseSkins(simdjson::ondemand::object& jsonRoot);
+  bool parseNodes(simdjson::ondemand::object& jsonRoot);
+  std::vector<int> parseSceneRoots(simdjson::ondemand::object& jsonRoot);
+  bool parseAnimations(simdjson::ondemand::object& jsonRoot);
+
+  bool getBufferView(int bufferViewIndex, const unsigned char** start, size_t* size) const;
+
+  // Creates the node hierarchy below the scene root, allocating mesh packs as they are
+  // referenced.  The packs are filled by decode() and completed by finish().
+  void createNodes(const std::vector<int>& roots, KRNode* parent, const std::vector<KRMaterial*>& materials);
+  void decode();
+  void finish(KRBundle* bundle);
+
+  // Resamples the animation channels of nodes created by createNodes() into curves
+  void importAnimations(KRBundle* bundle);
+
+private:
+  KRContext& m_context;
+  std::vector<Block*>& m_buffers;
+  std::string m_baseName;
+
+  std::vector<BufferViewInfo> m_bufferViews;
+  std::vector<AccessorInfo> m_accessors;
+  std::vector<GltfMesh> m_meshes;
+  std::vector<GltfSkin> m_skins;
+  std::vector<GltfNode> m_nodes;
+  std::vector<GltfAnimation> m_animations;
+
+  std::set<std::string> m_nodeNames;
+  std::map<std::pair<int, int>, std::vector<std::string>> m_meshVariants;
+  std::vector<PendingMesh> m_pendingMeshes;
+  std::vector<std::function<void()>> m_jobs;
+  std::atomic<size_t> m_invalidIndexes;
+
+  bool getStream(int accessorIndex, ElementStream* stream) const;
+  bool readAccessor(int accessorIndex, std::vector<float>& values, int* componentCount) const;
+  void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+  bool getSparseStreams(const AccessorInfo& accessor, ElementStream* indexes, ElementStream* values) const;
+  void applySparse(const PendingMesh& pending, const PendingMesh::Attribute& attribute) const;
+
+  const std::vector<std::string>& getMeshVariant(int meshIndex, int skinIndex, const std::vector<KRMaterial*>& materials);
+  bool buildMesh(const std::string& name, const std::vector<const GltfPrimitive*>& primitives, Topology topology, int skinIndex, const std::vector<KRMaterial*>& materials);
+  void createNode(int nodeIndex, KRNode* parent, const std::vector<KRMaterial*>& materials);
+  std::string getUniqueNodeName(const std::string& name);
+};
+
+bool GltfImporter::parseBufferViews(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonBufferViews;
+  if (!tryJson(jsonRoot["bufferViews"].get_array().get(jsonBufferViews))) {
+    return true;
+  }
+  for (auto jsonBufferView : jsonBufferViews) {
+    BufferViewInfo& bufferView = m_bufferViews.emplace_back();
+    int64_t buffer = -1;
+    int64_t byteOffset = 0;
+    int64_t byteLength = 0;
+    int64_t byteStride = 0;
+    if (!tryJsonRequired(jsonBufferView["buffer"].get(buffer)) || !tryJsonRequired(jsonBufferView["byteLength"].get(byteLength))) {
+      return false;
+    }
+    tryJson(jsonBufferView["byteOffset"].get(byteOffset));
+    tryJson(jsonBufferView["byteStride"].get(byteStride));
+    if (buffer < 0 || buffer >= (int64_t)m_buffers.size() || byteOffset < 0 || byteLength < 0 || byteStride < 0 ||
+      (size_t)(byteOffset + byteLength) > m_buffers[buffer]->getSize()) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Buffer view %i is out of range.", (int)m_bufferViews.size() - 1);
+      return false;
+    }
+    bufferView.buffer = (int)buffer;
+    bufferView.byteOffset = (size_t)byteOffset;
+    bufferView.byteLength = (size_t)byteLength;
+    bufferView.byteStride = (size_t)byteStride;
+  }
+  return true;
+}
+
+bool GltfImporter::parseAccessors(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonAccessors;
+  if (!tryJson(jsonRoot["accessors"].get_array().get(jsonAccessors))) {
+    return true;
+  }
+  for (auto jsonAccessor : jsonAccessors) {
+    AccessorInfo& accessor = m_accessors.emplace_back();
+    int accessorIndex = (int)m_accessors.size() - 1;
+    int64_t count = 0;
+    int64_t componentType = 0;
+    std::string_view type;
+    if (!tryJsonRequired(jsonAccessor["count"].get(count)) ||
+      !tryJsonRequired(jsonAccessor["componentType"].get(componentType)) ||
+      !tryJsonRequired(jsonAccessor["type"].get(type))) {
+      return false;
+    }
+    accessor.count = (size_t)std::max(count, (int64_t)0);
+    accessor.componentType = (int)componentType;
+    accessor.componentCount = GetTypeComponentCount(type);
+    if (GetComponentSize(accessor.componentType) == 0 || accessor.componentCount == 0) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Accessor %i has an unknown type.", accessorIndex);
+      return false;
+    }
+
+    int64_t bufferView = -1;
+    int64_t byteOffset = 0;
+    tryJson(jsonAccessor["bufferView"].get(bufferView));
+    tryJson(jsonAccessor["byteOffset"].get(byteOffset));
+    tryJson(jsonAccessor["normalized"].get(accessor.normalized));
+    accessor.bufferView = (int)bufferView;
+    accessor.byteOffset = (size_t)std::max(byteOffset, (int64_t)0);
+
+    if (accessor.componentCount <= 4) {
+      // Each array is read before the next is requested, as the document is parsed on demand
+      int minCount = 0;
+      int maxCount = 0;
+      simdjson::ondemand::array jsonBound;
+      if (tryJson(jsonAccessor["min"].get_array().get(jsonBound))) {
+        for (auto jsonValue : jsonBound) {
+          double v = 0.0;
+          if (minCount < 4 && tryJsonRequired(jsonValue.get(v))) {
+            accessor.min[minCount++] = (float)v;
+          }
+        }
+      }
+      if (tryJson(jsonAccessor["max"].get_array().get(jsonBound))) {
+        for (auto jsonValue : jsonBound) {
+          double v = 0.0;
+          if (maxCount < 4 && tryJsonRequired(jsonValue.get(v))) {
+            accessor.max[maxCount++] = (float)v;
+          }
+        }
+      }
+      accessor.hasBounds = minCount == accessor.componentCount && maxCount == accessor.componentCount;
+    }
+
+    simdjson::ondemand::object jsonSparse;
+    if (tryJson(jsonAccessor["sparse"].get(jsonSparse))) {
+      int64_t sparseCount = 0;
+      int64_t indicesView = -1;
+      int64_t indicesOffset = 0;
+      int64_t indicesComponentType = 0;
+      int64_t valuesView = -1;
+      int64_t valuesOffset = 0;
+      if (!tryJsonRequired(jsonSparse["count"].get(sparseCount)) ||
+        !tryJsonRequired(jsonSparse["indices"]["bufferView"].get(indicesView)) ||
+        !tryJsonRequired(jsonSparse["indices"]["componentType"].get(indicesComponentType)) ||
+        !tryJsonRequired(jsonSparse["values"]["bufferView"].get(valuesView))) {
+        return false;
+      }
+      tryJson(jsonSparse["indices"]["byteOffset"].get(indicesOffset));
+      tryJson(jsonSparse["values"]["byteOffset"].get(valuesOffset));
+      accessor.sparseCount = (size_t)std::max(sparseCount, (int64_t)0);
+      accessor.sparseIndicesView = (int)indicesView;
+      accessor.sparseIndicesOffset = (size_t)std::max(indicesOffset, (int64_t)0);
+      accessor.sparseIndicesComponentType = (int)indicesComponentType;
+      accessor.sparseValuesView = (int)valuesView;
+      accessor.sparseValuesOffset = (size_t)std::max(valuesOffset, (int64_t)0);
+    }
+  }
+  return true;
+}
+
+bool GltfImporter::parseMeshes(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonMeshes;
+  if (!tryJson(jsonRoot["meshes"].get_array().get(jsonMeshes))) {
+    return true;
+  }
+  for (auto jsonMesh : jsonMeshes) {
+    GltfMesh& mesh = m_meshes.emplace_back();
+    std::string_view name;
+    if (tryJson(jsonMesh["name"].get(name))) {
+      mesh.name = name;
+    } else {
+      mesh.name = std::format("{}_mesh_{}", m_baseName, m_meshes.size() - 1);
+    }
+
+    simdjson::ondemand::array jsonPrimitives;
+    if (!tryJsonRequired(jsonMesh["primitives"].get_array().get(jsonPrimitives))) {
+      return false;
+    }
+    for (auto jsonPrimitive : jsonPrimitives) {
+      GltfPrimitive& primitive = mesh.primitives.emplace_back();
+      tryJson(jsonPrimitive["mode"].get(primitive.mode));
+      tryJson(jsonPrimitive["material"].get(primitive.material));
+      tryJson(jsonPrimitive["indices"].get(primitive.indices));
+
+      simdjson::ondemand::object jsonAttributes;
+      if (!tryJsonRequired(jsonPrimitive["attributes"].get(jsonAttributes))) {
+        return false;
+      }
+      for (auto jsonAttribute : jsonAttributes) {
+        std::string_view semantic;
+        int64_t accessor = -1;
+        if (!tryJsonRequired(jsonAttribute.unescaped_key().get(semantic)) || !tryJsonRequired(jsonAttribute.value().get(accessor))) {
+          return false;
+        }
+        if (accessor < 0 || accessor >= (int64_t)m_accessors.size()) {
+          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Mesh attribute with accessor index out of range: %s", mesh.name.c_str());
+          return false;
+        }
+        int set = 0;
+        if (semantic == "POSITION") {
+          primitive.position = (int)accessor;
+        } else if (semantic == "NORMAL") {
+          primitive.normal = (int)accessor;
+        } else if (semantic == "TANGENT") {
+          primitive.tangent = (int)accessor;
+        } else if (semantic.starts_with("TEXCOORD_") && std::from_chars(semantic.data() + 9, semantic.data() + semantic.size(), set).ec == std::errc() && set < 8) {
+          primitive.texcoord[set] = (int)accessor;
+        } else if (semantic.starts_with("COLOR_") && std::from_chars(semantic.data() + 6, semantic.data() + semantic.size(), set).ec == std::errc() && set < 8) {
+          primitive.color[set] = (int)accessor;
+        } else if (semantic == "JOINTS_0") {
+          primitive.joints = (int)accessor;
+        } else if (semantic == "WEIGHTS_0") {
+          primitive.weights = (int)accessor;
+        }
+        // Other semantics, including additional joint influences, are not imported
+      }
+
+      simdjson::ondemand::array jsonTargets;
+      if (tryJson(jsonPrimitive["targets"].get_array().get(jsonTargets))) {
+        KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: Morph targets are not supported and will be ignored for mesh: %s", mesh.name.c_str());
+      }
+    }
+  }
+  return true;
+}
+
+bool GltfImporter::parseSkins(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonSkins;
+  if (!tryJson(jsonRoot["skins"].get_array().get(jsonSkins))) {
+    return true;
+  }
+  for (auto jsonSkin : jsonSkins) {
+    GltfSkin& skin = m_skins.emplace_back();
+    tryJson(jsonSkin["inverseBindMatrices"].get(skin.inverseBindMatrices));
+    simdjson::ondemand::array jsonJoints;
+    if (!tryJsonRequired(jsonSkin["joints"].get_array().get(jsonJoints))) {
+      return false;
+    }
+    for (auto jsonJoint : jsonJoints) {
+      int64_t joint = -1;
+      if (!tryJsonRequired(jsonJoint.get(joint))) {
+        return false;
+      }
+      skin.joints.push_back((int)joint);
+    }
+  }
+  return true;
+}
+
+bool GltfImporter::parseNodes(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonNodes;
+  if (!tryJson(jsonRoot["nodes"].get_array().get(jsonNodes))) {
+    return true;
+  }
+  for (auto jsonNode : jsonNodes) {
+    GltfNode& node = m_nodes.emplace_back();
+    std::string_view name;
+    if (tryJson(jsonNode["name"].get(name))) {
+      node.name = name;
+    } else {
+      node.name = std::format("{}_node_{}", m_baseName, m_nodes.size() - 1);
+    }
+    tryJson(jsonNode["mesh"].get(node.mesh));
+    tryJson(jsonNode["skin"].get(node.skin));
+    tryJson(jsonNode["translation"].get(node.translation));
+    tryJson(jsonNode["rotation"].get(node.rotation));
+    tryJson(jsonNode["scale"].get(node.scale));
+
+    simdjson::ondemand::array jsonMatrix;
+    if (tryJson(jsonNode["matrix"].get_array().get(jsonMatrix))) {
+      int i = 0;
+      for (auto jsonValue : jsonMatrix) {
+        double v = 0.0;
+        if (i < 16 && tryJsonRequired(jsonValue.get(v))) {
+          node.matrix[i++] = (float)v;
+        }
+      }
+      node.hasMatrix = i == 16;
+    }
+
+    simdjson::ondemand::array jsonChildren;
+    if (tryJson(jsonNode["children"].get_array().get(jsonChildren))) {
+      for (auto jsonChild : jsonChildren) {
+        int64_t child = -1;
+        if (tryJsonRequired(jsonChild.get(child))) {
+          node.children.push_back((int)child);
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < (int)m_nodes.size(); i++) {
+    for (int child : m_nodes[i].children) {
+      if (child < 0 || child >= (int)m_nodes.size() || m_nodes[child].parent != -1) {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Node has an invalid child: %s", m_nodes[i].name.c_str());
+        return false;
+      }
+      m_nodes[child].parent = i;
+    }
+  }
+  return true;
+}
+
+std::vector<int> GltfImporter::parseSceneRoots(simdjson::ondemand::object& jsonRoot)
+{
+  std::vector<int> roots;
+  int64_t sceneIndex = 0;
+  tryJson(jsonRoot["scene"].get(sceneIndex));
+  simdjson::ondemand::array jsonScenes;
+  if (tryJson(jsonRoot["scenes"].get_array().get(jsonScenes))) {
+    int64_t i = 0;
+    for (auto jsonScene : jsonScenes) {
+      if (i++ != sceneIndex) {
+        continue;
+      }
+      simdjson::ondemand::array jsonSceneNodes;
+      if (tryJson(jsonScene["nodes"].get_array().get(jsonSceneNodes))) {
+        for (auto jsonSceneNode : jsonSceneNodes) {
+          int64_t node = -1;
+          if (tryJsonRequired(jsonSceneNode.get(node)) && node >= 0 && node < (int64_t)m_nodes.size()) {
+            roots.push_back((int)node);
+          }
+        }
+      }
+      return roots;
+    }
+  }
+
+  // Without a scene, every node without a parent is imported
+  for (int i = 0; i < (int)m_nodes.size(); i++) {
+    if (m_nodes[i].parent == -1) {
+      roots.push_back(i);
+    }
+  }
+  return roots;
+}
+
+bool GltfImporter::parseAnimations(simdjson::ondemand::object& jsonRoot)
+{
+  simdjson::ondemand::array jsonAnimations;
+  if (!tryJson(jsonRoot["animations"].get_array().get(jsonAnimations))) {
+    return true;
+  }
+  bool morphWarning = false;
+  for (auto jsonAnimation : jsonAnimations) {
+    GltfAnimation& animation = m_animations.emplace_back();
+    std::string_view name;
+    if (tryJson(jsonAnimation["name"].get(name))) {
+      animation.name = name;
+    } else {
+      animation.name = std::format("{}_animation_{}", m_baseName, m_animations.size() - 1);
+    }
+
+    simdjson::ondemand::array jsonChannels;
+    if (!tryJsonRequired(jsonAnimation["channels"].get_array().get(jsonChannels))) {
+      return false;
+    }
+    for (auto jsonChannel : jsonChannels) {
+      // The target is read completely before moving on to the sampler
+      simdjson::ondemand::object jsonTarget;
+      int node = -1;
+      std::string_view path;
+      int sampler = -1;
+      if (!tryJsonRequired(jsonChannel["target"].get_object().get(jsonTarget))) {
+        return false;
+      }
+      bool hasNode = tryJson(jsonTarget["node"].get(node));
+      if (!tryJsonRequired(jsonTarget["path"].get(path)) || !tryJsonRequired(jsonChannel["sampler"].get(sampler))) {
+        return false;
+      }
+      if (!hasNode) {
+        // Channels without a node are targeted by extensions
+        continue;
+      }
+      GltfAnimationPath targetPath;
+      if (path == "translation") {
+        targetPath = GLTF_PATH_TRANSLATION;
+      } else if (path == "rotation") {
+        targetPath = GLTF_PATH_ROTATION;
+      } else if (path == "scale") {
+        targetPath = GLTF_PATH_SCALE;
+      } else {
+        if (path == "weights" && !morphWarning) {
+          KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: Morph target animation is not supported.");
+          morphWarning = true;
+        }
+        continue;
+      }
+      if (node < 0 || node >= (int)m_nodes.size()) {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Animation channel has a node index out of range: %s", animation.name.c_str());
+        continue;
+      }
+      GltfAnimationChannel& channel = animation.channels.emplace_back();
+      channel.sampler = sampler;
+      channel.node = node;
+      channel.path = targetPath;
+    }
+
+    simdjson::ondemand::array jsonSamplers;
+    if (!tryJsonRequired(jsonAnimation["samplers"].get_array().get(jsonSamplers))) {
+      return false;
+    }
+    for (auto jsonSampler : jsonSamplers) {
+      GltfAnimationSampler& sampler = animation.samplers.emplace_back();
+      if (!tryJsonRequired(jsonSampler["input"].get(sampler.input)) ||
+        !tryJsonRequired(jsonSampler["output"].get(sampler.output))) {
+        return false;
+      }
+      std::string_view interpolation;
+      if (tryJson(jsonSampler["interpolation"].get(interpolation))) {
+        if (interpolation == "STEP") {
+          sampler.interpolation = GLTF_INTERPOLATION_STEP;
+        } else if (interpolation == "CUBICSPLINE") {
+          sampler.interpolation = GLTF_INTERPOLATION_CUBICSPLINE;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool GltfImporter::getBufferView(int bufferViewIndex, const unsigned char** start, size_t* size) const
+{
+  if (bufferViewIndex < 0 || bufferViewIndex >= (int)m_bufferViews.size()) {
+    return false;
+  }
+  const BufferViewInfo& bufferView = m_bufferViews[bufferViewIndex];
+  *start = (const unsigned char*)m_buffers[bufferView.buffer]->getStart() + bufferView.byteOffset;
+  *size = bufferView.byteLength;
+  return true;
+}
+
+bool GltfImporter::getStream(int accessorIndex, ElementStream* stream) const
+{
+  if (accessorIndex < 0 || accessorIndex >= (int)m_accessors.size()) {
+    return false;
+  }
+  const AccessorInfo& accessor = m_accessors[accessorIndex];
+  stream->componentType = accessor.componentType;
+  stream->componentCount = accessor.componentCount;
+  stream->normalized = accessor.normalized;
+  size_t elementSize = GetComponentSize(accessor.componentType) * accessor.componentCount;
+  if (accessor.bufferView == -1) {
+    stream->start = nullptr;
+    stream->stride = elementSize;
+    return true;
+  }
+
+  const unsigned char* viewStart = nullptr;
+  size_t viewSize = 0;
+  if (!getBufferView(accessor.bufferView, &viewStart, &viewSize)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Accessor %i has a buffer view index out of range.", accessorIndex);
+    return false;
+  }
+  size_t stride = m_bufferViews[accessor.bufferView].byteStride;
+  if (stride == 0) {
+    stride = elementSize;
+  }
+  if (accessor.count > 0 && accessor.byteOffset + (accessor.count - 1) * stride + elementSize > viewSize) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Accessor %i extends past the end of its buffer view.", accessorIndex);
+    return false;
+  }
+  stream->start = viewStart + accessor.byteOffset;
+  stream->stride = stride;
+  return true;
+}
+
+bool GltfImporter::readAccessor(int accessorIndex, std::vector<float>& values, int* componentCount) const
+{
+  ElementStream stream;
+  if (!getStream(accessorIndex, &stream)) {
+    return false;
+  }
+  const AccessorInfo& accessor = m_accessors[accessorIndex];
+  size_t componentSize = GetComponentSize(stream.componentType);
+  *componentCount = stream.componentCount;
+  values.assign(accessor.count * stream.componentCount, 0.f);
+  if (stream.start) {
+    for (size_t i = 0; i < accessor.count; i++) {
+      const unsigned char* element = stream.start + i * stream.stride;
+      for (int c = 0; c < stream.componentCount; c++) {
+        values[i * stream.componentCount + c] = ReadComponent(element + c * componentSize, stream.componentType, stream.normalized);
+      }
+    }
+  }
+  if (accessor.sparseCount > 0) {
+    ElementStream indexes;
+    ElementStream sparseValues;
+    if (!getSparseStreams(accessor, &indexes, &sparseValues)) {
+      return false;
+    }
+    for (size_t i = 0; i < accessor.sparseCount; i++) {
+      uint32_t index = ReadIndex(indexes.start + i * indexes.stride, indexes.componentType);
+      if (index >= accessor.count) {
+        continue;
+      }
+      const unsigned char* element = sparseValues.start + i * sparseValues.stride;
+      for (int c = 0; c < stream.componentCount; c++) {
+        values[index * stream.componentCount + c] = ReadComponent(element + c * componentSize, stream.componentType, stream.normalized);
+      }
+    }
+  }
+  return true;
+}
+
+bool GltfImporter::getSparseStreams(const AccessorInfo& accessor, ElementStream* indexes, ElementStream* values) const
+{
+  const unsigned char* viewStart = nullptr;
+  size_t viewSize = 0;
+  size_t indexSize = GetComponentSize(accessor.sparseIndicesComponentType);
+  if (indexSize == 0 || !getBufferView(accessor.sparseIndicesView, &viewStart, &viewSize) ||
+    accessor.sparseIndicesOffset + accessor.sparseCount * indexSize > viewSize) {
+    return false;
+  }
+  indexes->start = viewStart + accessor.sparseIndicesOffset;
+  indexes->stride = indexSize;
+  indexes->componentType = accessor.sparseIndicesComponentType;
+  indexes->componentCount = 1;
+
+  size_t valueSize = GetComponentSize(accessor.componentType) * accessor.componentCount;
+  if (!getBufferView(accessor.sparseValuesView, &viewStart, &viewSize) ||
+    accessor.sparseValuesOffset + accessor.sparseCount * valueSize > viewSize) {
+    return false;
+  }
+  values->start = viewStart + accessor.sparseValuesOffset;
+  values->stride = valueSize;
+  values->componentType = accessor.componentType;
+  values->componentCount = accessor.componentCount;
+  values->normalized = accessor.normalized;
+  return true;
+}
+
+void GltfImporter::applySparse(const PendingMesh& pending, const PendingMesh::Attribute& attribute) const
+{
+  const AccessorInfo& accessor = m_accessors[attribute.accessor];
+  ElementStream indexes;
+  ElementStream values;
+  if (!getSparseStreams(accessor, &indexes, &values)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Sparse accessor %i is out of range.", attribute.accessor);
+    return;
+  }
+  for (size_t i = 0; i < accessor.sparseCount; i++) {
+    uint32_t index = ReadIndex(indexes.start + i * indexes.stride, indexes.componentType);
+    if (index >= attribute.vertexCount) {
+      continue;
+    }
+    DecodeAttribute(values, i, 1, attribute.dest + index * pending.vertexSize, pending.vertexSize, attribute.info);
+  }
+}
+
+std::string GltfImporter::getUniqueNodeName(const std::string& name)
+{
+  // KRModel finds its bones by name, so node names must be unique within the scene
+  std::string uniqueName = name;
+  for (int suffix = 1; m_nodeNames.count(uniqueName); suffix++) {
+    uniqueName = std::format("{}_{}", name, suffix);
+  }
+  m_nodeNames.insert(uniqueName);
+  return uniqueName;
+}
+
+const std::vector<std::string>& GltfImporter::getMeshVariant(int meshIndex, int skinIndex, const std::vector<KRMaterial*>& materials)
+{
+  // A mesh gets a separate pack for each skin that it is used with, as the pack holds the
+  // bone names.  Primitives with different topologies are split into separate packs.
+  std::pair<int, int> key(meshIndex, skinIndex);
+  auto itr = m_meshVariants.find(key);
+  if (itr != m_meshVariants.end()) {
+    return itr->second;
+  }
+  std::vector<std::string>& names = m_meshVariants[key];
+  const GltfMesh& mesh = m_meshes[meshIndex];
+
+  std::string baseName = mesh.name;
+  for (auto& variant : m_meshVariants) {
+    if (variant.first.first == meshIndex && variant.first.second != skinIndex) {
+      baseName = std::format("{}_skin_{}", mesh.name, skinIndex);
+      break;
+    }
+  }
+
+  static const Topology kModeTopology[] = {
+    Topology::Points,
+    Topology::Lines,
+    Topology::Lines, // LINE_LOOP is not supported
+    Topology::LineStrips,
+    Topology::Triangles,
+    Topology::TriangleStrips,
+    Topology::TriangleFans
+  };
+  std::map<Topology, std::vector<const GltfPrimitive*>> groups;
+  for (const GltfPrimitive& primitive : mesh.primitives) {
+    if (primitive.mode < 0 || primitive.mode > 6 || primitive.mode == 2) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: Primitive mode %i is not supported for mesh: %s", primitive.mode, mesh.name.c_str());
+      continue;
+    }
+    // Strips and fans without normals are expanded to triangle lists for their flat normals
+    Topology topology = kModeTopology[primitive.mode];
+    if (primitive.mode >= 4 && primitive.normal < 0) {
+      topology = Topology::Triangles;
+    }
+    groups[topology].push_back(&primitive);
+  }
+
+  for (auto& group : groups) {
+    std::string name = names.empty() ? baseName : std::format("{}_{}", baseName, names.size());
+    if (buildMesh(name, group.second, group.first, skinIndex, materials)) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+bool GltfImporter::buildMesh(const std::string& name, const std::vector<const GltfPrimitive*>& sourcePrimitives, Topology topology, int skinIndex, const std::vector<KRMaterial*>& materials)
+{
+  struct PrimitiveRange
+  {
+    const GltfPrimitive* primitive;
+    size_t vertexCount; // In the pack
+    size_t indexCount; // In the pack
+    bool flat; // Expanded to a triangle list with flat normals
+    size_t sourceVertexCount;
+  };
+  std::vector<PrimitiveRange> primitives;
+
+  bool hasNormals = false;
+  bool hasTangents = false;
+  int texcoordSets = 0;
+  int colorSets = 0;
+  bool hasJoints = false;
+  for (const GltfPrimitive* primitive : sourcePrimitives) {
+    if (primitive->position < 0) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: Skipping primitive without positions in mesh: %s", name.c_str());
+      continue;
+    }
+    size_t vertexCount = m_accessors[primitive->position].count;
+    bool valid = vertexCount > 0;
+    auto checkAttribute = [&](int accessor) {
+      if (accessor >= 0 && m_accessors[accessor].count != vertexCount) {
+        valid = false;
+      }
+    };
+    checkAttribute(primitive->normal);
+    checkAttribute(primitive->tangent);
+    for (int set = 0; set < 8; set++) {
+      checkAttribute(primitive->texcoord[set]);
+      checkAttribute(primitive->color[set]);
+    }
+    checkAttribute(primitive->joints);
+    checkAttribute(primitive->weights);
+    size_t indexCount = vertexCount;
+    if (primitive->indices >= 0) {
+      if (primitive->indices >= (int)m_accessors.size() || m_accessors[primitive->indices].componentCount != 1) {
+        valid = false;
+      } else {
+        indexCount = m_accessors[primitive->indices].count;
+      }
+    }
+    bool flat = primitive->mode >= 4 && primitive->normal < 0;
+    size_t packVertexCount = vertexCount;
+    if (flat) {
+      indexCount = GetTriangleCount(primitive->mode, indexCount) * 3;
+      packVertexCount = indexCount;
+    }
+    if (!valid || indexCount == 0) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: Skipping invalid or empty primitive in mesh: %s", name.c_str());
+      continue;
+    }
+    primitives.push_back({ primitive, packVertexCount, indexCount, flat, vertexCount });
+
+    hasNormals |= primitive->normal >= 0 || flat;
+    hasTangents |= primitive->tangent >= 0 || flat;
+    for (int set = 0; set < 8; set++) {
+      if (primitive->texcoord[set] >= 0) {
+        texcoordSets = std::max(texcoordSets, set + 1);
+      }
+      if (primitive->color[set] >= 0) {
+        colorSets = std::max(colorSets, set + 1);
+      }
+    }
+    hasJoints |= primitive->joints >= 0 && primitive->weights >= 0;
+  }
+  if (primitives.empty()) {
+    return false;
+  }
+
+  const GltfSkin* skin = skinIndex >= 0 ? &m_skins[skinIndex] : nullptr;
+  if (skin == nullptr) {
+    hasJoints = false;
+  }
+
+  KRMesh::PrimitiveInfo primitiveInfo = {};
+  VertexAttributeInfo* attribute = primitiveInfo.layout.attributes;
+  *attribute++ = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::position };
+  if (hasNormals) {
+    *attribute++ = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::normal };
+  }
+  if (hasTangents) {
+    // The handedness in the w component of glTF tangents is not stored
+    *attribute++ = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::tangent };
+  }
+  for (int set = 0; set < texcoordSets; set++) {
+    *attribute++ = { ComponentType::float32, DataType::vec2, Normalization::none, VertexAttribute::texcoord };
+  }
+  for (int set = 0; set < colorSets; set++) {
+    *attribute++ = { ComponentType::uint8, DataType::vec4, Normalization::normalized, VertexAttribute::color };
+  }
+  if (hasJoints) {
+    ComponentType jointComponent = skin->joints.size() > 0x100 ? ComponentType::uint16 : ComponentType::uint8;
+    *attribute++ = { jointComponent, DataType::vec4, Normalization::none, VertexAttribute::joints };
+    *attribute++ = { ComponentType::float32, DataType::vec4, Normalization::none, VertexAttribute::weights };
+  }
+  for (int i = 0; i < kMaxAttributes && primitiveInfo.layout.attributes[i].component != ComponentType::empty; i++) {
+    primitiveInfo.layout.offsets[i] = primitiveInfo.layout.vertexSize;
+    primitiveInfo.layout.vertexSize += ComponentSize[(int)primitiveInfo.layout.attributes[i].component] * DataTypeComponentCount[(int)primitiveInfo.layout.attributes[i].type];
+  }
+  primitiveInfo.layout.topology = topology;
+
+  // Each primitive is drawn from its own index group, so indexes only need to address the
+  // vertexes of a single primitive
+  IndexFormat indexFormat = IndexFormat::uint16;
+  for (const PrimitiveRange& range : primitives) {
+    primitiveInfo.vertexCount += range.vertexCount;
+    primitiveInfo.indexCount += range.indexCount;
+    if (range.vertexCount > 0xffff) {
+      indexFormat = IndexFormat::uint32;
+    }
+  }
+
+  int boneCount = hasJoints ? (int)skin->joints.size() : 0;
+  PendingMesh& pending = m_pendingMeshes.emplace_back();
+  pending.mesh = new KRMesh(m_context, name);
+  pending.pack = pending.mesh->beginPack(primitiveInfo, indexFormat, (int)primitives.size(), boneCount, (int)primitives.size());
+  pending.vertexSize = primitiveInfo.layout.vertexSize;
+  pending.vertexCount = primitiveInfo.vertexCount;
+  for (int i = 0; i < kMaxAttributes && primitiveInfo.layout.attributes[i].component != ComponentType::empty; i++) {
+    int offset = primitiveInfo.layout.offsets[i];
+    switch (primitiveInfo.layout.attributes[i].attribute) {
+    case VertexAttribute::normal:
+      pending.normalOffset = offset;
+      break;
+    case VertexAttribute::tangent:
+      pending.tangentOffset = offset;
+      break;
+    case VertexAttribute::texcoord:
+      if (pending.texcoordOffset < 0) {
+        pending.texcoordOffset = offset;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  if (hasJoints) {
+    ElementStream inverseBindMatrices;
+    bool hasInverseBindMatrices = skin->inverseBindMatrices >= 0 && getStream(skin->inverseBindMatrices, &inverseBindMatrices) &&
+      inverseBindMatrices.start && inverseBindMatrices.componentType == GLTF_FLOAT && inverseBindMatrices.componentCount == 16 &&
+      m_accessors[skin->inverseBindMatrices].count >= skin->joints.size();
+    for (int bone = 0; bone < boneCount; bone++) {
+      KRMesh::pack_bone* packBone = pending.pack.bones + bone;
+      int joint = skin->joints[bone];
+      memset(packBone->szName, 0, KRENGINE_MAX_NAME_LENGTH);
+      if (joint >= 0 && joint < (int)m_nodes.size()) {
+        strncpy(packBone->szName, m_nodes[joint].name.c_str(), KRENGINE_MAX_NAME_LENGTH - 1);
+      }
+      // glTF matrices are column major, matching the memory layout of Matrix4
+      Matrix4 bindPose;
+      if (hasInverseBindMatrices) {
+        Matrix4 inverseBindPose;
+        memcpy(inverseBindPose.c, inverseBindMatrices.start + bone * inverseBindMatrices.stride, sizeof(float) * 16);
+        bindPose = Matrix4::Invert(inverseBindPose);
+      }
+      memcpy(packBone->bind_pose, bindPose.c, sizeof(float) * 16);
+    }
+  }
+
+  size_t firstVertex = 0;
+  size_t firstIndex = 0;
+  unsigned char* vertexes = pending.pack.vertexes;
+  int vertexSize = pending.vertexSize;
+  for (int p = 0; p < (int)primitives.size(); p++) {
+    const PrimitiveRange& range = primitives[p];
+    const GltfPrimitive* primitive = range.primitive;
+
+    KRMesh::pack_material* submesh = pending.pack.submeshes + p;
+    submesh->index_group = (uint16_t)p;
+    submesh->index_group_offset = 0;
+    submesh->vertex_count = (int32_t)range.indexCount;
+    memset(submesh->szName, 0, KRENGINE_MAX_NAME_LENGTH);
+    if (primitive->material >= 0 && primitive->material < (int)materials.size() && materials[primitive->material]) {
+      strncpy(submesh->szName, materials[primitive->material]->getName().c_str(), KRENGINE_MAX_NAME_LENGTH - 1);
+    }
+    pending.pack.indexBases[p * 2] = (__uint32_t)firstIndex;
+    pending.pack.indexBases[p * 2 + 1] = (__uint32_t)firstVertex;
+
+    // The extents are taken from the position bounds, which glTF requires, when every
+    // primitive provides them
+    const AccessorInfo& positions = m_accessors[primitive->position];
+    if (p == 0) {
+      pending.hasExtents = true;
+    }
+    if (!positions.hasBounds) {
+      pending.hasExtents = false;
+    } else if (p == 0) {
+      pending.extents.min = Vector3::Create(positions.min[0], positions.min[1], positions.min[2]);
+      pending.extents.max = Vector3::Create(positions.max[0], positions.max[1], positions.max[2]);
+    } else {
+      pending.extents.encapsulate(Vector3::Create(positions.min[0], positions.min[1], positions.min[2]));
+      pending.extents.encapsulate(Vector3::Create(positions.max[0], positions.max[1], positions.max[2]));
+    }
+
+    // Flat primitives are decoded to their own vertexes, which finish() expands into the pack
+    unsigned char* primitiveVertexes = vertexes + firstVertex * vertexSize;
+    size_t decodeCount = range.vertexCount;
+    if (range.flat) {
+      PendingMesh::FlatPrimitive& flat = pending.flatPrimitives.emplace_back();
+      flat.mode = primitive->mode;
+      flat.vertexCount = range.sourceVertexCount;
+      flat.triangleCount = range.indexCount / 3;
+      flat.firstVertex = firstVertex;
+      flat.vertexes.resize(range.sourceVertexCount * vertexSize);
+      if (primitive->indices >= 0 && !(getStream(primitive->indices, &flat.indexes) && flat.indexes.start != nullptr)) {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Could not read indexes for a primitive in mesh: %s", name.c_str());
+        flat.indexes = ElementStream();
+      }
+      primitiveVertexes = flat.vertexes.data();
+      decodeCount = range.sourceVertexCount;
+    }
+
+    // Attributes that are missing from this primitive are decoded from an empty stream,
+    // filling them with defaults
+    int attributeIndex = 0;
+    int texcoordSet = 0;
+    int colorSet = 0;
+    for (; attributeIndex < kMaxAttributes && primitiveInfo.layout.attributes[attributeIndex].component != ComponentType::empty; attributeIndex++) {
+      const VertexAttributeInfo& info = primitiveInfo.layout.attributes[attributeIndex];
+      int accessor = -1;
+      switch (info.attribute) {
+      case VertexAttribute::position:
+        accessor = primitive->position;
+        break;
+      case VertexAttribute::normal:
+        accessor = primitive->normal;
+        break;
+      case VertexAttribute::tangent:
+        accessor = primitive->tangent;
+        break;
+      case VertexAttribute::texcoord:
+        accessor = primitive->texcoord[texcoordSet++];
+        break;
+      case VertexAttribute::color:
+        accessor = primitive->color[colorSet++];
+        break;
+      case VertexAttribute::joints:
+        accessor = primitive->weights >= 0 ? primitive->joints : -1;
+        break;
+      case VertexAttribute::weights:
+        accessor = primitive->joints >= 0 ? primitive->weights : -1;
+        break;
+      }
+
+      ElementStream stream;
+      if (accessor >= 0 && !getStream(accessor, &stream)) {
+        accessor = -1;
+      }
+      if (accessor < 0) {
+        stream = ElementStream();
+      }
+      unsigned char* attributeVertexes = primitiveVertexes + primitiveInfo.layout.offsets[attributeIndex];
+      if (accessor >= 0 && m_accessors[accessor].sparseCount > 0) {
+        pending.attributes.push_back({ accessor, attributeVertexes, decodeCount, info });
+      }
+      for (size_t chunk = 0; chunk < decodeCount; chunk += kDecodeChunkSize) {
+        size_t count = std::min(kDecodeChunkSize, decodeCount - chunk);
+        unsigned char* dest = attributeVertexes + chunk * vertexSize;
+        m_jobs.push_back([stream, chunk, count, dest, vertexSize, info]() {
+          DecodeAttribute(stream, chunk, count, dest, vertexSize, info);
+        });
+      }
+    }
+
+    // The expanded vertexes of flat primitives are drawn in order
+    ElementStream indexStream;
+    bool indexed = !range.flat && primitive->indices >= 0 && getStream(primitive->indices, &indexStream) && indexStream.start != nullptr;
+    if (!range.flat && primitive->indices >= 0 && !indexed) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Could not read indexes for a primitive in mesh: %s", name.c_str());
+    }
+    for (size_t chunk = 0; chunk < range.indexCount; chunk += kDecodeChunkSize) {
+      size_t count = std::min(kDecodeChunkSize, range.indexCount - chunk);
+      void* indexes = pending.pack.indexes;
+      size_t indexStart = firstIndex + chunk;
+      uint32_t vertexCount = (uint32_t)range.vertexCount;
+      std::atomic<size_t>* invalidIndexes = &m_invalidIndexes;
+      m_jobs.push_back([indexed, indexStream, chunk, count, indexes, indexStart, indexFormat, vertexCount, invalidIndexes]() {
+        size_t invalid = 0;
+        for (size_t i = 0; i < count; i++) {
+          // Non-indexed primitives are given sequential indexes
+          uint32_t index = (uint32_t)(chunk + i);
+          if (indexed) {
+            index = ReadIndex(indexStream.start + (chunk + i) * indexStream.stride, indexStream.componentType);
+          }
+          if (index >= vertexCount) {
+            index = 0;
+            invalid++;
+          }
+          if (indexFormat == IndexFormat::uint32) {
+            ((__uint32_t*)indexes)[indexStart + i] = index;
+          } else {
+            ((__uint16_t*)indexes)[indexStart + i] = (__uint16_t)index;
+          }
+        }
+        if (invalid) {
+          *invalidIndexes += invalid;
+        }
+      });
+    }
+
+    firstVertex += range.vertexCount;
+    firstIndex += range.indexCount;
+  }
+  return true;
+}
+
+void GltfImporter::createNode(int nodeIndex, KRNode* parent, const std::vector<KRMaterial*>& materials)
+{
+  GltfNode& source = m_nodes[nodeIndex];
+  if (source.created) {
+    return;
+  }
+  source.created = true;
+
+  bool isJoint = false;
+  for (const GltfSkin& skin : m_skins) {
+    if (std::find(skin.joints.begin(), skin.joints.end(), nodeIndex) != skin.joints.end()) {
+      isJoint = true;
+      break;
+    }
+  }
+
+  const std::vector<std::string>* meshNames = nullptr;
+  if (source.mesh >= 0 && source.mesh < (int)m_meshes.size()) {
+    int skinIndex = source.skin >= 0 && source.skin < (int)m_skins.size() ? source.skin : -1;
+    meshNames = &getMeshVariant(source.mesh, skinIndex, materials);
+  }
+
+  KRScene& scene = parent->getScene();
+  KRNode* node = nullptr;
+  size_t firstChildMesh = 0;
+  if (isJoint) {
+    node = new KRBone(scene, source.name);
+  } else if (meshNames && !meshNames->empty()) {
+    KRModel* model = new KRModel(scene, source.name);
+    model->setMesh(meshNames->front());
+    firstChildMesh = 1;
+    node = model;
+  } else {
+    node = new KRNode(scene, source.name);
+  }
+
+  Vector3 translation = source.translation;
+  Vector3 scale = source.scale;
+  Vector4 rotation = source.rotation;
+  if (source.hasMatrix) {
+    // glTF matrices are column major, so each column's basis vector is contiguous
+    const float* m = source.matrix;
+    translation = Vector3::Create(m[12], m[13], m[14]);
+    Vector3 axis[3];
+    for (int i = 0; i < 3; i++) {
+      axis[i] = Vector3::Create(m[i * 4], m[i * 4 + 1], m[i * 4 + 2]);
+      scale[i] = axis[i].magnitude();
+      if (scale[i] > 0.f) {
+        axis[i] = axis[i] * (1.f / scale[i]);
+      }
+    }
+    if (Vector3::Dot(Vector3::Cross(axis[0], axis[1]), axis[2]) < 0.f) {
+      scale[0] = -scale[0];
+      axis[0] = -axis[0];
+    }
+    // Rotation matrix element (row r, column c) is axis[c][r]
+    float trace = axis[0][0] + axis[1][1] + axis[2][2];
+    if (trace > 0.f) {
+      float s = sqrtf(trace + 1.f) * 2.f;
+      rotation = Vector4::Create((axis[1][2] - axis[2][1]) / s, (axis[2][0] - axis[0][2]) / s, (axis[0][1] - axis[1][0]) / s, 0.25f * s);
+    } else if (axis[0][0] > axis[1][1] && axis[0][0] > axis[2][2]) {
+      float s = sqrtf(1.f + axis[0][0] - axis[1][1] - axis[2][2]) * 2.f;
+      rotation = Vector4::Create(0.25f * s, (axis[1][0] + axis[0][1]) / s, (axis[2][0] + axis[0][2]) / s, (axis[1][2] - axis[2][1]) / s);
+    } else if (axis[1][1] > axis[2][2]) {
+      float s = sqrtf(1.f + axis[1][1] - axis[0][0] - axis[2][2]) * 2.f;
+      rotation = Vector4::Create((axis[1][0] + axis[0][1]) / s, 0.25f * s, (axis[2][1] + axis[1][2]) / s, (axis[2][0] - axis[0][2]) / s);
+    } else {
+      float s = sqrtf(1.f + axis[2][2] - axis[0][0] - axis[1][1]) * 2.f;
+      rotation = Vector4::Create((axis[2][0] + axis[0][2]) / s, (axis[2][1] + axis[1][2]) / s, 0.25f * s, (axis[0][1] - axis[1][0]) / s);
+    }
+  }
+  node->setLocalTranslation(translation, true);
+  node->setLocalScale(scale, true);
+  // glTF rotations are stored as [x, y, z, w] quaternions
+  node->setLocalRotation(Quaternion::Create(rotation.w, rotation.x, rotation.y, rotation.z).eulerXYZ(), true);
+  parent->appendChild(node);
+
+  // The rest pose is kept to find animation channels that never leave it
+  source.translation = translation;
+  source.rotation = rotation;
+  source.scale = scale;
+
+  // Packs beyond the first, and meshes attached to bones, are placed in child models
+  if (meshNames) {
+    for (size_t i = isJoint ? 0 : firstChildMesh; i < meshNames->size(); i++) {
+      KRModel* model = new KRModel(scene, getUniqueNodeName(std::format("{}_mesh_{}", source.name, i)));
+      model->setMesh((*meshNames)[i]);
+      node->appendChild(model);
+    }
+  }
+
+  for (int child : source.children) {
+    createNode(child, node, materials);
+  }
+}
+
+void GltfImporter::createNodes(const std::vector<int>& roots, KRNode* parent, const std::vector<KRMaterial*>& materials)
+{
+  // Node names are assigned up front so that pack bone names match the bone nodes
+  for (GltfNode& node : m_nodes) {
+    node.name = getUniqueNodeName(node.name);
+  }
+  for (int root : roots) {
+    createNode(root, parent, materials);
+  }
+}
+
+void GltfImporter::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+  KRWorkerPool* pool = m_context.getWorkerPool();
+  if (pool && count > 1) {
+    pool->parallelFor(count, fn);
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+  }
+}
+
+void GltfImporter::decode()
+{
+  parallelFor(m_jobs.size(), [this](size_t i) {
+    m_jobs[i]();
+  });
+  m_jobs.clear();
+
+  if (m_invalidIndexes > 0) {
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: %i indexes were out of range and have been replaced.", (int)m_invalidIndexes);
+  }
+}
+
+void GltfImporter::finish(KRBundle* bundle)
+{
+  for (PendingMesh& pending : m_pendingMeshes) {
+    // Sparse substitutions are applied once the dense values have been decoded
+    for (const PendingMesh::Attribute& attribute : pending.attributes) {
+      applySparse(pending, attribute);
+    }
+    size_t invalidIndexes = 0;
+    for (const PendingMesh::FlatPrimitive& flat : pending.flatPrimitives) {
+      ExpandFlatPrimitive(pending, flat, &invalidIndexes);
+    }
+    pending.flatPrimitives.clear();
+    if (invalidIndexes > 0) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - GLTF: %i indexes were out of range and have been replaced.", (int)invalidIndexes);
+    }
+
+    if (!pending.hasExtents) {
+      for (int64_t i = 0; i < pending.vertexCount; i++) {
+        float p[3];
+        memcpy(p, pending.pack.vertexes + i * pending.vertexSize, sizeof(p));
+        Vector3 position = Vector3::Create(p[0], p[1], p[2]);
+        if (i == 0) {
+          pending.extents.min = position;
+          pending.extents.max = position;
+        } else {
+          pending.extents.encapsulate(position);
+        }
+      }
+    }
+
+    pending.mesh->endPack(pending.extents);
+    m_context.getMeshManager()->addMesh(pending.mesh);
+    pending.mesh->moveToBundle(bundle);
+  }
+  m_pendingMeshes.clear();
+}
+
+void GltfImporter::importAnimations(KRBundle* bundle)
+{
+  const float frameRate = (float)KRContext::KRENGINE_ANIMATION_FRAME_RATE;
+
+  // Decode the keys of every sampler
+  std::vector<GltfAnimationSampler*> samplers;
+  std::vector<GltfAnimationChannel*> channels;
+  std::vector<const GltfAnimation*> channelAnimations;
+  for (GltfAnimation& animation : m_animations) {
+    for (GltfAnimationSampler& sampler : animation.samplers) {
+      samplers.push_back(&sampler);
+    }
+    for (GltfAnimationChannel& channel : animation.channels) {
+      channels.push_back(&channel);
+      channelAnimations.push_back(&animation);
+    }
+  }
+  parallelFor(samplers.size(), [&](size_t i) {
+    GltfAnimationSampler& sampler = *samplers[i];
+    int inputComponents = 0;
+    sampler.valid = readAccessor(sampler.input, sampler.times, &inputComponents) && inputComponents == 1 &&
+      !sampler.times.empty() && readAccessor(sampler.output, sampler.values, &sampler.componentCount);
+  });
+
+  // Resample each channel over the time range of its sampler
+  parallelFor(channels.size(), [&](size_t i) {
+    GltfAnimationChannel& channel = *channels[i];
+    const std::vector<GltfAnimationSampler>& animationSamplers = channelAnimations[i]->samplers;
+    if (channel.sampler < 0 || channel.sampler >= (int)animationSamplers.size()) {
+      return;
+    }
+    const GltfAnimationSampler& sampler = animationSamplers[channel.sampler];
+    bool quaternion = channel.path == GLTF_PATH_ROTATION;
+    int keyStride = sampler.interpolation == GLTF_INTERPOLATION_CUBICSPLINE ? sampler.componentCount * 3 : sampler.componentCount;
+    if (!sampler.valid || sampler.componentCount != (quaternion ? 4 : 3) || sampler.values.size() != sampler.times.size() * keyStride) {
+      return;
+    }
+
+    channel.frameStart = (int)floorf(sampler.times.front() * frameRate);
+    channel.frameCount = (int)ceilf(sampler.times.back() * frameRate) - channel.frameStart + 1;
+    std::vector<float> values(channel.frameCount * sampler.componentCount);
+    ResampleKeys(sampler, quaternion, channel.frameStart, channel.frameCount, frameRate, values.data());
+
+    channel.frames.resize(channel.frameCount * 3);
+    for (int frame = 0; frame < channel.frameCount; frame++) {
+      Vector3 v;
+      if (quaternion) {
+        v = QuaternionToEulerDegrees(&values[frame * 4]);
+        if (frame > 0) {
+          // Choose the equivalent angles closest to the previous frame
+          for (int c = 0; c < 3; c++) {
+            float previous = channel.frames[c * channel.frameCount + frame - 1];
+            v[c] += 360.f * roundf((previous - v[c]) / 360.f);
+          }
+        }
+      } else {
+        v = Vector3::Create(values[frame * 3], values[frame * 3 + 1], values[frame * 3 + 2]);
+      }
+      for (int c = 0; c < 3; c++) {
+        channel.frames[c * channel.frameCount + frame] = v[c];
+      }
+    }
+    channel.valid = true;
+  });
+
+  static const KRNode::node_attribute_type kPathAttributes[3][3] = {
+    { KRNode::KRENGINE_NODE_ATTRIBUTE_TRANSLATE_X, KRNode::KRENGINE_NODE_ATTRIBUTE_TRANSLATE_Y, KRNode::KRENGINE_NODE_ATTRIBUTE_TRANSLATE_Z },
+    { KRNode::KRENGINE_NODE_ATTRIBUTE_ROTATE_X, KRNode::KRENGINE_NODE_ATTRIBUTE_ROTATE_Y, KRNode::KRENGINE_NODE_ATTRIBUTE_ROTATE_Z },
+    { KRNode::KRENGINE_NODE_ATTRIBUTE_SCALE_X, KRNode::KRENGINE_NODE_ATTRIBUTE_SCALE_Y, KRNode::KRENGINE_NODE_ATTRIBUTE_SCALE_Z }
+  };
+  static const char* kComponentNames[3][3] = {
+    { "translate_x", "translate_y", "translate_z" },
+    { "rotate_x", "rotate_y", "rotate_z" },
+    { "scale_x", "scale_y", "scale_z" }
+  };
+  auto nearlyEqual = [](float a, float b) {
+    return fabsf(a - b) <= 1e-5f * std::max(1.f, fabsf(b));
+  };
+
+  std::set<std::string> animationNames;
+  for (GltfAnimation& animation : m_animations) {
+    std::string animationName = animation.name;
+    for (int suffix = 1; animationNames.count(animationName); suffix++) {
+      animationName = std::format("{}_{}", animation.name, suffix);
+    }
+    animationNames.insert(animationName);
+
+    KRAnimation* newAnimation = new KRAnimation(m_context, animationName);
+    KRAnimationLayer* layer = new KRAnimationLayer(m_context);
+    layer->setName("default");
+    layer->setWeight(1.0f);
+    layer->setBlendMode(KRAnimationLayer::KRENGINE_ANIMATION_BLEND_MODE_OVERRIDE);
+    newAnimation->addLayer(layer);
+
+    float duration = 0.f;
+    for (GltfAnimationChannel& channel : animation.channels) {
+      const GltfNode& node = m_nodes[channel.node];
+      if (!channel.valid) {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Animation channel for node %s has an invalid sampler: %s", node.name.c_str(), animationName.c_str());
+        continue;
+      }
+      if (!node.created) {
+        continue;
+      }
+      duration = std::max(duration, animation.samplers[channel.sampler].times.back());
+
+      Vector3 rest = Vector3::Create(0.f, 0.f, 0.f);
+      switch (channel.path) {
+      case GLTF_PATH_TRANSLATION:
+        rest = node.translation;
+        break;
+      case GLTF_PATH_ROTATION:
+      {
+        float q[4] = { node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w };
+        rest = QuaternionToEulerDegrees(q);
+        break;
+      }
+      case GLTF_PATH_SCALE:
+        rest = node.scale;
+        break;
+      }
+
+      // As with KRAnimation::split, x, y and z are stripped together when none of them change.
+      // A constant component is kept as a single frame.
+      bool constant[3];
+      bool atRest = true;
+      for (int c = 0; c < 3; c++) {
+        const float* frames = &channel.frames[c * channel.frameCount];
+        constant[c] = true;
+        for (int frame = 1; frame < channel.frameCount && constant[c]; frame++) {
+          constant[c] = nearlyEqual(frames[frame], frames[0]);
+        }
+        atRest = atRest && constant[c] && nearlyEqual(frames[0], rest[c]);
+      }
+      if (atRest) {
+        continue;
+      }
+
+      for (int c = 0; c < 3; c++) {
+        std::string curveName = std::format("{}_{}_{}", animationName, node.name, kComponentNames[channel.path][c]);
+        KRAnimationCurve* curve = new KRAnimationCurve(m_context, curveName);
+        curve->setFrameRate(frameRate);
+        curve->setFrames(channel.frameStart, constant[c] ? 1 : channel.frameCount, &channel.frames[c * channel.frameCount]);
+        m_context.getAnimationCurveManager()->addAnimationCurve(curve);
+        curve->moveToBundle(bundle);
+
+        KRAnimationAttribute* attribute = new KRAnimationAttribute(m_context);
+        attribute->setCurveName(curveName);
+        attribute->setTargetName(node.name);
+        attribute->setTargetAttribute(kPathAttributes[channel.path][c]);
+        layer->addAttribute(attribute);
+      }
+    }
+
+    newAnimation->setDuration(duration);
+    m_context.getAnimationManager()->addAnimation(newAnimation);
+    newAnimation->moveToBundle(bundle);
+  }
+  m_animations.clear();
+}
+
+} // anonymous namespace
+
+KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std::vector<Block*>& buffers, const std::string& baseName)
 {
   std::string_view version;
   if (!tryJsonRequired(jsonRoot["asset"]["version"].get(version))) {
@@ -68,14 +1944,28 @@ KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std
       return nullptr;
     }
   }
-  
-  
+
+  GltfImporter importer(context, buffers, baseName);
+  if (!importer.parseBufferViews(jsonRoot) || !importer.parseAccessors(jsonRoot)) {
+    return nullptr;
+  }
+
+  KRBundle* bundle = new KRBundle(context, baseName);
+
   std::vector<KRTexture*> images;
   simdjson::ondemand::array jsonImages;
   if(tryJson(jsonRoot["images"].get_array().get(jsonImages))) {
     for (auto jsonImage : jsonImages) {
       KRTexture*& image = images.emplace_back();
       image = nullptr;
+      std::string imageName;
+      std::string_view imageNameVal;
+      if (tryJson(jsonImage["name"].get(imageNameVal))) {
+        imageName = imageNameVal;
+      } else {
+        // Name not found in JSON. Generate a fall-back name.
+        imageName = std::format("{}_image_{}", baseName, images.size() - 1);
+      }
       std::string_view uri;
       int bufferView = -1;
       if (tryJson(jsonImage["uri"].get(uri))) {
@@ -96,12 +1986,24 @@ KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std
           continue;
         }
         if (mimeType == "image/png") {
-          // TODO - Implement png loading from buffer view
-          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Loading PNG Images from a buffer view is not yet supported.");
-          continue;
+          const unsigned char* imageStart = nullptr;
+          size_t imageSize = 0;
+          if (!importer.getBufferView(bufferView, &imageStart, &imageSize)) {
+            KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Image with buffer view index out of range: %s", imageName.c_str());
+            continue;
+          }
+          // The texture outlives the glTF buffers, so it gets its own copy of the image
+          Block* imageData = new Block();
+          imageData->append((void*)imageStart, imageSize);
+          image = context.getTextureManager()->loadTexture(imageName.c_str(), "png", imageData);
+          if (image == nullptr) {
+            delete imageData;
+            continue;
+          }
+          image->moveToBundle(bundle);
         } else if (mimeType == "image/jpeg") {
           // TODO - Implement jpeg loading from buffer view
-          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Loading JPEG Images from a buffer view is not yet supported.");
+          KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: JPEG images are not supported: %s", imageName.c_str());
           continue;
         } else {
           std::string mimeTypeStr;
@@ -268,8 +2170,6 @@ KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std
     }
   }
 
-  KRBundle* bundle = new KRBundle(context, baseName);
-
   std::vector<KRMaterial*> materials;
   simdjson::ondemand::array jsonMaterials;
   if (tryJson(jsonRoot["materials"].get_array().get(jsonMaterials))) {
@@ -422,7 +2322,19 @@ KRBundle* LoadGltf(KRContext& context, simdjson::ondemand::object& jsonRoot, std
     }
   }
 
+  if (!importer.parseMeshes(jsonRoot) || !importer.parseSkins(jsonRoot) || !importer.parseNodes(jsonRoot)) {
+    return nullptr;
+  }
+  std::vector<int> roots = importer.parseSceneRoots(jsonRoot);
+  if (!importer.parseAnimations(jsonRoot)) {
+    return nullptr;
+  }
+
   KRScene* pScene = new KRScene(context, baseName + "_scene");
+  importer.createNodes(roots, pScene->getRootNode(), materials);
+  importer.decode();
+  importer.finish(bundle);
+  importer.importAnimations(bundle);
 
   context.getSceneManager()->add(pScene);
   KrResult result = pScene->moveToBundle(bundle);
@@ -437,55 +2349,120 @@ KRBundle* KRResource::LoadGltf(KRContext& context, const std::string& path)
 {
   std::string filePath = util::GetFilePath(path);
   std::string fileBase = util::GetFileBase(path);
-  std::string binFilePath = filePath + fileBase + ".bin";
 
-  Block jsonData;
-  Block binData;
-  if (!jsonData.load(path)) {
+  Block fileData;
+  if (!fileData.load(path)) {
     return nullptr;
   }
+  fileData.lock();
+
+  // A .glb file holds the JSON and the first buffer in chunks following a 12 byte header
+  const unsigned char* fileStart = (const unsigned char*)fileData.getStart();
+  size_t fileSize = fileData.getSize();
+  const char* json = (const char*)fileStart;
+  size_t jsonSize = fileSize;
+  Block* glbBuffer = nullptr;
+  uint32_t magic = 0;
+  if (fileSize >= 12) {
+    memcpy(&magic, fileStart, sizeof(magic));
+  }
+  if (magic == kGlbMagic) {
+    uint32_t header[3];
+    memcpy(header, fileStart, sizeof(header));
+    size_t glbSize = std::min((size_t)header[2], fileSize);
+    json = nullptr;
+    size_t offset = 12;
+    while (offset + 8 <= glbSize) {
+      uint32_t chunk[2];
+      memcpy(chunk, fileStart + offset, sizeof(chunk));
+      offset += 8;
+      if (chunk[0] > glbSize - offset) {
+        break;
+      }
+      if (chunk[1] == kGlbChunkJson && json == nullptr) {
+        json = (const char*)fileStart + offset;
+        jsonSize = chunk[0];
+      } else if (chunk[1] == kGlbChunkBin && glbBuffer == nullptr) {
+        glbBuffer = fileData.getSubBlock(offset, chunk[0]);
+      }
+      offset += (chunk[0] + 3) & ~3;
+    }
+    if (header[1] != 2 || json == nullptr) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Invalid GLB file: %s", path.c_str());
+      delete glbBuffer;
+      fileData.unlock();
+      return nullptr;
+    }
+  }
 
+  // The on-demand parser reads the document lazily, so the padded copy of the JSON is kept
+  // for the whole import
+  simdjson::padded_string jsonText(json, jsonSize);
   simdjson::ondemand::parser parser;
   simdjson::ondemand::document doc;
-  
-  jsonData.expand(SIMDJSON_PADDING);
-  jsonData.lock();
-  auto error = parser.iterate((const char*)jsonData.getStart(), jsonData.getSize()).get(doc);
-  jsonData.unlock();
-
+  auto error = parser.iterate(jsonText).get(doc);
   if (error) {
-    // TODO - Report and handle error
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Could not parse %s: %s", path.c_str(), simdjson::error_message(error));
+    delete glbBuffer;
+    fileData.unlock();
     return nullptr;
   }
   
   ondemand::object jsonRoot;
   error = doc.get_object().get(jsonRoot);
   if (error) {
-    // TODO - Report and handle error
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Could not parse %s: %s", path.c_str(), simdjson::error_message(error));
+    delete glbBuffer;
+    fileData.unlock();
     return nullptr;
   }
 
+  std::vector<Block*> buffers;
+  bool buffersLoaded = true;
   simdjson::ondemand::array jsonBuffers;
-  error = jsonRoot["buffers"].get_array().get(jsonBuffers);
-  if (error) {
-    // TODO - Report and handle error
-    return nullptr;
+  if (tryJson(jsonRoot["buffers"].get_array().get(jsonBuffers))) {
+    for (auto jsonBuffer : jsonBuffers) {
+      std::string_view bufferUri;
+      Block* block = nullptr;
+      if (tryJson(jsonBuffer["uri"].get_string().get(bufferUri))) {
+        block = new Block();
+        if (bufferUri.starts_with("data:")) {
+          size_t dataStart = bufferUri.find(";base64,");
+          if (dataStart == std::string_view::npos || !DecodeBase64(bufferUri.substr(dataStart + 8), *block)) {
+            KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Buffer data URI could not be decoded.");
+            buffersLoaded = false;
+          }
+        } else {
+          std::string bufferPath = filePath + DecodeUri(bufferUri);
+          if (!block->load(bufferPath)) {
+            KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Could not load buffer: %s", bufferPath.c_str());
+            buffersLoaded = false;
+          }
+        }
+      } else if (buffers.empty() && glbBuffer) {
+        // The first buffer of a .glb file without a uri refers to the BIN chunk
+        block = glbBuffer;
+        glbBuffer = nullptr;
+      } else {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - GLTF: Buffer without a uri could not be loaded.");
+        buffersLoaded = false;
+        block = new Block();
+      }
+      block->lock();
+      buffers.push_back(block);
+    }
   }
 
-  std::vector<Block> buffers;
-  for (auto jsonBuffer : jsonBuffers) {
-    std::string_view bufferUri;
-    error = jsonBuffer["uri"].get_string().get(bufferUri);
-    if (error) {
-      // TODO - Report and handle error
-      return nullptr;
-    }
-    Block& block = buffers.emplace_back();
-    if (!block.load(std::string(bufferUri))) {
-      // TODO - Report and handle error
-      return nullptr;
-    }
+  KRBundle* bundle = nullptr;
+  if (buffersLoaded) {
+    bundle = ::LoadGltf(context, jsonRoot, buffers, fileBase);
   }
 
-  return ::LoadGltf(context, jsonRoot, buffers, fileBase);
+  for (Block* buffer : buffers) {
+    buffer->unlock();
+    delete buffer;
+  }
+  delete glbBuffer;
+  fileData.unlock();
+  return bundle;
 }
@@ -29,338 +29,483 @@
 //  or implied, of Kearwood Gilbert.
 //
 
+
 #include "KREngine-common.h"
 
 #include "KRResource.h"
+#include "KRWorkerPool.h"
 #include "mesh/KRMesh.h"
 
 #include "mimir.h"
 
+#include <charconv>
+#include <tuple>
+
 using namespace mimir;
 using namespace hydra;
 
-KRMesh* KRResource::LoadObj(KRContext& context, const std::string& path)
-{
-  KRMesh* new_mesh = new KRMesh(context, util::GetFileBase(path));
+namespace {
 
-  KRMesh::mesh_info mi;
-
-  std::vector<std::string> material_names_t;
-
-  Block data;
+// The elements defined and the triangles referencing them within one chunk of the file
+struct ObjChunk
+{
+  const char* start = nullptr;
+  const char* end = nullptr;
+
+  std::vector<float> positions; // x, y, z
+  std::vector<float> texcoords; // u, v
+  std::vector<float> normals; // x, y, z
+
+  // Position, texcoord and normal index for each triangle corner.  Missing indexes are -1.
+  std::vector<int> corners;
+  // Corners holding negative (relative) OBJ indexes, which are local to the chunk until the
+  // element counts of the preceding chunks are known
+  std::vector<size_t> relativeCorners;
+  // First triangle corner and name of each usemtl statement
+  std::vector<std::pair<size_t, std::string>> materials;
+};
+
+// A welded vertex; vertexes are identical when all of their bytes match
+struct ObjVertex
+{
+  float position[3];
+  float normal[3];
+  float texcoord[2];
 
-  char szSymbol[500][256];
+  bool operator==(const ObjVertex& other) const
+  {
+    return memcmp(this, &other, sizeof(ObjVertex)) == 0;
+  }
+};
 
-  int* pFaces = NULL;
+struct ObjVertexHash
+{
+  size_t operator()(const ObjVertex& v) const
+  {
+    // FNV-1a over the 32-bit words of the vertex
+    uint32_t words[sizeof(ObjVertex) / sizeof(uint32_t)];
+    memcpy(words, &v, sizeof(words));
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t word : words) {
+      hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    return (size_t)(hash ^ (hash >> 32));
+  }
+};
 
-  vector<KRMesh::pack_material*> m_materials;
+struct ObjSubmesh
+{
+  std::string name;
+  // Ranges of triangle corners, as (chunk, first corner, end corner)
+  std::vector<std::tuple<size_t, size_t, size_t>> runs;
 
-  if (data.load(path)) {
-    //  -----=====----- Get counts -----=====----- 
+  std::vector<ObjVertex> vertexes;
+  std::vector<__uint32_t> indexes;
+  size_t invalidTriangles = 0;
+};
 
-    int cVertexData = 0;
+const char* SkipSpaces(const char* p, const char* end)
+{
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    p++;
+  }
+  return p;
+}
 
+const char* SkipToken(const char* p, const char* end)
+{
+  while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+    p++;
+  }
+  return p;
+}
 
-    int cFaces = 1;
-    int cMaterialFaceStart = 1;
+const char* ParseFloat(const char* p, const char* end, float* value)
+{
+  p = SkipSpaces(p, end);
+  if (p < end && *p == '+') {
+    p++;
+  }
+  std::from_chars_result result = std::from_chars(p, end, *value);
+  if (result.ec != std::errc()) {
+    *value = 0.f;
+    return SkipToken(p, end);
+  }
+  return result.ptr;
+}
 
-    char* pScan = (char*)data.getStart();
-    char* pEnd = (char*)data.getEnd();
-    while (pScan < pEnd) {
+// Parses one of the slash separated indexes of a face vertex.  Positive OBJ indexes are
+// 1-based; negative indexes count back from the last element defined so far.
+const char* ParseIndex(const char* p, const char* end, size_t localCount, int* index, bool* relative)
+{
+  int value = 0;
+  std::from_chars_result result = std::from_chars(p, end, value);
+  *relative = false;
+  if (result.ec != std::errc() || value == 0) {
+    *index = -1;
+  } else if (value > 0) {
+    *index = value - 1;
+  } else {
+    *index = (int)localCount + value;
+    *relative = true;
+  }
+  return result.ec == std::errc() ? result.ptr : p;
+}
 
-      // Scan through whitespace
-      while (pScan < pEnd && (*pScan == ' ' || *pScan == '\t' || *pScan == '\r' || *pScan == '\n')) {
-        pScan++;
+void ParseChunk(ObjChunk& chunk)
+{
+  const char* p = chunk.start;
+  const char* end = chunk.end;
+  std::vector<int> face;
+  std::vector<bool> faceRelative;
+
+  while (p < end) {
+    p = SkipSpaces(p, end);
+    const char* token = p;
+    p = SkipToken(p, end);
+    std::string_view keyword(token, p - token);
+
+    if (keyword == "v") {
+      float v[3];
+      for (int i = 0; i < 3; i++) {
+        p = ParseFloat(p, end, &v[i]);
       }
-
-      if (*pScan == '#') {
-        // Line is a comment line
-
-        // Scan to the end of the line
-        while (pScan < pEnd && *pScan != '\r' && *pScan != '\n') {
-          pScan++;
+      chunk.positions.insert(chunk.positions.end(), v, v + 3);
+    } else if (keyword == "vt") {
+      float v[2];
+      for (int i = 0; i < 2; i++) {
+        p = ParseFloat(p, end, &v[i]);
+      }
+      chunk.texcoords.insert(chunk.texcoords.end(), v, v + 2);
+    } else if (keyword == "vn") {
+      float v[3];
+      for (int i = 0; i < 3; i++) {
+        p = ParseFloat(p, end, &v[i]);
+      }
+      chunk.normals.insert(chunk.normals.end(), v, v + 3);
+    } else if (keyword == "f") {
+      face.clear();
+      faceRelative.clear();
+      size_t localCounts[3] = { chunk.positions.size() / 3, chunk.texcoords.size() / 2, chunk.normals.size() / 3 };
+      while (true) {
+        p = SkipSpaces(p, end);
+        if (p >= end || *p == '\r' || *p == '\n') {
+          break;
         }
-      } else {
-        int cSymbols = 0;
-        while (pScan < pEnd && *pScan != '\n' && *pScan != '\r') {
-
-          char* pDest = szSymbol[cSymbols++];
-          while (pScan < pEnd && *pScan != ' ' && *pScan != '\n' && *pScan != '\r') {
-            *pDest++ = *pScan++;
-          }
-          *pDest = '\0';
-
-          // Scan through whitespace, but don't advance to next line
-          while (pScan < pEnd && (*pScan == ' ' || *pScan == '\t')) {
-            pScan++;
+        // v, v/vt, v//vn or v/vt/vn
+        for (int i = 0; i < 3; i++) {
+          int index = -1;
+          bool relative = false;
+          if (i == 0 || (p < end && *p == '/')) {
+            if (i > 0) {
+              p++;
+            }
+            p = ParseIndex(p, end, localCounts[i], &index, &relative);
           }
+          face.push_back(index);
+          faceRelative.push_back(relative);
         }
+        p = SkipToken(p, end);
+      }
 
-        if (strcmp(szSymbol[0], "v") == 0) {
-          // Vertex (v)
-        } else if (strcmp(szSymbol[0], "vt") == 0) {
-          // Vertex Texture UV Coordinate (vt)
-        } else if (strcmp(szSymbol[0], "vn") == 0) {
-          // Vertex Normal (vn)
-        } else if (strcmp(szSymbol[0], "f") == 0) {
-          // Face (f)
-          int cFaceVertexes = (cSymbols - 3) * 3; // 3 vertexes per triangle.  Triangles have 4 symbols.  Quads have 5 symbols and generate two triangles.
-          cVertexData += cFaceVertexes;
-          cFaces += cFaceVertexes * 3 + 1; // Allocate space for count of vertices, Vertex Index, Texture Coordinate Index, and Normal Index
-
-        } else if (strcmp(szSymbol[0], "usemtl") == 0) {
-          // Use Material (usemtl)
-          if (cMaterialFaceStart - cFaces > 0) {
-            cFaces++;
-
+      // Polygons are split into a fan of triangles
+      int faceVertexCount = (int)face.size() / 3;
+      for (int i = 2; i < faceVertexCount; i++) {
+        int triangle[3] = { 0, i - 1, i };
+        for (int corner : triangle) {
+          for (int c = 0; c < 3; c++) {
+            if (faceRelative[corner * 3 + c]) {
+              chunk.relativeCorners.push_back(chunk.corners.size());
+            }
+            chunk.corners.push_back(face[corner * 3 + c]);
           }
-          material_names_t.push_back(std::string(szSymbol[1]));
         }
-
       }
+    } else if (keyword == "usemtl") {
+      p = SkipSpaces(p, end);
+      const char* name = p;
+      while (p < end && *p != '\r' && *p != '\n') {
+        p++;
+      }
+      const char* nameEnd = p;
+      while (nameEnd > name && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t')) {
+        nameEnd--;
+      }
+      chunk.materials.emplace_back(chunk.corners.size(), std::string(name, nameEnd - name));
     }
 
+    // Comments and unsupported statements are skipped to the end of the line
+    while (p < end && *p != '\n') {
+      p++;
+    }
+    if (p < end) {
+      p++;
+    }
+  }
+}
 
-    //  -----=====-----  Populate vertexes and faces -----=====----- 
-
-    int* pFaces = (int*)malloc(sizeof(int) * (cFaces + 1));
-    assert(pFaces != NULL);
-
-    std::vector<Vector3> indexed_vertices;
-    std::vector<Vector2> indexed_uva;
-    std::vector<Vector3> indexed_normals;
-
-    int* pFace = pFaces;
-    int* pMaterialFaces = pFace++;
-    *pMaterialFaces = 0;
-
-
-
-
-    // --------
+} // anonymous namespace
 
-    pScan = (char*)data.getStart();
-    while (pScan < pEnd) {
+KRMesh* KRResource::LoadObj(KRContext& context, const std::string& path, size_t chunkSize)
+{
+  KRMesh* new_mesh = new KRMesh(context, util::GetFileBase(path));
 
-      // Scan through whitespace
-      while (pScan < pEnd && (*pScan == ' ' || *pScan == '\t' || *pScan == '\r' || *pScan == '\n')) {
-        pScan++;
+  Block data;
+  if (!data.load(path)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - OBJ: Could not load: %s", path.c_str());
+    return new_mesh;
+  }
+  data.lock();
+  const char* fileStart = (const char*)data.getStart();
+  const char* fileEnd = fileStart + data.getSize();
+
+  KRWorkerPool* pool = context.getWorkerPool();
+  auto parallelFor = [pool](size_t count, const std::function<void(size_t)>& fn) {
+    if (pool && count > 1) {
+      pool->parallelFor(count, fn);
+    } else {
+      for (size_t i = 0; i < count; i++) {
+        fn(i);
       }
+    }
+  };
 
-      if (*pScan == '#') {
-        // Line is a comment line
+  //  -----=====----- Parse chunks in parallel -----=====-----
 
-        // Scan to the end of the line
-        while (pScan < pEnd && *pScan != '\r' && *pScan != '\n') {
-          pScan++;
+  std::vector<ObjChunk> chunks;
+  const char* chunkStart = fileStart;
+  while (chunkStart < fileEnd) {
+    const char* chunkEnd = fileEnd;
+    if ((size_t)(fileEnd - chunkStart) > chunkSize) {
+      chunkEnd = (const char*)memchr(chunkStart + chunkSize, '\n', fileEnd - chunkStart - chunkSize);
+      chunkEnd = chunkEnd ? chunkEnd + 1 : fileEnd;
+    }
+    ObjChunk& chunk = chunks.emplace_back();
+    chunk.start = chunkStart;
+    chunk.end = chunkEnd;
+    chunkStart = chunkEnd;
+  }
+  parallelFor(chunks.size(), [&chunks](size_t i) {
+    ParseChunk(chunks[i]);
+  });
+
+  //  -----=====----- Merge chunks -----=====-----
+
+  std::vector<float> positions;
+  std::vector<float> texcoords;
+  std::vector<float> normals;
+  std::vector<ObjSubmesh> submeshes;
+  std::map<std::string, size_t> submeshIndexes;
+  std::string material_name;
+  size_t elementCounts[3] = {};
+  for (size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++) {
+    ObjChunk& chunk = chunks[chunkIndex];
+
+    // Relative indexes become absolute once the elements of earlier chunks are counted
+    for (size_t corner : chunk.relativeCorners) {
+      chunk.corners[corner] += (int)elementCounts[corner % 3];
+    }
+    positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+    texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+    normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    elementCounts[0] += chunk.positions.size() / 3;
+    elementCounts[1] += chunk.texcoords.size() / 2;
+    elementCounts[2] += chunk.normals.size() / 3;
+    std::vector<float>().swap(chunk.positions);
+    std::vector<float>().swap(chunk.texcoords);
+    std::vector<float>().swap(chunk.normals);
+
+    // Triangles using the same material are gathered into a single submesh
+    size_t runStart = 0;
+    for (size_t i = 0; i <= chunk.materials.size(); i++) {
+      size_t runEnd = i < chunk.materials.size() ? chunk.materials[i].first : chunk.corners.size();
+      if (runEnd > runStart) {
+        auto itr = submeshIndexes.find(material_name);
+        if (itr == submeshIndexes.end()) {
+          itr = submeshIndexes.emplace(material_name, submeshes.size()).first;
+          submeshes.emplace_back().name = material_name;
         }
-      } else {
-        int cSymbols = 0;
-        while (pScan < pEnd && *pScan != '\n' && *pScan != '\r') {
+        submeshes[itr->second].runs.emplace_back(chunkIndex, runStart, runEnd);
+      }
+      if (i < chunk.materials.size()) {
+        material_name = chunk.materials[i].second;
+        runStart = runEnd;
+      }
+    }
+  }
 
-          char* pDest = szSymbol[cSymbols++];
-          while (pScan < pEnd && *pScan != ' ' && *pScan != '\n' && *pScan != '\r') {
-            *pDest++ = *pScan++;
+  //  -----=====----- Weld vertexes of each submesh in parallel -----=====-----
+
+  bool hasTexcoords = !texcoords.empty();
+  size_t positionCount = positions.size() / 3;
+  size_t texcoordCount = texcoords.size() / 2;
+  size_t normalCount = normals.size() / 3;
+  parallelFor(submeshes.size(), [&](size_t submeshIndex) {
+    ObjSubmesh& submesh = submeshes[submeshIndex];
+    std::unordered_map<ObjVertex, __uint32_t, ObjVertexHash> vertexIndexes;
+    for (auto& run : submesh.runs) {
+      const std::vector<int>& corners = chunks[std::get<0>(run)].corners;
+      for (size_t triangle = std::get<1>(run); triangle < std::get<2>(run); triangle += 9) {
+        ObjVertex vertexes[3];
+        memset(vertexes, 0, sizeof(vertexes));
+        bool valid = true;
+        bool hasNormals = true;
+        for (int i = 0; i < 3; i++) {
+          const int* corner = &corners[triangle + i * 3];
+          if (corner[0] < 0 || corner[0] >= (int)positionCount) {
+            valid = false;
+            break;
           }
-          *pDest = '\0';
-
-          // Scan through whitespace, but don't advance to next line
-          while (pScan < pEnd && (*pScan == ' ' || *pScan == '\t')) {
-            pScan++;
+          memcpy(vertexes[i].position, &positions[corner[0] * 3], sizeof(float) * 3);
+          if (corner[1] >= 0 && corner[1] < (int)texcoordCount) {
+            memcpy(vertexes[i].texcoord, &texcoords[corner[1] * 2], sizeof(float) * 2);
+          }
+          if (corner[2] >= 0 && corner[2] < (int)normalCount) {
+            Vector3 normal = Vector3::Normalize(Vector3::Create(normals[corner[2] * 3], normals[corner[2] * 3 + 1], normals[corner[2] * 3 + 2]));
+            vertexes[i].normal[0] = normal.x;
+            vertexes[i].normal[1] = normal.y;
+            vertexes[i].normal[2] = normal.z;
+          } else {
+            hasNormals = false;
           }
         }
-
-        if (strcmp(szSymbol[0], "v") == 0) {
-          // Vertex (v)
-          float x, y, z;
-          char* pChar = szSymbol[1];
-          x = strtof(pChar, &pChar);
-          pChar = szSymbol[2];
-          y = strtof(pChar, &pChar);
-          pChar = szSymbol[3];
-          z = strtof(pChar, &pChar);
-          indexed_vertices.push_back(Vector3::Create(x, y, z));
-        } else if (strcmp(szSymbol[0], "vt") == 0) {
-          // Vertex Texture UV Coordinate (vt)
-          char* pChar = szSymbol[1];
-          float u, v;
-
-          u = strtof(pChar, &pChar);
-          pChar = szSymbol[2];
-          v = strtof(pChar, &pChar);
-          indexed_uva.push_back(Vector2::Create(u, v));
-        } else if (strcmp(szSymbol[0], "vn") == 0) {
-          // Vertex Normal (vn)
-          float x, y, z;
-          char* pChar = szSymbol[1];
-          x = strtof(pChar, &pChar);
-          pChar = szSymbol[2];
-          y = strtof(pChar, &pChar);
-          pChar = szSymbol[3];
-          z = strtof(pChar, &pChar);
-          indexed_normals.push_back(Vector3::Create(x, y, z));
-        } else if (strcmp(szSymbol[0], "f") == 0) {
-          // Face (f)
-          int cFaceVertices = cSymbols - 1;
-
-          *pFace++ = cFaceVertices;
-          for (int iSymbol = 1; iSymbol < cSymbols; iSymbol++) {
-            char* pChar = szSymbol[iSymbol];
-            if (*pChar == '.' || (*pChar >= '0' && *pChar <= '9')) {
-              *pFace++ = (int)strtol(pChar, &pChar, 10) - 1; // Vertex Index
-
-              if (*pChar == '/') {
-                pChar++;
-                if (*pChar == '/') {
-                  *pFace++ = -1;
-                } else {
-                  *pFace++ = (int)strtol(pChar, &pChar, 10) - 1; // Texture Coordinate Index
-                }
-              } else {
-                *pFace++ = -1;
-              }
-
-              if (*pChar == '/') {
-                pChar++;
-                if (*pChar == '/') {
-                  *pFace++ = -1;
-                } else {
-                  *pFace++ = (int)strtol(pChar, &pChar, 10) - 1; // Normal Index
-                }
-              } else {
-                *pFace++ = -1;
-              }
-              while (*pChar == '/') {
-                pChar++;
-                strtol(pChar, &pChar, 10);
-              }
-            }
+        if (!valid) {
+          submesh.invalidTriangles++;
+          continue;
+        }
+        if (!hasNormals) {
+          // Note - We don't take into consideration smoothing groups or smoothing angles when generating normals; all generated normals represent flat shaded polygons
+          Vector3 p0 = Vector3::Create(vertexes[0].position[0], vertexes[0].position[1], vertexes[0].position[2]);
+          Vector3 p1 = Vector3::Create(vertexes[1].position[0], vertexes[1].position[1], vertexes[1].position[2]);
+          Vector3 p2 = Vector3::Create(vertexes[2].position[0], vertexes[2].position[1], vertexes[2].position[2]);
+          Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+          normal.normalize();
+          for (int i = 0; i < 3; i++) {
+            vertexes[i].normal[0] = normal.x;
+            vertexes[i].normal[1] = normal.y;
+            vertexes[i].normal[2] = normal.z;
           }
-
-
-        } else if (strcmp(szSymbol[0], "usemtl") == 0) {
-          // Use Material (usemtl)
-          if (pFace - pMaterialFaces > 1) {
-            *pMaterialFaces = (int)(pFace - pMaterialFaces - 1);
-            pMaterialFaces = pFace++;
+        }
+        for (int i = 0; i < 3; i++) {
+          auto inserted = vertexIndexes.emplace(vertexes[i], (__uint32_t)submesh.vertexes.size());
+          if (inserted.second) {
+            submesh.vertexes.push_back(vertexes[i]);
           }
+          submesh.indexes.push_back(inserted.first->second);
         }
       }
     }
-
-
-    *pMaterialFaces = (int)(pFace - pMaterialFaces - 1);
-    *pFace++ = 0;
-
-
-    int iVertex = 0;
-
-
-    std::vector<std::string>::iterator material_itr = material_names_t.begin();
-    KRMesh::pack_material* pMaterial = new KRMesh::pack_material();
-    pMaterial->start_vertex = iVertex;
-    pMaterial->vertex_count = 0;
-    memset(pMaterial->szName, 0, 256);
-    if (material_itr < material_names_t.end()) {
-      strncpy(pMaterial->szName, (*material_itr++).c_str(), 256);
+  });
+
+  //  -----=====----- Write the pack -----=====-----
+
+  size_t invalidTriangles = 0;
+  size_t totalVertexCount = 0;
+  size_t totalIndexCount = 0;
+  IndexFormat index_format = IndexFormat::uint16;
+  for (size_t i = 0; i < submeshes.size(); i++) {
+    invalidTriangles += submeshes[i].invalidTriangles;
+    if (submeshes[i].indexes.empty()) {
+      submeshes.erase(submeshes.begin() + i--);
+      continue;
     }
-    m_materials.push_back(pMaterial);
-
-
-    pFace = pFaces;
-    while (*pFace != 0 && iVertex < cVertexData) {
-      pMaterial->start_vertex = iVertex;
-
-      int* pMaterialEndFace = pFace + *pFace;
-      ++pFace;
-      while (pFace < pMaterialEndFace && iVertex < cVertexData) {
-        int cFaceVertexes = *pFace;
-        Vector3 firstFaceVertex;
-        Vector3 prevFaceVertex;
-        Vector3 firstFaceNormal;
-        Vector3 prevFaceNormal;
-        Vector2 firstFaceUva;
-        Vector2 prevFaceUva;
-        for (int iFaceVertex = 0; iFaceVertex < cFaceVertexes; iFaceVertex++) {
-          if (iFaceVertex > 2) {
-            // There have already been 3 vertices.  Now we need to split the quad into a second triangle composed of the 1st, 3rd, and 4th vertices
-            iVertex += 2;
-
-            mi.vertices.push_back(firstFaceVertex);
-            mi.texcoord[0].push_back(firstFaceUva);
-            mi.normals.push_back(firstFaceNormal);
-
-            mi.vertices.push_back(prevFaceVertex);
-            mi.texcoord[0].push_back(prevFaceUva);
-            mi.normals.push_back(prevFaceNormal);
-          }
-          Vector3 vertex = indexed_vertices[pFace[iFaceVertex * 3 + 1]];
-          Vector2 new_uva;
-          if (pFace[iFaceVertex * 3 + 2] >= 0) {
-            new_uva = indexed_uva[pFace[iFaceVertex * 3 + 2]];
-          }
-          Vector3 normal;
-          if (pFace[iFaceVertex * 3 + 3] >= 0) {
-            Vector3 normal = indexed_normals[pFace[iFaceVertex * 3 + 3]];
-          }
-
-          mi.vertices.push_back(vertex);
-          mi.texcoord[0].push_back(new_uva);
-          mi.normals.push_back(normal);
+    totalVertexCount += submeshes[i].vertexes.size();
+    totalIndexCount += submeshes[i].indexes.size();
+    if (submeshes[i].vertexes.size() > 0xffff) {
+      index_format = IndexFormat::uint32;
+    }
+  }
+  if (invalidTriangles > 0) {
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Kraken - OBJ: %i triangles with invalid vertex indexes were skipped: %s", (int)invalidTriangles, path.c_str());
+  }
+  if (submeshes.empty()) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Kraken - OBJ: No triangles found: %s", path.c_str());
+    data.unlock();
+    return new_mesh;
+  }
 
-          if (iFaceVertex == 0) {
-            firstFaceVertex = vertex;
-            firstFaceUva = new_uva;
-            firstFaceNormal = normal;
-          }
-          prevFaceVertex = vertex;
-          prevFaceUva = new_uva;
-          prevFaceNormal = normal;
+  PrimitiveInfo primitive = {};
+  VertexAttributeInfo* attribute = primitive.layout.attributes;
+  attribute->attribute = VertexAttribute::position;
+  attribute->type = DataType::vec3;
+  attribute->component = ComponentType::float32;
+  attribute->normalization = Normalization::none;
+  attribute++;
+  attribute->attribute = VertexAttribute::normal;
+  attribute->type = DataType::vec3;
+  attribute->component = ComponentType::float16;
+  attribute->normalization = Normalization::none;
+  attribute++;
+  if (hasTexcoords) {
+    attribute->attribute = VertexAttribute::texcoord;
+    attribute->type = DataType::vec2;
+    attribute->component = ComponentType::float32;
+    attribute->normalization = Normalization::none;
+    attribute++;
+  }
+  for (int i = 0; i < kMaxAttributes && primitive.layout.attributes[i].component != ComponentType::empty; i++) {
+    primitive.layout.offsets[i] = primitive.layout.vertexSize;
+    primitive.layout.vertexSize += ComponentSize[(int)primitive.layout.attributes[i].component] * DataTypeComponentCount[(int)primitive.layout.attributes[i].type];
+  }
+  primitive.layout.topology = Topology::Triangles;
+  primitive.vertexCount = (int)totalVertexCount;
+  primitive.indexCount = (int)totalIndexCount;
+
+  // Each submesh is drawn from its own index group
+  KRMesh::PackData pack = new_mesh->beginPack(primitive, index_format, (int)submeshes.size(), 0, (int)submeshes.size());
+  std::vector<size_t> startVertexes(submeshes.size());
+  std::vector<size_t> startIndexes(submeshes.size());
+  size_t startVertex = 0;
+  size_t startIndex = 0;
+  for (size_t i = 0; i < submeshes.size(); i++) {
+    KRMesh::pack_material* pPackMaterial = pack.submeshes + i;
+    pPackMaterial->index_group = (uint16_t)i;
+    pPackMaterial->index_group_offset = 0;
+    pPackMaterial->vertex_count = (int)submeshes[i].indexes.size();
+    memset(pPackMaterial->szName, 0, KRENGINE_MAX_NAME_LENGTH);
+    strncpy(pPackMaterial->szName, submeshes[i].name.c_str(), KRENGINE_MAX_NAME_LENGTH);
+    pack.indexBases[i * 2] = (__uint32_t)startIndex;
+    pack.indexBases[i * 2 + 1] = (__uint32_t)startVertex;
+    startVertexes[i] = startVertex;
+    startIndexes[i] = startIndex;
+    startVertex += submeshes[i].vertexes.size();
+    startIndex += submeshes[i].indexes.size();
+  }
 
-          iVertex++;
-        }
-        pFace += cFaceVertexes * 3 + 1;
-      }
-      pMaterial->vertex_count = iVertex - pMaterial->start_vertex;
-      if (*pFace != 0) {
-        pMaterial = new KRMesh::pack_material();
-        pMaterial->start_vertex = iVertex;
-        pMaterial->vertex_count = 0;
-        memset(pMaterial->szName, 0, 256);
-
-        if (material_itr < material_names_t.end()) {
-          strncpy(pMaterial->szName, (*material_itr++).c_str(), 256);
-        }
-        m_materials.push_back(pMaterial);
+  parallelFor(submeshes.size(), [&](size_t i) {
+    const ObjSubmesh& submesh = submeshes[i];
+    for (size_t v = 0; v < submesh.vertexes.size(); v++) {
+      const ObjVertex& vertex = submesh.vertexes[v];
+      int index = (int)(startVertexes[i] + v);
+      new_mesh->setVertexPosition(index, Vector3::Create(vertex.position[0], vertex.position[1], vertex.position[2]));
+      new_mesh->setVertexNormal(index, Vector3::Create(vertex.normal[0], vertex.normal[1], vertex.normal[2]));
+      if (hasTexcoords) {
+        new_mesh->setVertexTexCoord(index, 0, Vector2::Create(vertex.texcoord[0], vertex.texcoord[1]));
       }
     }
-
-    for (int iMaterial = 0; iMaterial < m_materials.size(); iMaterial++) {
-      KRMesh::pack_material* pNewMaterial = m_materials[iMaterial];
-      if (pNewMaterial->vertex_count > 0) {
-        mi.material_names.push_back(std::string(pNewMaterial->szName));
-        mi.submesh_starts.push_back(pNewMaterial->start_vertex);
-        mi.submesh_lengths.push_back(pNewMaterial->vertex_count);
+    for (size_t j = 0; j < submesh.indexes.size(); j++) {
+      new_mesh->setIndex((int)(startIndexes[i] + j), submesh.indexes[j]);
+    }
+  });
+
+  AABB extents;
+  bool firstVertex = true;
+  for (const ObjSubmesh& submesh : submeshes) {
+    for (const ObjVertex& vertex : submesh.vertexes) {
+      Vector3 position = Vector3::Create(vertex.position[0], vertex.position[1], vertex.position[2]);
+      if (firstVertex) {
+        firstVertex = false;
+        extents.min = position;
+        extents.max = position;
+      } else {
+        extents.encapsulate(position);
       }
-      delete pNewMaterial;
     }
-
-    // TODO: Bones not yet supported for OBJ
-//        std::vector<std::string> bone_names;
-//        std::vector<Matrix4> bone_bind_poses;
-//        std::vector<std::vector<int> > bone_indexes;
-//        std::vector<std::vector<float> > bone_weights;
-//        
-//        std::vector<__uint16_t> vertex_indexes;
-//        std::vector<std::pair<int, int> > vertex_index_bases;
-
-    mi.format = Topology::Triangles;
-    new_mesh->LoadData(mi, true, false);
   }
 
-  if (pFaces) {
-    free(pFaces);
-  }
+  // TODO: Bones not yet supported for OBJ
+  new_mesh->endPack(extents);
+  data.unlock();
 
   return new_mesh;
 }
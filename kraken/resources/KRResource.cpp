@@ -33,13 +33,16 @@
 #include "KRResource.h"
 #include "resources/bundle/KRBundle.h"
 #include "KRContext.h"
+#include "KRResourceLoader.h"
 
 using namespace mimir;
 
 KRResource::KRResource(KRContext& context, std::string name) : KRContextObject(context)
 {
   m_name = name;
-  context.addResource(this, name);
+  if (!KRResourceLoader::DeferRegistration(this)) {
+    context.addResource(this, name);
+  }
 }
 KRResource::~KRResource()
 {
@@ -57,7 +57,9 @@ public:
 
   virtual ~KRResource();
 
-  static KRMesh* LoadObj(KRContext& context, const std::string& path);
+  // The file is split at line boundaries into chunks of about chunkSize bytes, which are
+  // parsed in parallel
+  static KRMesh* LoadObj(KRContext& context, const std::string& path, size_t chunkSize = 0x400000);
 #if !TARGET_OS_IPHONE
   //    static KRScene* LoadFbx(KRContext &context, const std::string& path); TODO, FINDME, HACK! - Uncomment
   static KRScene* LoadBlenderScene(KRContext& context, const std::string& path);
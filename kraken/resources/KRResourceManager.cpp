@@ -31,6 +31,7 @@
 
 #include "KRResourceManager.h"
 #include "KREngine-common.h"
+#include "KRContext.h"
 
 KRResourceManager::KRResourceManager(KRContext& context) : KRContextObject(context)
 {
@@ -41,3 +42,8 @@ KRResourceManager::~KRResourceManager()
 {
 
 }
+
+bool KRResourceManager::loadDeferredResources(const std::string& name)
+{
+  return m_pContext->getBundleManager()->loadDeferredResources(name);
+}
@@ -45,4 +45,9 @@ public:
 
   virtual KRResource* loadResource(const std::string& name, const std::string& extension, mimir::Block* data) = 0;
   virtual KRResource* getResource(const std::string& name, const std::string& extension) = 0;
+
+protected:
+  // Loads resources with the given name that bundles deferred until first use.
+  // Returns true if any resources were loaded.
+  bool loadDeferredResources(const std::string& name);
 };
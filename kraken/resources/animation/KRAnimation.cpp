@@ -87,9 +87,15 @@ bool KRAnimation::save(Block& data)
 KRAnimation* KRAnimation::Load(KRContext& context, const std::string& name, Block* data)
 {
   std::string xml_string = data->getString();
+  delete data;
 
   tinyxml2::XMLDocument doc;
   doc.Parse(xml_string.c_str());
+  return Load(context, name, doc);
+}
+
+KRAnimation* KRAnimation::Load(KRContext& context, const std::string& name, tinyxml2::XMLDocument& doc)
+{
   KRAnimation* new_animation = new KRAnimation(context, name);
 
   tinyxml2::XMLElement* animation_node = doc.RootElement();
@@ -124,7 +130,6 @@ KRAnimation* KRAnimation::Load(KRContext& context, const std::string& name, Bloc
 
   //    KRNode *n = KRNode::LoadXML(*new_scene, scene_element->FirstChildElement());
 
-  delete data;
   return new_animation;
 }
 
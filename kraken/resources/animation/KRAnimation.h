@@ -49,6 +49,7 @@ public:
   virtual bool save(mimir::Block& data);
 
   static KRAnimation* Load(KRContext& context, const std::string& name, mimir::Block* data);
+  static KRAnimation* Load(KRContext& context, const std::string& name, tinyxml2::XMLDocument& doc);
 
   void addLayer(KRAnimationLayer* layer);
   unordered_map<std::string, KRAnimationLayer*>& getLayers();
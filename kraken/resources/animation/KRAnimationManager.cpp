@@ -104,6 +104,13 @@ KRAnimation* KRAnimationManager::loadAnimation(const char* szName, mimir::Block*
   return pAnimation;
 }
 
+KRAnimation* KRAnimationManager::loadAnimation(const char* szName, tinyxml2::XMLDocument& doc)
+{
+  KRAnimation* pAnimation = KRAnimation::Load(*m_pContext, szName, doc);
+  addAnimation(pAnimation);
+  return pAnimation;
+}
+
 KRAnimation* KRAnimationManager::getAnimation(const char* szName)
 {
   return m_animations[szName];
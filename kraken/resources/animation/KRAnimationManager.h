@@ -51,6 +51,7 @@ public:
   virtual KRResource* getResource(const std::string& name, const std::string& extension) override;
 
   KRAnimation* loadAnimation(const char* szName, mimir::Block* data);
+  KRAnimation* loadAnimation(const char* szName, tinyxml2::XMLDocument& doc);
   KRAnimation* getAnimation(const char* szName);
   void addAnimation(KRAnimation* new_animation);
   unordered_map<std::string, KRAnimation*>& getAnimations();
@@ -55,6 +55,10 @@ KRAnimationCurve::~KRAnimationCurve()
 }
 bool KRAnimationCurve::load(Block* data)
 {
+  if (!ValidateData(data)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to load animation curve %s: Invalid or corrupt data.", getName().c_str());
+    return false;
+  }
   m_pData->unload();
   delete m_pData;
   m_pData = data;
@@ -77,6 +81,16 @@ bool KRAnimationCurve::save(Block& data)
   return true;
 }
 
+bool KRAnimationCurve::ValidateData(Block* data)
+{
+  if (data->getSize() < sizeof(animation_curve_header)) {
+    return false;
+  }
+  animation_curve_header header;
+  data->copy(&header, 0, sizeof(header));
+  return header.frame_count >= 0 && (size_t)header.frame_count <= (data->getSize() - sizeof(header)) / sizeof(float);
+}
+
 KRAnimationCurve* KRAnimationCurve::Load(KRContext& context, const std::string& name, Block* data)
 {
   KRAnimationCurve* new_animation_curve = new KRAnimationCurve(context, name);
@@ -174,6 +188,21 @@ void KRAnimationCurve::setValue(int frame_number, float value)
   m_pData->unlock();
 }
 
+void KRAnimationCurve::setFrames(int frame_start, int frame_count, const float* values)
+{
+  // Writes the header and all frame values with a single expansion of the block
+  m_pData->lock();
+  size_t data_size = sizeof(animation_curve_header) + sizeof(float) * frame_count;
+  if (data_size > m_pData->getSize()) {
+    m_pData->expand(data_size - m_pData->getSize());
+  }
+  animation_curve_header* header = (animation_curve_header*)m_pData->getStart();
+  header->frame_start = frame_start;
+  header->frame_count = frame_count;
+  memcpy((char*)m_pData->getStart() + sizeof(animation_curve_header), values, sizeof(float) * frame_count);
+  m_pData->unlock();
+}
+
 float KRAnimationCurve::getValue(float local_time)
 {
   // TODO - Need to add interpolation for time values between frames.
@@ -57,9 +57,12 @@ public:
   float getValue(float local_time);
   float getValue(int frame_number);
   void setValue(int frame_number, float value);
+  void setFrames(int frame_start, int frame_count, const float* values);
 
 
   static KRAnimationCurve* Load(KRContext& context, const std::string& name, mimir::Block* data);
+  // Returns true if the data holds a curve header and all of its frames
+  static bool ValidateData(mimir::Block* data);
 
   bool valueChanges(float start_time, float duration);
   bool valueChanges(int start_frame, int frame_count);
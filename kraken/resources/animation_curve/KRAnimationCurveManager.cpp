@@ -77,6 +77,9 @@ KRAnimationCurve* KRAnimationCurveManager::loadAnimationCurve(const std::string&
 KRAnimationCurve* KRAnimationCurveManager::getAnimationCurve(const std::string& name)
 {
   unordered_map<std::string, KRAnimationCurve*>::iterator itr = m_animationCurves.find(name);
+  if (itr == m_animationCurves.end() && loadDeferredResources(name)) {
+    itr = m_animationCurves.find(name);
+  }
   if (itr == m_animationCurves.end()) {
     return NULL; // Not found
   } else {
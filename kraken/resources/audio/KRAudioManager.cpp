@@ -35,6 +35,7 @@
 #include "block.h"
 #include "KRAudioBuffer.h"
 #include "KRContext.h"
+#include "KRHRTFBank.h"
 #include "nodes/KRCollider.h"
 #include "siren.h"
 
@@ -50,6 +51,11 @@ KRAudioManager::KRAudioManager(KRContext& context)
   m_enable_hrtf = true;
   m_enable_reverb = true;
   m_reverb_max_length = 8.0f;
+#ifdef __APPLE__
+  m_offline_rendering = false;
+#else
+  m_offline_rendering = true; // No audio device backend on this platform yet
+#endif
 
   m_anticlick_block = true;
 #ifdef __APPLE__
@@ -81,8 +87,6 @@ KRAudioManager::KRAudioManager(KRContext& context)
   m_workspace_data = NULL;
   m_reverb_sequence = 0;
 
-  m_hrtf_data = NULL;
-
   for (int i = 0; i < KRENGINE_MAX_REVERB_IMPULSE_MIX; i++) {
     m_reverb_impulse_responses[i] = NULL;
     m_reverb_impulse_responses_weight[i] = 0.0f;
@@ -143,17 +147,13 @@ void KRAudioManager::setListenerScene(KRScene* scene)
   m_listener_scene = scene;
 }
 
-#ifdef __APPLE__
-// Apple Core Audio
-void KRAudioManager::renderAudio(UInt32 inNumberFrames, AudioBufferList* ioData)
+// Copies rendered blocks to the output, calling renderBlock() whenever the current block has been consumed.
+// stride is 1 for non-interleaved output and KRENGINE_MAX_OUTPUT_CHANNELS for interleaved output.
+void KRAudioManager::renderOutput(float* outLeft, float* outRight, int stride, int frameCount)
 {
-  // uint64_t start_time = mach_absolute_time();
-  Float32* outA = (Float32*)ioData->mBuffers[0].mData;
-  Float32* outB = (Float32*)ioData->mBuffers[1].mData; // Non-Interleaved only
-
   int output_frame = 0;
 
-  while (output_frame < inNumberFrames) {
+  while (output_frame < frameCount) {
     int frames_ready = KRENGINE_AUDIO_BLOCK_LENGTH - m_output_sample;
     if (frames_ready == 0) {
       renderBlock();
@@ -161,27 +161,93 @@ void KRAudioManager::renderAudio(UInt32 inNumberFrames, AudioBufferList* ioData)
       frames_ready = KRENGINE_AUDIO_BLOCK_LENGTH;
     }
 
-    int frames_processed = inNumberFrames - output_frame;
+    int frames_processed = frameCount - output_frame;
     if (frames_processed > frames_ready) frames_processed = frames_ready;
 
     float* block_data = getBlockAddress(0);
 
     for (int i = 0; i < frames_processed; i++) {
-
-      float left_channel = block_data[m_output_sample * KRENGINE_MAX_OUTPUT_CHANNELS];
-      float right_channel = block_data[m_output_sample * KRENGINE_MAX_OUTPUT_CHANNELS + 1];
+      outLeft[output_frame * stride] = block_data[m_output_sample * KRENGINE_MAX_OUTPUT_CHANNELS];
+      outRight[output_frame * stride] = block_data[m_output_sample * KRENGINE_MAX_OUTPUT_CHANNELS + 1];
       m_output_sample++;
+      output_frame++;
+    }
+  }
+}
 
-      // Interleaved
-      //        outA[i*2] = (Float32)left_channel;
-      //        outA[i*2 + 1] = (Float32)right_channel;
+bool KRAudioManager::getOfflineRendering()
+{
+  return m_offline_rendering;
+}
 
-      // Non-Interleaved
-      outA[output_frame] = (Float32)left_channel;
-      outB[output_frame] = (Float32)right_channel;
-      output_frame++;
+void KRAudioManager::setOfflineRendering(bool offline)
+{
+  if (m_offline_rendering != offline) {
+    if (m_initialized) {
+      // Switch backends; the audio system is initialized again by the next call to makeCurrentContext()
+      cleanupAudio();
+      m_initialized = false;
     }
+    m_offline_rendering = offline;
   }
+}
+
+void KRAudioManager::renderOffline(float* interleavedOutput, int frameCount)
+{
+  assert(m_offline_rendering); // The audio device would be rendering concurrently
+  makeCurrentContext();
+  renderOutput(interleavedOutput, interleavedOutput + 1, KRENGINE_MAX_OUTPUT_CHANNELS, frameCount);
+}
+
+bool KRAudioManager::renderOfflineToFile(const std::string& path, int frameCount)
+{
+  const int header_size = 44;
+  const int block_align = KRENGINE_MAX_OUTPUT_CHANNELS * sizeof(float);
+  __uint32_t data_size = (__uint32_t)frameCount * block_align;
+
+  Block data;
+  data.expand(header_size + data_size);
+  data.lock();
+  unsigned char* header = (unsigned char*)data.getStart();
+  auto write16 = [](unsigned char* p, __uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+  };
+  auto write32 = [](unsigned char* p, __uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+  };
+  memcpy(header, "RIFF", 4);
+  write32(header + 4, header_size - 8 + data_size);
+  memcpy(header + 8, "WAVE", 4);
+  memcpy(header + 12, "fmt ", 4);
+  write32(header + 16, 16);
+  write16(header + 20, 3); // WAVE_FORMAT_IEEE_FLOAT
+  write16(header + 22, KRENGINE_MAX_OUTPUT_CHANNELS);
+  write32(header + 24, KRENGINE_AUDIO_FRAME_RATE);
+  write32(header + 28, KRENGINE_AUDIO_FRAME_RATE * block_align);
+  write16(header + 32, block_align);
+  write16(header + 34, 8 * sizeof(float));
+  memcpy(header + 36, "data", 4);
+  write32(header + 40, data_size);
+
+  renderOffline((float*)(header + header_size), frameCount);
+  data.unlock();
+
+  return data.save(path);
+}
+
+#ifdef __APPLE__
+// Apple Core Audio
+void KRAudioManager::renderAudio(UInt32 inNumberFrames, AudioBufferList* ioData)
+{
+  // uint64_t start_time = mach_absolute_time();
+  Float32* outA = (Float32*)ioData->mBuffers[0].mData;
+  Float32* outB = (Float32*)ioData->mBuffers[1].mData; // Non-Interleaved only
+
+  renderOutput(outA, outB, 1, inNumberFrames);
 
   //    uint64_t end_time = mach_absolute_time();
   //    uint64_t duration = (end_time - start_time) * m_timebase_info.numer / m_timebase_info.denom; // Nanoseconds
@@ -425,456 +491,85 @@ void KRSetAUCanonical(AudioStreamBasicDescription& desc, UInt32 nChannels, bool
 
 void KRAudioManager::initHRTF()
 {
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 005.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 025.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 035.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 055.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 065.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 085.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 095.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 115.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 125.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 145.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 155.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 175.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-10.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 005.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 025.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 035.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 055.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 065.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 085.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 095.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 115.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 125.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 145.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 155.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 175.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-20.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 006.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 012.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 018.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 024.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 036.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 042.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 048.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 054.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 066.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 072.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 078.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 084.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 096.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 102.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 108.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 114.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 126.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 132.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 138.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 144.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 156.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 162.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 168.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 174.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-30.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 006.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 013.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 019.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 026.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 032.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 039.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 051.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 058.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 064.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 071.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 077.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 084.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 096.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 103.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 109.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 116.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 122.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 129.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 141.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 148.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 154.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 161.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 167.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 174.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(-40.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 005.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 025.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 035.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 055.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 065.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 085.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 095.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 115.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 125.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 145.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 155.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 175.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(0.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 005.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 025.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 035.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 055.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 065.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 085.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 095.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 115.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 125.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 145.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 155.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 175.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(10.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 005.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 025.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 035.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 055.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 065.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 085.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 095.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 115.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 125.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 145.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 155.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 175.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(20.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 006.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 012.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 018.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 024.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 036.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 042.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 048.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 054.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 066.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 072.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 078.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 084.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 096.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 102.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 108.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 114.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 126.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 132.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 138.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 144.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 156.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 162.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 168.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 174.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(30.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 006.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 013.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 019.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 026.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 032.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 039.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 051.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 058.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 064.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 071.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 077.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 084.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 096.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 103.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 109.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 116.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 122.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 129.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 141.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 148.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 154.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 161.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 167.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 174.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(40.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 008.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 016.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 024.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 032.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 048.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 056.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 064.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 072.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 088.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 096.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 104.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 112.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 128.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 136.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 144.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 152.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 168.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(50.0f, 176.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 010.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 020.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 040.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 050.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 070.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 080.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 100.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 110.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 130.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 140.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 160.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 170.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(60.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 015.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 045.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 075.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 105.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 135.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 165.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(70.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 000.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 030.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 060.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 090.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 120.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 150.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(80.0f, 180.0f));
-  m_hrtf_sample_locations.push_back(Vector2::Create(90.0f, 000.0f));
-
-  if (m_hrtf_data) {
-    delete m_hrtf_data;
+  // Use the bank baked by kraken_convert in place, if it was bundled
+  KRUnknown* bakedBank = getContext().getUnknownManager()->get("hrtf_kemar", "krhrtf");
+  if (bakedBank && m_hrtf_bank.load(bakedBank->getData())) {
+    return;
   }
-  m_hrtf_data = (float*)malloc(m_hrtf_sample_locations.size() * sizeof(float) * 128 * 4 * 2);
 
-  for (int channel = 0; channel < 2; channel++) {
-    m_hrtf_spectral[channel].clear();
+  // Otherwise transform the individual impulse responses
+  if (!m_hrtf_bank.build(*this)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Failed to initialize HRTF bank.");
   }
-
-  int sample_index = 0;
-  for (std::vector<Vector2>::iterator itr = m_hrtf_sample_locations.begin(); itr != m_hrtf_sample_locations.end(); itr++) {
-    Vector2 pos = *itr;
-    KRAudioSample* sample = getHRTFSample(pos);
-    for (int channel = 0; channel < 2; channel++) {
-      dsp::SplitComplex spectral;
-      spectral.realp = m_hrtf_data + sample_index * 1024 + channel * 512;
-      spectral.imagp = m_hrtf_data + sample_index * 1024 + channel * 512 + 256;
-      sample->sample(0, 128, channel, spectral.realp, 1.0f, false);
-      memset(spectral.realp + 128, 0, sizeof(float) * 128);
-      memset(spectral.imagp, 0, sizeof(float) * 256);
-      dsp::FFTForward(m_fft_setup[8 - KRENGINE_AUDIO_BLOCK_LOG2N], &spectral, 8);
-      m_hrtf_spectral[channel][pos] = spectral;
-    }
-    sample_index++;
-  }
-
 }
 
-KRAudioSample* KRAudioManager::getHRTFSample(const Vector2& hrtf_dir)
+KrResult KRAudioManager::bakeHRTFBank(KRBundle* bundle)
 {
-  //hrtf_kemar_H-10e000a.wav
-  char szName[64];
-  sprintf(szName, "hrtf_kemar_H%de%03da", int(hrtf_dir.x), abs(int(hrtf_dir.y)));
+  KRHRTFBank bank;
+  if (!bank.build(*this)) {
+    return KR_ERROR_NOT_FOUND;
+  }
+  Block* data = new Block();
+  bank.save(*data);
 
-  return get(szName);
+  KRUnknown* bankResource = new KRUnknown(getContext(), "hrtf_kemar", "krhrtf", data);
+  getContext().getUnknownManager()->add(bankResource);
+  return bankResource->moveToBundle(bundle);
 }
 
 dsp::SplitComplex KRAudioManager::getHRTFSpectral(const Vector2& hrtf_dir, const int channel)
 {
-  Vector2 dir = hrtf_dir;
+  float azimuth = hrtf_dir.y;
   int sample_channel = channel;
-  if (dir.y < 0) {
-    dir.y = -dir.y;
+  if (azimuth < 0) {
+    azimuth = -azimuth;
     sample_channel = (channel + 1) % 2;
   }
-  return m_hrtf_spectral[sample_channel][dir];
+  int ring = KRHRTFBank::GetRing(hrtf_dir.x);
+  return m_hrtf_bank.getSpectral(ring, m_hrtf_bank.findAzimuthNearest(ring, azimuth), sample_channel);
 }
 
 Vector2 KRAudioManager::getNearestHRTFSample(const Vector2& dir)
 {
   float elev_gran = 10.0f;
 
-
   Vector2 dir_deg = dir * (180.0f / (float)M_PI);
   float elevation = floor(dir_deg.x / elev_gran + 0.5f) * elev_gran;
-  if (elevation < -40.0f) {
-    elevation = -40.0f;
+  int ring = KRHRTFBank::GetRing(elevation);
+
+  Vector2 nearest = Vector2::Create(KRHRTFBank::GetRingElevation(ring), m_hrtf_bank.getAzimuth(ring, m_hrtf_bank.findAzimuthNearest(ring, fabs(dir_deg.y))));
+  if (dir_deg.y < 0.0f && nearest.y > 0.0f) {
+    // Mirrored direction on the left side
+    nearest.y = -nearest.y;
   }
+  return nearest;
+}
 
-  Vector2 min_direction;
-  bool first = true;
-  float min_distance = 360.0f;
-  for (std::vector<Vector2>::iterator itr = m_hrtf_sample_locations.begin(); itr != m_hrtf_sample_locations.end(); itr++) {
-    if (first) {
-      first = false;
-      min_direction = (*itr);
-    } else if ((*itr).x == elevation) {
-      float distance = fabs(dir_deg.y - (*itr).y);
-      if (min_distance > distance) {
-        min_direction = (*itr);
-        min_distance = distance;
-      }
-      distance = fabs(dir_deg.y - -(*itr).y);
-      if (min_distance > distance) {
-        min_direction = (*itr);
-        min_direction.y = -min_direction.y;
-        min_distance = distance;
-      }
-    }
+void KRAudioManager::getHRTFAzimuthBracket(int ring, float azimuth, float& lower, float& upper)
+{
+  int count = m_hrtf_bank.getAzimuthCount(ring);
+  if (azimuth >= 0.0f) {
+    int index = m_hrtf_bank.findAzimuthFloor(ring, azimuth);
+    lower = m_hrtf_bank.getAzimuth(ring, index);
+    upper = index + 1 < count ? m_hrtf_bank.getAzimuth(ring, index + 1) : lower;
+    return;
   }
-  return min_direction;
+
+  // Negative azimuths are the measured azimuths mirrored, so the bracket is found
+  // on the positive side and reversed.
+  float mirrored = -azimuth;
+  int below = m_hrtf_bank.findAzimuthFloor(ring, mirrored);
+  int above = below;
+  if (m_hrtf_bank.getAzimuth(ring, below) < mirrored) {
+    above = below + 1;
+  } else {
+    below = below - 1;
+  }
+  upper = -m_hrtf_bank.getAzimuth(ring, below);
+  if (upper == 0.0f) {
+    upper = 0.0f; // Avoid a negative zero, which would hash differently
+  }
+  lower = above < count ? -m_hrtf_bank.getAzimuth(ring, above) : upper;
 }
 
 void KRAudioManager::getHRTFMix(const Vector2& dir, Vector2& dir1, Vector2& dir2, Vector2& dir3, Vector2& dir4, float& mix1, float& mix2, float& mix3, float& mix4)
@@ -898,85 +593,8 @@ void KRAudioManager::getHRTFMix(const Vector2& dir, Vector2& dir1, Vector2& dir2
   dir3.x = elev2;
   dir4.x = elev2;
 
-  bool first1 = true;
-  bool first2 = true;
-  bool first3 = true;
-  bool first4 = true;
-  for (std::vector<Vector2>::iterator itr = m_hrtf_sample_locations.begin(); itr != m_hrtf_sample_locations.end(); itr++) {
-    Vector2 sample_pos = *itr;
-
-    if (sample_pos.x == elev1) {
-      if (sample_pos.y <= azimuth) {
-        if (first1) {
-          first1 = false;
-          dir1.y = sample_pos.y;
-        } else if (sample_pos.y > dir1.y) {
-          dir1.y = sample_pos.y;
-        }
-      }
-      if (-sample_pos.y <= azimuth) {
-        if (first1) {
-          first1 = false;
-          dir1.y = -sample_pos.y;
-        } else if (-sample_pos.y > dir1.y) {
-          dir1.y = -sample_pos.y;
-        }
-      }
-
-      if (sample_pos.y > azimuth) {
-        if (first2) {
-          first2 = false;
-          dir2.y = sample_pos.y;
-        } else if (sample_pos.y < dir2.y) {
-          dir2.y = sample_pos.y;
-        }
-      }
-      if (-sample_pos.y > azimuth) {
-        if (first2) {
-          first2 = false;
-          dir2.y = -sample_pos.y;
-        } else if (-sample_pos.y < dir2.y) {
-          dir2.y = -sample_pos.y;
-        }
-      }
-    }
-    if (sample_pos.x == elev2) {
-      if (sample_pos.y <= azimuth) {
-        if (first3) {
-          first3 = false;
-          dir3.y = sample_pos.y;
-        } else if (sample_pos.y > dir3.y) {
-          dir3.y = sample_pos.y;
-        }
-      }
-      if (-sample_pos.y <= azimuth) {
-        if (first3) {
-          first3 = false;
-          dir3.y = -sample_pos.y;
-        } else if (-sample_pos.y > dir3.y) {
-          dir3.y = -sample_pos.y;
-        }
-      }
-
-      if (sample_pos.y > azimuth) {
-        if (first4) {
-          first4 = false;
-          dir4.y = sample_pos.y;
-        } else if (sample_pos.y < dir4.y) {
-          dir4.y = sample_pos.y;
-        }
-      }
-      if (-sample_pos.y > azimuth) {
-        if (first4) {
-          first4 = false;
-          dir4.y = -sample_pos.y;
-        } else if (-sample_pos.y < dir4.y) {
-          dir4.y = -sample_pos.y;
-        }
-      }
-    }
-  }
-
+  getHRTFAzimuthBracket(KRHRTFBank::GetRing(elev1), azimuth, dir1.y, dir2.y);
+  getHRTFAzimuthBracket(KRHRTFBank::GetRing(elev2), azimuth, dir3.y, dir4.y);
 
   float azim_blend1 = 0.0f;
   if (dir2.y > dir1.y) {
@@ -1028,6 +646,11 @@ void KRAudioManager::initAudio()
     // ----====---- Initialize HRTF Engine ----====----
     initHRTF();
 
+    if (m_offline_rendering) {
+      // Null device; blocks are only rendered by renderOffline()
+      return;
+    }
+
 #ifdef __APPLE__
     // Apple Core Audio
     // ----====---- Initialize Core Audio Objects ----====----
@@ -1089,7 +712,7 @@ void KRAudioManager::initAudio()
       &size));
 
     KRSetAUCanonical(desc, 2, false);
-    desc.mSampleRate = 44100.0f;
+    desc.mSampleRate = (Float64)KRENGINE_AUDIO_FRAME_RATE;
 
     OSDEBUG(AudioUnitSetProperty(m_auMixer,
       kAudioUnitProperty_StreamFormat,
@@ -1118,7 +741,7 @@ void KRAudioManager::initAudio()
 
     // ----
     KRSetAUCanonical(desc, 2, false);
-    desc.mSampleRate = 44100.0f;
+    desc.mSampleRate = (Float64)KRENGINE_AUDIO_FRAME_RATE;
 
 
     // ----
@@ -1172,10 +795,7 @@ void KRAudioManager::cleanupAudio()
     m_workspace_data = NULL;
   }
 
-  if (m_hrtf_data) {
-    free(m_hrtf_data);
-    m_hrtf_data = NULL;
-  }
+  m_hrtf_bank.clear();
 
   for (int i = 0; i < KRENGINE_MAX_REVERB_IMPULSE_MIX; i++) {
     m_reverb_impulse_responses[i] = NULL;
@@ -1291,7 +911,14 @@ KRAudioSample* KRAudioManager::get(const std::string& name)
 {
   std::string lower_name = name;
   std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
-  return m_sounds[lower_name];
+  unordered_map<std::string, KRAudioSample*>::iterator itr = m_sounds.find(lower_name);
+  if (itr == m_sounds.end() && loadDeferredResources(lower_name)) {
+    itr = m_sounds.find(lower_name);
+  }
+  if (itr == m_sounds.end()) {
+    return NULL;
+  }
+  return itr->second;
 }
 
 Block* KRAudioManager::getBufferData(int size)
@@ -38,6 +38,7 @@
 #include "KRContextObject.h"
 #include "block.h"
 #include "nodes/KRAudioSource.h"
+#include "KRHRTFBank.h"
 #include "siren.h"
 
 const int KRENGINE_AUDIO_MAX_POOL_SIZE = 60; //32;
@@ -71,6 +72,7 @@ const float KRENGINE_AUDIO_CUTOFF = 0.02f; // Cutoff gain level, to cull out pro
 const int KRENGINE_REVERB_MAX_SAMPLES = 128000; // 2.9 seconds //435200; // At least 10s reverb impulse response length, divisible by KRENGINE_AUDIO_BLOCK_LENGTH
 const int KRENGINE_MAX_REVERB_IMPULSE_MIX = 8; // Maximum number of impulse response filters that can be mixed simultaneously
 const int KRENGINE_MAX_OUTPUT_CHANNELS = 2;
+const int KRENGINE_AUDIO_FRAME_RATE = 44100; // Output sample rate, in frames per second
 
 const int KRENGINE_MAX_ACTIVE_SOURCES = 16;
 const int KRENGINE_AUDIO_ANTICLICK_SAMPLES = 64;
@@ -78,6 +80,7 @@ const int KRENGINE_AUDIO_ANTICLICK_SAMPLES = 64;
 
 class KRAmbientZone;
 class KRReverbZone;
+class KRBundle;
 
 typedef struct
 {
@@ -110,6 +113,9 @@ public:
   KRAudioSample* load(const std::string& name, const std::string& extension, mimir::Block* data);
   KRAudioSample* get(const std::string& name);
 
+  // Transforms the HRTF impulse responses into a single krhrtf resource in the bundle
+  KrResult bakeHRTFBank(KRBundle* bundle);
+
   // Listener position and orientation
   KRScene* getListenerScene();
   void setListenerScene(KRScene* scene);
@@ -159,6 +165,16 @@ public:
   float getReverbMaxLength();
   void setReverbMaxLength(float max_length);
 
+  // Offline rendering replaces the audio device with a null device; output is
+  // only produced when requested with renderOffline() or renderOfflineToFile().
+  bool getOfflineRendering();
+  void setOfflineRendering(bool offline);
+
+  // Renders frameCount frames of interleaved stereo output, as fast as possible
+  void renderOffline(float* interleavedOutput, int frameCount);
+  // Renders frameCount frames of stereo output to a 32-bit float WAV file
+  bool renderOfflineToFile(const std::string& path, int frameCount);
+
   void _registerOpenAudioSample(KRAudioSample* audioSample);
   void _registerCloseAudioSample(KRAudioSample* audioSample);
 
@@ -167,6 +183,7 @@ private:
   bool m_enable_hrtf;
   bool m_enable_reverb;
   float m_reverb_max_length;
+  bool m_offline_rendering;
 
   KRScene* m_listener_scene; // For now, only one scene is allowed to have active audio at once
 
@@ -223,6 +240,7 @@ private:
   siren::dsp::SplitComplex m_workspace[3];
 
   float* getBlockAddress(int block_offset);
+  void renderOutput(float* outLeft, float* outRight, int stride, int frameCount);
   void renderBlock();
   void renderReverb();
   void renderAmbient();
@@ -231,13 +249,11 @@ private:
   void renderReverbImpulseResponse(int impulse_response_offset, int frame_count_log2);
   void renderLimiter();
 
-  std::vector<hydra::Vector2> m_hrtf_sample_locations;
-  float* m_hrtf_data;
-  unordered_map<hydra::Vector2, siren::dsp::SplitComplex> m_hrtf_spectral[2];
+  KRHRTFBank m_hrtf_bank;
 
   hydra::Vector2 getNearestHRTFSample(const hydra::Vector2& dir);
   void getHRTFMix(const hydra::Vector2& dir, hydra::Vector2& hrtf1, hydra::Vector2& hrtf2, hydra::Vector2& hrtf3, hydra::Vector2& hrtf4, float& mix1, float& mix2, float& mix3, float& mix4);
-  KRAudioSample* getHRTFSample(const hydra::Vector2& hrtf_dir);
+  void getHRTFAzimuthBracket(int ring, float azimuth, float& lower, float& upper);
   siren::dsp::SplitComplex getHRTFSpectral(const hydra::Vector2& hrtf_dir, const int channel);
 
   unordered_map<std::string, siren_ambient_zone_weight_info> m_ambient_zone_weights;
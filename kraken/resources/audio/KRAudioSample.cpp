@@ -39,6 +39,33 @@
 using namespace mimir;
 using namespace siren;
 
+namespace {
+const int WAVE_FORMAT_PCM = 0x0001;
+const int WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+const int WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+__uint32_t ReadLE16(const unsigned char* p)
+{
+  return (__uint32_t)p[0] | ((__uint32_t)p[1] << 8);
+}
+
+__uint32_t ReadLE32(const unsigned char* p)
+{
+  return (__uint32_t)p[0] | ((__uint32_t)p[1] << 8) | ((__uint32_t)p[2] << 16) | ((__uint32_t)p[3] << 24);
+}
+
+template<typename T>
+short FloatSampleToInt16(T value)
+{
+  if (value >= (T)1.0) {
+    return 32767;
+  } else if (value <= (T)-1.0) {
+    return -32767;
+  }
+  return (short)lrint(value * (T)32767.0);
+}
+} // anonymous namespace
+
 KRAudioSample::KRAudioSample(KRContext& context, std::string name, std::string extension) : KRResource(context, name)
 {
   m_pData = new Block();
@@ -49,10 +76,18 @@ KRAudioSample::KRAudioSample(KRContext& context, std::string name, std::string e
   m_audio_file_id = 0;
   m_fileRef = NULL;
 #endif
+  m_wavEncoding = WAV_ENCODING_NONE;
+  m_wavDataOffset = 0;
+  m_wavBytesPerSample = 0;
+  m_wavBlockAlign = 0;
+  m_wavOpen = false;
+  m_decodeFailed = false;
+
   m_totalFrames = 0;
   m_bytesPerFrame = 0;
   m_frameRate = 0;
   m_bufferCount = 0;
+  m_channelsPerFrame = 0;
 
   m_last_frame_used = 0;
 }
@@ -67,10 +102,18 @@ KRAudioSample::KRAudioSample(KRContext& context, std::string name, std::string e
   m_audio_file_id = 0;
   m_fileRef = NULL;
 #endif
+  m_wavEncoding = WAV_ENCODING_NONE;
+  m_wavDataOffset = 0;
+  m_wavBytesPerSample = 0;
+  m_wavBlockAlign = 0;
+  m_wavOpen = false;
+  m_decodeFailed = false;
+
   m_totalFrames = 0;
   m_bytesPerFrame = 0;
   m_frameRate = 0;
   m_bufferCount = 0;
+  m_channelsPerFrame = 0;
 
   m_last_frame_used = 0;
 }
@@ -97,6 +140,9 @@ __int64_t KRAudioSample::getFrameCount()
 float KRAudioSample::sample(int frame_offset, int frame_rate, int channel)
 {
   loadInfo();
+  if (m_bytesPerFrame == 0) {
+    return 0.0f; // Sample could not be decoded
+  }
 
   int c = std::min(channel, m_channelsPerFrame - 1);
 
@@ -137,6 +183,12 @@ void KRAudioSample::sample(__int64_t frame_offset, int frame_count, int channel,
 
   m_last_frame_used = (int)getContext().getAudioManager()->getAudioFrame();
 
+  if (m_bytesPerFrame == 0) {
+    // Sample could not be decoded
+    memset(buffer, 0, frame_count * sizeof(float));
+    return;
+  }
+
   if (loop) {
     int buffer_offset = 0;
     int frames_left = frame_count;
@@ -243,8 +295,152 @@ OSStatus KRAudioSample::WriteProc( // AudioFile_WriteProc
 }
 #endif // Apple Audio Toolbox
 
+bool KRAudioSample::parseWav()
+{
+  // Locate the "fmt " and "data" chunks of a RIFF / WAVE file
+  size_t size = m_pData->getSize();
+  if (size < 12) {
+    return false;
+  }
+  unsigned char header[12];
+  m_pData->copy(header, 0, 12);
+  if (memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+
+  bool have_format = false;
+  int format_tag = 0;
+  int channels = 0;
+  int frame_rate = 0;
+  int block_align = 0;
+  int bits_per_sample = 0;
+
+  size_t offset = 12;
+  while (offset + 8 <= size) {
+    unsigned char chunk_header[8];
+    m_pData->copy(chunk_header, offset, 8);
+    size_t chunk_start = offset + 8;
+    size_t chunk_size = ReadLE32(chunk_header + 4);
+
+    if (memcmp(chunk_header, "fmt ", 4) == 0) {
+      if (chunk_size < 16 || chunk_size > size - chunk_start) {
+        return false;
+      }
+      unsigned char fmt[40];
+      memset(fmt, 0, sizeof(fmt));
+      m_pData->copy(fmt, chunk_start, std::min(chunk_size, sizeof(fmt)));
+      format_tag = ReadLE16(fmt);
+      channels = ReadLE16(fmt + 2);
+      frame_rate = ReadLE32(fmt + 4);
+      block_align = ReadLE16(fmt + 12);
+      bits_per_sample = ReadLE16(fmt + 14);
+      if (format_tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 40) {
+        // The SubFormat GUID starts with the actual format tag
+        format_tag = ReadLE16(fmt + 24);
+      }
+      have_format = true;
+    } else if (memcmp(chunk_header, "data", 4) == 0 && have_format) {
+      if (channels < 1 || frame_rate < 1 || block_align < channels || block_align % channels != 0) {
+        return false;
+      }
+      int bytes_per_sample = block_align / channels;
+      if (format_tag == WAVE_FORMAT_PCM && bytes_per_sample >= 1 && bytes_per_sample <= 4) {
+        m_wavEncoding = WAV_ENCODING_PCM;
+      } else if (format_tag == WAVE_FORMAT_IEEE_FLOAT && (bytes_per_sample == 4 || bytes_per_sample == 8)) {
+        m_wavEncoding = WAV_ENCODING_FLOAT;
+      } else {
+#ifndef __APPLE__
+        // On Apple platforms, Audio Toolbox gets a chance to decode compressed WAV files
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unsupported WAV encoding (format: %i, bits per sample: %i) in audio sample: %s", format_tag, bits_per_sample, getName().c_str());
+        m_decodeFailed = true;
+#endif
+        return false;
+      }
+
+      // Streaming writers may leave the data size unset, so clamp to the end of the file
+      size_t data_size = std::min(chunk_size, size - chunk_start);
+      m_wavDataOffset = chunk_start;
+      m_wavBytesPerSample = bytes_per_sample;
+      m_wavBlockAlign = block_align;
+
+      m_totalFrames = data_size / block_align;
+      m_channelsPerFrame = channels;
+      m_bytesPerFrame = 2 * channels;
+      m_frameRate = frame_rate;
+
+      int maxFramesPerBuffer = KRENGINE_AUDIO_MAX_BUFFER_SIZE / m_bytesPerFrame;
+      m_bufferCount = (int)((m_totalFrames + maxFramesPerBuffer - 1) / maxFramesPerBuffer); // CEIL(_totalFrames / maxFramesPerBuffer)
+      return true;
+    }
+
+    if (chunk_size > size - chunk_start) {
+      break;
+    }
+    offset = chunk_start + chunk_size + (chunk_size & 1); // Chunks are padded to an even size
+  }
+  return false;
+}
+
+void KRAudioSample::DecodeWavFrames(const unsigned char* src, WavEncoding encoding, int bytesPerSample, int sampleCount, short* dest)
+{
+  // Convert interleaved WAV samples to the native 16-bit interleaved format of KRAudioBuffer
+  if (encoding == WAV_ENCODING_FLOAT) {
+    if (bytesPerSample == 4) {
+      for (int i = 0; i < sampleCount; i++) {
+        float value;
+        memcpy(&value, src + i * 4, sizeof(value));
+        dest[i] = FloatSampleToInt16(value);
+      }
+    } else {
+      for (int i = 0; i < sampleCount; i++) {
+        double value;
+        memcpy(&value, src + i * 8, sizeof(value));
+        dest[i] = FloatSampleToInt16(value);
+      }
+    }
+    return;
+  }
+
+  switch (bytesPerSample) {
+  case 1:
+    // 8-bit WAV samples are unsigned
+    for (int i = 0; i < sampleCount; i++) {
+      dest[i] = (short)(((int)src[i] - 128) << 8);
+    }
+    break;
+  case 2:
+    memcpy(dest, src, sampleCount * sizeof(short));
+    break;
+  default:
+    // Keep the most significant 16 bits of 24 and 32 bit samples
+    for (int i = 0; i < sampleCount; i++) {
+      const unsigned char* sample = src + i * bytesPerSample + bytesPerSample - 2;
+      dest[i] = (short)ReadLE16(sample);
+    }
+    break;
+  }
+}
+
 void KRAudioSample::openFile()
 {
+  if (m_wavOpen || m_decodeFailed) {
+    return;
+  }
+#ifdef __APPLE__
+  if (m_fileRef != NULL) {
+    return;
+  }
+#endif
+
+  if (parseWav()) {
+    m_wavOpen = true;
+    getContext().getAudioManager()->_registerOpenAudioSample(this);
+    return;
+  }
+  if (m_decodeFailed) {
+    return;
+  }
+
 #ifdef __APPLE__
   // Apple Audio Toolbox
 
@@ -297,12 +493,15 @@ void KRAudioSample::openFile()
     getContext().getAudioManager()->_registerOpenAudioSample(this);
   }
 #else
-#pragma message ( "TODO - implement for Windows" )
+  KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to decode audio sample: %s.%s  Only WAV files are supported on this platform.", getName().c_str(), m_extension.c_str());
+  m_decodeFailed = true;
 #endif
 }
 
 void KRAudioSample::closeFile()
 {
+  m_wavOpen = false;
+
 #ifdef __APPLE__
   // Apple Audio Toolbox
   if (m_fileRef) {
@@ -356,6 +555,14 @@ void KRAudioSample::PopulateBuffer(KRAudioSample* sound, int index, void* data)
   int startFrame = index * maxFramesPerBuffer;
   __uint32_t frameCount = std::min((__uint32_t)sound->m_totalFrames - startFrame, (__uint32_t)maxFramesPerBuffer);
 
+  if (sound->m_wavOpen) {
+    sound->m_pData->lock();
+    const unsigned char* src = (const unsigned char*)sound->m_pData->getStart() + sound->m_wavDataOffset + (size_t)startFrame * sound->m_wavBlockAlign;
+    DecodeWavFrames(src, sound->m_wavEncoding, sound->m_wavBytesPerSample, frameCount * sound->m_channelsPerFrame, (short*)data);
+    sound->m_pData->unlock();
+    return;
+  }
+
 #ifdef __APPLE__
   // Apple Audio Toolbox
   AudioBufferList outputBufferInfo;
@@ -96,6 +96,23 @@ private:
     SInt64		inSize);
 #endif
 
+  // RIFF / WAVE decoding, used on all platforms when the data is a WAV file
+  enum WavEncoding
+  {
+    WAV_ENCODING_NONE = 0,
+    WAV_ENCODING_PCM,
+    WAV_ENCODING_FLOAT
+  };
+  WavEncoding m_wavEncoding;
+  size_t m_wavDataOffset;
+  int m_wavBytesPerSample;
+  int m_wavBlockAlign;
+  bool m_wavOpen;
+  bool m_decodeFailed; // Set once a sample could not be decoded, so the error is only reported once
+
+  bool parseWav();
+  static void DecodeWavFrames(const unsigned char* src, WavEncoding encoding, int bytesPerSample, int sampleCount, short* dest);
+
   int m_bufferCount;
 
   __int64_t m_totalFrames;
@@ -0,0 +1,289 @@
+//
+//  KRHRTFBank.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KREngine-common.h"
+#include "KRHRTFBank.h"
+
+#include "KRContext.h"
+#include "KRAudioSample.h"
+#include "KRAudioManager.h"
+
+using namespace mimir;
+using namespace siren;
+
+namespace {
+
+// Azimuth spacing of each ring of the KEMAR measurements, from -40 to 90 degrees elevation.
+// Sample names use the azimuth rounded to the nearest degree.
+const struct
+{
+  int azimuthCount;
+  float azimuthStep;
+} KEMAR_RINGS[KRHRTFBank::kRingCount] = {
+  { 29, 360.0f / 56.0f }, // -40
+  { 31, 6.0f },  // -30
+  { 37, 5.0f },  // -20
+  { 37, 5.0f },  // -10
+  { 37, 5.0f },  // 0
+  { 37, 5.0f },  // 10
+  { 37, 5.0f },  // 20
+  { 31, 6.0f },  // 30
+  { 29, 360.0f / 56.0f }, // 40
+  { 23, 8.0f },  // 50
+  { 19, 10.0f }, // 60
+  { 13, 15.0f }, // 70
+  { 7, 30.0f },  // 80
+  { 1, 360.0f }, // 90
+};
+
+const char HRTF_BANK_MAGIC[4] = { 'K', 'R', 'H', 'B' };
+
+} // anonymous namespace
+
+KRHRTFBank::KRHRTFBank()
+  : m_rings{}
+  , m_azimuths(nullptr)
+  , m_spectra(nullptr)
+  , m_sampleCount(0)
+  , m_builtSpectra(nullptr)
+  , m_data(nullptr)
+{
+
+}
+
+KRHRTFBank::~KRHRTFBank()
+{
+  clear();
+}
+
+void KRHRTFBank::clear()
+{
+  if (m_data) {
+    m_data->unlock();
+    m_data = nullptr;
+  }
+  if (m_builtSpectra) {
+    free(m_builtSpectra);
+    m_builtSpectra = nullptr;
+  }
+  m_builtAzimuths.clear();
+  m_azimuths = nullptr;
+  m_spectra = nullptr;
+  m_sampleCount = 0;
+  memset(m_rings, 0, sizeof(m_rings));
+}
+
+bool KRHRTFBank::isLoaded() const
+{
+  return m_spectra != nullptr;
+}
+
+bool KRHRTFBank::build(KRAudioManager& audioManager)
+{
+  clear();
+
+  for (int ring = 0; ring < kRingCount; ring++) {
+    m_rings[ring].firstSample = (uint32_t)m_builtAzimuths.size();
+    m_rings[ring].sampleCount = (uint32_t)KEMAR_RINGS[ring].azimuthCount;
+    for (int i = 0; i < KEMAR_RINGS[ring].azimuthCount; i++) {
+      m_builtAzimuths.push_back(floorf(i * KEMAR_RINGS[ring].azimuthStep + 0.5f));
+    }
+  }
+  m_sampleCount = m_builtAzimuths.size();
+  m_builtSpectra = (float*)malloc(m_sampleCount * 2 * kSpectrumLength * 2 * sizeof(float));
+
+  dsp::FFTWorkspace fft;
+  fft.create(kSpectrumLog2);
+
+  bool success = true;
+  for (int ring = 0; ring < kRingCount && success; ring++) {
+    for (uint32_t i = 0; i < m_rings[ring].sampleCount; i++) {
+      //hrtf_kemar_H-10e000a.wav
+      char szName[64];
+      snprintf(szName, sizeof(szName), "hrtf_kemar_H%de%03da", (int)GetRingElevation(ring), (int)m_builtAzimuths[m_rings[ring].firstSample + i]);
+      KRAudioSample* sample = audioManager.get(szName);
+      if (sample == nullptr) {
+        KRContext::Log(KRContext::LOG_LEVEL_ERROR, "HRTF impulse response not found: %s", szName);
+        success = false;
+        break;
+      }
+      for (int channel = 0; channel < 2; channel++) {
+        float* spectrum = m_builtSpectra + ((m_rings[ring].firstSample + i) * 2 + channel) * kSpectrumLength * 2;
+        dsp::SplitComplex spectral;
+        spectral.realp = spectrum;
+        spectral.imagp = spectrum + kSpectrumLength;
+        sample->sample(0, kImpulseLength, channel, spectral.realp, 1.0f, false);
+        memset(spectral.realp + kImpulseLength, 0, sizeof(float) * (kSpectrumLength - kImpulseLength));
+        memset(spectral.imagp, 0, sizeof(float) * kSpectrumLength);
+        dsp::FFTForward(fft, &spectral, kSpectrumLog2);
+      }
+    }
+  }
+
+  fft.destroy();
+
+  if (!success) {
+    clear();
+    return false;
+  }
+  m_azimuths = m_builtAzimuths.data();
+  m_spectra = m_builtSpectra;
+  return true;
+}
+
+bool KRHRTFBank::load(Block* data)
+{
+  clear();
+
+  data->lock();
+  const uint8_t* start = (const uint8_t*)data->getStart();
+  size_t size = data->getSize();
+
+  Header header;
+  if (size < sizeof(header)) {
+    data->unlock();
+    return false;
+  }
+  memcpy(&header, start, sizeof(header));
+  if (memcmp(header.magic, HRTF_BANK_MAGIC, sizeof(HRTF_BANK_MAGIC)) != 0 || header.version != kVersion
+    || header.ringCount != kRingCount || header.spectrumLength != kSpectrumLength
+    || header.elevationMin != kElevationMin || header.elevationStep != kElevationStep) {
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Ignoring incompatible HRTF bank.");
+    data->unlock();
+    return false;
+  }
+
+  size_t spectraSize = (size_t)header.sampleCount * 2 * kSpectrumLength * 2 * sizeof(float);
+  if (sizeof(header) + header.sampleCount * sizeof(float) > header.dataOffset || header.dataOffset + spectraSize > size) {
+    KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Ignoring truncated HRTF bank.");
+    data->unlock();
+    return false;
+  }
+  for (int ring = 0; ring < kRingCount; ring++) {
+    if (header.rings[ring].sampleCount == 0 || header.rings[ring].firstSample + header.rings[ring].sampleCount > header.sampleCount) {
+      KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Ignoring corrupt HRTF bank.");
+      data->unlock();
+      return false;
+    }
+  }
+
+  memcpy(m_rings, header.rings, sizeof(m_rings));
+  m_sampleCount = header.sampleCount;
+  m_azimuths = (const float*)(start + sizeof(header));
+  m_spectra = (const float*)(start + header.dataOffset);
+  m_data = data;
+  return true;
+}
+
+void KRHRTFBank::save(Block& data) const
+{
+  assert(isLoaded());
+
+  Header header{};
+  memcpy(header.magic, HRTF_BANK_MAGIC, sizeof(HRTF_BANK_MAGIC));
+  header.version = kVersion;
+  header.ringCount = kRingCount;
+  header.sampleCount = (uint32_t)m_sampleCount;
+  header.spectrumLength = kSpectrumLength;
+  header.elevationMin = kElevationMin;
+  header.elevationStep = kElevationStep;
+  memcpy(header.rings, m_rings, sizeof(header.rings));
+
+  size_t azimuthEnd = sizeof(header) + m_sampleCount * sizeof(float);
+  header.dataOffset = (uint32_t)((azimuthEnd + kDataAlignment - 1) & ~(kDataAlignment - 1));
+
+  data.append(&header, sizeof(header));
+  data.append((void*)m_azimuths, m_sampleCount * sizeof(float));
+  uint8_t padding[kDataAlignment] = {};
+  data.append(padding, header.dataOffset - azimuthEnd);
+  data.append((void*)m_spectra, m_sampleCount * 2 * kSpectrumLength * 2 * sizeof(float));
+}
+
+int KRHRTFBank::GetRing(float elevation)
+{
+  int ring = (int)floorf((elevation - kElevationMin) / kElevationStep);
+  return std::clamp(ring, 0, kRingCount - 1);
+}
+
+float KRHRTFBank::GetRingElevation(int ring)
+{
+  return (float)(kElevationMin + ring * kElevationStep);
+}
+
+float KRHRTFBank::getAzimuth(int ring, int index) const
+{
+  return m_azimuths[m_rings[ring].firstSample + index];
+}
+
+int KRHRTFBank::getAzimuthCount(int ring) const
+{
+  return (int)m_rings[ring].sampleCount;
+}
+
+int KRHRTFBank::findAzimuthFloor(int ring, float azimuth) const
+{
+  int count = getAzimuthCount(ring);
+  const float* azimuths = m_azimuths + m_rings[ring].firstSample;
+  if (count == 1) {
+    return 0;
+  }
+  // Azimuths are evenly spaced but rounded, so the estimate is off by at most one
+  float step = azimuths[count - 1] / (count - 1);
+  int index = std::clamp((int)(azimuth / step), 0, count - 1);
+  while (index > 0 && azimuths[index] > azimuth) {
+    index--;
+  }
+  while (index + 1 < count && azimuths[index + 1] <= azimuth) {
+    index++;
+  }
+  return index;
+}
+
+int KRHRTFBank::findAzimuthNearest(int ring, float azimuth) const
+{
+  int index = findAzimuthFloor(ring, azimuth);
+  if (index + 1 < getAzimuthCount(ring)) {
+    const float* azimuths = m_azimuths + m_rings[ring].firstSample;
+    if (azimuths[index + 1] - azimuth < azimuth - azimuths[index]) {
+      index++;
+    }
+  }
+  return index;
+}
+
+dsp::SplitComplex KRHRTFBank::getSpectral(int ring, int index, int channel) const
+{
+  const float* spectrum = m_spectra + ((m_rings[ring].firstSample + index) * 2 + channel) * kSpectrumLength * 2;
+  dsp::SplitComplex spectral;
+  spectral.realp = (float*)spectrum;
+  spectral.imagp = (float*)spectrum + kSpectrumLength;
+  return spectral;
+}
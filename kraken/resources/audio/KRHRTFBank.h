@@ -0,0 +1,125 @@
+//
+//  KRHRTFBank.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+#include "block.h"
+#include "siren.h"
+
+class KRAudioManager;
+
+// Frequency domain HRTF impulse responses for every direction of the KEMAR set.
+// Directions lie on rings of equal elevation with evenly spaced azimuths, so a
+// direction is found by indexing rather than by searching.  Only azimuths from
+// 0 to 180 degrees are stored; the other side is the mirror image with the
+// left and right channels swapped.
+//
+// The bank is baked into a single "krhrtf" resource by kraken_convert and used
+// in place from the loaded bundle.  If no baked bank is available, it is built
+// from the individual impulse response samples.
+class KRHRTFBank
+{
+public:
+  static const int kElevationMin = -40;
+  static const int kElevationMax = 90;
+  static const int kElevationStep = 10;
+  static const int kRingCount = (kElevationMax - kElevationMin) / kElevationStep + 1;
+  static const int kImpulseLength = 128;
+  static const int kSpectrumLength = 256; // Complex bins per channel; impulse responses are zero padded to the FFT size
+  static const int kSpectrumLog2 = 8;
+
+  KRHRTFBank();
+  ~KRHRTFBank();
+
+  // Transforms the individual KEMAR impulse responses
+  bool build(KRAudioManager& audioManager);
+  // Uses a baked bank in place.  The block is locked until the bank is cleared and
+  // must outlive it.
+  bool load(mimir::Block* data);
+  void save(mimir::Block& data) const;
+  void clear();
+
+  bool isLoaded() const;
+
+  // Ring with an elevation of at most the given elevation in degrees, clamped to the measured range
+  static int GetRing(float elevation);
+  static float GetRingElevation(int ring);
+
+  // Measured azimuth in degrees, from 0 to 180
+  float getAzimuth(int ring, int index) const;
+  int getAzimuthCount(int ring) const;
+  // Index of the last azimuth at most the given positive azimuth
+  int findAzimuthFloor(int ring, float azimuth) const;
+  // Index of the azimuth nearest to the given positive azimuth
+  int findAzimuthNearest(int ring, float azimuth) const;
+
+  siren::dsp::SplitComplex getSpectral(int ring, int index, int channel) const;
+
+private:
+  struct Ring
+  {
+    uint32_t firstSample;
+    uint32_t sampleCount;
+  };
+
+  // Layout of a baked bank.  The header is followed by the azimuth of every
+  // sample, then by the spectra starting at dataOffset, which is 64 byte aligned.
+  // Each sample holds the real then the imaginary bins of the left channel,
+  // followed by those of the right channel.
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t ringCount;
+    uint32_t sampleCount;
+    uint32_t spectrumLength;
+    uint32_t dataOffset;
+    int32_t elevationMin;
+    int32_t elevationStep;
+    Ring rings[kRingCount];
+  };
+
+  static const int kVersion = 1;
+  static const size_t kDataAlignment = 64;
+
+  Ring m_rings[kRingCount];
+  const float* m_azimuths;
+  const float* m_spectra;
+  size_t m_sampleCount;
+
+  // Owned storage when built from impulse responses
+  std::vector<float> m_builtAzimuths;
+  float* m_builtSpectra;
+
+  // Baked bank being used in place
+  mimir::Block* m_data;
+};
@@ -32,11 +32,23 @@
 #include "KRBundle.h"
 #include "KRContext.h"
 #include "KREngine-common.h"
+#include "KRResourceLoader.h"
+#include "mimir.h"
 
 using namespace mimir;
 
+// Version 1 krbundles are tar archives
 const int KRENGINE_KRBUNDLE_HEADER_SIZE = 512;
 
+// Version 2 krbundles start with a krbundle_header that locates the table of contents.
+// Resource data follows the header, in the order the resources were added to the bundle.
+// The table of contents is written after the resource data and holds one krbundle_toc_entry
+// per resource, sorted by lower case name and then by extension, followed by a string table
+// containing each resource's name immediately followed by its extension.
+const char KRENGINE_KRBUNDLE_MAGIC[8] = { 'K', 'R', 'B', 'U', 'N', 'D', 'L', 'E' };
+const __uint32_t KRENGINE_KRBUNDLE_VERSION = 2;
+const __uint64_t KRENGINE_KRBUNDLE_DATA_ALIGNMENT = 64;
+
 typedef struct _tar_header
 {
   char file_name[100];
@@ -51,50 +63,270 @@ typedef struct _tar_header
 
 } tar_header_type;
 
+typedef struct _krbundle_header
+{
+  char magic[8];
+  __uint32_t version;
+  __uint32_t entry_count;
+  __uint64_t toc_offset;
+  __uint64_t toc_size; // Size of the table of contents, including the string table
+} krbundle_header;
+
+typedef struct _krbundle_toc_entry
+{
+  __uint64_t data_offset;
+  __uint64_t data_size;
+  __uint64_t content_hash; // 64-bit FNV-1a hash of the resource data
+  __uint32_t name_offset; // Offset of the name within the string table
+  __uint16_t name_length;
+  __uint16_t extension_length; // The extension immediately follows the name in the string table
+} krbundle_toc_entry;
+
+namespace {
+__uint64_t RoundUp(__uint64_t s, __uint64_t alignment)
+{
+  return (s + alignment - 1) & ~(alignment - 1);
+}
+
+std::string ToLower(const std::string& s)
+{
+  std::string lower = s;
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  return lower;
+}
+} // anonymous namespace
+
 KRBundle::KRBundle(KRContext& context, std::string name, Block* pData) : KRResource(context, name)
 {
   m_pData = pData;
+  m_nextSequence = 0;
+
+  if (!readTableOfContents()) {
+    readTarEntries();
+  }
+
+  // Meshes, textures, audio samples and animation curves are looked up by name when they are
+  // needed, so they are only loaded on first use.  Everything else, such as scenes and materials
+  // which register themselves under other names, is decoded now in parallel and registered in
+  // the order it was bundled.
+  std::vector<Entry*> immediate;
+  for (Entry& entry : m_entries) {
+    if (!IsDeferredType(entry.extension)) {
+      entry.loaded = true;
+      immediate.push_back(&entry);
+    }
+  }
+  std::sort(immediate.begin(), immediate.end(), [](const Entry* a, const Entry* b) {
+    return a->sequence < b->sequence;
+  });
+  std::vector<KRResourceLoader::Request> requests(immediate.size());
+  for (size_t i = 0; i < immediate.size(); i++) {
+    requests[i].fileName = getEntryFileName(*immediate[i]);
+    requests[i].data = getEntryData(*immediate[i]);
+    requests[i].resource = nullptr;
+  }
+  context.getResourceLoader()->load(requests);
+}
+
+KRBundle::KRBundle(KRContext& context, std::string name) : KRResource(context, name)
+{
+  // Create an empty krbundle.  Resources are serialized as they are appended and the
+  // bundle is only assembled when it is saved.
+  m_pData = nullptr;
+  m_nextSequence = 0;
+}
 
-  __int64_t file_pos = 0;
-  while (file_pos < (__int64_t)m_pData->getSize()) {
+bool KRBundle::readTableOfContents()
+{
+  __uint64_t file_size = m_pData->getSize();
+  if (file_size < sizeof(krbundle_header)) {
+    return false;
+  }
+  krbundle_header header;
+  m_pData->copy(&header, 0, sizeof(header));
+  if (memcmp(header.magic, KRENGINE_KRBUNDLE_MAGIC, sizeof(header.magic)) != 0) {
+    return false;
+  }
+
+  if (header.version != KRENGINE_KRBUNDLE_VERSION
+    || header.toc_offset > file_size || header.toc_size > file_size - header.toc_offset
+    || (__uint64_t)header.entry_count * sizeof(krbundle_toc_entry) > header.toc_size) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to read krbundle: %s  Unsupported version or corrupt table of contents.", getName().c_str());
+    return true;
+  }
+
+  std::vector<unsigned char> toc(header.toc_size);
+  m_pData->copy(toc.data(), header.toc_offset, header.toc_size);
+  const unsigned char* strings = toc.data() + header.entry_count * sizeof(krbundle_toc_entry);
+  __uint64_t strings_size = header.toc_size - header.entry_count * sizeof(krbundle_toc_entry);
+
+  m_entries.reserve(header.entry_count);
+  for (__uint32_t i = 0; i < header.entry_count; i++) {
+    krbundle_toc_entry record;
+    memcpy(&record, toc.data() + i * sizeof(krbundle_toc_entry), sizeof(record));
+    if ((__uint64_t)record.name_offset + record.name_length + record.extension_length > strings_size
+      || record.data_offset > file_size || record.data_size > file_size - record.data_offset) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Skipping corrupt table of contents entry %i in krbundle: %s", i, getName().c_str());
+      continue;
+    }
+    Entry entry;
+    entry.name.assign((const char*)strings + record.name_offset, record.name_length);
+    entry.extension.assign((const char*)strings + record.name_offset + record.name_length, record.extension_length);
+    entry.key = ToLower(entry.name);
+    entry.offset = record.data_offset;
+    entry.size = record.data_size;
+    entry.hash = record.content_hash;
+    entry.sequence = record.data_offset; // Resource data is stored in the order it was added
+    entry.data = nullptr;
+    entry.loaded = false;
+    m_entries.push_back(entry);
+  }
+  if (!std::is_sorted(m_entries.begin(), m_entries.end(), EntryLess)) {
+    std::sort(m_entries.begin(), m_entries.end(), EntryLess);
+  }
+  m_nextSequence = file_size; // Resources appended later are ordered after everything in the file
+  return true;
+}
+
+void KRBundle::readTarEntries()
+{
+  __uint64_t file_size = m_pData->getSize();
+  __uint64_t file_pos = 0;
+  while (file_pos + KRENGINE_KRBUNDLE_HEADER_SIZE <= file_size) {
     tar_header_type file_header;
-    m_pData->copy(&file_header, (int)file_pos, sizeof(file_header));
-    size_t file_size = strtol(file_header.file_size, NULL, 8);
-    file_pos += 512; // Skip past the header to the file contents
+    m_pData->copy(&file_header, file_pos, sizeof(file_header));
+    __uint64_t entry_size = 0;
+    if (file_header.file_size[0] & 0x80) {
+      // Sizes of 8GB and larger are stored as a base-256 big-endian number
+      for (int i = 1; i < 12; i++) {
+        entry_size = (entry_size << 8) | (unsigned char)file_header.file_size[i];
+      }
+    } else {
+      char octal_size[13];
+      memcpy(octal_size, file_header.file_size, 12);
+      octal_size[12] = '\0';
+      entry_size = strtoull(octal_size, NULL, 8);
+    }
+    file_pos += KRENGINE_KRBUNDLE_HEADER_SIZE; // Skip past the header to the file contents
+    if (entry_size > file_size - file_pos) {
+      break;
+    }
     if (file_header.file_name[0] != '\0' && file_header.file_name[0] != '.') {
       // We ignore the last two records in the tar file, which are zero'ed out tar_header structures
-      Block* pFileData = pData->getSubBlock((int)file_pos, (int)file_size);
-      context.loadResource(file_header.file_name, pFileData);
+      std::string file_name(file_header.file_name, strnlen(file_header.file_name, sizeof(file_header.file_name)));
+      Entry entry;
+      entry.name = util::GetFileBase(file_name);
+      entry.extension = util::GetFileExtension(file_name);
+      entry.key = ToLower(entry.name);
+      entry.offset = file_pos;
+      entry.size = entry_size;
+      entry.hash = 0; // Not available for tar archives
+      entry.sequence = m_entries.size();
+      entry.data = nullptr;
+      entry.loaded = false;
+      m_entries.push_back(entry);
     }
-    file_pos += RoundUpSize(file_size);
+    file_pos += RoundUpSize(entry_size);
   }
+  m_nextSequence = m_entries.size();
+  std::stable_sort(m_entries.begin(), m_entries.end(), EntryLess);
 }
 
-KRBundle::KRBundle(KRContext& context, std::string name) : KRResource(context, name)
+std::string KRBundle::getEntryFileName(const Entry& entry)
 {
-  // Create an empty krbundle (tar) file, initialized with two zero-ed out file headers, which terminate it.
-  m_pData = new Block();
-  m_pData->expand(KRENGINE_KRBUNDLE_HEADER_SIZE * 2);
-  m_pData->lock();
-  memset(m_pData->getStart(), 0, m_pData->getSize());
-  m_pData->unlock();
+  std::string file_name = entry.name;
+  if (!entry.extension.empty()) {
+    file_name += "." + entry.extension;
+  }
+  return file_name;
 }
 
-size_t KRBundle::RoundUpSize(size_t s)
+Block* KRBundle::getEntryData(const Entry& entry)
 {
-  // Get amount of padding needed to increase s to a 512 byte alignment
-  if ((s & 0x01ff) == 0) {
-    // file size is a multiple of 512 bytes, we can just add it
-    return s;
-  } else {
-    // We would not be on a 512 byte boundary, round up to the next one
-    return (s + 0x0200) - (s & 0x1ff);
+  Block* pFileData = m_pData->getSubBlock(entry.offset, entry.size);
+#if defined(DEBUG) || defined(_DEBUG)
+  if (entry.hash != 0) {
+    pFileData->lock();
+    if (ContentHash(pFileData->getStart(), entry.size) != entry.hash) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Content hash mismatch for %s.%s in krbundle: %s", entry.name.c_str(), entry.extension.c_str(), getName().c_str());
+    }
+    pFileData->unlock();
   }
+#endif
+  return pFileData;
+}
+
+bool KRBundle::loadDeferred(const std::string& name)
+{
+  std::string key = ToLower(name);
+  // The file names and data are copied while locked, as m_entries may be reallocated by
+  // append() once the lock is released.
+  std::vector<std::pair<std::string, Block*>> pending;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Entry>::iterator itr = std::lower_bound(m_entries.begin(), m_entries.end(), key, [](const Entry& entry, const std::string& key) {
+      return entry.key < key;
+    });
+    for (; itr != m_entries.end() && itr->key == key; itr++) {
+      if (!itr->loaded) {
+        itr->loaded = true;
+        pending.push_back(std::make_pair(getEntryFileName(*itr), getEntryData(*itr)));
+      }
+    }
+  }
+  // Resources are loaded outside of the lock, as loading may request other resources
+  for (std::pair<std::string, Block*>& resource : pending) {
+    getContext().loadResource(resource.first, resource.second);
+  }
+  return !pending.empty();
+}
+
+bool KRBundle::IsDeferredType(const std::string& extension)
+{
+  const char* DEFERRED_EXTENSIONS[] = {
+    "krmesh", "kranimationcurve",
+    "png", "pvr", "ktx", "ktx2", "tga",
+    "wav", "mp3", "aac"
+  };
+  std::string lower_extension = ToLower(extension);
+  for (const char* deferred : DEFERRED_EXTENSIONS) {
+    if (lower_extension.compare(deferred) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool KRBundle::EntryLess(const Entry& a, const Entry& b)
+{
+  int c = a.key.compare(b.key);
+  if (c != 0) {
+    return c < 0;
+  }
+  return a.extension < b.extension;
+}
+
+__uint64_t KRBundle::ContentHash(const void* data, size_t size)
+{
+  __uint64_t hash = 0xcbf29ce484222325ULL;
+  const unsigned char* p = (const unsigned char*)data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ p[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
 
+__uint64_t KRBundle::RoundUpSize(__uint64_t s)
+{
+  // Get amount of padding needed to increase s to a 512 byte alignment
+  return RoundUp(s, KRENGINE_KRBUNDLE_HEADER_SIZE);
 }
 
 KRBundle::~KRBundle()
 {
+  for (Entry& entry : m_entries) {
+    delete entry.data;
+  }
   delete m_pData;
 }
 
@@ -105,68 +337,128 @@ std::string KRBundle::getExtension()
 
 bool KRBundle::save(const std::string& path)
 {
-  return m_pData->save(path);
+  Block data;
+  if (!serialize(data)) {
+    return false;
+  }
+  return data.save(path);
 }
 
 bool KRBundle::save(Block& data)
 {
-  if (m_pData->getSize() > KRENGINE_KRBUNDLE_HEADER_SIZE * 2) {
+  if (!m_entries.empty()) {
     // Only output krbundles that contain files
-    data.append(*m_pData);
+    return serialize(data);
   }
   return true;
 }
 
-Block* KRBundle::append(KRResource& resource)
+bool KRBundle::serialize(Block& data)
 {
-  // Serialize resource to binary representation
-  Block resource_data;
-  resource.save(resource_data);
-
-  std::string file_name = resource.getName() + "." + resource.getExtension();
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-  // Padding is added at the end of file to align next header to a 512 byte boundary.  Padding at the end of the archive includes an additional 1024 bytes -- two zero-ed out file headers that mark the end of the archive
-  size_t padding_size = RoundUpSize(resource_data.getSize()) - resource_data.getSize() + KRENGINE_KRBUNDLE_HEADER_SIZE * 2;
-  size_t resource_data_start = m_pData->getSize() + KRENGINE_KRBUNDLE_HEADER_SIZE;
-  m_pData->expand(KRENGINE_KRBUNDLE_HEADER_SIZE + resource_data.getSize() + padding_size - KRENGINE_KRBUNDLE_HEADER_SIZE * 2); // We will overwrite the existing zero-ed out file headers that marked the end of the archive, so we don't have to include their size here
+  // Lay out the resource data in the order the resources were added, followed by the table of contents
+  std::vector<size_t> order(m_entries.size());
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return m_entries[a].sequence < m_entries[b].sequence;
+  });
 
-  m_pData->lock();
+  std::vector<__uint64_t> data_offsets(m_entries.size());
+  __uint64_t data_end = sizeof(krbundle_header);
+  for (size_t i : order) {
+    data_end = RoundUp(data_end, KRENGINE_KRBUNDLE_DATA_ALIGNMENT);
+    data_offsets[i] = data_end;
+    data_end += m_entries[i].size;
+  }
 
-  // Get location of file header
-  tar_header_type* file_header = (tar_header_type*)((unsigned char*)m_pData->getEnd() - padding_size - resource_data.getSize() - KRENGINE_KRBUNDLE_HEADER_SIZE);
+  __uint64_t strings_size = 0;
+  for (const Entry& entry : m_entries) {
+    assert(entry.name.size() <= 0xffff && entry.extension.size() <= 0xffff);
+    strings_size += entry.name.size() + entry.extension.size();
+  }
 
-  // Zero out new file header
-  memset(file_header, 0, KRENGINE_KRBUNDLE_HEADER_SIZE);
+  krbundle_header header;
+  memcpy(header.magic, KRENGINE_KRBUNDLE_MAGIC, sizeof(header.magic));
+  header.version = KRENGINE_KRBUNDLE_VERSION;
+  header.entry_count = (__uint32_t)m_entries.size();
+  header.toc_offset = RoundUp(data_end, 8);
+  header.toc_size = m_entries.size() * sizeof(krbundle_toc_entry) + strings_size;
 
-  // Copy resource data
-  resource_data.lock();
-  memcpy((unsigned char*)m_pData->getEnd() - padding_size - resource_data.getSize(), resource_data.getStart(), resource_data.getSize());
-  resource_data.unlock();
+  __uint64_t base = data.getSize();
+  __uint64_t bundle_size = header.toc_offset + header.toc_size;
+  data.expand(bundle_size);
+  data.lock();
+  unsigned char* out = (unsigned char*)data.getStart() + base;
+  memset(out, 0, bundle_size);
+  memcpy(out, &header, sizeof(header));
 
-  // Zero out alignment padding and terminating set of file header blocks
-  memset((unsigned char*)m_pData->getEnd() - padding_size, 0, padding_size);
+  unsigned char* toc = out + header.toc_offset;
+  unsigned char* strings = toc + m_entries.size() * sizeof(krbundle_toc_entry);
+  __uint32_t string_offset = 0;
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    const Entry& entry = m_entries[i];
+    if (entry.data) {
+      entry.data->lock();
+      memcpy(out + data_offsets[i], entry.data->getStart(), entry.size);
+      entry.data->unlock();
+    } else {
+      m_pData->copy(out + data_offsets[i], entry.offset, entry.size);
+    }
 
-  // Populate new file header fields
-  strncpy(file_header->file_name, file_name.c_str(), 100);
-  strcpy(file_header->file_mode, "000644 ");
-  strcpy(file_header->owner_id, "000000 ");
-  strcpy(file_header->group_id, "000000 ");
-  sprintf(file_header->file_size, "%011o", (int)resource_data.getSize());
-  file_header->file_size[11] = ' '; // Terminate with space rather than '\0'
-  sprintf(file_header->mod_time, "%011o", (int)time(NULL));
-  file_header->mod_time[11] = ' '; // Terminate with space rather than '\0'
+    krbundle_toc_entry record;
+    record.data_offset = data_offsets[i];
+    record.data_size = entry.size;
+    record.content_hash = entry.hash;
+    record.name_offset = string_offset;
+    record.name_length = (__uint16_t)entry.name.size();
+    record.extension_length = (__uint16_t)entry.extension.size();
+    memcpy(toc + i * sizeof(krbundle_toc_entry), &record, sizeof(record));
 
-  // Calculate and write checksum for header
-  memset(file_header->checksum, ' ', 8); // Must be filled with spaces and no null terminator during checksum calculation
-  int check_sum = 0;
-  for (int i = 0; i < KRENGINE_KRBUNDLE_HEADER_SIZE; i++) {
-    unsigned char* byte_ptr = (unsigned char*)file_header;
-    check_sum += byte_ptr[i];
+    memcpy(strings + string_offset, entry.name.data(), entry.name.size());
+    string_offset += (__uint32_t)entry.name.size();
+    memcpy(strings + string_offset, entry.extension.data(), entry.extension.size());
+    string_offset += (__uint32_t)entry.extension.size();
   }
-  sprintf(file_header->checksum, "%07o", check_sum);
+  data.unlock();
+  return true;
+}
 
-  m_pData->unlock();
+Block* KRBundle::append(KRResource& resource)
+{
+  // Serialize resource to binary representation.  Previously appended resources
+  // are not copied again; the bundle is assembled when it is saved.
+  Block* resource_data = new Block();
+  resource.save(*resource_data);
 
-  Block* pFileData = m_pData->getSubBlock((int)resource_data_start, (int)resource_data.getSize());
-  return pFileData;
+  Entry entry;
+  entry.name = resource.getName();
+  entry.extension = resource.getExtension();
+  entry.key = ToLower(entry.name);
+  entry.offset = 0;
+  entry.size = resource_data->getSize();
+  resource_data->lock();
+  entry.hash = ContentHash(resource_data->getStart(), entry.size);
+  resource_data->unlock();
+  entry.data = resource_data;
+  entry.loaded = true;
+  insertEntry(entry);
+
+  return resource_data->getSubBlock(0, entry.size);
+}
+
+void KRBundle::insertEntry(Entry& entry)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  entry.sequence = m_nextSequence++;
+  std::vector<Entry>::iterator itr = std::lower_bound(m_entries.begin(), m_entries.end(), entry, EntryLess);
+  if (itr != m_entries.end() && !EntryLess(entry, *itr)) {
+    // Replace a resource with the same name and extension
+    delete itr->data;
+    *itr = entry;
+  } else {
+    m_entries.insert(itr, entry);
+  }
 }
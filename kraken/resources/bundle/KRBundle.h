@@ -46,7 +46,38 @@ public:
 
   mimir::Block* append(KRResource& resource);
 
+  // Loads the resources in this bundle with the given name that were deferred until first use.
+  // Returns true if any resources were loaded.
+  bool loadDeferred(const std::string& name);
+
 private:
+  typedef struct
+  {
+    std::string name;
+    std::string extension;
+    std::string key; // Lower case name, used to sort the table of contents
+    __uint64_t offset;
+    __uint64_t size;
+    __uint64_t hash;
+    __uint64_t sequence; // Order in which the resource was added to the bundle
+    mimir::Block* data; // Serialized resource, for resources appended since the bundle was loaded
+    bool loaded;
+  } Entry;
+
   mimir::Block* m_pData;
-  static size_t RoundUpSize(size_t s);
+  std::vector<Entry> m_entries; // Sorted by key, then by extension
+  __uint64_t m_nextSequence;
+  std::mutex m_mutex;
+
+  bool readTableOfContents();
+  void readTarEntries();
+  std::string getEntryFileName(const Entry& entry);
+  mimir::Block* getEntryData(const Entry& entry);
+  void insertEntry(Entry& entry);
+  bool serialize(mimir::Block& data);
+
+  static bool IsDeferredType(const std::string& extension);
+  static bool EntryLess(const Entry& a, const Entry& b);
+  static __uint64_t ContentHash(const void* data, size_t size);
+  static __uint64_t RoundUpSize(__uint64_t s);
 };
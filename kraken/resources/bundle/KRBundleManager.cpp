@@ -81,6 +81,18 @@ KRBundle* KRBundleManager::getBundle(const char* szName)
   return m_bundles[szName];
 }
 
+bool KRBundleManager::loadDeferredResources(const std::string& name)
+{
+  bool loaded = false;
+  for (unordered_map<std::string, KRBundle*>::iterator itr = m_bundles.begin(); itr != m_bundles.end(); ++itr) {
+    KRBundle* bundle = (*itr).second;
+    if (bundle && bundle->loadDeferred(name)) {
+      loaded = true;
+    }
+  }
+  return loaded;
+}
+
 unordered_map<std::string, KRBundle*> KRBundleManager::getBundles()
 {
   return m_bundles;
@@ -53,6 +53,10 @@ public:
   KRBundle* getBundle(const char* szName);
   KRBundle* createBundle(const char* szName);
 
+  // Loads resources with the given name that bundles deferred until first use.
+  // Returns true if any resources were loaded.
+  bool loadDeferredResources(const std::string& name);
+
   std::vector<std::string> getBundleNames();
   unordered_map<std::string, KRBundle*> getBundles();
 
@@ -743,7 +743,7 @@ kraken_stream_level KRMaterial::getStreamLevel()
   return stream_level;
 }
 
-bool KRMaterial::bind(KRNode::RenderInfo& ri, const VertexBufferLayout* layout, CullMode cullMode, const std::vector<KRBone*>& bones, const std::vector<Matrix4>& bind_poses, const Matrix4& matModel, KRTexture* pLightMap, float lod_coverage)
+bool KRMaterial::bind(KRNode::RenderInfo& ri, const VertexBufferLayout* layout, CullMode cullMode, const KRSkinPalette* skinPalette, const Matrix4& matModel, KRTexture* pLightMap, float lod_coverage)
 {
   bool bLightMap = pLightMap && ri.camera->settings.bEnableLightMap;
 
@@ -759,13 +759,13 @@ bool KRMaterial::bind(KRNode::RenderInfo& ri, const VertexBufferLayout* layout,
   bool bAlphaBlend = m_alphaMode == KRMATERIAL_ALPHA_MODE_BLEND;
 
   PipelineInfo info{};
-  std::string shader_name("object");
+  static const std::string shader_name("object");
   info.shader_name = &shader_name;
   info.pCamera = ri.camera;
   info.point_lights = &ri.point_lights;
   info.directional_lights = &ri.directional_lights;
   info.spot_lights = &ri.spot_lights;
-  info.bone_count = (int)bones.size();
+  info.bone_count = skinPalette ? (int)skinPalette->getBoneCount() : 0;
   info.renderPass = ri.renderPass;
   info.bDiffuseMap = bDiffuseMap;
   info.bNormalMap = bNormalMap;
@@ -792,39 +792,11 @@ bool KRMaterial::bind(KRNode::RenderInfo& ri, const VertexBufferLayout* layout,
   }
 
   // Bind bones
-  if (pShader->hasPushConstant(ShaderValue::bone_transforms)) {
-    float bone_mats[256 * 16];
-    float* bone_mat_component = bone_mats;
-    for (int bone_index = 0; bone_index < bones.size(); bone_index++) {
-      KRBone* bone = bones[bone_index];
-
-      //                Vector3 initialRotation = bone->getInitialLocalRotation();
-      //                Vector3 rotation = bone->getLocalRotation();
-      //                Vector3 initialTranslation = bone->getInitialLocalTranslation();
-      //                Vector3 translation = bone->getLocalTranslation();
-      //                Vector3 initialScale = bone->getInitialLocalScale();
-      //                Vector3 scale = bone->getLocalScale();
-      //                
-                  //printf("%s - delta rotation: %.4f %.4f %.4f\n", bone->getName().c_str(), (rotation.x - initialRotation.x) * 180.0 / M_PI, (rotation.y - initialRotation.y) * 180.0 / M_PI, (rotation.z - initialRotation.z) * 180.0 / M_PI);
-                  //printf("%s - delta translation: %.4f %.4f %.4f\n", bone->getName().c_str(), translation.x - initialTranslation.x, translation.y - initialTranslation.y, translation.z - initialTranslation.z);
-      //                printf("%s - delta scale: %.4f %.4f %.4f\n", bone->getName().c_str(), scale.x - initialScale.x, scale.y - initialScale.y, scale.z - initialScale.z);
-
-      Matrix4 skin_bone_bind_pose = bind_poses[bone_index];
-      Matrix4 active_mat = bone->getActivePoseMatrix();
-      Matrix4 inv_bind_mat = bone->getInverseBindPoseMatrix();
-      Matrix4 inv_bind_mat2 = Matrix4::Invert(bind_poses[bone_index]);
-      Matrix4 t = (inv_bind_mat * active_mat);
-      Matrix4 t2 = inv_bind_mat2 * bone->getModelMatrix();
-      for (int i = 0; i < 16; i++) {
-        *bone_mat_component++ = t[i];
-      }
-    }
-    /*
-    * TODO: Implement Skinned Mesh bone transform buffer upload
-    if (pShader->hasPushConstant(ShaderValue::bone_transforms)) {
-      pShader->setPushConstant(ShaderValue::bone_transforms, (Matrix4*)bone_mats, bones.size());
+  if (skinPalette) {
+    if (!pShader->setStorageBuffer("bone_transforms", skinPalette->buffer, skinPalette->offset, skinPalette->matrices.size() * sizeof(float))) {
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Skinned pipeline for material %s has no bone_transforms storage buffer.", getName().c_str());
+      return false;
     }
-    */
   }
 
   bool success = true;
@@ -101,6 +101,16 @@ void KRMaterialManager::add(KRMaterial* new_material)
 
 KRMaterial* KRMaterialManager::loadMtl(Block* data)
 {
+  std::vector<KRMaterial*> materials = ParseMtl(*m_pContext, data);
+  for (KRMaterial* material : materials) {
+    add(material);
+  }
+  return materials.empty() ? NULL : materials.back();
+}
+
+std::vector<KRMaterial*> KRMaterialManager::ParseMtl(KRContext& context, Block* data)
+{
+  std::vector<KRMaterial*> materials;
   KRMaterial* pMaterial = NULL;
   char szSymbol[16][256];
   data->lock();
@@ -145,8 +155,8 @@ KRMaterial* KRMaterialManager::loadMtl(Block* data)
 
         if (strcmp(szSymbol[0], "newmtl") == 0 && cSymbols >= 2) {
 
-          pMaterial = new KRMaterial(*m_pContext, szSymbol[1]);
-          m_materials[szSymbol[1]] = pMaterial;
+          pMaterial = new KRMaterial(context, szSymbol[1]);
+          materials.push_back(pMaterial);
         }
         if (pMaterial != NULL) {
           if (strcmp(szSymbol[0], "alpha_mode") == 0) {
@@ -297,5 +307,5 @@ KRMaterial* KRMaterialManager::loadMtl(Block* data)
   }
   data->unlock();
   delete data;
-  return pMaterial;
+  return materials;
 }
@@ -53,6 +53,8 @@ public:
   virtual KRResource* getResource(const std::string& name, const std::string& extension) override;
 
   KRMaterial* loadMtl(mimir::Block* data);
+  // Parses the materials in an mtl file without adding them to a manager.  Takes ownership of data.
+  static std::vector<KRMaterial*> ParseMtl(KRContext& context, mimir::Block* data);
   void add(KRMaterial* new_material);
   KRMaterial* getMaterial(const std::string& name);
 
@@ -36,12 +36,15 @@
 #include "KREngine-common.h"
 
 #include "KRMesh.h"
+#include "KRMeshBVH.h"
 
 #include "KRPipeline.h"
 #include "KRPipelineManager.h"
 #include "KRContext.h"
 #include "KRRenderPass.h"
-#include "../3rdparty/forsyth/forsyth.h"
+#include "KRWorkerPool.h"
+#include "KRMeshOptimizer.h"
+#include "KRVertexWelder.h"
 
 using namespace mimir;
 using namespace hydra;
@@ -106,7 +109,9 @@ KRMesh::~KRMesh()
 void KRMesh::releaseData(bool includeMainDatablock /* = true*/)
 {
   m_hasTransparency = false;
+  m_bvh.reset();
   m_submeshes.clear();
+  m_boneInverseBindPoses.clear();
   if (m_pIndexBaseData) {
     m_pIndexBaseData->unlock();
     delete m_pIndexBaseData;
@@ -150,12 +155,34 @@ void KRMesh::loadPack(Block* data)
   m_pMetaData = m_pData->getSubBlock(0, sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count);
   m_pMetaData->lock();
 
-  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + KRALIGN(2 * ph.primitive.indexCount), ph.index_base_count * 8);
+  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + getIndexDataSize(ph), ph.index_base_count * 8);
   m_pIndexBaseData->lock();
 
   m_extents = ph.extents;
 }
 
+bool KRMesh::ValidatePack(Block* data)
+{
+  __uint64_t size = data->getSize();
+  if (size < sizeof(pack_header)) {
+    return false;
+  }
+  pack_header ph;
+  data->copy((void*)&ph, 0, sizeof(ph));
+  if (ph.submesh_count < 0 || ph.bone_count < 0 || ph.index_base_count < 0
+    || (int)ph.index_format >= (int)IndexFormatSize.size()
+    || ph.primitive.vertexCount < 0 || ph.primitive.indexCount < 0 || ph.primitive.layout.vertexSize < 0) {
+    return false;
+  }
+  __uint64_t required = sizeof(pack_header)
+    + sizeof(pack_material) * (__uint64_t)ph.submesh_count
+    + sizeof(pack_bone) * (__uint64_t)ph.bone_count
+    + getIndexDataSize(ph)
+    + KRALIGN(8 * (__uint64_t)ph.index_base_count)
+    + (__uint64_t)ph.primitive.layout.vertexSize * (__uint64_t)ph.primitive.vertexCount;
+  return required <= size;
+}
+
 void KRMesh::getMaterials()
 {
   if (m_materials.size() != 0) {
@@ -233,7 +260,7 @@ kraken_stream_level KRMesh::getStreamLevel()
 }
 
 
-void KRMesh::render(KRNode::RenderInfo& ri, const std::string& object_name, const Matrix4& matModel, KRTexture* pLightMap, const std::vector<KRBone*>& bones, float lod_coverage)
+void KRMesh::render(KRNode::RenderInfo& ri, const std::string& object_name, const Matrix4& matModel, KRTexture* pLightMap, const KRSkinPalette* skinPalette, float lod_coverage)
 {
   //fprintf(stderr, "Rendering model: %s\n", m_name.c_str());
   if (ri.renderPass->getType() != RenderPassType::RENDER_PASS_ADDITIVE_PARTICLES && ri.renderPass->getType() != RenderPassType::RENDER_PASS_PARTICLE_OCCLUSION && ri.renderPass->getType() != RenderPassType::RENDER_PASS_VOLUMETRIC_EFFECTS_ADDITIVE) {
@@ -256,15 +283,10 @@ void KRMesh::render(KRNode::RenderInfo& ri, const std::string& object_name, cons
 
           if (pMaterial) {
             if ((!pMaterial->isTransparent() && ri.renderPass->getType() != RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT) || (pMaterial->isTransparent() && ri.renderPass->getType() == RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT)) {
-              std::vector<Matrix4> bone_bind_poses;
-              for (int i = 0; i < (int)bones.size(); i++) {
-                bone_bind_poses.push_back(getBoneBindPose(i)); 
-              }
-
               switch (pMaterial->getAlphaMode()) {
               case KRMaterial::KRMATERIAL_ALPHA_MODE_OPAQUE: // Non-transparent materials
               case KRMaterial::KRMATERIAL_ALPHA_MODE_TEST: // Alpha in diffuse texture is interpreted as punch-through when < 0.5
-                if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullBack, bones, bone_bind_poses, matModel, pLightMap, lod_coverage))
+                if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullBack, skinPalette, matModel, pLightMap, lod_coverage))
                 {
                   renderSubmesh(ri.commandBuffer, iSubmesh, ri.renderPass, object_name, pMaterial->getName(), lod_coverage);
                 }
@@ -274,14 +296,14 @@ void KRMesh::render(KRNode::RenderInfo& ri, const std::string& object_name, cons
                   // Blended alpha rendered in two passes.  First pass renders backfaces; second pass renders frontfaces.
                   // 
                   // Render back faces before front faces
-                  if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullFront, bones, bone_bind_poses, matModel, pLightMap, lod_coverage))
+                  if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullFront, skinPalette, matModel, pLightMap, lod_coverage))
                   {
                     renderSubmesh(ri.commandBuffer, iSubmesh, ri.renderPass, object_name, pMaterial->getName(), lod_coverage);
                   }
                 }
 
                 // Render front faces
-                if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullBack, bones, bone_bind_poses, matModel, pLightMap, lod_coverage))
+                if (pMaterial->bind(ri, &getHeader()->primitive.layout, CullMode::kCullBack, skinPalette, matModel, pLightMap, lod_coverage))
                 {
                   renderSubmesh(ri.commandBuffer, iSubmesh, ri.renderPass, object_name, pMaterial->getName(), lod_coverage);
                 }
@@ -354,11 +376,11 @@ void KRMesh::createDataBlocks(KRMeshManager::KRVBOData::vbo_type t)
         getIndexedRange(index_group++, start_index_offset, start_vertex_offset, index_count, vertex_count);
 
         if ((int)mesh.vertex_data_blocks.size() <= vbo_index) {
-          int vertex_count = getHeader()->primitive.vertexCount;
           int vertex_size = getHeader()->primitive.layout.vertexSize;
+          int index_size = IndexFormatSize[(int)pHeader->index_format];
           Block* vertex_data_block = m_pData->getSubBlock(vertex_data_offset + start_vertex_offset * vertex_size, vertex_count * vertex_size);
-          Block* index_data_block = m_pData->getSubBlock(index_data_offset + start_index_offset * 2, index_count * 2);
-          mesh.vbo_data_blocks.emplace_back(std::make_shared<KRMeshManager::KRVBOData>(getContext().getMeshManager(), vertex_data_block, index_data_block, &pHeader->primitive.layout, true, t
+          Block* index_data_block = m_pData->getSubBlock(index_data_offset + start_index_offset * index_size, index_count * index_size);
+          mesh.vbo_data_blocks.emplace_back(std::make_shared<KRMeshManager::KRVBOData>(getContext().getMeshManager(), vertex_data_block, index_data_block, pHeader->index_format, &pHeader->primitive.layout, true, t
 #if KRENGINE_DEBUG_GPU_LABELS
             , m_lodBaseName.c_str()
 #endif
@@ -387,7 +409,7 @@ void KRMesh::createDataBlocks(KRMeshManager::KRVBOData::vbo_type t)
         if ((int)mesh.vertex_data_blocks.size() <= vbo_index) {
           Block* index_data_block = NULL;
           Block* vertex_data_block = m_pData->getSubBlock(vertex_data_offset + iBuffer * MAX_VBO_SIZE * vertex_size, vertex_size * cBufferVertexes);
-          mesh.vbo_data_blocks.emplace_back(std::make_shared<KRMeshManager::KRVBOData>(getContext().getMeshManager(), vertex_data_block, index_data_block, &pHeader->primitive.layout, true, t
+          mesh.vbo_data_blocks.emplace_back(std::make_shared<KRMeshManager::KRVBOData>(getContext().getMeshManager(), vertex_data_block, index_data_block, IndexFormat::uint16, &pHeader->primitive.layout, true, t
 #if KRENGINE_DEBUG_GPU_LABELS
             , m_lodBaseName.c_str()
 #endif
@@ -460,7 +482,7 @@ void KRMesh::renderSubmesh(VkCommandBuffer& commandBuffer, int iSubmesh, const K
       int vertex_draw_count = cVertexes;
       if (vertex_draw_count > index_count - index_group_offset) vertex_draw_count = index_count - index_group_offset;
 
-      vkCmdDrawIndexed(commandBuffer, vertex_draw_count, 1, index_group_offset, 0, 0);
+      vkCmdDrawIndexed(commandBuffer, vertex_draw_count, 1, vbo_data_block.getFirstIndex() + index_group_offset, vbo_data_block.getBaseVertex(), 0);
       m_pContext->getMeshManager()->log_draw_call(renderPass->getType(), object_name, material_name, vertex_draw_count);
       cVertexes -= vertex_draw_count;
       index_group_offset = 0;
@@ -481,7 +503,7 @@ void KRMesh::renderSubmesh(VkCommandBuffer& commandBuffer, int iSubmesh, const K
 
       if (iVertex + cVertexes >= MAX_VBO_SIZE) {
         assert(iVertex + (MAX_VBO_SIZE - iVertex) <= cBufferVertexes);
-        vkCmdDraw(commandBuffer, (MAX_VBO_SIZE - iVertex), 1, iVertex, 0);
+        vkCmdDraw(commandBuffer, (MAX_VBO_SIZE - iVertex), 1, vbo_data_block.getBaseVertex() + iVertex, 0);
         m_pContext->getMeshManager()->log_draw_call(renderPass->getType(), object_name, material_name, (MAX_VBO_SIZE - iVertex));
 
         cVertexes -= (MAX_VBO_SIZE - iVertex);
@@ -490,7 +512,7 @@ void KRMesh::renderSubmesh(VkCommandBuffer& commandBuffer, int iSubmesh, const K
       } else {
         assert(iVertex + cVertexes <= cBufferVertexes);
 
-        vkCmdDraw(commandBuffer, cVertexes, 1, iVertex, 0);
+        vkCmdDraw(commandBuffer, cVertexes, 1, vbo_data_block.getBaseVertex() + iVertex, 0);
         m_pContext->getMeshManager()->log_draw_call(renderPass->getType(), object_name, material_name, cVertexes);
 
         cVertexes = 0;
@@ -502,9 +524,6 @@ void KRMesh::renderSubmesh(VkCommandBuffer& commandBuffer, int iSubmesh, const K
 
 void KRMesh::LoadData(const KRMesh::mesh_info& mi, bool calculate_normals, bool calculate_tangents)
 {
-
-  releaseData();
-
   // TODO, FINDME - These values should be passed as a parameter and set by GUI flags
   bool use_f16_vertexes = false;
   bool use_f16_normals = true;
@@ -604,24 +623,20 @@ void KRMesh::LoadData(const KRMesh::mesh_info& mi, bool calculate_normals, bool
   primitive.vertexCount = mi.vertices.size();
   primitive.indexCount = mi.vertex_indexes.size();
 
-  size_t index_count = mi.vertex_indexes.size();
-  size_t index_base_count = mi.vertex_index_bases.size();
-  size_t submesh_count = mi.submesh_lengths.size();
+  // Indexes are relative to their index base; use 16-bit indexes unless one can't be represented
+  IndexFormat index_format = IndexFormat::uint16;
+  for (__uint32_t index : mi.vertex_indexes) {
+    if (index > 0xffff) {
+      index_format = IndexFormat::uint32;
+      break;
+    }
+  }
+
   size_t bone_count = mi.bone_names.size();
-  size_t new_file_size = sizeof(pack_header) + sizeof(pack_material) * submesh_count + sizeof(pack_bone) * bone_count + KRALIGN(2 * index_count) + KRALIGN(8 * index_base_count) + primitive.layout.vertexSize * primitive.vertexCount;
-  m_pData = new Block();
-  m_pMetaData = m_pData;
-  m_pData->expand(new_file_size);
-  m_pData->lock();
+  PackData pack = beginPack(primitive, index_format, (int)mi.submesh_lengths.size(), (int)bone_count, (int)mi.vertex_index_bases.size());
   pack_header* pHeader = getHeader();
-  memset(pHeader, 0, sizeof(pack_header));
-  memcpy(&pHeader->primitive, &primitive, sizeof(PrimitiveInfo));
-  pHeader->submesh_count = (__int32_t)submesh_count;
-  pHeader->bone_count = (__int32_t)bone_count;
-  pHeader->index_base_count = (__int32_t)index_base_count;
-  strcpy(pHeader->szTag, "KRMESH1.0      ");
 
-  pack_material* pPackMaterials = (pack_material*)(pHeader + 1);
+  pack_material* pPackMaterials = pack.submeshes;
 
   for (int iMaterial = 0; iMaterial < pHeader->submesh_count; iMaterial++) {
     pack_material* pPackMaterial = pPackMaterials + iMaterial;
@@ -675,11 +690,8 @@ void KRMesh::LoadData(const KRMesh::mesh_info& mi, bool calculate_normals, bool
     }
   }
 
-  pHeader->extents = m_extents;
-
-  __uint16_t* index_data = getIndexData();
-  for (std::vector<__uint16_t>::const_iterator itr = mi.vertex_indexes.begin(); itr != mi.vertex_indexes.end(); itr++) {
-    *index_data++ = *itr;
+  for (int i = 0; i < (int)mi.vertex_indexes.size(); i++) {
+    setIndex(i, mi.vertex_indexes[i]);
   }
 
   __uint32_t* index_base_data = getIndexBaseData();
@@ -767,6 +779,41 @@ void KRMesh::LoadData(const KRMesh::mesh_info& mi, bool calculate_normals, bool
       assert(false); // Not Supported
     } // switch
   }
+
+  endPack(m_extents);
+}
+
+KRMesh::PackData KRMesh::beginPack(const PrimitiveInfo& primitive, IndexFormat indexFormat, int submeshCount, int boneCount, int indexBaseCount)
+{
+  releaseData();
+
+  size_t new_file_size = sizeof(pack_header) + sizeof(pack_material) * submeshCount + sizeof(pack_bone) * boneCount + KRALIGN(IndexFormatSize[(int)indexFormat] * primitive.indexCount) + KRALIGN(8 * indexBaseCount) + primitive.layout.vertexSize * primitive.vertexCount;
+  m_pData = new Block();
+  m_pMetaData = m_pData;
+  m_pData->expand(new_file_size);
+  m_pData->lock();
+  pack_header* pHeader = getHeader();
+  memset(pHeader, 0, sizeof(pack_header));
+  memcpy(&pHeader->primitive, &primitive, sizeof(PrimitiveInfo));
+  pHeader->submesh_count = (__int32_t)submeshCount;
+  pHeader->bone_count = (__int32_t)boneCount;
+  pHeader->index_base_count = (__int32_t)indexBaseCount;
+  pHeader->index_format = indexFormat;
+  strcpy(pHeader->szTag, "KRMESH1.0      ");
+
+  PackData pack;
+  pack.submeshes = getSubmesh(0);
+  pack.bones = getBone(0);
+  pack.indexes = getIndexData();
+  pack.indexBases = getIndexBaseData();
+  pack.vertexes = getVertexData();
+  return pack;
+}
+
+void KRMesh::endPack(const AABB& extents)
+{
+  m_extents = extents;
+  getHeader()->extents = extents;
   m_pData->unlock();
 
   // ----
@@ -775,7 +822,7 @@ void KRMesh::LoadData(const KRMesh::mesh_info& mi, bool calculate_normals, bool
   m_pData->copy((void*)&ph, 0, sizeof(ph));
   m_pMetaData = m_pData->getSubBlock(0, sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count);
   m_pMetaData->lock();
-  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + KRALIGN(2 * ph.primitive.indexCount), ph.index_base_count * 8);
+  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + getIndexDataSize(ph), ph.index_base_count * 8);
   m_pIndexBaseData->lock();
 
   // ----
@@ -847,13 +894,40 @@ unsigned char* KRMesh::getVertexData() const
 size_t KRMesh::getVertexDataOffset() const
 {
   pack_header* pHeader = getHeader();
-  return sizeof(pack_header) + sizeof(pack_material) * pHeader->submesh_count + sizeof(pack_bone) * pHeader->bone_count + KRALIGN(2 * pHeader->primitive.indexCount) + KRALIGN(8 * pHeader->index_base_count);
+  return sizeof(pack_header) + sizeof(pack_material) * pHeader->submesh_count + sizeof(pack_bone) * pHeader->bone_count + getIndexDataSize(*pHeader) + KRALIGN(8 * pHeader->index_base_count);
+}
+
+void* KRMesh::getIndexData() const
+{
+  return (unsigned char*)m_pData->getStart() + getIndexDataOffset();
 }
 
-__uint16_t* KRMesh::getIndexData() const
+size_t KRMesh::getIndexDataSize(const pack_header& header)
 {
+  return KRALIGN(IndexFormatSize[(int)header.index_format] * header.primitive.indexCount);
+}
 
-  return (__uint16_t*)((unsigned char*)m_pData->getStart() + getIndexDataOffset());
+IndexFormat KRMesh::getIndexFormat() const
+{
+  return getHeader()->index_format;
+}
+
+__uint32_t KRMesh::getIndex(int index) const
+{
+  if (getIndexFormat() == IndexFormat::uint32) {
+    return ((__uint32_t*)getIndexData())[index];
+  }
+  return ((__uint16_t*)getIndexData())[index];
+}
+
+void KRMesh::setIndex(int index, __uint32_t value)
+{
+  if (getIndexFormat() == IndexFormat::uint32) {
+    ((__uint32_t*)getIndexData())[index] = value;
+  } else {
+    assert(value <= 0xffff);
+    ((__uint16_t*)getIndexData())[index] = (__uint16_t)value;
+  }
 }
 
 size_t KRMesh::getIndexDataOffset() const
@@ -866,7 +940,7 @@ __uint32_t* KRMesh::getIndexBaseData() const
 {
   if (m_pIndexBaseData == NULL) {
     pack_header* pHeader = getHeader();
-    return (__uint32_t*)((unsigned char*)m_pData->getStart() + sizeof(pack_header) + sizeof(pack_material) * pHeader->submesh_count + sizeof(pack_bone) * pHeader->bone_count + KRALIGN(2 * pHeader->primitive.indexCount));
+    return (__uint32_t*)((unsigned char*)m_pData->getStart() + sizeof(pack_header) + sizeof(pack_material) * pHeader->submesh_count + sizeof(pack_bone) * pHeader->bone_count + getIndexDataSize(*pHeader));
   } else {
     return (__uint32_t*)m_pIndexBaseData->getStart();
   }
@@ -1824,6 +1898,18 @@ Matrix4 KRMesh::getBoneBindPose(int bone_index)
   return Matrix4::Create(getBone(bone_index)->bind_pose);
 }
 
+const Matrix4& KRMesh::getBoneInverseBindPose(int bone_index)
+{
+  if (m_boneInverseBindPoses.empty()) {
+    int bone_count = getBoneCount();
+    m_boneInverseBindPoses.reserve(bone_count);
+    for (int i = 0; i < bone_count; i++) {
+      m_boneInverseBindPoses.push_back(Matrix4::Invert(getBoneBindPose(i)));
+    }
+  }
+  return m_boneInverseBindPoses[bone_index];
+}
+
 Topology KRMesh::getTopology() const
 {
   return getHeader()->primitive.layout.topology;
@@ -1863,63 +1949,34 @@ bool KRMesh::rayCast(const Vector3& start, const Vector3& dir, const Triangle3&
 }
 
 
-bool KRMesh::rayCast(const Vector3& start, const Vector3& dir, HitInfo& hitinfo) const
+const KRMeshBVH* KRMesh::getBVH() const
 {
-  m_pData->lock();
-  bool hit_found = false;
-  for (int submesh_index = 0; submesh_index < getSubmeshCount(); submesh_index++) {
-    int vertex_count = getVertexCount(submesh_index);
-    switch (getTopology()) {
-    case Topology::Triangles:
-      for (int triangle_index = 0; triangle_index < vertex_count / 3; triangle_index++) {
-        int tri_vert_index[3]; // FINDME, HACK!  This is not very efficient for indexed collider meshes...
-        tri_vert_index[0] = getVertexIndex(submesh_index, triangle_index * 3);
-        tri_vert_index[1] = getVertexIndex(submesh_index, triangle_index * 3 + 1);
-        tri_vert_index[2] = getVertexIndex(submesh_index, triangle_index * 3 + 2);
-
-        Triangle3 tri = Triangle3::Create(getVertexPosition(tri_vert_index[0]), getVertexPosition(tri_vert_index[1]), getVertexPosition(tri_vert_index[2]));
+  std::lock_guard<std::mutex> lock(m_bvhMutex);
+  if (!m_bvh) {
+    m_pData->lock();
+    m_bvh = std::make_unique<KRMeshBVH>(*this);
+    m_pData->unlock();
+  }
+  return m_bvh.get();
+}
 
-        if (rayCast(start, dir, tri, getVertexNormal(tri_vert_index[0]), getVertexNormal(tri_vert_index[1]), getVertexNormal(tri_vert_index[2]), hitinfo)) hit_found = true;
-      }
-      break;
-    default:
-      assert(false); // Not yet implemented
-      break;
-    }
+bool KRMesh::rayCast(const Vector3& start, const Vector3& dir, HitInfo& hitinfo) const
+{
+  if (getTopology() != Topology::Triangles) {
+    assert(false); // Not yet implemented
+    return false;
   }
-  m_pData->unlock();
-  return hit_found;
+  return getBVH()->rayCast(start, dir, std::numeric_limits<float>::max(), hitinfo);
 }
 
 
 bool KRMesh::sphereCast(const Matrix4& model_to_world, const Vector3& v0, const Vector3& v1, float radius, HitInfo& hitinfo) const
 {
-  m_pData->lock();
-
-  bool hit_found = false;
-  for (int submesh_index = 0; submesh_index < getSubmeshCount(); submesh_index++) {
-    int vertex_count = getVertexCount(submesh_index);
-    switch (getTopology()) {
-      case Topology::Triangles:
-      for (int triangle_index = 0; triangle_index < vertex_count / 3; triangle_index++) {
-        int tri_vert_index[3]; // FINDME, HACK!  This is not very efficient for indexed collider meshes...
-        tri_vert_index[0] = getVertexIndex(submesh_index, triangle_index * 3);
-        tri_vert_index[1] = getVertexIndex(submesh_index, triangle_index * 3 + 1);
-        tri_vert_index[2] = getVertexIndex(submesh_index, triangle_index * 3 + 2);
-
-        Triangle3 tri = Triangle3::Create(getVertexPosition(tri_vert_index[0]), getVertexPosition(tri_vert_index[1]), getVertexPosition(tri_vert_index[2]));
-
-        if (sphereCast(model_to_world, v0, v1, radius, tri, hitinfo)) hit_found = true;
-      }
-      break;
-    default:
-      assert(false); // Not yet implemented
-      break;
-    }
+  if (getTopology() != Topology::Triangles) {
+    assert(false); // Not yet implemented
+    return false;
   }
-  m_pData->unlock();
-
-  return hit_found;
+  return getBVH()->sphereCast(model_to_world, v0, v1, radius, hitinfo);
 }
 
 bool KRMesh::sphereCast(const Matrix4& model_to_world, const Vector3& v0, const Vector3& v1, float radius, const Triangle3& tri, HitInfo& hitinfo)
@@ -1957,18 +2014,19 @@ bool KRMesh::sphereCast(const Matrix4& model_to_world, const Vector3& v0, const
 
 bool KRMesh::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo) const
 {
-  m_pData->lock();
+  if (getTopology() != Topology::Triangles) {
+    assert(false); // Not yet implemented
+    return false;
+  }
   HitInfo new_hitinfo;
   Vector3 dir = Vector3::Normalize(v1 - v0);
-  if (rayCast(v0, dir, new_hitinfo)) {
+  if (getBVH()->rayCast(v0, dir, (v1 - v0).magnitude(), new_hitinfo)) {
     if ((new_hitinfo.getPosition() - v0).sqrMagnitude() <= (v1 - v0).sqrMagnitude()) {
       // The hit was between v1 and v2
       hitinfo = new_hitinfo;
-      m_pData->unlock();
       return true;
     }
   }
-  m_pData->unlock();
   return false; // Either no hit, or the hit was beyond v1
 }
 
@@ -1977,89 +2035,109 @@ void KRMesh::convertToIndexed()
   m_pData->lock();
   KRMesh::pack_header* header = getHeader();
   const VertexBufferLayout* layout = &header->primitive.layout;
-  pack_material* packMaterial = (pack_material*)(header + 1);
 
   // Convert model to indexed vertices, identying vertexes with identical attributes and optimizing order of trianges for best usage post-vertex-transform cache on GPU
-  int vertex_index_offset = 0;
-  int vertex_index_base_start_vertex = 0;
-
   std::vector<std::byte> newVertexData;
   int newVertexCount = 0;
-  std::vector<uint16_t> newIndexes;
+  std::vector<__uint32_t> newIndexes;
   std::vector<std::pair<int, int>> newVertexIndexRanges;
 
-  for (int submesh_index = 0; submesh_index < getSubmeshCount(); submesh_index++) {
-    pack_material* pPackMaterial = getSubmesh(submesh_index);
-
-    int vertexes_remaining = getVertexCount(submesh_index);
+  // Each submesh is de-duplicated independently, so its indexes are relative to the first vertex it emits
+  std::vector<int> submeshStartVertex;
+  std::vector<int> submeshVertexCount;
+  std::vector<int> submeshStartIndex;
+  IndexFormat indexFormat = IndexFormat::uint16;
 
-    int vertex_count = vertexes_remaining;
-    if (vertex_count > 0xffff) {
-      vertex_count = 0xffff;
+  // The submeshes are welded in parallel, then concatenated in order
+  int submesh_count = getSubmeshCount();
+  std::vector<std::unique_ptr<KRVertexWelder>> welders(submesh_count);
+  std::vector<std::vector<__uint32_t>> submeshIndexes(submesh_count);
+  auto weldSubmesh = [&](size_t submesh_index) {
+    pack_material* pPackMaterial = getSubmesh((int)submesh_index);
+    int vertex_count = pPackMaterial->vertex_count;
+    const std::byte* vertexBytes = reinterpret_cast<const std::byte*>(getVertexData(pPackMaterial->start_vertex));
+    welders[submesh_index] = std::make_unique<KRVertexWelder>(layout->vertexSize, vertex_count);
+    std::vector<__uint32_t>& indexes = submeshIndexes[submesh_index];
+    indexes.resize(vertex_count);
+    for (int i = 0; i < vertex_count; i++) {
+      indexes[i] = welders[submesh_index]->weld(vertexBytes + (size_t)i * layout->vertexSize);
     }
-
-    if (submesh_index == 0 || vertex_index_offset + vertex_count > 0xffff) {
-      newVertexIndexRanges.push_back(std::pair<int, int>((int)newIndexes.size(), newVertexCount));
-      vertex_index_offset = 0;
-      vertex_index_base_start_vertex = newVertexCount;
+  };
+  KRWorkerPool* pool = getContext().getWorkerPool();
+  if (pool && submesh_count > 1) {
+    pool->parallelFor(submesh_count, weldSubmesh);
+  } else {
+    for (int submesh_index = 0; submesh_index < submesh_count; submesh_index++) {
+      weldSubmesh(submesh_index);
     }
+  }
 
-    int source_index = pPackMaterial->start_vertex;
-    pPackMaterial->start_vertex = (int)newVertexIndexRanges.size() - 1 + (vertex_index_offset << 16);
-    pPackMaterial->vertex_count = vertexes_remaining;
-
-    while (vertexes_remaining) {
-      typedef std::vector<std::byte> vertex_data_t;
-
-      std::map<vertex_data_t, int> prevIndices;
-
-      for (int i = 0; i < vertex_count; i++) {
-        vertex_data_t vertexData;
-        const std::byte* vertexBytes = reinterpret_cast<const std::byte*>(getVertexData(source_index));
-        vertexData.insert(vertexData.end(), vertexBytes, vertexBytes + layout->vertexSize);
-        
-        int found_index = -1;
-        if (prevIndices.count(vertexData) == 0) {
-          found_index = (int)(newVertexCount) - vertex_index_base_start_vertex;
-          prevIndices[vertexData] = found_index;
-          newVertexData.insert(newVertexData.end(), vertexData.begin(), vertexData.end());
-          newVertexCount++;
-        } else {
-          found_index = prevIndices[vertexData];
-        }
+  for (int submesh_index = 0; submesh_index < submesh_count; submesh_index++) {
+    int submesh_start_vertex = newVertexCount;
+    submeshStartVertex.push_back(newVertexCount);
+    submeshStartIndex.push_back((int)newIndexes.size());
 
-        newIndexes.push_back(found_index);
-        //fprintf(stderr, "Submesh: %6i  IndexBase: %3i  Index: %6i\n", submesh_index, vertex_index_bases.size(), found_index);
+    const std::vector<std::byte>& vertexData = welders[submesh_index]->getVertexData();
+    newVertexData.insert(newVertexData.end(), vertexData.begin(), vertexData.end());
+    newVertexCount += welders[submesh_index]->getVertexCount();
+    newIndexes.insert(newIndexes.end(), submeshIndexes[submesh_index].begin(), submeshIndexes[submesh_index].end());
+    welders[submesh_index].reset();
+    std::vector<__uint32_t>().swap(submeshIndexes[submesh_index]);
 
-        source_index++;
-      }
+    submeshVertexCount.push_back(newVertexCount - submesh_start_vertex);
+    if (newVertexCount - submesh_start_vertex > 0xffff) {
+      // A single submesh can't be addressed with 16-bit indexes, so the whole mesh
+      // switches to 32-bit indexes rather than splitting the submesh into several draws.
+      indexFormat = IndexFormat::uint32;
+    }
+  }
 
-      vertexes_remaining -= vertex_count;
-      vertex_index_offset += vertex_count;
+  // Group the submeshes into index ranges.  With 32-bit indexes, every submesh gets its own
+  // range and is drawn with a single call.  With 16-bit indexes, consecutive submeshes share
+  // a range while its vertexes remain addressable.
+  int group_start_vertex = 0;
+  int group_start_index = 0;
+  for (int submesh_index = 0; submesh_index < getSubmeshCount(); submesh_index++) {
+    pack_material* pPackMaterial = getSubmesh(submesh_index);
+    int start_vertex = submeshStartVertex[submesh_index];
+    int start_index = submeshStartIndex[submesh_index];
+    int submesh_index_count = pPackMaterial->vertex_count;
 
-      vertex_count = vertexes_remaining;
-      if (vertex_count > 0xffff) {
-        vertex_count = 0xffff;
-      }
+    bool new_group = submesh_index == 0 || indexFormat == IndexFormat::uint32;
+    if (start_vertex + submeshVertexCount[submesh_index] - group_start_vertex > 0xffff) {
+      new_group = true;
+    }
+    if (start_index - group_start_index > 0xffff) {
+      // index_group_offset must fit in 16 bits
+      new_group = true;
+    }
+    if (new_group) {
+      newVertexIndexRanges.push_back(std::pair<int, int>(start_index, start_vertex));
+      group_start_vertex = start_vertex;
+      group_start_index = start_index;
+    }
 
-      if (vertex_index_offset + vertex_count > 0xffff) {
-        newVertexIndexRanges.push_back(std::pair<int, int>((int)newIndexes.size(), newVertexCount));
-        vertex_index_offset = 0;
-        vertex_index_base_start_vertex = newVertexCount;
+    int rebase = start_vertex - group_start_vertex;
+    if (rebase != 0) {
+      for (int i = start_index; i < start_index + submesh_index_count; i++) {
+        newIndexes[i] += rebase;
       }
     }
+
+    pPackMaterial->index_group = (uint16_t)(newVertexIndexRanges.size() - 1);
+    pPackMaterial->index_group_offset = (uint16_t)(start_index - group_start_index);
   }
 
   KRContext::Log(KRContext::LOG_LEVEL_INFORMATION, "Convert to indexed, before: %i after: %i (%.2f%% saving)", getHeader()->primitive.vertexCount, newVertexCount, ((float)getHeader()->primitive.vertexCount - (float)newVertexCount) / (float)getHeader()->primitive.vertexCount * 100.0f);
 
-  int submesh_count = getSubmeshCount();
   int bone_count = getBoneCount();
 
   header->index_base_count = newVertexIndexRanges.size();
+  header->index_format = indexFormat;
   header->primitive.indexCount = newIndexes.size();
   header->primitive.vertexCount = newVertexCount;
 
-  size_t new_file_size = sizeof(pack_header) + sizeof(pack_material) * submesh_count + sizeof(pack_bone) * bone_count + KRALIGN(2 * header->primitive.indexCount) + KRALIGN(8 * header->index_base_count) + newVertexData.size();
+  size_t new_file_size = sizeof(pack_header) + sizeof(pack_material) * submesh_count + sizeof(pack_bone) * bone_count + getIndexDataSize(*header) + KRALIGN(8 * header->index_base_count) + newVertexData.size();
 
   pack_header ph;
   m_pData->copy((void*)&ph, 0, sizeof(ph));
@@ -2072,7 +2150,7 @@ void KRMesh::convertToIndexed()
 
   m_pMetaData = m_pData->getSubBlock(0, sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count);
   m_pMetaData->lock();
-  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + KRALIGN(2 * ph.primitive.indexCount), ph.index_base_count * 8);
+  m_pIndexBaseData = m_pData->getSubBlock(sizeof(pack_header) + sizeof(pack_material) * ph.submesh_count + sizeof(pack_bone) * ph.bone_count + getIndexDataSize(ph), ph.index_base_count * 8);
   m_pIndexBaseData->lock();
 
   // ---- Copy new buffers ----
@@ -2083,8 +2161,14 @@ void KRMesh::convertToIndexed()
   memcpy(vertex_data, newVertexData.data(), newVertexData.size());
   
   // Index Data
-  __uint16_t* index_data = getIndexData();
-  memcpy(index_data, newIndexes.data(), newIndexes.size());
+  if (indexFormat == IndexFormat::uint32) {
+    memcpy(getIndexData(), newIndexes.data(), newIndexes.size() * sizeof(__uint32_t));
+  } else {
+    __uint16_t* index_data = (__uint16_t*)getIndexData();
+    for (__uint32_t index : newIndexes) {
+      *index_data++ = (__uint16_t)index;
+    }
+  }
 
   // Index data ranges
   __uint32_t* index_base_data = getIndexBaseData();
@@ -2132,8 +2216,6 @@ void KRMesh::getIndexedRange(int index_group, int& start_index_offset, int& star
 int KRMesh::getVertexIndex(int submesh, int index) const
 {
   if (getIndexCount(submesh) > 0) {
-    __uint16_t* index_data = getIndexData();
-
     int start_index_offset, start_vertex_offset, index_count, vertex_count;
     int index_group = getSubmesh(submesh)->index_group;
     int index_group_offset = getSubmesh(submesh)->index_group_offset;
@@ -2143,7 +2225,7 @@ int KRMesh::getVertexIndex(int submesh, int index) const
       remaining_vertices -= index_count;
       getIndexedRange(index_group++, start_index_offset, start_vertex_offset, index_count, vertex_count);
     }
-    return index_data[start_index_offset + remaining_vertices] + start_vertex_offset;
+    return getIndex(start_index_offset + remaining_vertices) + start_vertex_offset;
   } else {
     return getSubmesh(submesh)->start_vertex + index;
   }
@@ -2151,94 +2233,117 @@ int KRMesh::getVertexIndex(int submesh, int index) const
 
 void KRMesh::optimizeIndexes()
 {
-  // TODO - Re-enable this once crash with KRMeshSphere vertices is corrected
-  return;
-
-  m_pData->lock();
   // TODO - Implement optimization for indexed strips
-  if (getTopology() == Topology::Triangles && getIndexCount(0) > 0) {
-    int vertex_size = (int)getHeader()->primitive.layout.vertexSize;
-    __uint16_t* new_indices = (__uint16_t*)malloc(0x10000 * sizeof(__uint16_t));
-    __uint16_t* vertex_mapping = (__uint16_t*)malloc(0x10000 * sizeof(__uint16_t));
-    unsigned char* new_vertex_data = (unsigned char*)malloc(vertex_size * 0x10000);
-
-    // FINDME, TODO, HACK - This will segfault if the KRData object is still mmap'ed to a read-only file.  Need to detach from the file before calling this function.  Currently, this function is only being used during the import process, so it isn't going to cause any problems for now.
-
-    pack_header* header = getHeader();
-
-    __uint16_t* index_data = getIndexData();
-    // unsigned char *vertex_data = getVertexData(); // Uncomment when re-enabling Step 2 below
-
-    for (int submesh_index = 0; submesh_index < header->submesh_count; submesh_index++) {
-      pack_material* submesh = getSubmesh(submesh_index);
-      int vertexes_remaining = submesh->vertex_count;
-      int index_group = getSubmesh(submesh_index)->index_group;
-      int index_group_offset = getSubmesh(submesh_index)->index_group_offset;
-      while (vertexes_remaining > 0) {
-        int start_index_offset, start_vertex_offset, index_count, vertex_count;
-        getIndexedRange(index_group++, start_index_offset, start_vertex_offset, index_count, vertex_count);
-
-        int vertexes_to_process = vertexes_remaining;
-        if (vertexes_to_process + index_group_offset > 0xffff) {
-          vertexes_to_process = 0xffff - index_group_offset;
-        }
-
-        __uint16_t* index_data_start = index_data + start_index_offset + index_group_offset;
-
-
-        // ----====---- Step 1: Optimize triangle drawing order to maximize use of the GPU's post-transform vertex cache ----====----
-        Forsyth::OptimizeFaces(index_data_start, vertexes_to_process, vertex_count, new_indices, 16); // FINDME, TODO - GPU post-transform vertex cache size of 16 should be configureable
-        memcpy(index_data_start, new_indices, vertexes_to_process * sizeof(__uint16_t));
-        vertexes_remaining -= vertexes_to_process;
+  if (getTopology() != Topology::Triangles || getIndexCount(0) == 0) {
+    return;
+  }
 
-        /*
+  // FINDME, TODO, HACK - This will segfault if the KRData object is still mmap'ed to a read-only file.  Need to detach from the file before calling this function.  Currently, this function is only being used during the import process, so it isn't going to cause any problems for now.
+  m_pData->lock();
 
-         unsigned char * vertex_data_start = vertex_data + start_vertex_offset;
+  pack_header* header = getHeader();
+  int cacheSize = getContext().getVertexCacheSize();
+  size_t vertex_size = header->primitive.layout.vertexSize;
 
-        // ----====---- Step 2: Re-order the vertex data to maintain cache coherency ----====----
-        for(int i=0; i < vertex_count; i++) {
-            vertex_mapping[i] = i;
-        }
-        int new_vertex_index=0;
-        for(int index_number=0; index_number<index_count; index_number++) {
-            int prev_vertex_index = index_data_start[index_number];
-            if(prev_vertex_index > new_vertex_index) {
-                // Swap prev_vertex_index and new_vertex_index
-
-                for(int i=0; i < index_count; i++) {
-                    if(index_data_start[i] == prev_vertex_index) {
-                        index_data_start[i] = new_vertex_index;
-                    } else if(index_data_start[i] == new_vertex_index) {
-                        index_data_start[i] = prev_vertex_index;
-                    }
-                }
+  // Triangles may only be reordered within a submesh, and vertexes only within an index group.
+  // Collect the range of each submesh that falls within each index group.
+  struct IndexRange
+  {
+    int start_index;
+    int index_count;
+  };
+  std::vector<std::vector<IndexRange>> groupRanges(header->index_base_count);
+  for (int submesh_index = 0; submesh_index < header->submesh_count; submesh_index++) {
+    pack_material* submesh = getSubmesh(submesh_index);
+    int indexes_remaining = submesh->vertex_count;
+    int index_group = submesh->index_group;
+    int index_group_offset = submesh->index_group_offset;
+    while (indexes_remaining > 0 && index_group < header->index_base_count) {
+      int start_index_offset, start_vertex_offset, index_count, vertex_count;
+      getIndexedRange(index_group, start_index_offset, start_vertex_offset, index_count, vertex_count);
+      int indexes_to_process = std::min(indexes_remaining, index_count - index_group_offset);
+      if (indexes_to_process > 0) {
+        groupRanges[index_group].push_back(IndexRange{ start_index_offset + index_group_offset, indexes_to_process });
+        indexes_remaining -= indexes_to_process;
+      }
+      index_group++;
+      index_group_offset = 0;
+    }
+  }
 
-                int tmp = vertex_mapping[prev_vertex_index];
-                vertex_mapping[prev_vertex_index] = vertex_mapping[new_vertex_index];
-                vertex_mapping[new_vertex_index] = tmp;
+  std::vector<KRMeshOptimizer::CacheStatistics> before(header->index_base_count, KRMeshOptimizer::CacheStatistics{});
+  std::vector<KRMeshOptimizer::CacheStatistics> after(header->index_base_count, KRMeshOptimizer::CacheStatistics{});
+  auto optimizeGroup = [&](size_t index_group) {
+    int start_index_offset, start_vertex_offset, index_count, vertex_count;
+    getIndexedRange((int)index_group, start_index_offset, start_vertex_offset, index_count, vertex_count);
+    if (index_count <= 0 || vertex_count <= 0) {
+      return;
+    }
 
+    std::vector<__uint32_t> indexes(index_count);
+    for (int i = 0; i < index_count; i++) {
+      indexes[i] = getIndex(start_index_offset + i);
+      if (indexes[i] >= (__uint32_t)vertex_count) {
+        KRContext::Log(KRContext::LOG_LEVEL_WARNING, "Mesh \"%s\" has an out of range index in index group %i.  Skipping optimization of the group.", getName().c_str(), (int)index_group);
+        return;
+      }
+    }
 
-                new_vertex_index++;
-            }
-        }
+    std::vector<float> positions(vertex_count * 3);
+    for (int i = 0; i < vertex_count; i++) {
+      Vector3 position = getVertexPosition(start_vertex_offset + i);
+      positions[i * 3] = position.x;
+      positions[i * 3 + 1] = position.y;
+      positions[i * 3 + 2] = position.z;
+    }
 
-        for(int i=0; i < vertex_count; i++) {
-            int vertex_size = (int)getHeader()->primitive.vertexSize;
-            memcpy(new_vertex_data + vertex_mapping[i] * vertex_size, vertex_data_start + i * m_vertex_size, m_vertex_size);
-        }
-        memcpy(vertex_data_start, new_vertex_data, vertex_count * vertex_size);
-         */
+    // ----====---- Step 1: Optimize triangle drawing order to maximize use of the GPU's post-transform vertex cache ----====----
+    // ----====---- Step 2: Order clusters of triangles to reduce overdraw ----====----
+    std::vector<size_t> clusters;
+    for (const IndexRange& range : groupRanges[index_group]) {
+      __uint32_t* range_indexes = indexes.data() + (range.start_index - start_index_offset);
+      size_t range_index_count = range.index_count - range.index_count % 3;
+      before[index_group].add(KRMeshOptimizer::AnalyzeVertexCache(range_indexes, range_index_count, vertex_count, cacheSize));
+      KRMeshOptimizer::OptimizeVertexCache(range_indexes, range_index_count, vertex_count, cacheSize, clusters);
+      KRMeshOptimizer::OptimizeOverdraw(range_indexes, range_index_count, positions.data(), clusters);
+    }
 
+    // ----====---- Step 3: Re-order the vertex data to maintain cache coherency ----====----
+    std::vector<__uint32_t> vertex_mapping;
+    KRMeshOptimizer::OptimizeVertexFetch(indexes.data(), index_count, vertex_count, vertex_mapping);
+    unsigned char* vertex_data_start = getVertexData(start_vertex_offset);
+    std::vector<unsigned char> new_vertex_data(vertex_count * vertex_size);
+    for (int i = 0; i < vertex_count; i++) {
+      memcpy(new_vertex_data.data() + vertex_mapping[i] * vertex_size, vertex_data_start + i * vertex_size, vertex_size);
+    }
+    memcpy(vertex_data_start, new_vertex_data.data(), new_vertex_data.size());
+    for (int i = 0; i < index_count; i++) {
+      setIndex(start_index_offset + i, indexes[i]);
+    }
 
+    for (const IndexRange& range : groupRanges[index_group]) {
+      __uint32_t* range_indexes = indexes.data() + (range.start_index - start_index_offset);
+      size_t range_index_count = range.index_count - range.index_count % 3;
+      after[index_group].add(KRMeshOptimizer::AnalyzeVertexCache(range_indexes, range_index_count, vertex_count, cacheSize));
+    }
+  };
 
-        index_group_offset = 0;
-      }
+  KRWorkerPool* pool = getContext().getWorkerPool();
+  if (pool && header->index_base_count > 1) {
+    pool->parallelFor(header->index_base_count, optimizeGroup);
+  } else {
+    for (int index_group = 0; index_group < header->index_base_count; index_group++) {
+      optimizeGroup(index_group);
     }
+  }
 
-    free(new_indices);
-    free(vertex_mapping);
-    free(new_vertex_data);
-  } // getTopology() == Topology::Triangles && getIndexCount(0) > 0
+  KRMeshOptimizer::CacheStatistics total_before = {};
+  KRMeshOptimizer::CacheStatistics total_after = {};
+  for (int index_group = 0; index_group < header->index_base_count; index_group++) {
+    total_before.add(before[index_group]);
+    total_after.add(after[index_group]);
+  }
+  KRContext::Log(KRContext::LOG_LEVEL_INFORMATION, "Optimize indexes for a %i entry vertex cache, ACMR before: %.3f after: %.3f, ATVR before: %.3f after: %.3f", cacheSize, total_before.getACMR(), total_after.getACMR(), total_before.getATVR(), total_after.getATVR());
 
   m_pData->unlock();
 }
@@ -36,6 +36,7 @@
 #include "KRContext.h"
 #include "nodes/KRBone.h"
 #include "KRMeshManager.h"
+#include "KRMeshBVH.h"
 #include "resources/material/KRMaterialBinding.h"
 
 #include "KREngine-common.h"
@@ -61,6 +62,7 @@ class KRRenderPass;
 
 class KRMesh : public KRResource
 {
+  friend class KRMeshBVH;
 
 public:
   KRMesh(KRContext& context, std::string name, mimir::Block* data);
@@ -85,7 +87,7 @@ public:
   {
     Topology format;
     std::vector<hydra::Vector3> vertices;
-    std::vector<__uint16_t> vertex_indexes;
+    std::vector<__uint32_t> vertex_indexes;
     std::vector<std::pair<int, int> > vertex_index_bases;
     std::vector<hydra::Vector2> texcoord[8];
     std::vector<hydra::Vector4> color[8];
@@ -100,7 +102,7 @@ public:
     std::vector<std::vector<float> > bone_weights;
   };
 
-  void render(KRNode::RenderInfo& ri, const std::string& object_name, const hydra::Matrix4& matModel, KRTexture* pLightMap, const std::vector<KRBone*>& bones, float lod_coverage = 0.0f);
+  void render(KRNode::RenderInfo& ri, const std::string& object_name, const hydra::Matrix4& matModel, KRTexture* pLightMap, const KRSkinPalette* skinPalette, float lod_coverage = 0.0f);
 
   std::string m_lodBaseName;
 
@@ -170,6 +172,21 @@ public:
     float bind_pose[16];
   } pack_bone;
 
+  // Destination for importers that decode vertex and index data directly into a new pack
+  struct PackData
+  {
+    pack_material* submeshes;
+    pack_bone* bones;
+    void* indexes;
+    __uint32_t* indexBases;
+    unsigned char* vertexes;
+  };
+
+  // Allocates a pack and leaves it locked for writing.  The submesh, bone, index and
+  // vertex data are not initialized.  endPack() must be called once they are written.
+  PackData beginPack(const PrimitiveInfo& primitive, IndexFormat indexFormat, int submeshCount, int boneCount, int indexBaseCount);
+  void endPack(const hydra::AABB& extents);
+
   int getLODCoverage() const;
   std::string getLODBaseName() const;
 
@@ -181,6 +198,7 @@ public:
   int getIndexCount(int submesh) const;
   const VertexBufferLayout* getLayout(int submesh) const;
 
+  IndexFormat getIndexFormat() const;
   int getVertexIndex(int submesh, int index) const;
   hydra::Vector3 getVertexPosition(int index) const;
   hydra::Vector3 getVertexNormal(int index) const;
@@ -219,6 +237,8 @@ public:
   int getBoneCount();
   char* getBoneName(int bone_index);
   hydra::Matrix4 getBoneBindPose(int bone_index);
+  // Inverse of the pack_bone bind pose, computed once per loaded pack
+  const hydra::Matrix4& getBoneInverseBindPose(int bone_index);
 
 
   Topology getTopology() const;
@@ -229,6 +249,9 @@ public:
 
   static int GetLODCoverage(const std::string& name);
 
+  // Returns true if the pack header is readable and the sections it describes fit in the data
+  static bool ValidatePack(mimir::Block* data);
+
 protected:
   bool m_constant; // TRUE if this should be always loaded and should not be passed through the streamer
 
@@ -236,6 +259,12 @@ private:
   mimir::Block* m_pData;
   mimir::Block* m_pMetaData;
   mimir::Block* m_pIndexBaseData;
+  std::vector<hydra::Matrix4> m_boneInverseBindPoses;
+
+  // Built on the first ray, line or sphere cast against the mesh
+  mutable std::unique_ptr<KRMeshBVH> m_bvh;
+  mutable std::mutex m_bvhMutex;
+  const KRMeshBVH* getBVH() const;
 
   void getSubmeshes();
   void getMaterials();
@@ -260,7 +289,8 @@ private:
     int32_t bone_count;
     hydra::AABB extents; // Axis aligned bounding box, in model's coordinate space
     int32_t index_base_count;
-    unsigned char reserved[456 - sizeof(PrimitiveInfo)]; // Pad out to 512 bytes
+    IndexFormat index_format; // Packs written before 32-bit index support have this zeroed, selecting IndexFormat::uint16
+    unsigned char reserved[455 - sizeof(PrimitiveInfo)]; // Pad out to 512 bytes
   } pack_header;
 
   static_assert(sizeof(pack_header) == 512);
@@ -273,8 +303,11 @@ private:
   unsigned char* getVertexData() const;
   size_t getVertexDataOffset() const;
   unsigned char* getVertexData(int index) const;
-  __uint16_t* getIndexData() const;
+  void* getIndexData() const;
   size_t getIndexDataOffset() const;
+  static size_t getIndexDataSize(const pack_header& header);
+  __uint32_t getIndex(int index) const;
+  void setIndex(int index, __uint32_t value);
   __uint32_t* getIndexBaseData() const;
   pack_header* getHeader() const;
   pack_bone* getBone(int index);
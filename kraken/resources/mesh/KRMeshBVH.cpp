@@ -0,0 +1,400 @@
+//
+//  KRMeshBVH.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KREngine-common.h"
+
+#include "KRMeshBVH.h"
+#include "KRMesh.h"
+
+using namespace hydra;
+
+namespace {
+
+float component(const Vector3& v, int axis)
+{
+  return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+float surfaceArea(const Vector3& min, const Vector3& max)
+{
+  Vector3 e = max - min;
+  return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+struct Bin
+{
+  Vector3 min;
+  Vector3 max;
+  int count;
+
+  void reset()
+  {
+    min = Vector3::Create(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    max = Vector3::Create(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+    count = 0;
+  }
+
+  void encapsulate(const Vector3& v)
+  {
+    min = Vector3::Create(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
+    max = Vector3::Create(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+  }
+
+  void encapsulate(const Bin& b)
+  {
+    encapsulate(b.min);
+    encapsulate(b.max);
+    count += b.count;
+  }
+};
+
+} // namespace
+
+KRMeshBVH::KRMeshBVH(const KRMesh& mesh)
+{
+  std::vector<Vector3> positions;
+  std::vector<Vector3> normals;
+
+  if (mesh.getTopology() == Topology::Triangles) {
+    for (int submesh_index = 0; submesh_index < mesh.getSubmeshCount(); submesh_index++) {
+      int vertex_count = mesh.getVertexCount(submesh_index);
+      for (int i = 0; i + 2 < vertex_count; i += 3) {
+        for (int j = 0; j < 3; j++) {
+          int vertex_index = mesh.getVertexIndex(submesh_index, i + j);
+          positions.push_back(mesh.getVertexPosition(vertex_index));
+          normals.push_back(mesh.getVertexNormal(vertex_index));
+        }
+      }
+    }
+  }
+
+  size_t triangle_count = positions.size() / 3;
+  std::vector<Vector3> centroids(triangle_count);
+  std::vector<uint32_t> order(triangle_count);
+  for (size_t i = 0; i < triangle_count; i++) {
+    centroids[i] = (positions[i * 3] + positions[i * 3 + 1] + positions[i * 3 + 2]) * (1.0f / 3.0f);
+    order[i] = (uint32_t)i;
+  }
+
+  m_positions = std::move(positions);
+  build(centroids, order);
+
+  // Store the triangles in leaf order
+  std::vector<Vector3> sorted_positions(m_positions.size());
+  m_normals.resize(normals.size());
+  for (size_t i = 0; i < triangle_count; i++) {
+    for (int j = 0; j < 3; j++) {
+      sorted_positions[i * 3 + j] = m_positions[order[i] * 3 + j];
+      m_normals[i * 3 + j] = normals[order[i] * 3 + j];
+    }
+  }
+  m_positions = std::move(sorted_positions);
+}
+
+KRMeshBVH::~KRMeshBVH()
+{
+
+}
+
+size_t KRMeshBVH::getTriangleCount() const
+{
+  return m_positions.size() / 3;
+}
+
+size_t KRMeshBVH::getNodeCount() const
+{
+  return m_nodes.size();
+}
+
+void KRMeshBVH::updateBounds(Node& node, const std::vector<uint32_t>& order, const std::vector<Vector3>& positions) const
+{
+  Bin bounds;
+  bounds.reset();
+  for (uint32_t i = node.first; i < node.first + node.count; i++) {
+    for (int j = 0; j < 3; j++) {
+      bounds.encapsulate(positions[order[i] * 3 + j]);
+    }
+  }
+  node.min[0] = bounds.min.x;
+  node.min[1] = bounds.min.y;
+  node.min[2] = bounds.min.z;
+  node.max[0] = bounds.max.x;
+  node.max[1] = bounds.max.y;
+  node.max[2] = bounds.max.z;
+}
+
+void KRMeshBVH::build(std::vector<Vector3>& centroids, std::vector<uint32_t>& order)
+{
+  size_t triangle_count = order.size();
+  m_nodes.clear();
+  if (triangle_count == 0) {
+    return;
+  }
+  m_nodes.reserve(triangle_count * 2);
+
+  Node& root = m_nodes.emplace_back();
+  root.first = 0;
+  root.count = (uint32_t)triangle_count;
+  updateBounds(root, order, m_positions);
+
+  // Pairs of node index and depth.  Depth is limited so that traversal fits in a fixed stack.
+  std::vector<std::pair<uint32_t, int>> pending;
+  pending.push_back(std::make_pair(0, 0));
+  while (!pending.empty()) {
+    uint32_t node_index = pending.back().first;
+    int depth = pending.back().second;
+    pending.pop_back();
+
+    Node node = m_nodes[node_index];
+    if (node.count <= kMaxLeafTriangles || depth + 2 >= kMaxDepth) {
+      continue;
+    }
+
+    // Split on the centroid bounds, rather than the triangle bounds, so every bin can receive triangles
+    Bin centroid_bounds;
+    centroid_bounds.reset();
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+      centroid_bounds.encapsulate(centroids[order[i]]);
+    }
+
+    // Binned surface area heuristic
+    float best_cost = std::numeric_limits<float>::max();
+    int best_axis = -1;
+    int best_split = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      float axis_min = component(centroid_bounds.min, axis);
+      float axis_max = component(centroid_bounds.max, axis);
+      if (axis_max <= axis_min) {
+        continue;
+      }
+      float scale = kBinCount / (axis_max - axis_min);
+
+      Bin bins[kBinCount];
+      for (Bin& bin : bins) {
+        bin.reset();
+      }
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        uint32_t tri = order[i];
+        int bin_index = std::min(kBinCount - 1, (int)((component(centroids[tri], axis) - axis_min) * scale));
+        Bin& bin = bins[bin_index];
+        bin.count++;
+        bin.encapsulate(m_positions[tri * 3]);
+        bin.encapsulate(m_positions[tri * 3 + 1]);
+        bin.encapsulate(m_positions[tri * 3 + 2]);
+      }
+
+      // Sweep from the right to find the cost of each right partition
+      float right_area[kBinCount - 1];
+      int right_count[kBinCount - 1];
+      Bin right;
+      right.reset();
+      for (int i = kBinCount - 1; i > 0; i--) {
+        right.encapsulate(bins[i]);
+        right_count[i - 1] = right.count;
+        right_area[i - 1] = right.count ? surfaceArea(right.min, right.max) : 0.0f;
+      }
+
+      Bin left;
+      left.reset();
+      for (int i = 0; i < kBinCount - 1; i++) {
+        left.encapsulate(bins[i]);
+        if (left.count == 0 || right_count[i] == 0) {
+          continue;
+        }
+        float cost = left.count * surfaceArea(left.min, left.max) + right_count[i] * right_area[i];
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_axis = axis;
+          best_split = i;
+        }
+      }
+    }
+
+    if (best_axis == -1) {
+      // All centroids are coincident
+      continue;
+    }
+
+    float leaf_cost = node.count * surfaceArea(Vector3::Create(node.min[0], node.min[1], node.min[2]), Vector3::Create(node.max[0], node.max[1], node.max[2]));
+    if (best_cost >= leaf_cost && node.count <= kMaxLeafTriangles * 4) {
+      continue;
+    }
+
+    // Partition the triangles about the chosen split
+    float axis_min = component(centroid_bounds.min, best_axis);
+    float scale = kBinCount / (component(centroid_bounds.max, best_axis) - axis_min);
+    auto middle = std::partition(order.begin() + node.first, order.begin() + node.first + node.count, [&](uint32_t tri) {
+      int bin_index = std::min(kBinCount - 1, (int)((component(centroids[tri], best_axis) - axis_min) * scale));
+      return bin_index <= best_split;
+    });
+    uint32_t left_count = (uint32_t)(middle - (order.begin() + node.first));
+    if (left_count == 0 || left_count == node.count) {
+      continue;
+    }
+
+    uint32_t left_index = (uint32_t)m_nodes.size();
+    Node& left_node = m_nodes.emplace_back();
+    left_node.first = node.first;
+    left_node.count = left_count;
+    updateBounds(left_node, order, m_positions);
+
+    Node& right_node = m_nodes.emplace_back();
+    right_node.first = node.first + left_count;
+    right_node.count = node.count - left_count;
+    updateBounds(right_node, order, m_positions);
+
+    m_nodes[node_index].first = left_index;
+    m_nodes[node_index].count = 0;
+
+    pending.push_back(std::make_pair(left_index, depth + 1));
+    pending.push_back(std::make_pair(left_index + 1, depth + 1));
+  }
+}
+
+bool KRMeshBVH::intersectRay(const Node& node, const Vector3& start, const Vector3& inv_dir, float max_distance, float& distance)
+{
+  float tx1 = (node.min[0] - start.x) * inv_dir.x;
+  float tx2 = (node.max[0] - start.x) * inv_dir.x;
+  float tmin = std::min(tx1, tx2);
+  float tmax = std::max(tx1, tx2);
+
+  float ty1 = (node.min[1] - start.y) * inv_dir.y;
+  float ty2 = (node.max[1] - start.y) * inv_dir.y;
+  tmin = std::max(tmin, std::min(ty1, ty2));
+  tmax = std::min(tmax, std::max(ty1, ty2));
+
+  float tz1 = (node.min[2] - start.z) * inv_dir.z;
+  float tz2 = (node.max[2] - start.z) * inv_dir.z;
+  tmin = std::max(tmin, std::min(tz1, tz2));
+  tmax = std::min(tmax, std::max(tz1, tz2));
+
+  distance = tmin;
+  return tmax >= std::max(tmin, 0.0f) && tmin <= max_distance;
+}
+
+bool KRMeshBVH::rayCast(const Vector3& start, const Vector3& dir, float max_distance, HitInfo& hitinfo) const
+{
+  if (m_nodes.empty()) {
+    return false;
+  }
+
+  Vector3 inv_dir = Vector3::Create(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+  bool hit_found = false;
+
+  uint32_t stack[kMaxDepth];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node& node = m_nodes[stack[--stack_size]];
+
+    // Nodes farther than the closest hit so far can't contain a closer hit
+    float limit = max_distance;
+    if (hitinfo.didHit()) {
+      limit = std::min(limit, hitinfo.getDistance());
+    }
+    float distance;
+    if (!intersectRay(node, start, inv_dir, limit, distance)) {
+      continue;
+    }
+
+    if (node.count > 0) {
+      for (uint32_t tri = node.first; tri < node.first + node.count; tri++) {
+        const Vector3* v = &m_positions[tri * 3];
+        const Vector3* n = &m_normals[tri * 3];
+        if (KRMesh::rayCast(start, dir, Triangle3::Create(v[0], v[1], v[2]), n[0], n[1], n[2], hitinfo)) {
+          hit_found = true;
+        }
+      }
+    } else {
+      // Visit the nearer child first so that the closest hit prunes the farther child
+      float left_distance, right_distance;
+      bool left_hit = intersectRay(m_nodes[node.first], start, inv_dir, limit, left_distance);
+      bool right_hit = intersectRay(m_nodes[node.first + 1], start, inv_dir, limit, right_distance);
+      if (left_hit && right_hit) {
+        if (left_distance < right_distance) {
+          stack[stack_size++] = node.first + 1;
+          stack[stack_size++] = node.first;
+        } else {
+          stack[stack_size++] = node.first;
+          stack[stack_size++] = node.first + 1;
+        }
+      } else if (left_hit) {
+        stack[stack_size++] = node.first;
+      } else if (right_hit) {
+        stack[stack_size++] = node.first + 1;
+      }
+      assert(stack_size < kMaxDepth);
+    }
+  }
+  return hit_found;
+}
+
+bool KRMeshBVH::sphereCast(const Matrix4& model_to_world, const Vector3& v0, const Vector3& v1, float radius, HitInfo& hitinfo) const
+{
+  if (m_nodes.empty()) {
+    return false;
+  }
+
+  // The hierarchy is in model space, while the sphere is swept in world space
+  AABB sweep_bounds = AABB::Create(
+    Vector3::Create(std::min(v0.x, v1.x) - radius, std::min(v0.y, v1.y) - radius, std::min(v0.z, v1.z) - radius),
+    Vector3::Create(std::max(v0.x, v1.x) + radius, std::max(v0.y, v1.y) + radius, std::max(v0.z, v1.z) + radius)
+  );
+
+  bool hit_found = false;
+
+  uint32_t stack[kMaxDepth];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node& node = m_nodes[stack[--stack_size]];
+    AABB node_bounds = AABB::Create(AABB::Create(Vector3::Create(node.min[0], node.min[1], node.min[2]), Vector3::Create(node.max[0], node.max[1], node.max[2])), model_to_world);
+    if (!node_bounds.intersects(sweep_bounds)) {
+      continue;
+    }
+
+    if (node.count > 0) {
+      for (uint32_t tri = node.first; tri < node.first + node.count; tri++) {
+        const Vector3* v = &m_positions[tri * 3];
+        if (KRMesh::sphereCast(model_to_world, v0, v1, radius, Triangle3::Create(v[0], v[1], v[2]), hitinfo)) {
+          hit_found = true;
+        }
+      }
+    } else {
+      stack[stack_size++] = node.first;
+      stack[stack_size++] = node.first + 1;
+      assert(stack_size < kMaxDepth);
+    }
+  }
+  return hit_found;
+}
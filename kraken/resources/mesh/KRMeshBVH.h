@@ -0,0 +1,78 @@
+//
+//  KRMeshBVH.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+
+#include "hydra.h"
+
+class KRMesh;
+
+// Bounding volume hierarchy over the triangles of a KRMesh, in model space.
+// Nodes and triangles are stored in flat arrays, with each leaf referencing a
+// contiguous run of triangles, so that traversal touches as little memory as possible.
+class KRMeshBVH
+{
+public:
+  KRMeshBVH(const KRMesh& mesh);
+  ~KRMeshBVH();
+
+  bool rayCast(const hydra::Vector3& start, const hydra::Vector3& dir, float max_distance, hydra::HitInfo& hitinfo) const;
+  bool sphereCast(const hydra::Matrix4& model_to_world, const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo) const;
+
+  size_t getTriangleCount() const;
+  size_t getNodeCount() const;
+
+private:
+  static const int kMaxLeafTriangles = 4;
+  static const int kBinCount = 16;
+  static const int kMaxDepth = 64;
+
+  struct Node
+  {
+    float min[3];
+    uint32_t first; // First triangle for leaves, left child for interior nodes.  The right child follows the left child.
+    float max[3];
+    uint32_t count; // Number of triangles for leaves, 0 for interior nodes
+  };
+  static_assert(sizeof(Node) == 32);
+
+  std::vector<Node> m_nodes;
+
+  // Three entries per triangle, in leaf order
+  std::vector<hydra::Vector3> m_positions;
+  std::vector<hydra::Vector3> m_normals;
+
+  void build(std::vector<hydra::Vector3>& centroids, std::vector<uint32_t>& order);
+  void updateBounds(Node& node, const std::vector<uint32_t>& order, const std::vector<hydra::Vector3>& positions) const;
+  static bool intersectRay(const Node& node, const hydra::Vector3& start, const hydra::Vector3& inv_dir, float max_distance, float& distance);
+};
@@ -43,10 +43,14 @@ using namespace mimir;
 
 KRMeshManager::KRMeshManager(KRContext& context)
   : KRResourceManager(context)
-  , m_currentVBO(NULL)
   , m_vboMemUsed(0)
+  , m_boundCommandBuffer(VK_NULL_HANDLE)
+  , m_boundVertexBuffer(VK_NULL_HANDLE)
+  , m_boundIndexBuffer(VK_NULL_HANDLE)
+  , m_boundIndexType(VK_INDEX_TYPE_UINT16)
   , m_memoryTransferredThisFrame(0)
   , m_streamerComplete(true)
+  , m_streamerPending(false)
   , m_draw_call_logging_enabled(false)
   , m_draw_call_log_used(false)
 {
@@ -87,7 +91,7 @@ void KRMeshManager::init()
   memcpy(KRENGINE_VBO_3D_CUBE_VERTICES.getStart(), _KRENGINE_VBO_3D_CUBE_VERTEX_DATA, sizeof(float) * 3 * 14);
   KRENGINE_VBO_3D_CUBE_VERTICES.unlock();
 
-  KRENGINE_VBO_DATA_3D_CUBE_VERTICES.init(this, &KRENGINE_VBO_3D_CUBE_VERTICES, nullptr, &KRENGINE_VBO_3D_CUBE_LAYOUT, false, KRVBOData::CONSTANT
+  KRENGINE_VBO_DATA_3D_CUBE_VERTICES.init(this, &KRENGINE_VBO_3D_CUBE_VERTICES, nullptr, IndexFormat::uint16, &KRENGINE_VBO_3D_CUBE_LAYOUT, false, KRVBOData::CONSTANT
 #if KRENGINE_DEBUG_GPU_LABELS
     , "Cube Mesh [built-in]"
 #endif
@@ -115,7 +119,7 @@ void KRMeshManager::init()
   memcpy(KRENGINE_VBO_2D_SQUARE_VERTICES.getStart(), _KRENGINE_VBO_2D_SQUARE_VERTEX_DATA, sizeof(float) * 5 * 4);
   KRENGINE_VBO_2D_SQUARE_VERTICES.unlock();
 
-  KRENGINE_VBO_DATA_2D_SQUARE_VERTICES.init(this, &KRENGINE_VBO_2D_SQUARE_VERTICES, nullptr, &KRENGINE_VBO_2D_SQUARE_LAYOUT, false, KRVBOData::CONSTANT
+  KRENGINE_VBO_DATA_2D_SQUARE_VERTICES.init(this, &KRENGINE_VBO_2D_SQUARE_VERTICES, nullptr, IndexFormat::uint16, &KRENGINE_VBO_2D_SQUARE_LAYOUT, false, KRVBOData::CONSTANT
 #if KRENGINE_DEBUG_GPU_LABELS
     , "Square Mesh [built-in]"
 #endif
@@ -148,6 +152,11 @@ KRResource* KRMeshManager::getResource(const std::string& name, const std::strin
 
 KRMesh* KRMeshManager::loadMesh(const char* szName, Block* pData)
 {
+  if (!KRMesh::ValidatePack(pData)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to load mesh %s: Invalid or corrupt mesh pack.", szName);
+    delete pData;
+    return nullptr;
+  }
   KRMesh* mesh = new KRMesh(*m_pContext, szName, pData);
   addMesh(mesh);
   return mesh;
@@ -168,6 +177,9 @@ KRMesh* KRMeshManager::getMesh(const char* szName)
   std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
 
   unordered_map<std::string, KRMesh*>::iterator itr = m_meshes.find(lower_name);
+  if (itr == m_meshes.end() && loadDeferredResources(lower_name)) {
+    itr = m_meshes.find(lower_name);
+  }
   if (itr == m_meshes.end()) {
     KRContext::Log(KRContext::LOG_LEVEL_INFORMATION, "Model not found: %s", lower_name.c_str());
     return nullptr;
@@ -184,25 +196,10 @@ void KRMeshManager::bindVBO(VkCommandBuffer& commandBuffer, KRVBOData* vbo_data,
 {
   vbo_data->requestResidency(lodCoverage);
 
-  bool vbo_changed = false;
-  if (m_currentVBO == NULL) {
-    vbo_changed = true;
-  } else if (m_currentVBO->m_data != vbo_data->m_data) {
-    vbo_changed = true;
-  }
-
-  if (vbo_changed) {
-
-    if (m_vbosActive.find(vbo_data->m_data) != m_vbosActive.end()) {
-      m_currentVBO = m_vbosActive[vbo_data->m_data];
-    } else {
-      m_currentVBO = vbo_data;
-
-      m_vbosActive[vbo_data->m_data] = m_currentVBO;
-    }
-
-    m_currentVBO->bind(commandBuffer);
-  }
+  // Draws offset into the heap page with vbo_data's own base vertex and first
+  // index, so it is bound even if another KRVBOData shares its data block.
+  // Redundant binds of the same heap page are skipped by bind().
+  vbo_data->bind(commandBuffer);
 }
 
 void KRMeshManager::startFrame(float deltaTime)
@@ -254,6 +251,14 @@ void KRMeshManager::startFrame(float deltaTime)
       m_vbosActive.erase((*itr)->m_data);
     }
 
+    // Release heap pages emptied by expiry and relocation
+    for (auto& device : getContext().getDeviceManager()->getDevices()) {
+      KRGeometryHeap* heap = device.second->getGeometryHeap();
+      if (heap) {
+        heap->trim();
+      }
+    }
+
     if (m_activeVBOs_streamer_copy.size() > 0) {
       m_streamerComplete = false;
     }
@@ -264,7 +269,9 @@ void KRMeshManager::startFrame(float deltaTime)
 
 void KRMeshManager::endFrame(float deltaTime)
 {
-  m_currentVBO = nullptr;
+  m_boundCommandBuffer = VK_NULL_HANDLE;
+  m_boundVertexBuffer = VK_NULL_HANDLE;
+  m_boundIndexBuffer = VK_NULL_HANDLE;
 }
 
 void KRMeshManager::doStreaming(long& memoryRemaining, long& memoryRemainingThisFrame)
@@ -277,12 +284,20 @@ void KRMeshManager::doStreaming(long& memoryRemaining, long& memoryRemainingThis
 
   if (m_activeVBOs_streamer.size() > 0) {
     balanceVBOMemory(memoryRemaining, memoryRemainingThisFrame);
+    m_streamerPending = true;
+  } else {
+    memoryRemaining -= getMemUsed();
+  }
+}
+
+void KRMeshManager::finishStreaming()
+{
+  if (m_streamerPending) {
+    m_streamerPending = false;
 
     m_streamerFenceMutex.lock();
     m_streamerComplete = true;
     m_streamerFenceMutex.unlock();
-  } else {
-    memoryRemaining -= getMemUsed();
   }
 }
 
@@ -302,6 +317,24 @@ void KRMeshManager::balanceVBOMemory(long& memoryRemaining, long& memoryRemainin
     }
     memoryRemaining -= vbo_size;
   }
+
+  defragmentVBOMemory(memoryRemainingThisFrame);
+}
+
+void KRMeshManager::defragmentVBOMemory(long& memoryRemainingThisFrame)
+{
+  // Move streaming data out of lightly used heap pages, highest priority
+  // first, so that the pages can be released.
+  for (auto vbo_itr = m_activeVBOs_streamer.begin(); vbo_itr != m_activeVBOs_streamer.end(); vbo_itr++) {
+    KRVBOData* vbo_data = (*vbo_itr).second;
+    long vbo_size = vbo_data->getSize();
+    if (memoryRemainingThisFrame <= vbo_size) {
+      continue;
+    }
+    if (vbo_data->isInSparsePage() && vbo_data->relocate()) {
+      memoryRemainingThisFrame -= vbo_size;
+    }
+  }
 }
 
 long KRMeshManager::getMemUsed()
@@ -363,7 +396,7 @@ void KRMeshManager::initVolumetricLightingVertexes()
     m_volumetricLightingVertexLayout.offsets[0] = offsetof(VolumetricLightingVertexData, vertex);
     m_volumetricLightingVertexLayout.attributes[0] = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::position };
 
-    KRENGINE_VBO_DATA_VOLUMETRIC_LIGHTING.init(this, &m_volumetricLightingVertexData, nullptr, &m_volumetricLightingVertexLayout, false, KRVBOData::CONSTANT
+    KRENGINE_VBO_DATA_VOLUMETRIC_LIGHTING.init(this, &m_volumetricLightingVertexData, nullptr, IndexFormat::uint16, &m_volumetricLightingVertexLayout, false, KRVBOData::CONSTANT
 #if KRENGINE_DEBUG_GPU_LABELS
       , "Volumetric Lighting Planes [built-in]"
 #endif
@@ -417,7 +450,7 @@ void KRMeshManager::initRandomParticles()
     m_randomParticleVertexLayout.attributes[0] = { ComponentType::float32, DataType::vec3, Normalization::none, VertexAttribute::position };
     m_randomParticleVertexLayout.attributes[1] = { ComponentType::float32, DataType::vec2, Normalization::none, VertexAttribute::texcoord };
 
-    KRENGINE_VBO_DATA_RANDOM_PARTICLES.init(this, &m_randomParticleVertexData, nullptr, &m_randomParticleVertexLayout, false, KRVBOData::CONSTANT
+    KRENGINE_VBO_DATA_RANDOM_PARTICLES.init(this, &m_randomParticleVertexData, nullptr, IndexFormat::uint16, &m_randomParticleVertexLayout, false, KRVBOData::CONSTANT
 #if KRENGINE_DEBUG_GPU_LABELS
       , "Random Particles [built-in]"
 #endif
@@ -461,10 +494,12 @@ KRMeshManager::KRVBOData::KRVBOData()
   m_debugLabel[0] = '\0';
   m_is_vbo_loaded = false;
   m_is_vbo_ready = false;
+  m_is_relocating = false;
   m_manager = NULL;
   m_type = STREAMING;
   m_data = NULL;
   m_index_data = NULL;
+  m_index_format = IndexFormat::uint16;
   m_layout = NULL;
   m_size = 0;
 
@@ -472,9 +507,10 @@ KRMeshManager::KRVBOData::KRVBOData()
   m_last_frame_max_lod_coverage = 0.0f;
 
   memset(m_allocations, 0, sizeof(AllocationInfo) * KRENGINE_MAX_GPU_COUNT);
+  memset(m_pendingAllocations, 0, sizeof(AllocationInfo) * KRENGINE_MAX_GPU_COUNT);
 }
 
-KRMeshManager::KRVBOData::KRVBOData(KRMeshManager* manager, Block* data, Block* index_data, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
+KRMeshManager::KRVBOData::KRVBOData(KRMeshManager* manager, Block* data, Block* index_data, IndexFormat index_format, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
 #if KRENGINE_DEBUG_GPU_LABELS
   , const char* debug_label
 #endif
@@ -482,16 +518,18 @@ KRMeshManager::KRVBOData::KRVBOData(KRMeshManager* manager, Block* data, Block*
 {
   m_debugLabel[0] = '\0';
   memset(m_allocations, 0, sizeof(AllocationInfo) * KRENGINE_MAX_GPU_COUNT);
+  memset(m_pendingAllocations, 0, sizeof(AllocationInfo) * KRENGINE_MAX_GPU_COUNT);
   m_is_vbo_loaded = false;
   m_is_vbo_ready = false;
-  init(manager, data, index_data, layout, static_vbo, t
+  m_is_relocating = false;
+  init(manager, data, index_data, index_format, layout, static_vbo, t
 #if KRENGINE_DEBUG_GPU_LABELS
     , debug_label
 #endif
   );
 }
 
-void KRMeshManager::KRVBOData::init(KRMeshManager* manager, Block* data, Block* index_data, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
+void KRMeshManager::KRVBOData::init(KRMeshManager* manager, Block* data, Block* index_data, IndexFormat index_format, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
 #if KRENGINE_DEBUG_GPU_LABELS
   , const char* debug_label
 #endif
@@ -505,6 +543,7 @@ void KRMeshManager::KRVBOData::init(KRMeshManager* manager, Block* data, Block*
   m_static_vbo = static_vbo;
   m_data = data;
   m_index_data = index_data;
+  m_index_format = index_format;
   m_layout = layout;
 
   m_size = m_data->getSize();
@@ -543,68 +582,15 @@ void KRMeshManager::KRVBOData::load(VkCommandBuffer& commandBuffer)
   for (auto deviceItr = deviceManager->getDevices().begin(); deviceItr != deviceManager->getDevices().end() && iAllocation < KRENGINE_MAX_GPU_COUNT; deviceItr++, iAllocation++) {
     KRDevice& device = *(*deviceItr).second;
     KrDeviceHandle deviceHandle = (*deviceItr).first;
-    VmaAllocator allocator = device.getAllocator();
     AllocationInfo& allocation = m_allocations[iAllocation];
     allocation.device = deviceHandle;
 
+    if (!upload(commandBuffer, device, allocation, UINT32_MAX)) {
 #if KRENGINE_DEBUG_GPU_LABELS
-    char debug_label[KRENGINE_DEBUG_GPU_LABEL_MAX_LEN];
-
-    const char* type_label = "";
-
-    switch (m_type) {
-    case vbo_type::STREAMING:
-      type_label = "Streaming";
-      break;
-    case vbo_type::CONSTANT:
-      type_label = "Constant";
-      break;
-    case vbo_type::IMMEDIATE:
-      type_label = "Immediate";
-      break;
-    default:
-      assert(false);
-    }
-
-    snprintf(debug_label, KRENGINE_DEBUG_GPU_LABEL_MAX_LEN, "%s Vertices: %s", type_label, m_debugLabel);
-#endif // KRENGINE_DEBUG_GPU_LABELS
-
-    device.createBuffer(
-      m_data->getSize(),
-      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-      &allocation.vertex_buffer,
-      &allocation.vertex_allocation
-#if KRENGINE_DEBUG_GPU_LABELS
-      , debug_label
-#endif // KRENGINE_DEBUG_GPU_LABELS
-    );
-    if (m_type == vbo_type::IMMEDIATE) {
-      device.graphicsUpload(commandBuffer, *m_data, allocation.vertex_buffer);
-    } else {
-      device.streamUpload(*m_data, allocation.vertex_buffer);
-    }
-
-
-    if (m_index_data && m_index_data->getSize() > 0) {
-#if KRENGINE_DEBUG_GPU_LABELS
-      snprintf(debug_label, KRENGINE_DEBUG_GPU_LABEL_MAX_LEN, "%s Indexes: %s", type_label, m_debugLabel);
-#endif // KRENGINE_DEBUG_GPU_LABELS
-      device.createBuffer(
-        m_index_data->getSize(),
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        &allocation.index_buffer,
-        &allocation.index_allocation
-#if KRENGINE_DEBUG_GPU_LABELS
-        , debug_label
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to allocate geometry heap space for %s", m_debugLabel);
+#else
+      KRContext::Log(KRContext::LOG_LEVEL_ERROR, "Unable to allocate geometry heap space.");
 #endif
-      );
-      if (m_type == vbo_type::IMMEDIATE) {
-        device.graphicsUpload(commandBuffer, *m_index_data, allocation.index_buffer);
-      } else {
-        device.streamUpload(*m_index_data, allocation.index_buffer);
-      }
     }
   }
 
@@ -618,22 +604,69 @@ void KRMeshManager::KRVBOData::load(VkCommandBuffer& commandBuffer)
   }
 }
 
+bool KRMeshManager::KRVBOData::upload(VkCommandBuffer& commandBuffer, KRDevice& device, AllocationInfo& allocation, uint32_t pageLimit)
+{
+  KRGeometryHeap* heap = device.getGeometryHeap();
+  if (heap == nullptr) {
+    return false;
+  }
+
+  bool has_indexes = m_index_data && m_index_data->getSize() > 0;
+  if (!heap->allocate(m_data->getSize(), getVertexAlignment(), &allocation.vertex_allocation, pageLimit)) {
+    return false;
+  }
+  if (has_indexes && !heap->allocate(m_index_data->getSize(), IndexFormatSize[(int)m_index_format], &allocation.index_allocation, pageLimit)) {
+    heap->free(allocation.vertex_allocation);
+    return false;
+  }
+
+  if (m_type == vbo_type::IMMEDIATE) {
+    device.graphicsUpload(commandBuffer, *m_data, allocation.vertex_allocation.buffer, allocation.vertex_allocation.offset);
+  } else {
+    device.streamUpload(*m_data, allocation.vertex_allocation.buffer, allocation.vertex_allocation.offset);
+  }
+
+  if (has_indexes) {
+    if (m_type == vbo_type::IMMEDIATE) {
+      device.graphicsUpload(commandBuffer, *m_index_data, allocation.index_allocation.buffer, allocation.index_allocation.offset);
+    } else {
+      device.streamUpload(*m_index_data, allocation.index_allocation.buffer, allocation.index_allocation.offset);
+    }
+  }
+  return true;
+}
+
+void KRMeshManager::KRVBOData::releaseAllocation(AllocationInfo& allocation)
+{
+  if (allocation.device) {
+    KRDeviceManager* deviceManager = m_manager->getContext().getDeviceManager();
+    std::unique_ptr<KRDevice>& device = deviceManager->getDevice(allocation.device);
+    if (device && device->getGeometryHeap()) {
+      device->getGeometryHeap()->free(allocation.vertex_allocation);
+      device->getGeometryHeap()->free(allocation.index_allocation);
+    }
+  }
+  memset(&allocation, 0, sizeof(AllocationInfo));
+}
+
+VkDeviceSize KRMeshManager::KRVBOData::getVertexAlignment() const
+{
+  // Vertex data must start on a whole vertex to be addressed with vertexOffset,
+  // and on a 4 byte boundary for attribute fetch.
+  VkDeviceSize stride = m_layout->vertexSize;
+  assert(stride > 0);
+  VkDeviceSize alignment = stride;
+  while (alignment % 4 != 0) {
+    alignment += stride;
+  }
+  return alignment;
+}
+
 void KRMeshManager::KRVBOData::unload()
 {
-  KRDeviceManager* deviceManager = m_manager->getContext().getDeviceManager();
   for (int i = 0; i < KRENGINE_MAX_GPU_COUNT; i++) {
-    AllocationInfo& allocation = m_allocations[i];
-    if (allocation.device) {
-      std::unique_ptr<KRDevice>& device = deviceManager->getDevice(allocation.device);
-      if (device) {
-        VmaAllocator allocator = device->getAllocator();
-        vmaDestroyBuffer(allocator, allocation.vertex_buffer, allocation.vertex_allocation);
-        if (allocation.index_buffer) {
-          vmaDestroyBuffer(allocator, allocation.index_buffer, allocation.index_allocation);
-        }
-      }
-    }
-    memset(&allocation, 0, sizeof(AllocationInfo));
+    releaseAllocation(m_allocations[i]);
+    releaseAllocation(m_pendingAllocations[i]);
   }
 
   if (isVBOLoaded()) {
@@ -642,18 +675,100 @@ void KRMeshManager::KRVBOData::unload()
 
   m_is_vbo_loaded = false;
   m_is_vbo_ready = false;
+  m_is_relocating = false;
 }
 
 void KRMeshManager::KRVBOData::bind(VkCommandBuffer& commandBuffer)
 {
-  VkBuffer vertexBuffers[] = { getVertexBuffer() };
-  VkDeviceSize offsets[] = { 0 };
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+  if (m_manager->m_boundCommandBuffer != commandBuffer) {
+    m_manager->m_boundCommandBuffer = commandBuffer;
+    m_manager->m_boundVertexBuffer = VK_NULL_HANDLE;
+    m_manager->m_boundIndexBuffer = VK_NULL_HANDLE;
+  }
+
+  // Data sharing a heap page is drawn without rebinding
+  VkBuffer vertexBuffer = getVertexBuffer();
+  if (m_manager->m_boundVertexBuffer != vertexBuffer) {
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
+    m_manager->m_boundVertexBuffer = vertexBuffer;
+  }
 
   if (m_index_data && m_index_data->getSize() > 0) {
-    // TODO - Support 32-bit index buffers
-    vkCmdBindIndexBuffer(commandBuffer, getIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    VkIndexType indexType = m_index_format == IndexFormat::uint32 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+    VkBuffer indexBuffer = getIndexBuffer();
+    if (m_manager->m_boundIndexBuffer != indexBuffer || m_manager->m_boundIndexType != indexType) {
+      vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+      m_manager->m_boundIndexBuffer = indexBuffer;
+      m_manager->m_boundIndexType = indexType;
+    }
+  }
+}
+
+bool KRMeshManager::KRVBOData::isInSparsePage()
+{
+  if (m_type != STREAMING || !m_is_vbo_ready || m_is_relocating) {
+    return false;
+  }
+  KRDeviceManager* deviceManager = m_manager->getContext().getDeviceManager();
+  for (int i = 0; i < KRENGINE_MAX_GPU_COUNT; i++) {
+    AllocationInfo& allocation = m_allocations[i];
+    if (allocation.device == 0) {
+      continue;
+    }
+    std::unique_ptr<KRDevice>& device = deviceManager->getDevice(allocation.device);
+    if (!device || device->getGeometryHeap() == nullptr) {
+      continue;
+    }
+    KRGeometryHeap* heap = device->getGeometryHeap();
+    if (heap->isSparse(allocation.vertex_allocation.page)) {
+      return true;
+    }
+    if (allocation.index_allocation.buffer != VK_NULL_HANDLE && heap->isSparse(allocation.index_allocation.page)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool KRMeshManager::KRVBOData::relocate()
+{
+  assert(m_type == STREAMING);
+  KRDeviceManager* deviceManager = m_manager->getContext().getDeviceManager();
+  VkCommandBuffer noCommandBuffer = VK_NULL_HANDLE;
+  for (int i = 0; i < KRENGINE_MAX_GPU_COUNT; i++) {
+    AllocationInfo& allocation = m_allocations[i];
+    if (allocation.device == 0) {
+      continue;
+    }
+    std::unique_ptr<KRDevice>& device = deviceManager->getDevice(allocation.device);
+    if (!device || device->getGeometryHeap() == nullptr) {
+      continue;
+    }
+    KRGeometryHeap* heap = device->getGeometryHeap();
+
+    // Only move into pages before the first sparse page holding this data
+    uint32_t pageLimit = UINT32_MAX - 1;
+    if (heap->isSparse(allocation.vertex_allocation.page)) {
+      pageLimit = allocation.vertex_allocation.page;
+    }
+    if (allocation.index_allocation.buffer != VK_NULL_HANDLE && heap->isSparse(allocation.index_allocation.page)) {
+      pageLimit = std::min(pageLimit, allocation.index_allocation.page);
+    }
+
+    AllocationInfo& pending = m_pendingAllocations[i];
+    pending.device = allocation.device;
+    if (!upload(noCommandBuffer, *device, pending, pageLimit)) {
+      for (int j = 0; j < KRENGINE_MAX_GPU_COUNT; j++) {
+        releaseAllocation(m_pendingAllocations[j]);
+      }
+      return false;
+    }
   }
+
+  m_is_relocating = true;
+  m_manager->m_memoryTransferredThisFrame += getSize();
+  return true;
 }
 
 void KRMeshManager::KRVBOData::requestResidency(float lodCoverage)
@@ -681,6 +796,15 @@ float KRMeshManager::KRVBOData::getStreamPriority()
 
 void KRMeshManager::KRVBOData::_swapHandles()
 {
+  if (m_is_relocating) {
+    // The old ranges are retired by the geometry heap until frames referencing them have completed
+    for (int i = 0; i < KRENGINE_MAX_GPU_COUNT; i++) {
+      releaseAllocation(m_allocations[i]);
+      m_allocations[i] = m_pendingAllocations[i];
+      memset(&m_pendingAllocations[i], 0, sizeof(AllocationInfo));
+    }
+    m_is_relocating = false;
+  }
   m_is_vbo_ready = m_is_vbo_loaded;
 }
 
@@ -695,13 +819,25 @@ void KRMeshManager::primeVBO(KRVBOData* vbo_data)
 VkBuffer& KRMeshManager::KRVBOData::getVertexBuffer()
 {
   assert(m_is_vbo_ready);
-  return m_allocations->vertex_buffer;
+  return m_allocations->vertex_allocation.buffer;
 }
 
 VkBuffer& KRMeshManager::KRVBOData::getIndexBuffer()
 {
   assert(m_is_vbo_ready);
-  return m_allocations->index_buffer;
+  return m_allocations->index_allocation.buffer;
+}
+
+int32_t KRMeshManager::KRVBOData::getBaseVertex() const
+{
+  assert(m_is_vbo_ready);
+  return (int32_t)(m_allocations->vertex_allocation.offset / m_layout->vertexSize);
+}
+
+uint32_t KRMeshManager::KRVBOData::getFirstIndex() const
+{
+  assert(m_is_vbo_ready);
+  return (uint32_t)(m_allocations->index_allocation.offset / IndexFormatSize[(int)m_index_format]);
 }
 
 
@@ -709,3 +845,8 @@ const VertexBufferLayout* KRMeshManager::KRVBOData::getLayout() const
 {
   return m_layout;
 }
+
+IndexFormat KRMeshManager::KRVBOData::getIndexFormat() const
+{
+  return m_index_format;
+}
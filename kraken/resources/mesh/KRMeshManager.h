@@ -35,10 +35,12 @@
 
 #include "resources/KRResourceManager.h"
 #include "KRContextObject.h"
+#include "KRGeometryHeap.h"
 #include "block.h"
 #include "nodes/KRNode.h"
 
 class KRContext;
+class KRDevice;
 class KRMesh;
 class VertexBufferLayout;
 enum RenderPassType : uint8_t;
@@ -53,6 +55,18 @@ enum class Topology : uint8_t
   TriangleFans
 };
 
+enum class IndexFormat : uint8_t
+{
+  uint16 = 0,
+  uint32
+};
+
+static constexpr std::array<int, 2> IndexFormatSize =
+{
+  2, // uint16
+  4 // uint32
+};
+
 enum class ComponentType : uint8_t
 {
   empty = 0,
@@ -208,12 +222,12 @@ public:
     } vbo_type;
 
     KRVBOData();
-    KRVBOData(KRMeshManager* manager, mimir::Block* data, mimir::Block* index_data, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
+    KRVBOData(KRMeshManager* manager, mimir::Block* data, mimir::Block* index_data, IndexFormat index_format, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
 #if KRENGINE_DEBUG_GPU_LABELS
         , const char* debug_label
 #endif
     );
-    void init(KRMeshManager* manager, mimir::Block* data, mimir::Block* index_data, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
+    void init(KRMeshManager* manager, mimir::Block* data, mimir::Block* index_data, IndexFormat index_format, const VertexBufferLayout* layout, bool static_vbo, vbo_type t
 #if KRENGINE_DEBUG_GPU_LABELS
       , const char* debug_label
 #endif
@@ -223,6 +237,7 @@ public:
 
     mimir::Block* m_data;
     mimir::Block* m_index_data;
+    IndexFormat m_index_format;
     const VertexBufferLayout* m_layout;
 
     bool isVBOLoaded()
@@ -238,6 +253,11 @@ public:
     void unload();
     void bind(VkCommandBuffer& commandBuffer);
 
+    // Moves resident data out of sparse geometry heap pages.  The new
+    // location is used after the next _swapHandles().
+    bool relocate();
+    bool isInSparsePage();
+
     // KRMeshManager depends on the address of KRVBOData's being constant
     // after allocation.  This is enforced by deleted copy constructors.
     KRVBOData(const KRVBOData& o) = delete;
@@ -265,7 +285,12 @@ public:
 
     VkBuffer& getVertexBuffer();
     VkBuffer& getIndexBuffer();
+    // Vertex buffers are shared with other KRVBOData's, so draws must add
+    // these to their vertexOffset and firstIndex.
+    int32_t getBaseVertex() const;
+    uint32_t getFirstIndex() const;
     const VertexBufferLayout* getLayout() const;
+    IndexFormat getIndexFormat() const;
 
   private:
     KRMeshManager* m_manager;
@@ -277,17 +302,21 @@ public:
     bool m_static_vbo;
     bool m_is_vbo_loaded;
     bool m_is_vbo_ready;
+    bool m_is_relocating;
 
     typedef struct
     {
       KrDeviceHandle device;
-      VkBuffer vertex_buffer;
-      VmaAllocation vertex_allocation;
-      VkBuffer index_buffer;
-      VmaAllocation index_allocation;
+      KRGeometryHeap::Allocation vertex_allocation;
+      KRGeometryHeap::Allocation index_allocation;
     } AllocationInfo;
 
     AllocationInfo m_allocations[KRENGINE_MAX_GPU_COUNT];
+    AllocationInfo m_pendingAllocations[KRENGINE_MAX_GPU_COUNT];
+
+    bool upload(VkCommandBuffer& commandBuffer, KRDevice& device, AllocationInfo& allocation, uint32_t pageLimit);
+    void releaseAllocation(AllocationInfo& allocation);
+    VkDeviceSize getVertexAlignment() const;
 
 #if KRENGINE_DEBUG_GPU_LABELS
     char m_debugLabel[KRENGINE_DEBUG_GPU_LABEL_MAX_LEN];
@@ -333,6 +362,8 @@ public:
 
 
   void doStreaming(long& memoryRemaining, long& memoryRemainingThisFrame);
+  // Called by the streamer thread once the transfers recorded by doStreaming have completed
+  void finishStreaming();
 
 private:
   mimir::Block KRENGINE_VBO_3D_CUBE_VERTICES;
@@ -347,7 +378,12 @@ private:
   unordered_map<std::string, KRMesh*> m_meshes;
 
   long m_vboMemUsed;
-  KRVBOData* m_currentVBO;
+
+  // Heap pages bound by the last KRVBOData::bind()
+  VkCommandBuffer m_boundCommandBuffer;
+  VkBuffer m_boundVertexBuffer;
+  VkBuffer m_boundIndexBuffer;
+  VkIndexType m_boundIndexType;
 
   unordered_map<mimir::Block*, KRVBOData*> m_vbosActive;
   std::vector<std::pair<float, KRVBOData*> > m_activeVBOs_streamer;
@@ -361,8 +397,10 @@ private:
 
   std::mutex m_streamerFenceMutex;
   bool m_streamerComplete;
+  bool m_streamerPending;
 
   void balanceVBOMemory(long& memoryRemaining, long& memoryRemainingThisFrame);
+  void defragmentVBOMemory(long& memoryRemainingThisFrame);
 
   void primeVBO(KRVBOData* vbo_data);
 
@@ -0,0 +1,338 @@
+//
+//  KRMeshOptimizer.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KRMeshOptimizer.h"
+
+namespace {
+
+// A FIFO post-transform vertex cache, tracked with the time at which each vertex entered it
+class FifoCache
+{
+public:
+  FifoCache(size_t vertexCount, int cacheSize)
+    : m_entryTimes(vertexCount, 0)
+    , m_cacheSize(cacheSize)
+    , m_time((uint32_t)cacheSize + 1)
+  {
+  }
+
+  // Returns true when the vertex had to be transformed
+  bool access(uint32_t vertex)
+  {
+    if (m_time - m_entryTimes[vertex] > (uint32_t)m_cacheSize) {
+      m_entryTimes[vertex] = m_time++;
+      return true;
+    }
+    return false;
+  }
+
+  void clear()
+  {
+    m_time += m_cacheSize + 1;
+  }
+
+private:
+  std::vector<uint32_t> m_entryTimes;
+  int m_cacheSize;
+  uint32_t m_time;
+};
+
+} // anonymous namespace
+
+float KRMeshOptimizer::CacheStatistics::getACMR() const
+{
+  return triangleCount ? (float)cacheMisses / (float)triangleCount : 0.f;
+}
+
+float KRMeshOptimizer::CacheStatistics::getATVR() const
+{
+  return vertexCount ? (float)cacheMisses / (float)vertexCount : 0.f;
+}
+
+void KRMeshOptimizer::CacheStatistics::add(const CacheStatistics& other)
+{
+  triangleCount += other.triangleCount;
+  vertexCount += other.vertexCount;
+  cacheMisses += other.cacheMisses;
+}
+
+KRMeshOptimizer::CacheStatistics KRMeshOptimizer::AnalyzeVertexCache(const uint32_t* indexes, size_t indexCount, size_t vertexCount, int cacheSize)
+{
+  CacheStatistics statistics = {};
+  statistics.triangleCount = indexCount / 3;
+
+  FifoCache cache(vertexCount, std::max(cacheSize, kMinCacheSize));
+  std::vector<bool> referenced(vertexCount, false);
+  for (size_t i = 0; i < statistics.triangleCount * 3; i++) {
+    uint32_t vertex = indexes[i];
+    if (cache.access(vertex)) {
+      statistics.cacheMisses++;
+    }
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      statistics.vertexCount++;
+    }
+  }
+  return statistics;
+}
+
+void KRMeshOptimizer::OptimizeVertexCache(uint32_t* indexes, size_t indexCount, size_t vertexCount, int cacheSize, std::vector<size_t>& clusters)
+{
+  // Tipsify, from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw",
+  // Sander, Nehab and Barczak, 2007
+  cacheSize = std::max(cacheSize, kMinCacheSize);
+  size_t triangleCount = indexCount / 3;
+  clusters.clear();
+  if (triangleCount == 0) {
+    return;
+  }
+
+  // Triangles adjacent to each vertex
+  std::vector<uint32_t> liveTriangles(vertexCount, 0);
+  for (size_t i = 0; i < triangleCount * 3; i++) {
+    liveTriangles[indexes[i]]++;
+  }
+  std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; v++) {
+    adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+  }
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+      adjacency[fill[indexes[i]]++] = (uint32_t)(i / 3);
+    }
+  }
+
+  std::vector<uint32_t> cacheTimes(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+
+  uint32_t time = (uint32_t)cacheSize + 1;
+  size_t cursor = 0;
+  int64_t fanVertex = 0;
+  while (liveTriangles[fanVertex] == 0 && fanVertex + 1 < (int64_t)vertexCount) {
+    fanVertex++;
+  }
+  clusters.push_back(0);
+
+  while (fanVertex >= 0) {
+    // Emit every remaining triangle around the fanning vertex
+    candidates.clear();
+    for (uint32_t a = adjacencyStart[fanVertex]; a < adjacencyStart[fanVertex + 1]; a++) {
+      uint32_t triangle = adjacency[a];
+      if (emitted[triangle]) {
+        continue;
+      }
+      emitted[triangle] = true;
+      for (int c = 0; c < 3; c++) {
+        uint32_t v = indexes[triangle * 3 + c];
+        output.push_back(v);
+        deadEnds.push_back(v);
+        candidates.push_back(v);
+        liveTriangles[v]--;
+        if (time - cacheTimes[v] > (uint32_t)cacheSize) {
+          cacheTimes[v] = time++;
+        }
+      }
+    }
+
+    // Prefer the candidate that will still be in the cache after its own triangles are emitted
+    int64_t best = -1;
+    int64_t bestPriority = -1;
+    for (uint32_t v : candidates) {
+      if (liveTriangles[v] == 0) {
+        continue;
+      }
+      int64_t priority = 0;
+      if (time - cacheTimes[v] + 2 * liveTriangles[v] <= (uint32_t)cacheSize) {
+        priority = time - cacheTimes[v];
+      }
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        best = v;
+      }
+    }
+
+    if (best == -1) {
+      // Dead end; fall back to recently used vertexes, then to the next vertex in order.
+      // Either way, the cache is cold, so a new cluster starts here.
+      while (!deadEnds.empty() && best == -1) {
+        uint32_t v = deadEnds.back();
+        deadEnds.pop_back();
+        if (liveTriangles[v] > 0) {
+          best = v;
+        }
+      }
+      while (best == -1 && cursor < vertexCount) {
+        if (liveTriangles[cursor] > 0) {
+          best = (int64_t)cursor;
+        }
+        cursor++;
+      }
+      if (best != -1 && output.size() / 3 > clusters.back()) {
+        clusters.push_back(output.size() / 3);
+      }
+    }
+    fanVertex = best;
+  }
+
+  memcpy(indexes, output.data(), output.size() * sizeof(uint32_t));
+
+  // Split the clusters further wherever the cache efficiency of the cluster so far, measured
+  // from a cold cache, is already close to that of the whole mesh
+  CacheStatistics overall = AnalyzeVertexCache(indexes, triangleCount * 3, vertexCount, cacheSize);
+  float threshold = overall.getACMR() * kClusterSplitThreshold;
+  std::vector<size_t> hardClusters;
+  hardClusters.swap(clusters);
+  hardClusters.push_back(triangleCount);
+  FifoCache cache(vertexCount, cacheSize);
+  for (size_t c = 0; c + 1 < hardClusters.size(); c++) {
+    size_t clusterStart = hardClusters[c];
+    size_t clusterMisses = 0;
+    clusters.push_back(clusterStart);
+    cache.clear();
+    for (size_t t = clusterStart; t < hardClusters[c + 1]; t++) {
+      for (int i = 0; i < 3; i++) {
+        if (cache.access(indexes[t * 3 + i])) {
+          clusterMisses++;
+        }
+      }
+      size_t clusterTriangles = t + 1 - clusterStart;
+      if (t + 1 < hardClusters[c + 1] && clusterTriangles >= kMinClusterTriangles && (float)clusterMisses <= threshold * (float)clusterTriangles) {
+        clusterStart = t + 1;
+        clusterMisses = 0;
+        clusters.push_back(clusterStart);
+        cache.clear();
+      }
+    }
+  }
+}
+
+void KRMeshOptimizer::OptimizeOverdraw(uint32_t* indexes, size_t indexCount, const float* positions, const std::vector<size_t>& clusters)
+{
+  size_t triangleCount = indexCount / 3;
+  if (clusters.size() < 2) {
+    return;
+  }
+
+  // Area weighted centroid and normal of each cluster
+  struct Cluster
+  {
+    size_t start;
+    size_t end;
+    float centroid[3];
+    float normal[3];
+    float area;
+    float sortKey;
+  };
+  std::vector<Cluster> sorted(clusters.size());
+  float meshCentroid[3] = { 0.f, 0.f, 0.f };
+  float meshArea = 0.f;
+  for (size_t c = 0; c < clusters.size(); c++) {
+    Cluster& cluster = sorted[c];
+    cluster = {};
+    cluster.start = clusters[c];
+    cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+    for (size_t t = cluster.start; t < cluster.end; t++) {
+      const float* p0 = positions + indexes[t * 3] * 3;
+      const float* p1 = positions + indexes[t * 3 + 1] * 3;
+      const float* p2 = positions + indexes[t * 3 + 2] * 3;
+      float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+      float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+      float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+      float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5f;
+      for (int i = 0; i < 3; i++) {
+        cluster.centroid[i] += (p0[i] + p1[i] + p2[i]) * (area / 3.f);
+        cluster.normal[i] += n[i];
+      }
+      cluster.area += area;
+    }
+    for (int i = 0; i < 3; i++) {
+      meshCentroid[i] += cluster.centroid[i];
+    }
+    meshArea += cluster.area;
+    if (cluster.area > 0.f) {
+      for (int i = 0; i < 3; i++) {
+        cluster.centroid[i] /= cluster.area;
+      }
+    }
+  }
+  if (meshArea > 0.f) {
+    for (int i = 0; i < 3; i++) {
+      meshCentroid[i] /= meshArea;
+    }
+  }
+
+  // Clusters facing away from the centroid of the mesh are more likely to occlude the rest
+  // of the mesh, so they are drawn first
+  for (Cluster& cluster : sorted) {
+    float length = sqrtf(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+    cluster.sortKey = 0.f;
+    if (length > 0.f) {
+      for (int i = 0; i < 3; i++) {
+        cluster.sortKey += (cluster.centroid[i] - meshCentroid[i]) * cluster.normal[i] / length;
+      }
+    }
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {
+    return a.sortKey > b.sortKey;
+  });
+
+  std::vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+  for (const Cluster& cluster : sorted) {
+    output.insert(output.end(), indexes + cluster.start * 3, indexes + cluster.end * 3);
+  }
+  memcpy(indexes, output.data(), output.size() * sizeof(uint32_t));
+}
+
+void KRMeshOptimizer::OptimizeVertexFetch(uint32_t* indexes, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+  const uint32_t kUnassigned = 0xffffffff;
+  remap.assign(vertexCount, kUnassigned);
+  uint32_t nextVertex = 0;
+  for (size_t i = 0; i < indexCount; i++) {
+    uint32_t& newVertex = remap[indexes[i]];
+    if (newVertex == kUnassigned) {
+      newVertex = nextVertex++;
+    }
+    indexes[i] = newVertex;
+  }
+  for (uint32_t& newVertex : remap) {
+    if (newVertex == kUnassigned) {
+      newVertex = nextVertex++;
+    }
+  }
+}
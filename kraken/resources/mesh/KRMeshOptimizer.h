@@ -0,0 +1,77 @@
+//
+//  KRMeshOptimizer.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+
+// Reorders indexed triangle lists for the GPU.  Triangles are ordered for reuse of the
+// post-transform vertex cache with Tipsify, clusters of triangles are then ordered to reduce
+// overdraw, and finally vertexes are renumbered in order of first use for vertex fetch locality.
+//
+// Indexes are relative to the start of their vertex range and must be less than vertexCount.
+class KRMeshOptimizer
+{
+public:
+  struct CacheStatistics
+  {
+    size_t triangleCount;
+    size_t vertexCount;
+    size_t cacheMisses;
+
+    // Average cache miss ratio; transformed vertexes per triangle
+    float getACMR() const;
+    // Average transformed vertex ratio; transformed vertexes per referenced vertex
+    float getATVR() const;
+    void add(const CacheStatistics& other);
+  };
+
+  // Simulates a FIFO post-transform cache of cacheSize entries
+  static CacheStatistics AnalyzeVertexCache(const uint32_t* indexes, size_t indexCount, size_t vertexCount, int cacheSize);
+
+  // Reorders the triangles with Tipsify.  The triangle offset at which each cluster starts is
+  // returned in clusters.  Clusters are split where the vertex cache is cold, so that they
+  // can be reordered with little effect on cache efficiency.
+  static void OptimizeVertexCache(uint32_t* indexes, size_t indexCount, size_t vertexCount, int cacheSize, std::vector<size_t>& clusters);
+
+  // Orders the clusters produced by OptimizeVertexCache so that clusters facing away from the
+  // center of the mesh are drawn first.  positions holds x, y and z for each vertex.
+  static void OptimizeOverdraw(uint32_t* indexes, size_t indexCount, const float* positions, const std::vector<size_t>& clusters);
+
+  // Renumbers the vertexes in the order in which the indexes first reference them.  remap
+  // receives the new index of each vertex; vertexes that are never referenced are moved to the end.
+  static void OptimizeVertexFetch(uint32_t* indexes, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+private:
+  static constexpr int kMinCacheSize = 3;
+  static constexpr size_t kMinClusterTriangles = 8;
+  static constexpr float kClusterSplitThreshold = 1.05f;
+};
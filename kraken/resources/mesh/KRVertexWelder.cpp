@@ -0,0 +1,95 @@
+//
+//  KRVertexWelder.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "KRVertexWelder.h"
+
+KRVertexWelder::KRVertexWelder(size_t vertexSize, size_t maxVertexCount)
+  : m_vertexSize(vertexSize)
+  , m_vertexCount(0)
+{
+  size_t capacity = 16;
+  while (capacity < maxVertexCount * 2) {
+    capacity *= 2;
+  }
+  m_slots.assign(capacity, 0);
+  m_hashes.reserve(maxVertexCount);
+  m_arena.reserve(maxVertexCount * vertexSize);
+}
+
+__uint32_t KRVertexWelder::weld(const std::byte* vertexBytes)
+{
+  uint64_t hash = Hash(vertexBytes, m_vertexSize);
+  size_t mask = m_slots.size() - 1;
+  for (size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask) {
+    __uint32_t entry = m_slots[slot];
+    if (entry == 0) {
+      // Slots hold the index of a unique vertex plus one, so that zero marks an empty slot
+      m_slots[slot] = m_vertexCount + 1;
+      m_hashes.push_back(hash);
+      m_arena.insert(m_arena.end(), vertexBytes, vertexBytes + m_vertexSize);
+      return m_vertexCount++;
+    }
+    __uint32_t index = entry - 1;
+    if (m_hashes[index] == hash && memcmp(m_arena.data() + index * m_vertexSize, vertexBytes, m_vertexSize) == 0) {
+      return index;
+    }
+  }
+}
+
+__uint32_t KRVertexWelder::getVertexCount() const
+{
+  return m_vertexCount;
+}
+
+const std::vector<std::byte>& KRVertexWelder::getVertexData() const
+{
+  return m_arena;
+}
+
+uint64_t KRVertexWelder::Hash(const std::byte* data, size_t size)
+{
+  // Multiply-xorshift mix over 8 byte words, followed by any remaining bytes
+  uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ (uint64_t)data[i]) * 0x100000001b3ull;
+  }
+  hash ^= hash >> 29;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 32;
+  return hash;
+}
@@ -0,0 +1,58 @@
+//
+//  KRVertexWelder.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+
+// Welds vertexes with identical bytes.  Unique vertexes are appended to an arena in order of
+// first use and found again through an open-addressing table of indexes into the arena, so
+// the result matches de-duplication with an ordered map keyed on the vertex bytes.
+class KRVertexWelder
+{
+public:
+  KRVertexWelder(size_t vertexSize, size_t maxVertexCount);
+
+  // Returns the index of the unique vertex matching vertexBytes, adding it if it is new
+  __uint32_t weld(const std::byte* vertexBytes);
+
+  __uint32_t getVertexCount() const;
+  const std::vector<std::byte>& getVertexData() const;
+
+private:
+  size_t m_vertexSize;
+  __uint32_t m_vertexCount;
+  std::vector<__uint32_t> m_slots;
+  std::vector<uint64_t> m_hashes;
+  std::vector<std::byte> m_arena;
+
+  static uint64_t Hash(const std::byte* data, size_t size);
+};
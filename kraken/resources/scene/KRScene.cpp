@@ -41,6 +41,173 @@
 #include "resources/audio/KRAudioManager.h"
 #include "resources/KRResourceRequest.h"
 #include "KRRenderPass.h"
+#include "KRWorkerPool.h"
+
+namespace {
+
+// Octree depth at which culling fans out to the worker pool
+const int KRENGINE_CULL_SPLIT_DEPTH = 2;
+
+typedef std::vector<KRScene::VisibleOctreeNode> VisibleList;
+
+// Cull functors test a batch of bounds: cull(const hydra::AABB* bounds, size_t count, uint8_t* mask)
+// sets mask[i] to 1 for each visible box.
+
+template <typename Cull>
+bool CullOne(const Cull& cull, const hydra::AABB& bounds)
+{
+  uint8_t mask = 0;
+  cull(&bounds, 1, &mask);
+  return mask != 0;
+}
+
+// Appends octree_node, which has already passed cull, and its visible descendants.
+// The children of each node are culled together as one batch.
+template <typename Cull>
+void AppendCulledSubtree(KROctreeNode* octree_node, const int* child_order, const Cull& cull, VisibleList& visible)
+{
+  size_t index = visible.size();
+  visible.push_back(KRScene::VisibleOctreeNode{ octree_node, 0 });
+
+  KROctreeNode* children[8];
+  hydra::AABB child_bounds[8];
+  uint8_t child_visible[8];
+  size_t child_count = 0;
+  for (int i = 0; i < 8; i++) {
+    KROctreeNode* child = octree_node->getChildren()[child_order[i]];
+    if (child) {
+      children[child_count] = child;
+      child_bounds[child_count] = child->getBounds();
+      child_count++;
+    }
+  }
+  if (child_count) {
+    cull(child_bounds, child_count, child_visible);
+    for (size_t i = 0; i < child_count; i++) {
+      if (child_visible[i]) {
+        AppendCulledSubtree(children[i], child_order, cull, visible);
+      }
+    }
+  }
+  visible[index].subtreeEnd = visible.size();
+}
+
+template <typename Cull>
+void AppendVisibleSubtree(KROctreeNode* octree_node, const int* child_order, const Cull& cull, VisibleList& visible)
+{
+  if (octree_node == nullptr || !CullOne(cull, octree_node->getBounds())) {
+    return;
+  }
+  AppendCulledSubtree(octree_node, child_order, cull, visible);
+}
+
+struct CullTask
+{
+  KROctreeNode* octreeNode;
+  int depth;
+  bool split; // Culled by a worker, along with its descendants
+};
+
+template <typename Cull>
+void CollectCullTasks(KROctreeNode* octree_node, int depth, const int* child_order, const Cull& cull, std::vector<CullTask>& tasks)
+{
+  if (octree_node == nullptr) {
+    return;
+  }
+  if (depth == KRENGINE_CULL_SPLIT_DEPTH) {
+    tasks.push_back(CullTask{ octree_node, depth, true });
+    return;
+  }
+  if (!CullOne(cull, octree_node->getBounds())) {
+    return;
+  }
+  tasks.push_back(CullTask{ octree_node, depth, false });
+  for (int i = 0; i < 8; i++) {
+    CollectCullTasks(octree_node->getChildren()[child_order[i]], depth + 1, child_order, cull, tasks);
+  }
+}
+
+// Produces the same list as AppendVisibleSubtree, culling the subtrees below
+// KRENGINE_CULL_SPLIT_DEPTH in parallel
+template <typename Cull>
+void BuildVisibleList(KROctreeNode* root, const int* child_order, const Cull& cull, KRWorkerPool* pool, VisibleList& visible)
+{
+  visible.clear();
+
+  std::vector<CullTask> tasks;
+  CollectCullTasks(root, 0, child_order, cull, tasks);
+
+  std::vector<size_t> split_tasks;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if (tasks[i].split) {
+      split_tasks.push_back(i);
+    }
+  }
+  std::vector<VisibleList> split_visible(split_tasks.size());
+  auto cullSplit = [&](size_t i) {
+    AppendVisibleSubtree(tasks[split_tasks[i]].octreeNode, child_order, cull, split_visible[i]);
+  };
+  if (pool) {
+    pool->parallelFor(split_tasks.size(), cullSplit);
+  } else {
+    for (size_t i = 0; i < split_tasks.size(); i++) {
+      cullSplit(i);
+    }
+  }
+
+  // Stitch the results back together in depth-first order
+  std::vector<std::pair<size_t, int>> open;
+  size_t split_index = 0;
+  for (const CullTask& task : tasks) {
+    while (!open.empty() && open.back().second >= task.depth) {
+      visible[open.back().first].subtreeEnd = visible.size();
+      open.pop_back();
+    }
+    if (task.split) {
+      size_t offset = visible.size();
+      for (KRScene::VisibleOctreeNode entry : split_visible[split_index++]) {
+        entry.subtreeEnd += offset;
+        visible.push_back(entry);
+      }
+    } else {
+      open.push_back(std::make_pair(visible.size(), task.depth));
+      visible.push_back(KRScene::VisibleOctreeNode{ task.octreeNode, 0 });
+    }
+  }
+  while (!open.empty()) {
+    visible[open.back().first].subtreeEnd = visible.size();
+    open.pop_back();
+  }
+}
+
+// Copies the visible subtree at source[index], visiting children in child_order
+void ReorderVisibleSubtree(const VisibleList& source, size_t index, const int* child_order, VisibleList& visible)
+{
+  const KRScene::VisibleOctreeNode& entry = source[index];
+  size_t children[8];
+  for (int i = 0; i < 8; i++) {
+    children[i] = SIZE_MAX;
+  }
+  for (size_t child = index + 1; child < entry.subtreeEnd; child = source[child].subtreeEnd) {
+    for (int i = 0; i < 8; i++) {
+      if (entry.octreeNode->getChildren()[i] == source[child].octreeNode) {
+        children[i] = child;
+        break;
+      }
+    }
+  }
+
+  size_t visible_index = visible.size();
+  visible.push_back(KRScene::VisibleOctreeNode{ entry.octreeNode, 0 });
+  for (int i = 0; i < 8; i++) {
+    if (children[child_order[i]] != SIZE_MAX) {
+      ReorderVisibleSubtree(source, children[child_order[i]], child_order, visible);
+    }
+  }
+  visible[visible_index].subtreeEnd = visible.size();
+}
+
+} // anonymous namespace
 
 using namespace mimir;
 using namespace hydra;
@@ -48,6 +215,9 @@ using namespace hydra;
 KRScene::KRScene(KRContext& context, std::string name) : KRResource(context, name)
 {
   m_pFirstLight = NULL;
+  if (context.getSpatialIndex() == KR_SPATIAL_INDEX_LINEAR_OCTREE) {
+    m_linearNodeTree = std::make_unique<KRLinearOctree>();
+  }
   m_pRootNode = new KRNode(*this, "scene_root");
   notify_sceneGraphCreate(m_pRootNode);
 }
@@ -110,34 +280,36 @@ void KRScene::render(KRNode::RenderInfo& ri)
     addDefaultLights();
   }
 
-  std::set<KRNode*> outerNodes = std::set<KRNode*>(m_nodeTree.getOuterSceneNodes()); // HACK - Copying the std::set as it is potentially modified as KRNode's update their bounds during the iteration.  This is very expensive and will be eliminated in the future.
-
-  // Get lights from outer nodes (directional lights, which have no bounds)
-  for (std::set<KRNode*>::iterator itr = outerNodes.begin(); itr != outerNodes.end(); itr++) {
-    KRNode* node = (*itr);
-    KRPointLight* point_light = dynamic_cast<KRPointLight*>(node);
-    if (point_light) {
-      ri.point_lights.push_back(point_light);
-    }
-    KRDirectionalLight* directional_light = dynamic_cast<KRDirectionalLight*>(node);
-    if (directional_light) {
-      ri.directional_lights.push_back(directional_light);
-    }
-    KRSpotLight* spot_light = dynamic_cast<KRSpotLight*>(node);
-    if (spot_light) {
-      ri.spot_lights.push_back(spot_light);
+  if (m_linearNodeTree) {
+    renderLinear(ri, resourceRequests);
+    for (KRResourceRequest request : resourceRequests) {
+      request.resource->requestResidency(request.usage, static_cast<float>(request.coverage) / 255.f);
     }
+    return;
   }
 
+  // Nodes may be added or deleted as they are rendered; the traversal keeps the scene node
+  // lists valid for iteration by index until it ends.
+  m_nodeTree.beginTraversal();
+
+  // Get lights from outer nodes (directional lights, which have no bounds)
+  ri.point_lights.insert(ri.point_lights.end(), m_nodeTree.getOuterPointLights().begin(), m_nodeTree.getOuterPointLights().end());
+  ri.directional_lights.insert(ri.directional_lights.end(), m_nodeTree.getOuterDirectionalLights().begin(), m_nodeTree.getOuterDirectionalLights().end());
+  ri.spot_lights.insert(ri.spot_lights.end(), m_nodeTree.getOuterSpotLights().begin(), m_nodeTree.getOuterSpotLights().end());
+
   // Render outer nodes
-  for (std::set<KRNode*>::iterator itr = outerNodes.begin(); itr != outerNodes.end(); itr++) {
-    KRNode* node = (*itr);
+  std::vector<KRNode*>& outerNodes = m_nodeTree.getOuterSceneNodes();
+  for (size_t i = 0; i < outerNodes.size(); i++) {
+    KRNode* node = outerNodes[i];
+    if (node == nullptr) {
+      continue;
+    }
     if (ri.renderPass->getType() == RenderPassType::RENDER_PASS_PRESTREAM) {
-      if ((*itr)->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
+      if (node->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
         node->preStream(*ri.viewport, resourceRequests);
       }
     } else {
-      if ((*itr)->getLODVisibility() > KRNode::LOD_VISIBILITY_PRESTREAM) {
+      if (node->getLODVisibility() > KRNode::LOD_VISIBILITY_PRESTREAM) {
         ri.reflectedObjects.push_back(node);
         node->render(ri);
         ri.reflectedObjects.pop_back();
@@ -151,17 +323,14 @@ void KRScene::render(KRNode::RenderInfo& ri)
     node->preStream(*ri.viewport, resourceRequests);
   }
 
-  std::vector<KROctreeNode*> remainingOctrees;
-  if (m_nodeTree.getRootNode() != NULL) {
-    remainingOctrees.push_back(m_nodeTree.getRootNode());
+  // Keep a reference, as a nested render may replace the cached set
+  std::shared_ptr<VisibleSet> visibleSet = getVisibleSet(*ri.viewport);
+  const std::vector<VisibleOctreeNode>& visible = getVisibleOctreeNodes(*visibleSet, ri);
+  if (!visible.empty()) {
+    render(ri, resourceRequests, visible, 0);
   }
 
-  while ((!remainingOctrees.empty())) {
-    for (std::vector<KROctreeNode*>::iterator octree_itr = remainingOctrees.begin(); octree_itr != remainingOctrees.end(); octree_itr++) {
-      render(ri, resourceRequests, *octree_itr);
-    }
-    remainingOctrees.clear();
-  }
+  m_nodeTree.endTraversal();
 
   // TODO: WIP Refactoring, this will be moved to the streaming system
   for (KRResourceRequest request : resourceRequests) {
@@ -169,83 +338,225 @@ void KRScene::render(KRNode::RenderInfo& ri)
   }
 }
 
-void KRScene::render(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests, KROctreeNode* pOctreeNode)
+std::shared_ptr<KRScene::VisibleSet> KRScene::getVisibleSet(const KRViewport& viewport)
 {
-  if (pOctreeNode) {
+  long frame = getContext().getCurrentFrame();
+  uint64_t revision = getSpatialIndexRevision();
 
-    AABB octreeBounds = pOctreeNode->getBounds();
+  // Culling results are only reused within a frame, while the octree structure is unchanged
+  std::erase_if(m_visibleSets, [frame, revision](const std::shared_ptr<VisibleSet>& visibleSet) {
+    return visibleSet->frame != frame || visibleSet->octreeRevision != revision;
+  });
 
-    bool in_viewport = false;
-    if (ri.renderPass->getType() == RenderPassType::RENDER_PASS_PRESTREAM) {
+  for (const std::shared_ptr<VisibleSet>& visibleSet : m_visibleSets) {
+    if (visibleSet->viewport == &viewport && visibleSet->viewProjectionMatrix == viewport.getViewProjectionMatrix()) {
+      return visibleSet;
+    }
+  }
+
+  std::shared_ptr<VisibleSet> visibleSet = std::make_shared<VisibleSet>();
+  visibleSet->viewport = &viewport;
+  visibleSet->viewProjectionMatrix = viewport.getViewProjectionMatrix();
+  visibleSet->frame = frame;
+  visibleSet->octreeRevision = revision;
+  visibleSet->prestreamValid = false;
+  visibleSet->frontToBackValid = false;
+  visibleSet->backToFrontValid = false;
+  visibleSet->outerNodeCount = 0;
+  m_visibleSets.push_back(visibleSet);
+  return visibleSet;
+}
+
+const std::vector<KRScene::VisibleOctreeNode>& KRScene::getVisibleOctreeNodes(VisibleSet& visibleSet, const KRNode::RenderInfo& ri)
+{
+  const KRViewport& viewport = *ri.viewport;
+  RenderPassType passType = ri.renderPass->getType();
+
+  if (passType == RenderPassType::RENDER_PASS_PRESTREAM) {
+    if (!visibleSet.prestreamValid) {
       // When pre-streaming, objects are streamed in behind and in-front of the camera
-      AABB viewportExtents = AABB::Create(ri.viewport->getCameraPosition() - Vector3::Create(ri.camera->settings.getPerspectiveFarZ()), ri.viewport->getCameraPosition() + Vector3::Create(ri.camera->settings.getPerspectiveFarZ()));
-      in_viewport = octreeBounds.intersects(viewportExtents);
-    } else {
-      in_viewport = ri.viewport->visible(pOctreeNode->getBounds());
-    }
-    if (in_viewport) {
-
-      // Add lights that influence this octree level and its children to the stack
-      int directional_light_count = 0;
-      int spot_light_count = 0;
-      int point_light_count = 0;
-      for (std::set<KRNode*>::iterator itr = pOctreeNode->getSceneNodes().begin(); itr != pOctreeNode->getSceneNodes().end(); itr++) {
-        KRNode* node = (*itr);
-        KRDirectionalLight* directional_light = dynamic_cast<KRDirectionalLight*>(node);
-        if (directional_light) {
-          ri.directional_lights.push_back(directional_light);
-          directional_light_count++;
-        }
-        KRSpotLight* spot_light = dynamic_cast<KRSpotLight*>(node);
-        if (spot_light) {
-          ri.spot_lights.push_back(spot_light);
-          spot_light_count++;
+      AABB viewportExtents = AABB::Create(viewport.getCameraPosition() - Vector3::Create(ri.camera->settings.getPerspectiveFarZ()), viewport.getCameraPosition() + Vector3::Create(ri.camera->settings.getPerspectiveFarZ()));
+      BuildVisibleList(m_nodeTree.getRootNode(), viewport.getFrontToBackOrder(), [&viewportExtents](const AABB* bounds, size_t count, uint8_t* mask) {
+        for (size_t i = 0; i < count; i++) {
+          mask[i] = bounds[i].intersects(viewportExtents) ? 1 : 0;
         }
-        KRPointLight* point_light = dynamic_cast<KRPointLight*>(node);
-        if (point_light) {
-          ri.point_lights.push_back(point_light);
-          point_light_count++;
-        }
-      }
+      }, getContext().getWorkerPool(), visibleSet.prestream);
+      visibleSet.prestreamValid = true;
+    }
+    return visibleSet.prestream;
+  }
 
-      // Render objects that are at this octree level
-      for (std::set<KRNode*>::iterator itr = pOctreeNode->getSceneNodes().begin(); itr != pOctreeNode->getSceneNodes().end(); itr++) {
-        KRNode* node = (*itr);
-        //assert(pOctreeNode->getBounds().contains((*itr)->getBounds()));  // Sanity check
-        if (ri.renderPass->getType() == RenderPassType::RENDER_PASS_PRESTREAM) {
-          if (node->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
-            node->preStream(*ri.viewport, resourceRequests);
-          }
-        } else {
-          if (node->getLODVisibility() > KRNode::LOD_VISIBILITY_PRESTREAM)
-          {
-            ri.reflectedObjects.push_back(*itr);
-            node->render(ri);
-            ri.reflectedObjects.pop_back();
-          }
-        }
+  if (!visibleSet.frontToBackValid) {
+    BuildVisibleList(m_nodeTree.getRootNode(), viewport.getFrontToBackOrder(), [&viewport](const AABB* bounds, size_t count, uint8_t* mask) {
+      viewport.visibleBatch(bounds, count, mask);
+    }, getContext().getWorkerPool(), visibleSet.frontToBack);
+    visibleSet.frontToBackValid = true;
+  }
+
+  if (passType == RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT || passType == RenderPassType::RENDER_PASS_ADDITIVE_PARTICLES || passType == RenderPassType::RENDER_PASS_VOLUMETRIC_EFFECTS_ADDITIVE) {
+    if (!visibleSet.backToFrontValid) {
+      visibleSet.backToFront.clear();
+      if (!visibleSet.frontToBack.empty()) {
+        visibleSet.backToFront.reserve(visibleSet.frontToBack.size());
+        ReorderVisibleSubtree(visibleSet.frontToBack, 0, viewport.getBackToFrontOrder(), visibleSet.backToFront);
       }
+      visibleSet.backToFrontValid = true;
+    }
+    return visibleSet.backToFront;
+  }
 
-      // Render child octrees
-      const int* childOctreeOrder = ri.renderPass->getType() == RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT || ri.renderPass->getType() == RenderPassType::RENDER_PASS_ADDITIVE_PARTICLES || ri.renderPass->getType() == RenderPassType::RENDER_PASS_VOLUMETRIC_EFFECTS_ADDITIVE ? ri.viewport->getBackToFrontOrder() : ri.viewport->getFrontToBackOrder();
+  return visibleSet.frontToBack;
+}
 
-      for (int i = 0; i < 8; i++) {
-        render(ri, resourceRequests, pOctreeNode->getChildren()[childOctreeOrder[i]]);
+void KRScene::renderLinear(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests)
+{
+  // Keep a reference, as a nested render may replace the cached set
+  std::shared_ptr<VisibleSet> visibleSet = getVisibleSet(*ri.viewport);
+  const std::vector<KRNode*>& visible = getVisibleSceneNodes(*visibleSet, ri);
+
+  // Every light that may reach a visible scene node applies to the whole pass
+  ri.point_lights.insert(ri.point_lights.end(), visibleSet->pointLights.begin(), visibleSet->pointLights.end());
+  ri.directional_lights.insert(ri.directional_lights.end(), visibleSet->directionalLights.begin(), visibleSet->directionalLights.end());
+  ri.spot_lights.insert(ri.spot_lights.end(), visibleSet->spotLights.begin(), visibleSet->spotLights.end());
+
+  // Scene nodes deleted while rendering are replaced by nullptr in the visible set
+  m_renderingVisibleSets.push_back(visibleSet);
+  for (size_t i = 0; i < visible.size(); i++) {
+    KRNode* node = visible[i];
+    if (node == nullptr) {
+      continue;
+    }
+    if (ri.renderPass->getType() == RenderPassType::RENDER_PASS_PRESTREAM) {
+      if (node->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
+        node->preStream(*ri.viewport, resourceRequests);
+      }
+    } else {
+      if (node->getLODVisibility() > KRNode::LOD_VISIBILITY_PRESTREAM) {
+        ri.reflectedObjects.push_back(node);
+        node->render(ri);
+        ri.reflectedObjects.pop_back();
       }
+    }
+  }
+  m_renderingVisibleSets.erase(std::find(m_renderingVisibleSets.begin(), m_renderingVisibleSets.end(), visibleSet));
 
-      // Remove lights added at this octree level from the stack
-      while (directional_light_count--) {
-        ri.directional_lights.pop_back();
+  // Stream assets for nodes that request having their assets always streamed in.
+  for (std::set<KRNode*>::iterator itr = m_alwaysStreamedNodes.begin(); itr != m_alwaysStreamedNodes.end(); itr++) {
+    KRNode* node = (*itr);
+    node->preStream(*ri.viewport, resourceRequests);
+  }
+}
+
+const std::vector<KRNode*>& KRScene::getVisibleSceneNodes(VisibleSet& visibleSet, const KRNode::RenderInfo& ri)
+{
+  const KRViewport& viewport = *ri.viewport;
+  RenderPassType passType = ri.renderPass->getType();
+  const std::set<KRNode*>& outerNodes = m_linearNodeTree->getOuterSceneNodes();
+
+  if (passType == RenderPassType::RENDER_PASS_PRESTREAM) {
+    if (!visibleSet.prestreamValid) {
+      // When pre-streaming, objects are streamed in behind and in-front of the camera
+      AABB viewportExtents = AABB::Create(viewport.getCameraPosition() - Vector3::Create(ri.camera->settings.getPerspectiveFarZ()), viewport.getCameraPosition() + Vector3::Create(ri.camera->settings.getPerspectiveFarZ()));
+      visibleSet.prestreamNodes.assign(outerNodes.begin(), outerNodes.end());
+      m_linearNodeTree->findIntersecting(viewportExtents, visibleSet.prestreamNodes);
+      visibleSet.prestreamValid = true;
+    }
+    return visibleSet.prestreamNodes;
+  }
+
+  if (!visibleSet.frontToBackValid) {
+    std::vector<KRNode*>& nodes = visibleSet.frontToBackNodes;
+    nodes.assign(outerNodes.begin(), outerNodes.end());
+    size_t outer_count = nodes.size();
+    m_linearNodeTree->findVisible(viewport, nodes);
+
+    // Outer scene nodes come first, followed by the others in order of distance from the camera
+    std::vector<std::pair<float, KRNode*>> sorted;
+    sorted.reserve(nodes.size() - outer_count);
+    Vector3 camera_position = viewport.getCameraPosition();
+    for (size_t i = outer_count; i < nodes.size(); i++) {
+      sorted.push_back(std::make_pair((nodes[i]->getBounds().center() - camera_position).sqrMagnitude(), nodes[i]));
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<float, KRNode*>& a, const std::pair<float, KRNode*>& b) {
+      return a.first < b.first;
+    });
+    for (size_t i = 0; i < sorted.size(); i++) {
+      nodes[outer_count + i] = sorted[i].second;
+    }
+    visibleSet.outerNodeCount = outer_count;
+
+    visibleSet.pointLights.clear();
+    visibleSet.directionalLights.clear();
+    visibleSet.spotLights.clear();
+    for (KRNode* node : nodes) {
+      if (KRPointLight* point_light = dynamic_cast<KRPointLight*>(node)) {
+        visibleSet.pointLights.push_back(point_light);
+      } else if (KRDirectionalLight* directional_light = dynamic_cast<KRDirectionalLight*>(node)) {
+        visibleSet.directionalLights.push_back(directional_light);
+      } else if (KRSpotLight* spot_light = dynamic_cast<KRSpotLight*>(node)) {
+        visibleSet.spotLights.push_back(spot_light);
       }
-      while (spot_light_count--) {
-        ri.spot_lights.pop_back();
+    }
+    visibleSet.frontToBackValid = true;
+  }
+
+  if (passType == RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT || passType == RenderPassType::RENDER_PASS_ADDITIVE_PARTICLES || passType == RenderPassType::RENDER_PASS_VOLUMETRIC_EFFECTS_ADDITIVE) {
+    if (!visibleSet.backToFrontValid) {
+      const std::vector<KRNode*>& frontToBack = visibleSet.frontToBackNodes;
+      size_t outer_count = visibleSet.outerNodeCount;
+      visibleSet.backToFrontNodes.assign(frontToBack.begin(), frontToBack.begin() + outer_count);
+      visibleSet.backToFrontNodes.insert(visibleSet.backToFrontNodes.end(), frontToBack.rbegin(), frontToBack.rend() - outer_count);
+      visibleSet.backToFrontValid = true;
+    }
+    return visibleSet.backToFrontNodes;
+  }
+
+  return visibleSet.frontToBackNodes;
+}
+
+void KRScene::render(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests, const std::vector<VisibleOctreeNode>& visible, size_t index)
+{
+  KROctreeNode* pOctreeNode = visible[index].octreeNode;
+
+  // Add lights that influence this octree level and its children to the stack
+  size_t directional_light_count = pOctreeNode->getDirectionalLights().size();
+  size_t spot_light_count = pOctreeNode->getSpotLights().size();
+  size_t point_light_count = pOctreeNode->getPointLights().size();
+  ri.directional_lights.insert(ri.directional_lights.end(), pOctreeNode->getDirectionalLights().begin(), pOctreeNode->getDirectionalLights().end());
+  ri.spot_lights.insert(ri.spot_lights.end(), pOctreeNode->getSpotLights().begin(), pOctreeNode->getSpotLights().end());
+  ri.point_lights.insert(ri.point_lights.end(), pOctreeNode->getPointLights().begin(), pOctreeNode->getPointLights().end());
+
+  // Render objects that are at this octree level
+  std::vector<KRNode*>& sceneNodes = pOctreeNode->getSceneNodes();
+  for (size_t i = 0; i < sceneNodes.size(); i++) {
+    KRNode* node = sceneNodes[i];
+    if (node == nullptr) {
+      continue;
+    }
+    //assert(pOctreeNode->getBounds().contains(node->getBounds()));  // Sanity check
+    if (ri.renderPass->getType() == RenderPassType::RENDER_PASS_PRESTREAM) {
+      if (node->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
+        node->preStream(*ri.viewport, resourceRequests);
       }
-      while (point_light_count--) {
-        ri.point_lights.pop_back();
+    } else {
+      if (node->getLODVisibility() > KRNode::LOD_VISIBILITY_PRESTREAM)
+      {
+        ri.reflectedObjects.push_back(node);
+        node->render(ri);
+        ri.reflectedObjects.pop_back();
       }
     }
+  }
 
+  // Render child octrees, which were culled and ordered for this pass
+  for (size_t child = index + 1; child < visible[index].subtreeEnd; child = visible[child].subtreeEnd) {
+    render(ri, resourceRequests, visible, child);
   }
+
+  // Remove lights added at this octree level from the stack
+  ri.directional_lights.resize(ri.directional_lights.size() - directional_light_count);
+  ri.spot_lights.resize(ri.spot_lights.size() - spot_light_count);
+  ri.point_lights.resize(ri.point_lights.size() - point_light_count);
 }
 
 std::string KRScene::getExtension()
@@ -278,6 +589,11 @@ KRScene* KRScene::Load(KRContext& context, const std::string& name, Block* data)
   delete data;
   tinyxml2::XMLDocument doc;
   doc.Parse(xml_string.c_str());
+  return Load(context, name, doc);
+}
+
+KRScene* KRScene::Load(KRContext& context, const std::string& name, tinyxml2::XMLDocument& doc)
+{
   KRScene* new_scene = new KRScene(context, name);
 
   tinyxml2::XMLElement* scene_element = doc.RootElement();
@@ -310,6 +626,113 @@ void KRScene::notify_sceneGraphCreate(KRNode* pNode)
   m_newNodes.insert(pNode);
 }
 
+void KRScene::notify_sceneGraphRename(KRNode* pNode, const std::string& previousName)
+{
+  auto itr = m_nodesByName.find(previousName);
+  if (itr != m_nodesByName.end()) {
+    std::erase(itr->second, pNode);
+    if (itr->second.empty()) {
+      m_nodesByName.erase(itr);
+    }
+  }
+  m_nodesByName[pNode->getName()].push_back(pNode);
+}
+
+void KRScene::indexNode(KRNode* pNode)
+{
+  m_nodesByName[pNode->getName()].push_back(pNode);
+  m_unclassifiedNodes.insert(pNode);
+}
+
+void KRScene::unindexNode(KRNode* pNode)
+{
+  auto itr = m_nodesByName.find(pNode->getName());
+  if (itr != m_nodesByName.end()) {
+    std::erase(itr->second, pNode);
+    if (itr->second.empty()) {
+      m_nodesByName.erase(itr);
+    }
+  }
+
+  if (!m_unclassifiedNodes.erase(pNode)) {
+    auto type = m_nodeTypes.find(pNode);
+    if (type != m_nodeTypes.end()) {
+      auto bucket = m_nodesByType.find(type->second);
+      bucket->second.erase(pNode);
+      if (bucket->second.empty()) {
+        m_nodesByType.erase(bucket);
+      }
+      m_nodeTypes.erase(type);
+    }
+  }
+}
+
+const std::vector<KRNode*>& KRScene::getNodesByName(const std::string& name)
+{
+  static const std::vector<KRNode*> empty;
+  auto itr = m_nodesByName.find(name);
+  if (itr == m_nodesByName.end()) {
+    return empty;
+  }
+  return itr->second;
+}
+
+const KRNodeTypeIndex& KRScene::getNodesByType()
+{
+  classifyNodes();
+  return m_nodesByType;
+}
+
+void KRScene::classifyNodes()
+{
+  for (KRNode* node : m_unclassifiedNodes) {
+    std::type_index type(typeid(*node));
+    m_nodesByType[type].insert(node);
+    m_nodeTypes.emplace(node, type);
+  }
+  m_unclassifiedNodes.clear();
+}
+
+void KRScene::addToSpatialIndex(KRNode* pNode)
+{
+  if (m_linearNodeTree) {
+    m_linearNodeTree->add(pNode);
+  } else {
+    m_nodeTree.add(pNode);
+  }
+}
+
+void KRScene::removeFromSpatialIndex(KRNode* pNode)
+{
+  if (m_linearNodeTree) {
+    m_linearNodeTree->remove(pNode);
+    for (const std::shared_ptr<VisibleSet>& visibleSet : m_renderingVisibleSets) {
+      std::replace(visibleSet->prestreamNodes.begin(), visibleSet->prestreamNodes.end(), pNode, (KRNode*)nullptr);
+      std::replace(visibleSet->frontToBackNodes.begin(), visibleSet->frontToBackNodes.end(), pNode, (KRNode*)nullptr);
+      std::replace(visibleSet->backToFrontNodes.begin(), visibleSet->backToFrontNodes.end(), pNode, (KRNode*)nullptr);
+    }
+  } else {
+    m_nodeTree.remove(pNode);
+  }
+}
+
+void KRScene::updateSpatialIndex(KRNode* pNode)
+{
+  if (m_linearNodeTree) {
+    m_linearNodeTree->update(pNode);
+  } else {
+    m_nodeTree.update(pNode);
+  }
+}
+
+uint64_t KRScene::getSpatialIndexRevision() const
+{
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->getRevision();
+  }
+  return m_nodeTree.getRevision();
+}
+
 void KRScene::notify_sceneGraphModify(KRNode* pNode)
 {
   //    m_nodeTree.update(pNode);
@@ -318,7 +741,7 @@ void KRScene::notify_sceneGraphModify(KRNode* pNode)
 
 void KRScene::notify_sceneGraphDelete(KRNode* pNode)
 {
-  m_nodeTree.remove(pNode);
+  removeFromSpatialIndex(pNode);
   m_physicsNodes.erase(pNode);
   if (pNode->alwaysStreamResources()) {
     m_alwaysStreamedNodes.erase(pNode);
@@ -341,7 +764,7 @@ void KRScene::notify_sceneGraphDelete(KRNode* pNode)
   }
   m_modifiedNodes.erase(pNode);
   if (!m_newNodes.erase(pNode)) {
-    m_nodeTree.remove(pNode);
+    removeFromSpatialIndex(pNode);
   }
 }
 
@@ -357,7 +780,7 @@ void KRScene::updateOctree(const KRViewport& viewport)
 
   for (std::set<KRNode*>::iterator itr = newNodes.begin(); itr != newNodes.end(); itr++) {
     KRNode* node = *itr;
-    m_nodeTree.add(node);
+    addToSpatialIndex(node);
     if (node->hasPhysics()) {
       m_physicsNodes.insert(node);
     }
@@ -384,7 +807,7 @@ void KRScene::updateOctree(const KRViewport& viewport)
   for (std::set<KRNode*>::iterator itr = modifiedNodes.begin(); itr != modifiedNodes.end(); itr++) {
     KRNode* node = *itr;
     if (node->getLODVisibility() >= KRNode::LOD_VISIBILITY_PRESTREAM) {
-      m_nodeTree.update(node);
+      updateSpatialIndex(node);
     }
     if (node->hasPhysics()) {
       m_physicsNodes.insert(node);
@@ -406,7 +829,7 @@ void KRScene::buildOctreeForTheFirstTime()
   m_newNodes.clear();
   for (std::set<KRNode*>::iterator itr = newNodes.begin(); itr != newNodes.end(); itr++) {
     KRNode* node = *itr;
-    m_nodeTree.add(node);
+    addToSpatialIndex(node);
     if (node->hasPhysics()) {
       m_physicsNodes.insert(node);
     }
@@ -446,6 +869,13 @@ void KRScene::addDefaultLights()
 
 AABB KRScene::getRootOctreeBounds()
 {
+  if (m_linearNodeTree) {
+    AABB bounds = m_linearNodeTree->getBounds();
+    if (bounds == AABB::Zero()) {
+      return AABB::Create(-Vector3::One(), Vector3::One());
+    }
+    return bounds;
+  }
   if (m_nodeTree.getRootNode()) {
     return m_nodeTree.getRootNode()->getBounds();
   } else {
@@ -456,19 +886,52 @@ AABB KRScene::getRootOctreeBounds()
 
 bool KRScene::lineCast(const Vector3& v0, const Vector3& v1, HitInfo& hitinfo, unsigned int layer_mask)
 {
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->lineCast(v0, v1, hitinfo, layer_mask);
+  }
   return m_nodeTree.lineCast(v0, v1, hitinfo, layer_mask);
 }
 
 bool KRScene::rayCast(const Vector3& v0, const Vector3& dir, HitInfo& hitinfo, unsigned int layer_mask)
 {
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->rayCast(v0, dir, hitinfo, layer_mask);
+  }
   return m_nodeTree.rayCast(v0, dir, hitinfo, layer_mask);
 }
 
 bool KRScene::sphereCast(const Vector3& v0, const Vector3& v1, float radius, HitInfo& hitinfo, unsigned int layer_mask)
 {
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->sphereCast(v0, v1, radius, hitinfo, layer_mask);
+  }
   return m_nodeTree.sphereCast(v0, v1, radius, hitinfo, layer_mask);
 }
 
+size_t KRScene::lineCastBatch(std::span<const KROctree::Line> lines, std::span<HitInfo> hitinfo, unsigned int layer_mask)
+{
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->lineCastBatch(lines, hitinfo, layer_mask, getContext().getWorkerPool());
+  }
+  return m_nodeTree.lineCastBatch(lines, hitinfo, layer_mask, getContext().getWorkerPool());
+}
+
+size_t KRScene::rayCastBatch(std::span<const KROctree::Ray> rays, std::span<HitInfo> hitinfo, unsigned int layer_mask)
+{
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->rayCastBatch(rays, hitinfo, layer_mask, getContext().getWorkerPool());
+  }
+  return m_nodeTree.rayCastBatch(rays, hitinfo, layer_mask, getContext().getWorkerPool());
+}
+
+size_t KRScene::sphereCastBatch(std::span<const KROctree::SweptSphere> spheres, std::span<HitInfo> hitinfo, unsigned int layer_mask)
+{
+  if (m_linearNodeTree) {
+    return m_linearNodeTree->sphereCastBatch(spheres, hitinfo, layer_mask, getContext().getWorkerPool());
+  }
+  return m_nodeTree.sphereCastBatch(spheres, hitinfo, layer_mask, getContext().getWorkerPool());
+}
+
 
 kraken_stream_level KRScene::getStreamLevel()
 {
@@ -42,8 +42,16 @@
 #include "nodes/KRAmbientZone.h"
 #include "nodes/KRReverbZone.h"
 #include "KROctree.h"
+#include "KRLinearOctree.h"
+
+#include <typeindex>
+#include <unordered_set>
+
 class KRModel;
 class KRLight;
+class KRPointLight;
+class KRDirectionalLight;
+class KRSpotLight;
 class KRSurface;
 class KRRenderGraph;
 
@@ -61,6 +69,7 @@ public:
   virtual bool save(mimir::Block& data);
 
   static KRScene* Load(KRContext& context, const std::string& name, mimir::Block* data);
+  static KRScene* Load(KRContext& context, const std::string& name, tinyxml2::XMLDocument& doc);
 
   KRNode* getRootNode();
   KRLight* getFirstLight();
@@ -71,6 +80,11 @@ public:
   bool rayCast(const hydra::Vector3& v0, const hydra::Vector3& dir, hydra::HitInfo& hitinfo, unsigned int layer_mask);
   bool sphereCast(const hydra::Vector3& v0, const hydra::Vector3& v1, float radius, hydra::HitInfo& hitinfo, unsigned int layer_mask);
 
+  // Batched casts, spread over the context's worker pool.  Results match the single casts above.
+  size_t lineCastBatch(std::span<const KROctree::Line> lines, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask);
+  size_t rayCastBatch(std::span<const KROctree::Ray> rays, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask);
+  size_t sphereCastBatch(std::span<const KROctree::SweptSphere> spheres, std::span<hydra::HitInfo> hitinfo, unsigned int layer_mask);
+
   void renderFrame(VkCommandBuffer& commandBuffer, KRSurface& surface, KRRenderGraph& renderGraph, float deltaTime);
   void render(KRNode::RenderInfo& ri);
 
@@ -80,6 +94,14 @@ public:
   void notify_sceneGraphCreate(KRNode* pNode);
   void notify_sceneGraphDelete(KRNode* pNode);
   void notify_sceneGraphModify(KRNode* pNode);
+  void notify_sceneGraphRename(KRNode* pNode, const std::string& previousName);
+
+  // Every node constructed for this scene is indexed by name and type until it is destroyed,
+  // including nodes that are hidden or not yet attached to the scene graph
+  void indexNode(KRNode* pNode);
+  void unindexNode(KRNode* pNode);
+  const std::vector<KRNode*>& getNodesByName(const std::string& name);
+  const KRNodeTypeIndex& getNodesByType();
 
   void physicsUpdate(float deltaTime);
   void addDefaultLights();
@@ -91,8 +113,55 @@ public:
   std::set<KRLocator*>& getLocators();
   std::set<KRLight*>& getLights();
 
+  // An octree node that passed culling, listed in depth-first order.  Its visible
+  // descendants follow it, up to subtreeEnd.
+  struct VisibleOctreeNode
+  {
+    KROctreeNode* octreeNode;
+    size_t subtreeEnd;
+  };
+
 private:
-  void render(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests, KROctreeNode* pOctreeNodey);
+  // Culling results for one viewport, shared by all render passes within a frame
+  struct VisibleSet
+  {
+    const KRViewport* viewport;
+    hydra::Matrix4 viewProjectionMatrix;
+    long frame;
+    uint64_t octreeRevision;
+
+    bool prestreamValid;
+    bool frontToBackValid;
+    bool backToFrontValid;
+    std::vector<VisibleOctreeNode> prestream;
+    std::vector<VisibleOctreeNode> frontToBack;
+    std::vector<VisibleOctreeNode> backToFront;
+
+    // With KR_SPATIAL_INDEX_LINEAR_OCTREE, scene nodes are listed directly.  Deleted scene
+    // nodes are replaced by nullptr.  The lights include the outer lights.
+    std::vector<KRNode*> prestreamNodes;
+    std::vector<KRNode*> frontToBackNodes;
+    std::vector<KRNode*> backToFrontNodes;
+    size_t outerNodeCount; // Outer scene nodes lead frontToBackNodes and backToFrontNodes
+    std::vector<KRPointLight*> pointLights;
+    std::vector<KRDirectionalLight*> directionalLights;
+    std::vector<KRSpotLight*> spotLights;
+  };
+
+  std::vector<std::shared_ptr<VisibleSet>> m_visibleSets;
+  // Sets being rendered with the linear octree, which may no longer be in m_visibleSets
+  std::vector<std::shared_ptr<VisibleSet>> m_renderingVisibleSets;
+
+  std::shared_ptr<VisibleSet> getVisibleSet(const KRViewport& viewport);
+  const std::vector<VisibleOctreeNode>& getVisibleOctreeNodes(VisibleSet& visibleSet, const KRNode::RenderInfo& ri);
+  void render(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests, const std::vector<VisibleOctreeNode>& visible, size_t index);
+  const std::vector<KRNode*>& getVisibleSceneNodes(VisibleSet& visibleSet, const KRNode::RenderInfo& ri);
+  void renderLinear(KRNode::RenderInfo& ri, std::list<KRResourceRequest>& resourceRequests);
+
+  void addToSpatialIndex(KRNode* pNode);
+  void removeFromSpatialIndex(KRNode* pNode);
+  void updateSpatialIndex(KRNode* pNode);
+  uint64_t getSpatialIndexRevision() const;
 
 
   KRNode* m_pRootNode;
@@ -111,6 +180,18 @@ private:
   std::set<KRNode*> m_alwaysStreamedNodes;
 
   KROctree m_nodeTree;
+  // Replaces m_nodeTree when the context uses KR_SPATIAL_INDEX_LINEAR_OCTREE
+  std::unique_ptr<KRLinearOctree> m_linearNodeTree;
+
+  std::unordered_map<std::string, std::vector<KRNode*>> m_nodesByName;
+  KRNodeTypeIndex m_nodesByType;
+  // Nodes are classified by type lazily, as their dynamic type is incomplete while constructing
+  std::unordered_set<KRNode*> m_unclassifiedNodes;
+  // The bucket of each classified node, as its dynamic type is gone by the time its
+  // destructor unindexes it
+  std::unordered_map<KRNode*, std::type_index> m_nodeTypes;
+
+  void classifyNodes();
 
 public:
 
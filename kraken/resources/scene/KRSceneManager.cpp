@@ -73,6 +73,18 @@ KRScene* KRSceneManager::loadScene(const std::string& name, Block* data)
   return pScene;
 }
 
+KRScene* KRSceneManager::loadScene(const std::string& name, tinyxml2::XMLDocument& doc)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::string lowerName = name;
+  std::transform(lowerName.begin(), lowerName.end(),
+                 lowerName.begin(), ::tolower);
+
+  KRScene* pScene = KRScene::Load(*m_pContext, name, doc);
+  m_scenes[lowerName] = pScene;
+  return pScene;
+}
+
 
 KRScene* KRSceneManager::createScene(const std::string& name)
 {
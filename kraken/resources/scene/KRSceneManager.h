@@ -52,6 +52,7 @@ public:
 
   void add(KRScene* scene);
   KRScene* loadScene(const std::string& name, mimir::Block* data);
+  KRScene* loadScene(const std::string& name, tinyxml2::XMLDocument& doc);
 
   KRScene* getScene(const std::string& name);
   KRScene* getFirstScene();
@@ -227,6 +227,11 @@ int KRTexture::getLodCount() const
   return m_lod_count;
 }
 
+int KRTexture::getLayerCount() const
+{
+  return 1;
+}
+
 int KRTexture::getCurrentLodMaxDim()
 {
   if (m_current_lod == -1) {
@@ -296,16 +301,19 @@ bool KRTexture::allocate(KRDevice& device, int target_lod, VkImageCreateFlags im
 {
   int min_mip = std::min(target_lod, m_lod_count - 1);
   int mip_count = m_lod_count - min_mip;
-  hydra::Vector3i dimensions = getDimensions() / (1 << target_lod);
+  hydra::Vector3i dimensions = getDimensions();
+  dimensions.x = std::max(1, dimensions.x >> min_mip);
+  dimensions.y = std::max(1, dimensions.y >> min_mip);
+  dimensions.z = std::max(1, dimensions.z >> min_mip);
 
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.imageType = getDimensions().z > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
   imageInfo.extent.width = static_cast<uint32_t>(dimensions.x);
   imageInfo.extent.height = static_cast<uint32_t>(dimensions.y);
   imageInfo.extent.depth = static_cast<uint32_t>(dimensions.z);
   imageInfo.mipLevels = mip_count;
-  imageInfo.arrayLayers = 1;
+  imageInfo.arrayLayers = getFaceCount() * getLayerCount();
   imageInfo.format = getFormat();
   imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
   imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -101,6 +101,7 @@ public:
   int getMaxMipMap();
   bool hasMipmaps();
   virtual int getFaceCount() const = 0;
+  virtual int getLayerCount() const;
   virtual VkFormat getFormat() const = 0;
   virtual hydra::Vector3i getDimensions() const = 0;
   int getLodCount() const;
@@ -53,13 +53,9 @@ bool KRTexture2D::createGPUTexture(int targetLod)
   }
 
   Vector3i dimensions = getDimensions();
+  int faceCount = getFaceCount();
+  int layerCount = faceCount * getLayerCount();
   size_t bufferSize = getMemRequiredForLodRange(targetLod);
-  void* buffer = malloc(bufferSize);
-
-  if (!getLodData(buffer, targetLod)) {
-    free(buffer);
-    return false;
-  }
 
   bool success = true;
   m_new_lod = -1;
@@ -75,7 +71,7 @@ bool KRTexture2D::createGPUTexture(int targetLod)
     texture.allocation = VK_NULL_HANDLE;
     texture.image = VK_NULL_HANDLE;
 
-    if (!allocate(device, targetLod, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &texture.image, &texture.allocation
+    if (!allocate(device, targetLod, faceCount == 6 ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &texture.image, &texture.allocation
 #if KRENGINE_DEBUG_GPU_LABELS
       , getName().c_str()
 #endif
@@ -90,13 +86,19 @@ bool KRTexture2D::createGPUTexture(int targetLod)
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = texture.image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    if (dimensions.z > 1) {
+      viewInfo.viewType = VK_IMAGE_VIEW_TYPE_3D;
+    } else if (faceCount == 6) {
+      viewInfo.viewType = layerCount > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+    } else {
+      viewInfo.viewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+    }
     viewInfo.format = getFormat();
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = mip_count;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = layerCount;
     VkResult res = vkCreateImageView(device.m_logicalDevice, &viewInfo, nullptr, &texture.fullImageView);
     if (res != VK_SUCCESS) {
       success = false;
@@ -107,7 +109,7 @@ bool KRTexture2D::createGPUTexture(int targetLod)
 	  regions.resize(mip_count, VkBufferImageCopy{});
     int bufferOffset = 0;
     for (int mip = min_mip; mip < min_mip + mip_count; mip++) {
-        VkBufferImageCopy& region = regions[mip];
+        VkBufferImageCopy& region = regions[mip - min_mip];
         region.bufferOffset = bufferOffset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
@@ -115,23 +117,28 @@ bool KRTexture2D::createGPUTexture(int targetLod)
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         region.imageSubresource.mipLevel = mip - min_mip;
         region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
+        region.imageSubresource.layerCount = layerCount;
 
         region.imageOffset = { 0, 0, 0 };
         region.imageExtent = {
-            (unsigned int)dimensions.x,
-            (unsigned int)dimensions.y,
-            (unsigned int)dimensions.z
+            (unsigned int)std::max(1, dimensions.x >> mip),
+            (unsigned int)std::max(1, dimensions.y >> mip),
+            (unsigned int)std::max(1, dimensions.z >> mip)
         };
 
 		    bufferOffset += getMemRequiredForLod(mip);
     }
 
-    device.streamUpload((void*)buffer, bufferSize, texture.image, regions.data(), regions.size());
+    // Decode directly into staging memory.  This is repeated for each device.
+    size_t stagingOffset = 0;
+    void* staging = device.streamReserve(bufferSize, &stagingOffset);
+    if (!getLodData(staging, targetLod)) {
+      success = false;
+      break;
+    }
+    device.streamCopy(stagingOffset, texture.image, regions.data(), (int)regions.size());
   }
 
-  free(buffer);
-
   if (success) {
     m_new_lod = targetLod;
     m_haveNewHandles = true;
@@ -90,13 +90,7 @@ bool KRTextureCube::createGPUTexture(int lod)
     return false;
   }
 
-  size_t bufferSizes[6] = {};
-  void* buffers[6] = {};
-  for (int i = 0; i < 6; i++) {
-      bufferSizes[i] = getMemRequiredForLodRange(lod);
-      buffers[i] = malloc(bufferSizes[i]);
-	  m_textures[i]->getLodData(buffers[i], lod);
-  }
+  size_t bufferSize = getMemRequiredForLodRange(lod);
 
   KRDeviceManager* deviceManager = getContext().getDeviceManager();
 
@@ -139,7 +133,10 @@ bool KRTextureCube::createGPUTexture(int lod)
           };
 
           // TODO - Vulkan refactoring.  We need to create a cube map texture rather than individual 2d textures.
-          device.streamUpload(buffers[i], bufferSizes[i], texture.image, &region, 1);
+          size_t stagingOffset = 0;
+          void* staging = device.streamReserve(bufferSize, &stagingOffset);
+          m_textures[i]->getLodData(staging, lod);
+          device.streamCopy(stagingOffset, texture.image, &region, 1);
       }
     }
   }
@@ -150,13 +147,6 @@ bool KRTextureCube::createGPUTexture(int lod)
     m_new_lod = target_lod;
   }
 
-  for (int i = 0; i < 6; i++) {
-    if (buffers[i]) {
-      free(buffers[i]);
-      buffers[i] = nullptr;
-    }
-  }
-
   return success;
 }
 
@@ -31,6 +31,9 @@
 
 #include "KRTextureKTX2.h"
 #include "KRTextureManager.h"
+#include "KRContext.h"
+#include "KRInflate.h"
+#include "KRZstdDecoder.h"
 
 #include "KREngine-common.h"
 
@@ -47,27 +50,19 @@ KRTextureKTX2::KRTextureKTX2(KRContext& context, Block* data, std::string name)
   if (memcmp(_KTX2FileIdentifier, m_header.identifier, 12) != 0) {
     assert(false); // Header not recognized
   }
-  if (m_header.pixelDepth != 0) {
-    assert(false); // 3d textures not (yet) supported
-  }
-  if (m_header.layerCount != 0) {
-    assert(false); // Array textures not (yet) supported
+  if (m_header.pixelDepth > 1 && (m_header.layerCount > 1 || m_header.faceCount != 1)) {
+    assert(false); // 3d textures can not be arrays or cube maps
   }
   if (m_header.faceCount != 1 && m_header.faceCount != 6) {
     assert(false);
   }
-  if (m_header.supercompressionScheme != 0) {
-    assert(false); // Not yet supported
+  if (m_header.supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE &&
+    m_header.supercompressionScheme != KTX2_SUPERCOMPRESSION_ZSTD &&
+    m_header.supercompressionScheme != KTX2_SUPERCOMPRESSION_ZLIB) {
+    // BasisLZ requires transcoding, which is not supported
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "KTX2 texture %s uses unsupported supercompression scheme %i", name.c_str(), m_header.supercompressionScheme);
   }
 
-  uint32_t width = m_header.pixelWidth >> m_header.levelCount;
-  uint32_t height = m_header.pixelHeight >> m_header.levelCount;
-  if (width < 1) {
-    width = 1;
-  }
-  if (height < 1) {
-    height = 1;
-  }
   m_lod_count = (int)std::max(m_header.levelCount, (__uint32_t)1);
 }
 
@@ -77,7 +72,8 @@ KRTextureKTX2::~KRTextureKTX2()
 
 Vector3i KRTextureKTX2::getDimensions() const
 {
-  return Vector3i::Create(Vector3i::Create(m_header.pixelWidth, m_header.pixelHeight, m_header.pixelDepth));
+  // Depth and height are zero for 2d and 1d textures
+  return Vector3i::Create(m_header.pixelWidth, std::max(m_header.pixelHeight, (__uint32_t)1), std::max(m_header.pixelDepth, (__uint32_t)1));
 }
 
 long KRTextureKTX2::getMemRequiredForLod(int lod)
@@ -87,7 +83,7 @@ long KRTextureKTX2::getMemRequiredForLod(int lod)
   KTX2LevelIndex levelIndex;
   m_pData->copy(&levelIndex, sizeof(m_header) + sizeof(KTX2LevelIndex) * target_lod, sizeof(KTX2LevelIndex));
 
-  return (long)levelIndex.byteLength;
+  return (long)levelIndex.uncompressedByteLength;
 }
 
 bool KRTextureKTX2::getLodData(void* buffer, int lod)
@@ -95,13 +91,60 @@ bool KRTextureKTX2::getLodData(void* buffer, int lod)
   unsigned char* converted_image = (unsigned char*)buffer;
   int target_lod = std::min(lod, m_lod_count - 1);
 
-  KTX2LevelIndex levelIndex;
-  m_pData->copy(&levelIndex, sizeof(m_header) + sizeof(KTX2LevelIndex) * target_lod, sizeof(KTX2LevelIndex));
-
-  // TODO - Implement copy of buffer data
-  assert(false);
+  // Levels are decompressed directly into the buffer, from target_lod down to the
+  // smallest, so only the levels being streamed in are read
+  bool success = true;
+  bool locked = false;
+  std::unique_ptr<KRZstdDecoder> decoder;
+  for (int level = target_lod; level < m_lod_count && success; level++) {
+    KTX2LevelIndex levelIndex;
+    m_pData->copy(&levelIndex, sizeof(m_header) + sizeof(KTX2LevelIndex) * level, sizeof(KTX2LevelIndex));
+    if (levelIndex.byteOffset + levelIndex.byteLength > m_pData->getSize()) {
+      success = false;
+      break;
+    }
+
+    switch (m_header.supercompressionScheme) {
+    case KTX2_SUPERCOMPRESSION_NONE:
+      m_pData->copy(converted_image, (int)levelIndex.byteOffset, (int)levelIndex.byteLength);
+      break;
+    case KTX2_SUPERCOMPRESSION_ZSTD:
+    {
+      if (!locked) {
+        m_pData->lock();
+        locked = true;
+      }
+      const uint8_t* compressed = (const uint8_t*)m_pData->getStart() + levelIndex.byteOffset;
+      size_t decompressedLength = 0;
+      if (!decoder) {
+        decoder = std::make_unique<KRZstdDecoder>();
+      }
+      success = decoder->decompress(compressed, levelIndex.byteLength, converted_image, levelIndex.uncompressedByteLength, &decompressedLength)
+        && decompressedLength == levelIndex.uncompressedByteLength;
+      break;
+    }
+    case KTX2_SUPERCOMPRESSION_ZLIB:
+    {
+      if (!locked) {
+        m_pData->lock();
+        locked = true;
+      }
+      KRInflate inflate;
+      inflate.addInput((const uint8_t*)m_pData->getStart() + levelIndex.byteOffset, levelIndex.byteLength);
+      success = inflate.read(converted_image, levelIndex.uncompressedByteLength) == levelIndex.uncompressedByteLength;
+      break;
+    }
+    default:
+      success = false;
+      break;
+    }
+    converted_image += levelIndex.uncompressedByteLength;
+  }
+  if (locked) {
+    m_pData->unlock();
+  }
 
-  return true;
+  return success;
 }
 
 std::string KRTextureKTX2::getExtension()
@@ -118,6 +161,12 @@ int KRTextureKTX2::getFaceCount() const
 
 VkFormat KRTextureKTX2::getFormat() const
 {
-  // TODO - Implement
-  return VK_FORMAT_UNDEFINED;
+  // Formats that require transcoding, such as UASTC, have a vkFormat of VK_FORMAT_UNDEFINED
+  return (VkFormat)m_header.vkFormat;
+}
+
+int KRTextureKTX2::getLayerCount() const
+{
+  // Zero for textures that are not arrays
+  return (int)std::max(m_header.layerCount, (__uint32_t)1);
 }
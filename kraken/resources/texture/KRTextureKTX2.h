@@ -45,9 +45,17 @@ public:
   virtual long getMemRequiredForLod(int lod) override;
   virtual hydra::Vector3i getDimensions() const override;
   virtual int getFaceCount() const override;
+  virtual int getLayerCount() const override;
   virtual VkFormat getFormat() const override;
 
 protected:
+  enum
+  {
+    KTX2_SUPERCOMPRESSION_NONE = 0,
+    KTX2_SUPERCOMPRESSION_BASISLZ = 1,
+    KTX2_SUPERCOMPRESSION_ZSTD = 2,
+    KTX2_SUPERCOMPRESSION_ZLIB = 3
+  };
 
   typedef struct
   {
@@ -66,9 +74,10 @@ protected:
     __uint32_t dfdByteLength;
     __uint32_t kvdByteOffset;
     __uint32_t kvdByteLength;
-    __uint32_t sgdByteOffset;
-    __uint32_t sgdByteLength;
+    __uint64_t sgdByteOffset;
+    __uint64_t sgdByteLength;
   } KTX2Header;
+  static_assert(sizeof(KTX2Header) == 80, "The level index follows the 80 byte KTX2 header");
 
   typedef struct
   {
@@ -48,6 +48,7 @@ KRTextureManager::KRTextureManager(KRContext& context) : KRResourceManager(conte
 
   m_memoryTransferredThisFrame = 0;
   m_streamerComplete = true;
+  m_streamerPending = false;
 }
 
 void KRTextureManager::destroy()
@@ -100,10 +101,6 @@ KRTexture* KRTextureManager::loadTexture(const char* szName, const char* szExten
 {
   KRTexture* pTexture = NULL;
 
-  std::string lowerName = szName;
-  std::transform(lowerName.begin(), lowerName.end(),
-                 lowerName.begin(), ::tolower);
-
   std::string lowerExtension = szExtension;
   std::transform(lowerExtension.begin(), lowerExtension.end(),
                  lowerExtension.begin(), ::tolower);
@@ -121,11 +118,20 @@ KRTexture* KRTextureManager::loadTexture(const char* szName, const char* szExten
   }
 
   if (pTexture) {
-    m_textures[lowerName] = pTexture;
+    addTexture(pTexture);
   }
   return pTexture;
 }
 
+void KRTextureManager::addTexture(KRTexture* texture)
+{
+  std::string lowerName = texture->getName();
+  std::transform(lowerName.begin(), lowerName.end(),
+                 lowerName.begin(), ::tolower);
+
+  m_textures[lowerName] = texture;
+}
+
 KRTexture* KRTextureManager::getTextureCube(const char* szName)
 {
   std::string lowerName = szName;
@@ -174,6 +180,9 @@ KRTexture* KRTextureManager::getTexture(const std::string& name)
                  lowerName.begin(), ::tolower);
 
   unordered_map<std::string, KRTexture*>::iterator itr = m_textures.find(lowerName);
+  if (itr == m_textures.end() && loadDeferredResources(lowerName)) {
+    itr = m_textures.find(lowerName);
+  }
   if (itr == m_textures.end()) {
     if (lowerName.length() <= 8) {
       return NULL;
@@ -266,12 +275,20 @@ void KRTextureManager::doStreaming(long& memoryRemaining, long& memoryRemainingT
 
   if (m_activeTextures_streamer.size() > 0) {
     balanceTextureMemory(memoryRemaining, memoryRemainingThisFrame);
+    m_streamerPending = true;
+  } else {
+    memoryRemaining -= getMemUsed();
+  }
+}
+
+void KRTextureManager::finishStreaming()
+{
+  if (m_streamerPending) {
+    m_streamerPending = false;
 
     m_streamerFenceMutex.lock();
     m_streamerComplete = true;
     m_streamerFenceMutex.unlock();
-  } else {
-    memoryRemaining -= getMemUsed();
   }
 }
 
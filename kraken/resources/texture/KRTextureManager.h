@@ -55,6 +55,7 @@ public:
   bool selectTexture(unsigned int target, int iTextureUnit, int iTextureHandle);
 
   KRTexture* loadTexture(const char* szName, const char* szExtension, mimir::Block* data);
+  void addTexture(KRTexture* texture);
   KRTexture* getTextureCube(const char* szName);
   KRTexture* getTexture(const std::string& name);
 
@@ -78,6 +79,8 @@ public:
   void setMaxAnisotropy(float max_anisotropy);
 
   void doStreaming(long& memoryRemaining, long& memoryRemainingThisFrame);
+  // Called by the streamer thread once the transfers recorded by doStreaming have completed
+  void finishStreaming();
   void primeTexture(KRTexture* texture);
 
 private:
@@ -93,6 +96,7 @@ private:
   std::vector<std::pair<float, KRTexture*> > m_activeTextures_streamer;
   std::vector<std::pair<float, KRTexture*> > m_activeTextures_streamer_copy;
   bool m_streamerComplete;
+  bool m_streamerPending;
 
   std::atomic<long> m_textureMemUsed;
 
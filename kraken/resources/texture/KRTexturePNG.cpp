@@ -32,6 +32,9 @@
 #include "KREngine-common.h"
 #include "KRContext.h"
 #include "KRTextureKTX2.h"
+#include "KRInflate.h"
+
+#include <bit>
 
 using namespace hydra;
 
@@ -64,45 +67,490 @@ struct PNG_HEADER
 };
 #pragma pack()
 
+namespace {
+
+enum PNGColorType
+{
+  PNG_COLOR_GREYSCALE = 0,
+  PNG_COLOR_RGB = 2,
+  PNG_COLOR_PALETTE = 3,
+  PNG_COLOR_GREYSCALE_ALPHA = 4,
+  PNG_COLOR_RGBA = 6
+};
+
+int PNGChannelCount(uint8_t colorType)
+{
+  switch (colorType) {
+  case PNG_COLOR_GREYSCALE:
+  case PNG_COLOR_PALETTE:
+    return 1;
+  case PNG_COLOR_GREYSCALE_ALPHA:
+    return 2;
+  case PNG_COLOR_RGB:
+    return 3;
+  case PNG_COLOR_RGBA:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+bool PNGValidDepth(uint8_t colorType, uint8_t depth)
+{
+  switch (colorType) {
+  case PNG_COLOR_GREYSCALE:
+    return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+  case PNG_COLOR_PALETTE:
+    return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+  case PNG_COLOR_RGB:
+  case PNG_COLOR_GREYSCALE_ALPHA:
+  case PNG_COLOR_RGBA:
+    return depth == 8 || depth == 16;
+  default:
+    return false;
+  }
+}
+
+uint8_t PaethPredictor(int a, int b, int c)
+{
+  int pa = abs(b - c);
+  int pb = abs(a - c);
+  int pc = abs(a + b - 2 * c);
+  if (pa <= pb && pa <= pc) {
+    return (uint8_t)a;
+  }
+  if (pb <= pc) {
+    return (uint8_t)b;
+  }
+  return (uint8_t)c;
+}
+
+// Larger images are rejected rather than decoded, as they are always expanded to RGBA8
+// and 16384 x 16384 already requires 1GB
+const uint32_t kMaxPNGDimension = 16384;
+
+// Unfilters bytes [start, length) of a scanline, one byte at a time
+void UnfilterRowScalar(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t start, size_t length, int bpp)
+{
+  switch (filter) {
+  case 1: // Sub
+    for (size_t i = std::max(start, (size_t)bpp); i < length; i++) {
+      row[i] += row[i - bpp];
+    }
+    break;
+  case 2: // Up
+    for (size_t i = start; i < length; i++) {
+      row[i] += prior[i];
+    }
+    break;
+  case 3: // Average
+    for (size_t i = start; i < length; i++) {
+      int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+      row[i] += (uint8_t)((left + prior[i]) >> 1);
+    }
+    break;
+  case 4: // Paeth
+    for (size_t i = start; i < length; i++) {
+      if (i >= (size_t)bpp) {
+        row[i] += PaethPredictor(row[i - bpp], prior[i], prior[i - bpp]);
+      } else {
+        row[i] += prior[i];
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+#if defined(KRAKEN_ARCH_X86_64) || defined(KRAKEN_USE_ARM_NEON)
+
+// 3 and 4 byte pixels are unfiltered a pixel at a time in SIMD registers.  Sub, Average
+// and Paeth depend on the previous pixel, so only Up can process a full vector at once.
+template <int bpp>
+inline uint32_t LoadPixel(const uint8_t* p)
+{
+  uint32_t value = 0;
+  memcpy(&value, p, bpp);
+  return value;
+}
+
+template <int bpp>
+inline void StorePixel(uint8_t* p, uint32_t value)
+{
+  memcpy(p, &value, bpp);
+}
+
+void UnfilterUp(uint8_t* row, const uint8_t* prior, size_t length)
+{
+  size_t i = 0;
+#if defined(KRAKEN_ARCH_X86_64)
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+    _mm_storeu_si128((__m128i*)(row + i), _mm_add_epi8(x, b));
+  }
+#else
+  for (; i + 16 <= length; i += 16) {
+    vst1q_u8(row + i, vaddq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+  }
+#endif
+  UnfilterRowScalar(2, row, prior, i, length, 1);
+}
+
+#if defined(KRAKEN_ARCH_X86_64)
+
+template <int bpp>
+void UnfilterPixels(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t length)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i a = zero;
+  switch (filter) {
+  case 1: // Sub
+    for (size_t i = 0; i < length; i += bpp) {
+      __m128i x = _mm_cvtsi32_si128((int)LoadPixel<bpp>(row + i));
+      a = _mm_add_epi8(x, a);
+      StorePixel<bpp>(row + i, (uint32_t)_mm_cvtsi128_si32(a));
+    }
+    break;
+  case 3: // Average
+  {
+    const __m128i one = _mm_set1_epi8(1);
+    for (size_t i = 0; i < length; i += bpp) {
+      __m128i b = _mm_cvtsi32_si128((int)LoadPixel<bpp>(prior + i));
+      __m128i x = _mm_cvtsi32_si128((int)LoadPixel<bpp>(row + i));
+      // _mm_avg_epu8 rounds up, so subtract the carry to floor
+      __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+      a = _mm_add_epi8(x, average);
+      StorePixel<bpp>(row + i, (uint32_t)_mm_cvtsi128_si32(a));
+    }
+    break;
+  }
+  case 4: // Paeth, evaluated in 16-bit lanes
+  {
+    __m128i c = zero;
+    for (size_t i = 0; i < length; i += bpp) {
+      __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)LoadPixel<bpp>(prior + i)), zero);
+      __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)LoadPixel<bpp>(row + i)), zero);
+
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = _mm_add_epi16(pa, pb);
+      pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+      pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+      pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+      // Ties prefer a, then b, as in PaethPredictor
+      __m128i useB = _mm_cmplt_epi16(pb, pa);
+      __m128i predictor = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, a));
+      __m128i useC = _mm_cmplt_epi16(pc, _mm_min_epi16(pa, pb));
+      predictor = _mm_or_si128(_mm_and_si128(useC, c), _mm_andnot_si128(useC, predictor));
+
+      a = _mm_and_si128(_mm_add_epi16(x, predictor), _mm_set1_epi16(0xff));
+      c = b;
+      StorePixel<bpp>(row + i, (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(a, zero)));
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+#else
+
+template <int bpp>
+void UnfilterPixels(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t length)
+{
+  uint8x8_t a = vdup_n_u8(0);
+  switch (filter) {
+  case 1: // Sub
+    for (size_t i = 0; i < length; i += bpp) {
+      uint8x8_t x = vreinterpret_u8_u32(vdup_n_u32(LoadPixel<bpp>(row + i)));
+      a = vadd_u8(x, a);
+      StorePixel<bpp>(row + i, vget_lane_u32(vreinterpret_u32_u8(a), 0));
+    }
+    break;
+  case 3: // Average
+    for (size_t i = 0; i < length; i += bpp) {
+      uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(LoadPixel<bpp>(prior + i)));
+      uint8x8_t x = vreinterpret_u8_u32(vdup_n_u32(LoadPixel<bpp>(row + i)));
+      a = vadd_u8(x, vhadd_u8(a, b));
+      StorePixel<bpp>(row + i, vget_lane_u32(vreinterpret_u32_u8(a), 0));
+    }
+    break;
+  case 4: // Paeth
+  {
+    uint8x8_t c = vdup_n_u8(0);
+    for (size_t i = 0; i < length; i += bpp) {
+      uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(LoadPixel<bpp>(prior + i)));
+      uint8x8_t x = vreinterpret_u8_u32(vdup_n_u32(LoadPixel<bpp>(row + i)));
+
+      uint16x8_t pa = vabdl_u8(b, c);
+      uint16x8_t pb = vabdl_u8(a, c);
+      uint16x8_t pc = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+
+      // Ties prefer a, then b, as in PaethPredictor
+      uint8x8_t useB = vmovn_u16(vcltq_u16(pb, pa));
+      uint8x8_t predictor = vbsl_u8(useB, b, a);
+      uint8x8_t useC = vmovn_u16(vcltq_u16(pc, vminq_u16(pa, pb)));
+      predictor = vbsl_u8(useC, c, predictor);
+
+      a = vadd_u8(x, predictor);
+      c = b;
+      StorePixel<bpp>(row + i, vget_lane_u32(vreinterpret_u32_u8(a), 0));
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+#endif
+
+#endif // defined(KRAKEN_ARCH_X86_64) || defined(KRAKEN_USE_ARM_NEON)
+
+// Reverses the filter of a scanline in place.  prior is the unfiltered previous
+// scanline, or zeros for the first scanline of an image or interlace pass.
+bool UnfilterRow(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t length, int bpp)
+{
+  if (filter > 4) {
+    return false;
+  }
+#if defined(KRAKEN_ARCH_X86_64) || defined(KRAKEN_USE_ARM_NEON)
+  if (filter == 2) {
+    UnfilterUp(row, prior, length);
+    return true;
+  }
+  if (bpp == 4) {
+    UnfilterPixels<4>(filter, row, prior, length);
+    return true;
+  }
+  if (bpp == 3) {
+    UnfilterPixels<3>(filter, row, prior, length);
+    return true;
+  }
+#endif
+  UnfilterRowScalar(filter, row, prior, 0, length, bpp);
+  return true;
+}
+
+struct PNGFormat
+{
+  int width;
+  int height;
+  uint8_t depth;
+  uint8_t colorType;
+  uint8_t interlaceMethod;
+  // Palette entries, or the tRNS color key, expanded to RGBA
+  uint8_t palette[256][4];
+  bool hasColorKey;
+  uint16_t colorKey[3];
+};
+
+// Expands an unfiltered scanline to RGBA8, writing pixels dstStep bytes apart
+void ExpandRow(const PNGFormat& format, const uint8_t* src, int width, uint8_t* dst, size_t dstStep)
+{
+  int depth = format.depth;
+  switch (format.colorType) {
+  case PNG_COLOR_PALETTE:
+  case PNG_COLOR_GREYSCALE:
+    if (depth == 16) {
+      for (int x = 0; x < width; x++, src += 2, dst += dstStep) {
+        uint16_t grey = (uint16_t)((src[0] << 8) | src[1]);
+        dst[0] = dst[1] = dst[2] = src[0];
+        dst[3] = format.hasColorKey && grey == format.colorKey[0] ? 0 : 0xff;
+      }
+    } else if (format.colorType == PNG_COLOR_PALETTE || depth < 8) {
+      // Sub-byte greyscale samples are expanded through the palette, which holds the scaled greys
+      int shift = 8 - depth;
+      int mask = (1 << depth) - 1;
+      for (int x = 0; x < width; x++, dst += dstStep) {
+        int bit = x * depth;
+        int index = (src[bit >> 3] >> (shift - (bit & 7))) & mask;
+        memcpy(dst, format.palette[index], 4);
+      }
+    } else {
+      for (int x = 0; x < width; x++, dst += dstStep) {
+        memcpy(dst, format.palette[src[x]], 4);
+      }
+    }
+    break;
+  case PNG_COLOR_GREYSCALE_ALPHA:
+  {
+    int stride = depth / 4;
+    for (int x = 0; x < width; x++, src += stride, dst += dstStep) {
+      dst[0] = dst[1] = dst[2] = src[0];
+      dst[3] = src[stride / 2];
+    }
+    break;
+  }
+  case PNG_COLOR_RGB:
+    if (depth == 16) {
+      for (int x = 0; x < width; x++, src += 6, dst += dstStep) {
+        bool keyed = format.hasColorKey
+          && ((src[0] << 8) | src[1]) == format.colorKey[0]
+          && ((src[2] << 8) | src[3]) == format.colorKey[1]
+          && ((src[4] << 8) | src[5]) == format.colorKey[2];
+        dst[0] = src[0];
+        dst[1] = src[2];
+        dst[2] = src[4];
+        dst[3] = keyed ? 0 : 0xff;
+      }
+    } else {
+      for (int x = 0; x < width; x++, src += 3, dst += dstStep) {
+        bool keyed = format.hasColorKey && src[0] == format.colorKey[0] && src[1] == format.colorKey[1] && src[2] == format.colorKey[2];
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = keyed ? 0 : 0xff;
+      }
+    }
+    break;
+  case PNG_COLOR_RGBA:
+    if (depth == 16) {
+      for (int x = 0; x < width; x++, src += 8, dst += dstStep) {
+        dst[0] = src[0];
+        dst[1] = src[2];
+        dst[2] = src[4];
+        dst[3] = src[6];
+      }
+    } else if (dstStep == 4) {
+      memcpy(dst, src, (size_t)width * 4);
+    } else {
+      for (int x = 0; x < width; x++, src += 4, dst += dstStep) {
+        memcpy(dst, src, 4);
+      }
+    }
+    break;
+  }
+}
+
+// Inflates, unfilters and expands the image into an RGBA8 buffer of width * height * 4 bytes
+bool DecodeImage(const PNGFormat& format, KRInflate& inflate, uint8_t* rgba)
+{
+  const int passStartX[7] = { 0, 4, 0, 2, 0, 1, 0 };
+  const int passStartY[7] = { 0, 0, 4, 0, 2, 0, 1 };
+  const int passStepX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+  const int passStepY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+  int bitsPerPixel = PNGChannelCount(format.colorType) * format.depth;
+  int filterBpp = std::max(1, bitsPerPixel / 8);
+  size_t maxRowBytes = ((size_t)format.width * bitsPerPixel + 7) / 8;
+
+  // Each scanline is preceded by its filter type byte
+  std::vector<uint8_t> scanlines((maxRowBytes + 1) * 2);
+  uint8_t* current = scanlines.data();
+  uint8_t* prior = current + maxRowBytes + 1;
+
+  int passCount = format.interlaceMethod == 1 ? 7 : 1;
+  for (int pass = 0; pass < passCount; pass++) {
+    int startX = 0, startY = 0, stepX = 1, stepY = 1;
+    if (format.interlaceMethod == 1) {
+      startX = passStartX[pass];
+      startY = passStartY[pass];
+      stepX = passStepX[pass];
+      stepY = passStepY[pass];
+    }
+    if (startX >= format.width || startY >= format.height) {
+      continue; // Empty passes are omitted from the stream
+    }
+    int passWidth = (format.width - startX + stepX - 1) / stepX;
+    int passHeight = (format.height - startY + stepY - 1) / stepY;
+    size_t rowBytes = ((size_t)passWidth * bitsPerPixel + 7) / 8;
+
+    memset(prior, 0, rowBytes + 1);
+    for (int y = 0; y < passHeight; y++) {
+      if (inflate.read(current, rowBytes + 1) != rowBytes + 1) {
+        return false;
+      }
+      if (!UnfilterRow(current[0], current + 1, prior + 1, rowBytes, filterBpp)) {
+        return false;
+      }
+      size_t pixel = (size_t)(startY + y * stepY) * format.width + startX;
+      ExpandRow(format, current + 1, passWidth, rgba + pixel * 4, (size_t)stepX * 4);
+      std::swap(current, prior);
+    }
+  }
+  return true;
+}
+
+// Linear to sRGB, indexed by linear intensity in 12 bits
+struct SRGBTables
+{
+  float toLinear[256];
+  uint8_t fromLinear[4096];
+
+  SRGBTables()
+  {
+    for (int i = 0; i < 256; i++) {
+      float c = i / 255.0f;
+      toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < 4096; i++) {
+      float c = i / 4095.0f;
+      float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+      fromLinear[i] = (uint8_t)std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f);
+    }
+  }
+};
+
+// Box filters an RGBA8 sRGB image to half size, averaging color in linear space
+void GenerateMip(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst)
+{
+  static const SRGBTables tables;
+  int dstWidth = std::max(1, srcWidth >> 1);
+  int dstHeight = std::max(1, srcHeight >> 1);
+  for (int y = 0; y < dstHeight; y++) {
+    const uint8_t* row0 = src + (size_t)std::min(y * 2, srcHeight - 1) * srcWidth * 4;
+    const uint8_t* row1 = src + (size_t)std::min(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+    for (int x = 0; x < dstWidth; x++) {
+      size_t x0 = (size_t)std::min(x * 2, srcWidth - 1) * 4;
+      size_t x1 = (size_t)std::min(x * 2 + 1, srcWidth - 1) * 4;
+      for (int channel = 0; channel < 3; channel++) {
+        float sum = tables.toLinear[row0[x0 + channel]] + tables.toLinear[row0[x1 + channel]]
+          + tables.toLinear[row1[x0 + channel]] + tables.toLinear[row1[x1 + channel]];
+        *dst++ = tables.fromLinear[(int)(sum * (4095.0f / 4.0f) + 0.5f)];
+      }
+      *dst++ = (uint8_t)((row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2) >> 2);
+    }
+  }
+}
+
+} // anonymous namespace
+
 KRTexturePNG::KRTexturePNG(KRContext& context, Block* data, std::string name) : KRTexture2D(context, data, name)
 {
+  m_dimensions = Vector2i::Create(0, 0);
+  m_lod_count = 0;
+
   data->lock();
   PNG_HEADER* pHeader = (PNG_HEADER*)data->getStart();
   uint8_t expected_magic[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
-  if (memcmp(pHeader->magic, expected_magic, 8) != 0) {
-    assert(false);
+  if (data->getSize() < sizeof(PNG_HEADER) || memcmp(pHeader->magic, expected_magic, 8) != 0) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "PNG texture %s is not a valid PNG file", name.c_str());
     data->unlock();
-    return; // Not a valid PNG file
+    return;
   }
 
-  m_dimensions.x = SWAP_4(pHeader->chunk_IHDR.width);
-  m_dimensions.y = SWAP_4(pHeader->chunk_IHDR.height);
-  m_lod_count = 1; // Mipmaps not yet supported for PNG images
-  switch (pHeader->chunk_IHDR.colorType) {
-  case 0:
-      // greyscale
-      m_imageSize = m_dimensions.x * m_dimensions.y * pHeader->chunk_IHDR.depth / 8;
-      break;
-  case 2:
-      // RGB
-      m_imageSize = m_dimensions.x * m_dimensions.y * pHeader->chunk_IHDR.depth / 8 * 3;
-      break;
-  case 3:
-      // Palette
-      m_imageSize = m_dimensions.x * m_dimensions.y * 3;
-      break;
-  case 4:
-      // Greyscale + alpha
-      m_imageSize = m_dimensions.x * m_dimensions.y * pHeader->chunk_IHDR.depth / 8 * 2;
-      break;
-  case 6:
-      // RGB + Alpha
-      m_imageSize = m_dimensions.x * m_dimensions.y * pHeader->chunk_IHDR.depth / 8 * 4;
-      break;
-  default:
-      assert(false);
-      break;
+  uint32_t width = SWAP_4(pHeader->chunk_IHDR.width);
+  uint32_t height = SWAP_4(pHeader->chunk_IHDR.height);
+  if (width == 0 || height == 0 || width > kMaxPNGDimension || height > kMaxPNGDimension) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "PNG texture %s has unsupported dimensions %u x %u", name.c_str(), width, height);
+    data->unlock();
+    return;
   }
+  if (!PNGValidDepth(pHeader->chunk_IHDR.colorType, pHeader->chunk_IHDR.depth)) {
+    KRContext::Log(KRContext::LOG_LEVEL_ERROR, "PNG texture %s has unsupported bit depth %i for color type %i", name.c_str(), pHeader->chunk_IHDR.depth, pHeader->chunk_IHDR.colorType);
+    data->unlock();
+    return;
+  }
+  m_dimensions.x = (int)width;
+  m_dimensions.y = (int)height;
+
+  // Mipmaps are generated on load, down to 1x1
+  m_lod_count = std::bit_width((unsigned int)std::max(std::max(m_dimensions.x, m_dimensions.y), 1));
 
   data->unlock();
 }
@@ -114,34 +562,103 @@ KRTexturePNG::~KRTexturePNG()
 
 bool KRTexturePNG::getLodData(void* buffer, int lod)
 {
-  unsigned char* converted_image = (unsigned char*)buffer;
-  // TODO - Vulkan Refactoring - Perhaps it would be more efficient to reformat the color channels during the copy to the staging buffer.
+  if (m_lod_count == 0) {
+    return false;
+  }
+  int target_lod = std::min(lod, m_lod_count - 1);
+
   m_pData->lock();
-  PNG_HEADER* pHeader = (PNG_HEADER*)m_pData->getStart();
+  uint8_t* start = (uint8_t*)m_pData->getStart();
+  uint8_t* end = (uint8_t*)m_pData->getEnd();
+  PNG_HEADER* pHeader = (PNG_HEADER*)start;
+
+  PNGFormat format;
+  format.width = m_dimensions.x;
+  format.height = m_dimensions.y;
+  format.depth = pHeader->chunk_IHDR.depth;
+  format.colorType = pHeader->chunk_IHDR.colorType;
+  format.interlaceMethod = pHeader->chunk_IHDR.interlateMethod;
+  format.hasColorKey = false;
+  if (!PNGValidDepth(format.colorType, format.depth) || format.interlaceMethod > 1 || pHeader->chunk_IHDR.compressionMethod != 0 || pHeader->chunk_IHDR.filterMethod != 0) {
+    m_pData->unlock();
+    return false;
+  }
+
+  // Greyscale images are expanded through the palette table
+  for (int i = 0; i < 256; i++) {
+    format.palette[i][0] = format.palette[i][1] = format.palette[i][2] = 0;
+    format.palette[i][3] = 0xff;
+  }
+  if (format.colorType == PNG_COLOR_GREYSCALE && format.depth <= 8) {
+    int maxValue = (1 << format.depth) - 1;
+    for (int i = 0; i <= maxValue; i++) {
+      format.palette[i][0] = format.palette[i][1] = format.palette[i][2] = (uint8_t)(i * 255 / maxValue);
+    }
+  }
+
+  KRInflate inflate;
+  uint8_t* chunk = (uint8_t*)&pHeader->chunk_IHDR.header;
+  while (chunk + sizeof(PNG_CHUNK_HEADER) <= end) {
+    PNG_CHUNK_HEADER* header = (PNG_CHUNK_HEADER*)chunk;
+    size_t length = SWAP_4(header->length);
+    uint8_t* chunk_data = chunk + sizeof(PNG_CHUNK_HEADER);
+    if (length > (size_t)(end - chunk_data)) {
+      break; // Truncated file
+    }
+    if (memcmp(header->type, "IEND", 4) == 0) {
+      break;
+    } else if (memcmp(header->type, "PLTE", 4) == 0) {
+      for (size_t i = 0; i < length / 3 && i < 256; i++) {
+        memcpy(format.palette[i], chunk_data + i * 3, 3);
+      }
+    } else if (memcmp(header->type, "tRNS", 4) == 0) {
+      if (format.colorType == PNG_COLOR_PALETTE) {
+        for (size_t i = 0; i < length && i < 256; i++) {
+          format.palette[i][3] = chunk_data[i];
+        }
+      } else if (format.colorType == PNG_COLOR_GREYSCALE && length >= 2) {
+        uint16_t key = (uint16_t)((chunk_data[0] << 8) | chunk_data[1]);
+        if (format.depth < 16) {
+          format.palette[key & ((1 << format.depth) - 1)][3] = 0;
+        }
+        format.hasColorKey = true;
+        format.colorKey[0] = key;
+      } else if (format.colorType == PNG_COLOR_RGB && length >= 6) {
+        format.hasColorKey = true;
+        for (int i = 0; i < 3; i++) {
+          // 8-bit samples are compared against the low byte
+          format.colorKey[i] = (uint16_t)((chunk_data[i * 2] << 8) | chunk_data[i * 2 + 1]);
+          if (format.depth == 8) {
+            format.colorKey[i] &= 0xff;
+          }
+        }
+      }
+    } else if (memcmp(header->type, "IDAT", 4) == 0) {
+      inflate.addInput(chunk_data, length);
+    }
+    chunk = chunk_data + length + 4; // Skip the CRC
+  }
 
-  PNG_CHUNK_IHDR* chunk_IHDR = &pHeader->chunk_IHDR;
+  // Levels above target_lod are only needed to generate the requested levels
+  std::vector<uint8_t> scratch;
+  if (target_lod > 0) {
+    scratch.resize(getMemRequiredForLodRange(0, target_lod - 1));
+  }
+  auto levelData = [&](int level) -> uint8_t* {
+    if (level < target_lod) {
+      return scratch.data() + (level > 0 ? getMemRequiredForLodRange(0, level - 1) : 0);
+    }
+    return (uint8_t*)buffer + (level > target_lod ? getMemRequiredForLodRange(target_lod, level - 1) : 0);
+  };
 
-  PNG_CHUNK_HEADER* chunk = &chunk_IHDR->header;
+  bool success = DecodeImage(format, inflate, levelData(0));
+  m_pData->unlock();
+  if (!success) {
+    return false;
+  }
 
-  uint8_t* palette_data = nullptr;
-  size_t palette_length = 0;
-  uint8_t* alpha_data = nullptr;
-  size_t alpha_length = 0;
-  while(chunk != nullptr)
-  {
-	  chunk = (PNG_CHUNK_HEADER*)((uint8_t*)chunk + sizeof(PNG_CHUNK_HEADER) + SWAP_4(chunk->length));
-	  assert(chunk < (PNG_CHUNK_HEADER*)m_pData->getEnd());
-      if (memcmp(chunk->type, "IEND", 4) == 0) {
-          chunk = nullptr;
-      } else if (memcmp(chunk->type, "PLTE", 4) == 0) {
-          palette_data = (uint8_t*)chunk + sizeof(PNG_CHUNK_HEADER);
-		  palette_length = SWAP_4(chunk->length);
-      } else if (memcmp(chunk->type, "tRNS", 4) == 0) {
-          alpha_data = (uint8_t*)chunk + sizeof(PNG_CHUNK_HEADER);
-          alpha_length = SWAP_4(chunk->length);
-      } else if (memcmp(chunk->type, "IDAT", 4) == 0) {
-          break;
-	  }
+  for (int level = 1; level < m_lod_count; level++) {
+    GenerateMip(levelData(level - 1), std::max(1, m_dimensions.x >> (level - 1)), std::max(1, m_dimensions.y >> (level - 1)), levelData(level));
   }
 
   return true;
@@ -159,7 +676,8 @@ KRTexture* KRTexturePNG::compress(bool premultiply_alpha)
 
 long KRTexturePNG::getMemRequiredForLod(int lod)
 {
-  return m_imageSize;
+  // Always expanded to RGBA8
+  return (long)std::max(1, m_dimensions.x >> lod) * std::max(1, m_dimensions.y >> lod) * 4;
 }
 
 Vector3i KRTexturePNG::getDimensions() const
@@ -53,6 +53,5 @@ public:
   virtual VkFormat getFormat() const override;
   virtual int getFaceCount() const override;
 private:
-  long m_imageSize;
   hydra::Vector2i m_dimensions;
 };
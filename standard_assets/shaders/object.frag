@@ -221,9 +221,6 @@ layout(location = 0) out vec4 colorOut;
 layout( push_constant ) uniform constants
 {
   highp mat4 mvp_matrix; // mvp_matrix is the result of multiplying the model, view, and projection matrices
-#if BONE_COUNT > 0
-  highp mat4 bone_transforms[BONE_COUNT];
-#endif
 #if ENABLE_PER_PIXEL == 1 || GBUFFER_PASS == 1
   #if HAS_NORMAL_MAP == 1
     #if HAS_NORMAL_MAP_SCALE == 1
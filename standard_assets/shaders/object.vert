@@ -45,7 +45,6 @@ layout(location = 2) in vec3 vertex_tangent;
 layout(location = 3) in lowp vec3 vertex_texcoord0;
 
 #if BONE_COUNT > 0
-    layout(location = 4) in lowp vec3 vertex_texcoord0;
     layout(location = 5) in highp vec4 bone_weights;
     layout(location = 6) in highp vec4 bone_indexes;
 #else
@@ -68,9 +67,6 @@ layout(location = 3) in lowp vec3 vertex_texcoord0;
 layout( push_constant ) uniform constants
 {
   highp mat4 mvp_matrix; // mvp_matrix is the result of multiplying the model, view, and projection matrices
-#if BONE_COUNT > 0
-  highp mat4 bone_transforms[BONE_COUNT];
-#endif
 #if ENABLE_PER_PIXEL == 1 || GBUFFER_PASS == 1
   #if HAS_NORMAL_MAP == 1
     #if HAS_NORMAL_MAP_SCALE == 1
@@ -247,6 +243,14 @@ layout( push_constant ) uniform constants
 #endif
 } PushConstants;
 
+#if BONE_COUNT > 0
+// Skin palette uploaded by KRModel::getSkinPalette, one matrix per bone
+layout(std430, set = 0, binding = 0) readonly buffer BoneTransforms
+{
+  highp mat4 matrices[];
+} bone_transforms;
+#endif
+
 #if ENABLE_PER_PIXEL == 1 || GBUFFER_PASS == 1
     #if HAS_DIFFUSE_MAP == 1 || HAS_NORMAL_MAP == 1 || HAS_SPEC_MAP == 1 || HAS_REFLECTION_MAP == 1
         layout(location=0) out highp vec2 texCoord;
@@ -336,11 +340,11 @@ void main()
     //scaled_bone_weights = vec4(1.0, 0.0, 0.0, 0.0);
     
     highp mat4 skin_matrix =
-        bone_transforms[ int(scaled_bone_indexes.x) ] * scaled_bone_weights.x +
-        bone_transforms[ int(scaled_bone_indexes.y) ] * scaled_bone_weights.y +
-        bone_transforms[ int(scaled_bone_indexes.z) ] * scaled_bone_weights.z +
-        bone_transforms[ int(scaled_bone_indexes.w) ] * scaled_bone_weights.w;
-    //skin_matrix = bone_transforms[0];
+        bone_transforms.matrices[ int(scaled_bone_indexes.x) ] * scaled_bone_weights.x +
+        bone_transforms.matrices[ int(scaled_bone_indexes.y) ] * scaled_bone_weights.y +
+        bone_transforms.matrices[ int(scaled_bone_indexes.z) ] * scaled_bone_weights.z +
+        bone_transforms.matrices[ int(scaled_bone_indexes.w) ] * scaled_bone_weights.w;
+    //skin_matrix = bone_transforms.matrices[0];
     highp vec3 vertex_position_skinned = (skin_matrix * vec4(vertex_position, 1)).xyz;
 
     highp vec3 vertex_normal_skinned = normalize(mat3(skin_matrix) * vertex_normal);
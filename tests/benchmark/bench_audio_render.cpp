@@ -0,0 +1,278 @@
+//
+//  bench_audio_render.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRViewport.h"
+#include "nodes/KRAudioSource.h"
+#include "nodes/KRReverbZone.h"
+#include "resources/audio/KRAudioManager.h"
+#include "resources/audio/KRAudioSample.h"
+#include "resources/scene/KRScene.h"
+
+#include <filesystem>
+#include <random>
+
+using namespace hydra;
+
+// Measures the Siren mixer through the offline render backend: WAV decoding into the
+// buffer cache, then HRTF spatialization with increasing source counts, with and without
+// impulse-response reverb. Results are reported in seconds of audio per second, so a
+// value above 1.0 renders faster than realtime.
+
+namespace {
+
+const int kRenderSeconds = 10;
+const int kQuickRenderSeconds = 1;
+const int kDecodeSeconds = 60;
+const int kQuickDecodeSeconds = 4;
+const int kRepeat = 3;
+const int kFrameLength = 1024; // Frames rendered between calls to startFrame, as a game loop would
+const int kMaxSources = 32;
+
+void Write16(std::vector<uint8_t>& wav, uint32_t value)
+{
+  wav.push_back(value & 0xff);
+  wav.push_back((value >> 8) & 0xff);
+}
+
+void Write32(std::vector<uint8_t>& wav, uint32_t value)
+{
+  Write16(wav, value & 0xffff);
+  Write16(wav, value >> 16);
+}
+
+// Builds a WAV file holding the given samples, as 16-bit PCM or 32-bit float
+std::vector<uint8_t> CreateWav(const std::vector<float>& samples, int channels, bool float_format)
+{
+  int bytes_per_sample = float_format ? 4 : 2;
+  uint32_t data_size = (uint32_t)(samples.size() * bytes_per_sample);
+  std::vector<uint8_t> wav;
+  wav.insert(wav.end(), { 'R', 'I', 'F', 'F' });
+  Write32(wav, 36 + data_size);
+  wav.insert(wav.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+  Write32(wav, 16);
+  Write16(wav, float_format ? 3 : 1); // WAVE_FORMAT_IEEE_FLOAT or WAVE_FORMAT_PCM
+  Write16(wav, channels);
+  Write32(wav, KRENGINE_AUDIO_FRAME_RATE);
+  Write32(wav, KRENGINE_AUDIO_FRAME_RATE * channels * bytes_per_sample);
+  Write16(wav, channels * bytes_per_sample);
+  Write16(wav, bytes_per_sample * 8);
+  wav.insert(wav.end(), { 'd', 'a', 't', 'a' });
+  Write32(wav, data_size);
+  for (float sample : samples) {
+    if (float_format) {
+      uint32_t bits;
+      memcpy(&bits, &sample, sizeof(bits));
+      Write32(wav, bits);
+    } else {
+      Write16(wav, (uint16_t)(int16_t)(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+    }
+  }
+  return wav;
+}
+
+KRAudioSample* LoadWav(KRContext& context, const std::string& name, const std::vector<uint8_t>& wav)
+{
+  mimir::Block* data = new mimir::Block();
+  data->append((void*)wav.data(), wav.size());
+  return context.getAudioManager()->load(name, "wav", data);
+}
+
+// A chord with some noise, so that the HRTF convolution sees a broad spectrum
+std::vector<float> CreateTone(int frame_count, int channels)
+{
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+  std::vector<float> samples((size_t)frame_count * channels);
+  for (int frame = 0; frame < frame_count; frame++) {
+    float t = (float)frame / KRENGINE_AUDIO_FRAME_RATE;
+    float value = 0.3f * sinf(2.0f * (float)M_PI * 220.0f * t) + 0.2f * sinf(2.0f * (float)M_PI * 330.0f * t) + noise(random);
+    for (int channel = 0; channel < channels; channel++) {
+      samples[(size_t)frame * channels + channel] = value;
+    }
+  }
+  return samples;
+}
+
+// Exponentially decaying noise, standing in for a room impulse response
+std::vector<float> CreateImpulseResponse(int frame_count)
+{
+  std::mt19937 random(5678);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+  std::vector<float> samples(frame_count);
+  for (int frame = 0; frame < frame_count; frame++) {
+    samples[frame] = noise(random) * expf(-6.0f * frame / frame_count);
+  }
+  return samples;
+}
+
+// The HRTF bank is built from the KEMAR impulse responses in the standard assets
+size_t LoadHRTF(KRContext& context)
+{
+  size_t count = 0;
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(KRAKEN_STANDARD_ASSETS_DIR "/hrtf_kemar", error)) {
+    if (entry.path().extension() != ".wav") {
+      continue;
+    }
+    mimir::Block* data = new mimir::Block();
+    if (!data->load(entry.path().string())) {
+      delete data;
+      continue;
+    }
+    context.loadResource(entry.path().filename().string(), data);
+    count++;
+  }
+  return count;
+}
+
+void BenchmarkDecode(KRContext& context, const char* name, int seconds, bool float_format)
+{
+  int frame_count = seconds * KRENGINE_AUDIO_FRAME_RATE;
+  KRAudioSample* sample = LoadWav(context, name, CreateWav(CreateTone(frame_count, 2), 2, float_format));
+
+  // The buffer cache holds a little over a second of audio, so reading the whole sample
+  // decodes nearly all of it again on every pass
+  std::vector<float> buffer(kFrameLength);
+  double elapsed = benchmark::Time(kRepeat, [&]() {
+    for (int frame = 0; frame < frame_count; frame += kFrameLength) {
+      sample->sample(frame, kFrameLength, 0, buffer.data(), 1.0f, false);
+    }
+  });
+  char label[96];
+  snprintf(label, sizeof(label), "KRAudioSample: decode %s", float_format ? "float32 stereo" : "PCM16 stereo");
+  benchmark::Report(label, elapsed, (double)seconds, "audio s");
+}
+
+// Renders the scene through the offline backend, returning the peak output level
+float Render(KRAudioManager* audio_manager, int seconds, double& elapsed)
+{
+  int frame_count = seconds * KRENGINE_AUDIO_FRAME_RATE;
+  std::vector<float> output(kFrameLength * KRENGINE_MAX_OUTPUT_CHANNELS);
+  float peak = 0.0f;
+  elapsed = benchmark::Time(kRepeat, [&]() {
+    for (int frame = 0; frame < frame_count; frame += kFrameLength) {
+      audio_manager->startFrame((float)kFrameLength / KRENGINE_AUDIO_FRAME_RATE);
+      audio_manager->renderOffline(output.data(), kFrameLength);
+      for (float value : output) {
+        peak = std::max(peak, fabsf(value));
+      }
+    }
+  });
+  return peak;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  bool quick = benchmark::IsQuick(argc, argv);
+  int render_seconds = quick ? kQuickRenderSeconds : kRenderSeconds;
+  int decode_seconds = quick ? kQuickDecodeSeconds : kDecodeSeconds;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRAudioManager* audio_manager = context->getAudioManager();
+  audio_manager->setOfflineRendering(true);
+
+  size_t hrtf_count = LoadHRTF(*context);
+  printf("%zu HRTF impulse responses\n", hrtf_count);
+  if (hrtf_count == 0) {
+    printf("The HRTF impulse responses were not found\n");
+    return 1;
+  }
+
+  BenchmarkDecode(*context, "bench_decode_pcm16", decode_seconds, false);
+  BenchmarkDecode(*context, "bench_decode_float", decode_seconds, true);
+
+  LoadWav(*context, "bench_tone", CreateWav(CreateTone(2 * KRENGINE_AUDIO_FRAME_RATE, 1), 1, false));
+  LoadWav(*context, "bench_reverb", CreateWav(CreateImpulseResponse(2 * KRENGINE_AUDIO_FRAME_RATE), 1, true));
+
+  // Looping sources on a ring around the listener, each from a different direction
+  KRScene* scene = context->getSceneManager()->createScene("bench_audio_render");
+  std::vector<KRAudioSource*> sources;
+  for (int i = 0; i < kMaxSources; i++) {
+    KRAudioSource* source = new KRAudioSource(*scene, "source" + std::to_string(i));
+    float angle = 2.0f * (float)M_PI * i / kMaxSources;
+    source->setLocalTranslation(Vector3::Create(cosf(angle) * 1.5f, (float)(i % 3) - 1.0f, sinf(angle) * 1.5f));
+    source->setSample("bench_tone");
+    source->setLooping(true);
+    source->setReverb(0.5f);
+    scene->getRootNode()->appendChild(source);
+    sources.push_back(source);
+  }
+  audio_manager->setListenerScene(scene);
+  audio_manager->setListenerOrientation(Vector3::Zero(), Vector3::Create(0.0f, 0.0f, -1.0f), Vector3::Create(0.0f, 1.0f, 0.0f));
+  audio_manager->setEnableReverb(false);
+
+  int result = 0;
+  double elapsed = 0.0;
+  Render(audio_manager, render_seconds, elapsed);
+  benchmark::Report("renderOffline: no sources", elapsed, (double)render_seconds, "audio s");
+
+  int playing = 0;
+  for (int source_count : { 1, 8, 32 }) {
+    for (; playing < source_count; playing++) {
+      sources[playing]->play();
+    }
+    float peak = Render(audio_manager, render_seconds, elapsed);
+    if (peak == 0.0f) {
+      printf("%i source(s) rendered silence\n", source_count);
+      result = 1;
+    }
+    char label[96];
+    snprintf(label, sizeof(label), "renderOffline: HRTF, %i source(s)", source_count);
+    benchmark::Report(label, elapsed, (double)render_seconds, "audio s");
+  }
+
+  // A reverb zone around the listener; every source sends to it
+  KRReverbZone* zone = new KRReverbZone(*scene, "reverb_zone");
+  zone->setZone("bench");
+  zone->setReverb("bench_reverb");
+  zone->setLocalScale(Vector3::Create(100.0f));
+  scene->getRootNode()->appendChild(zone);
+  Matrix4 view = Matrix4::LookAt(Vector3::Zero(), Vector3::Create(0.0f, 0.0f, -1.0f), Vector3::Create(0.0f, 1.0f, 0.0f));
+  Matrix4 projection{};
+  projection.perspective(45.0f * (float)M_PI / 180.0f, 16.0f / 9.0f, 0.3f, 1000.0f);
+  scene->updateOctree(KRViewport(Vector2::Create(1920.0f, 1080.0f), view, projection)); // Registers the zone with the scene
+  audio_manager->setEnableReverb(true);
+  for (float max_length : { 0.5f, 2.0f }) {
+    audio_manager->setReverbMaxLength(max_length);
+    Render(audio_manager, render_seconds, elapsed);
+    char label[96];
+    snprintf(label, sizeof(label), "renderOffline: HRTF + %.1fs reverb, %i sources", max_length, playing);
+    benchmark::Report(label, elapsed, (double)render_seconds, "audio s");
+  }
+
+  for (KRAudioSource* source : sources) {
+    source->stop();
+  }
+  audio_manager->setListenerScene(nullptr);
+  return result;
+}
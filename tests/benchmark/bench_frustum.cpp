@@ -0,0 +1,167 @@
+//
+//  bench_frustum.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRViewport.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Measures frustum culling throughput: the eight corner clip space test KRViewport::visible
+// used before it kept world space planes, the per-box plane test and visibleBatch.
+
+namespace {
+
+const size_t kBoxCount = 1000000;
+const size_t kQuickBoxCount = 20000;
+const float kWorldSize = 4000.0f;
+const int kRepeat = 5;
+const int kViewCount = 8;
+
+// The previous KRViewport::visible: transforms all eight corners to clip space and rejects
+// the box when every corner is outside the same plane
+bool VisibleCorners(const Matrix4& matViewProjection, const AABB& b)
+{
+  int outside_count[6] = { 0, 0, 0, 0, 0, 0 };
+  for (int iCorner = 0; iCorner < 8; iCorner++) {
+    Vector4 sourceCornerVertex = Vector4::Create(
+      (iCorner & 1) == 0 ? b.min.x : b.max.x,
+      (iCorner & 2) == 0 ? b.min.y : b.max.y,
+      (iCorner & 4) == 0 ? b.min.z : b.max.z, 1.0f);
+    Vector4 cornerVertex = Matrix4::Dot4(matViewProjection, sourceCornerVertex);
+    if (cornerVertex.x < -cornerVertex.w) {
+      outside_count[0]++;
+    }
+    if (cornerVertex.y < -cornerVertex.w) {
+      outside_count[1]++;
+    }
+    if (cornerVertex.z < -cornerVertex.w) {
+      outside_count[2]++;
+    }
+    if (cornerVertex.x > cornerVertex.w) {
+      outside_count[3]++;
+    }
+    if (cornerVertex.y > cornerVertex.w) {
+      outside_count[4]++;
+    }
+    if (cornerVertex.z > cornerVertex.w) {
+      outside_count[5]++;
+    }
+  }
+  for (int iFace = 0; iFace < 6; iFace++) {
+    if (outside_count[iFace] == 8) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t CountVisible(const std::vector<uint8_t>& mask)
+{
+  size_t count = 0;
+  for (uint8_t visible : mask) {
+    count += visible;
+  }
+  return count;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  size_t box_count = benchmark::IsQuick(argc, argv) ? kQuickBoxCount : kBoxCount;
+
+  // Boxes scattered through a flattened world, as the scene's octree cells and nodes are
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(-kWorldSize * 0.5f, kWorldSize * 0.5f);
+  std::uniform_real_distribution<float> extent(0.5f, 20.0f);
+  std::vector<AABB> boxes;
+  boxes.reserve(box_count);
+  for (size_t i = 0; i < box_count; i++) {
+    Vector3 center = Vector3::Create(position(random), position(random) * 0.1f, position(random));
+    Vector3 half = Vector3::Create(extent(random), extent(random), extent(random));
+    boxes.push_back(AABB::Create(center - half, center + half));
+  }
+  printf("%zu boxes, %d views\n", box_count, kViewCount);
+
+  // Views from the center of the scene, turning around the vertical axis
+  std::vector<KRViewport> viewports;
+  for (int i = 0; i < kViewCount; i++) {
+    float angle = (float)i * 2.0f * (float)M_PI / (float)kViewCount;
+    Matrix4 view = Matrix4::LookAt(Vector3::Zero(), Vector3::Create(cosf(angle), 0.0f, sinf(angle)), Vector3::Create(0.0f, 1.0f, 0.0f));
+    Matrix4 projection{};
+    projection.perspective(45.0f * (float)M_PI / 180.0f, 16.0f / 9.0f, 0.3f, kWorldSize * 0.5f);
+    viewports.push_back(KRViewport(Vector2::Create(1920.0f, 1080.0f), view, projection));
+  }
+
+  std::vector<uint8_t> corner_mask(box_count * kViewCount);
+  std::vector<uint8_t> plane_mask(box_count * kViewCount);
+  std::vector<uint8_t> batch_mask(box_count * kViewCount);
+  double corner_seconds = benchmark::Time(kRepeat, [&]() {
+    for (int view = 0; view < kViewCount; view++) {
+      const Matrix4& matViewProjection = viewports[view].getViewProjectionMatrix();
+      uint8_t* mask = corner_mask.data() + view * box_count;
+      for (size_t i = 0; i < box_count; i++) {
+        mask[i] = VisibleCorners(matViewProjection, boxes[i]) ? 1 : 0;
+      }
+    }
+  });
+  double plane_seconds = benchmark::Time(kRepeat, [&]() {
+    for (int view = 0; view < kViewCount; view++) {
+      uint8_t* mask = plane_mask.data() + view * box_count;
+      for (size_t i = 0; i < box_count; i++) {
+        mask[i] = viewports[view].visible(boxes[i]) ? 1 : 0;
+      }
+    }
+  });
+  double batch_seconds = benchmark::Time(kRepeat, [&]() {
+    for (int view = 0; view < kViewCount; view++) {
+      viewports[view].visibleBatch(boxes.data(), box_count, batch_mask.data() + view * box_count);
+    }
+  });
+
+  size_t culled_boxes = box_count * kViewCount;
+  printf("visible boxes per view: corners %zu, planes %zu, batch %zu\n",
+    CountVisible(corner_mask) / kViewCount, CountVisible(plane_mask) / kViewCount, CountVisible(batch_mask) / kViewCount);
+  benchmark::Report("frustum: corner test", corner_seconds, (double)culled_boxes, "boxes");
+  benchmark::Report("frustum: KRViewport::visible", plane_seconds, (double)culled_boxes, "boxes");
+  benchmark::Report("frustum: KRViewport::visibleBatch", batch_seconds, (double)culled_boxes, "boxes");
+  benchmark::ReportSpeedup("frustum: visible speedup", corner_seconds, plane_seconds);
+  benchmark::ReportSpeedup("frustum: visibleBatch speedup", corner_seconds, batch_seconds);
+
+  // The batch path must agree with the scalar plane test box for box
+  if (batch_mask != plane_mask) {
+    fprintf(stderr, "visibleBatch disagrees with KRViewport::visible\n");
+    return 1;
+  }
+  return 0;
+}
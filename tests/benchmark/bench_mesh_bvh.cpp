@@ -0,0 +1,175 @@
+//
+//  bench_mesh_bvh.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "resources/mesh/KRMesh.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Compares KRMesh ray and line casts, which use the mesh's BVH, with testing every
+// triangle of the mesh as KRMesh did before the BVH was added.
+
+namespace {
+
+const int kGridSize = 256;
+const int kQuickGridSize = 32;
+const int kBruteForceRayCount = 64;
+const int kRayCount = 100000;
+const int kRepeat = 3;
+
+// A rolling height field of kGridSize x kGridSize quads, two triangles each
+void CreateTerrain(KRMesh& mesh, int grid_size)
+{
+  KRMesh::mesh_info mi;
+  auto height = [](int x, int z) {
+    return sinf((float)x * 0.11f) * cosf((float)z * 0.07f) * 4.0f;
+  };
+  auto vertex = [&](int x, int z) {
+    return Vector3::Create((float)x, height(x, z), (float)z);
+  };
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      mi.vertices.push_back(vertex(x, z));
+      mi.vertices.push_back(vertex(x, z + 1));
+      mi.vertices.push_back(vertex(x + 1, z));
+      mi.vertices.push_back(vertex(x + 1, z));
+      mi.vertices.push_back(vertex(x, z + 1));
+      mi.vertices.push_back(vertex(x + 1, z + 1));
+    }
+  }
+  mi.submesh_starts.push_back(0);
+  mi.submesh_lengths.push_back((int)mi.vertices.size());
+  mi.material_names.push_back("__white");
+  mi.format = Topology::Triangles;
+  mesh.LoadData(mi, true, false);
+}
+
+// The closest hit of a ray against every triangle, as KRMesh::rayCast found it before the BVH
+bool BruteForceRayCast(const KRMesh& mesh, const Vector3& start, const Vector3& dir, float& hit_distance)
+{
+  bool hit_found = false;
+  for (int submesh_index = 0; submesh_index < mesh.getSubmeshCount(); submesh_index++) {
+    int vertex_count = mesh.getVertexCount(submesh_index);
+    for (int triangle_index = 0; triangle_index < vertex_count / 3; triangle_index++) {
+      Triangle3 tri = Triangle3::Create(
+        mesh.getVertexPosition(mesh.getVertexIndex(submesh_index, triangle_index * 3)),
+        mesh.getVertexPosition(mesh.getVertexIndex(submesh_index, triangle_index * 3 + 1)),
+        mesh.getVertexPosition(mesh.getVertexIndex(submesh_index, triangle_index * 3 + 2)));
+      Vector3 hit_point;
+      if (tri.rayCast(start, dir, hit_point)) {
+        float distance = (hit_point - start).magnitude();
+        if (!hit_found || distance < hit_distance) {
+          hit_distance = distance;
+          hit_found = true;
+        }
+      }
+    }
+  }
+  return hit_found;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  bool quick = benchmark::IsQuick(argc, argv);
+  int grid_size = quick ? kQuickGridSize : kGridSize;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRMesh* mesh = new KRMesh(*context, "bench_terrain");
+  CreateTerrain(*mesh, grid_size);
+  size_t triangle_count = (size_t)grid_size * grid_size * 2;
+  printf("%zu triangles\n", triangle_count);
+
+  // Rays from above the terrain, angled downwards in random directions
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(0.0f, (float)grid_size);
+  std::uniform_real_distribution<float> slope(-0.5f, 0.5f);
+  std::vector<Vector3> starts(kRayCount);
+  std::vector<Vector3> dirs(kRayCount);
+  for (int i = 0; i < kRayCount; i++) {
+    starts[i] = Vector3::Create(position(random), 20.0f, position(random));
+    dirs[i] = Vector3::Normalize(Vector3::Create(slope(random), -1.0f, slope(random)));
+  }
+
+  double bvh_build_seconds = benchmark::Time(1, [&]() {
+    HitInfo hitinfo;
+    mesh->rayCast(starts[0], dirs[0], hitinfo);
+  });
+  benchmark::Report("BVH build (first cast)", bvh_build_seconds, (double)triangle_count, "triangles");
+
+  int brute_force_count = quick ? 8 : kBruteForceRayCount;
+  std::vector<float> brute_force_distances(brute_force_count);
+  std::vector<bool> brute_force_hits(brute_force_count);
+  double brute_force_seconds = benchmark::Time(1, [&]() {
+    for (int i = 0; i < brute_force_count; i++) {
+      float distance = 0.0f;
+      brute_force_hits[i] = BruteForceRayCast(*mesh, starts[i], dirs[i], distance);
+      brute_force_distances[i] = distance;
+    }
+  });
+
+  // The BVH has to find the same closest hits
+  int mismatch_count = 0;
+  for (int i = 0; i < brute_force_count; i++) {
+    HitInfo hitinfo;
+    bool hit = mesh->rayCast(starts[i], dirs[i], hitinfo);
+    if (hit != brute_force_hits[i] || (hit && fabsf(hitinfo.getDistance() - brute_force_distances[i]) > 1e-3f)) {
+      mismatch_count++;
+    }
+  }
+
+  int hit_count = 0;
+  double ray_seconds = benchmark::Time(kRepeat, [&]() {
+    hit_count = 0;
+    for (int i = 0; i < kRayCount; i++) {
+      HitInfo hitinfo;
+      if (mesh->rayCast(starts[i], dirs[i], hitinfo)) {
+        hit_count++;
+      }
+    }
+  });
+  double line_seconds = benchmark::Time(kRepeat, [&]() {
+    for (int i = 0; i < kRayCount; i++) {
+      HitInfo hitinfo;
+      mesh->lineCast(starts[i], starts[i] + dirs[i] * 30.0f, hitinfo);
+    }
+  });
+
+  printf("%i of %i rays hit, %i brute force mismatches\n", hit_count, kRayCount, mismatch_count);
+  benchmark::Report("rayCast: brute force", brute_force_seconds, (double)brute_force_count, "rays");
+  benchmark::Report("rayCast: BVH", ray_seconds, (double)kRayCount, "rays");
+  benchmark::Report("lineCast: BVH", line_seconds, (double)kRayCount, "lines");
+  benchmark::ReportSpeedup("rayCast: speedup", brute_force_seconds / brute_force_count, ray_seconds / kRayCount);
+
+  return mismatch_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+//
+//  bench_node_find.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "nodes/KRBone.h"
+#include "resources/scene/KRScene.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Compares KRNode::find<T>(name), which uses the scene's name index, with the depth-first
+// search of the scene graph that it replaced.
+
+namespace {
+
+const size_t kNodeCount = 100000;
+const size_t kQuickNodeCount = 5000;
+const size_t kLookupCount = 2000;
+const int kRepeat = 5;
+
+// The scene graph, mirrored so that the search below visits nodes as KRNode::find used to
+struct TreeNode
+{
+  KRNode* node;
+  std::vector<size_t> children;
+};
+
+template <class T> T* SearchSubtree(const std::vector<TreeNode>& tree, size_t index, const std::string& name)
+{
+  T* match = dynamic_cast<T*>(tree[index].node);
+  if (match && name.compare(match->getName()) == 0) {
+    return match;
+  }
+  for (size_t child : tree[index].children) {
+    match = SearchSubtree<T>(tree, child, name);
+    if (match) {
+      return match;
+    }
+  }
+  return nullptr;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  size_t node_count = benchmark::IsQuick(argc, argv) ? kQuickNodeCount : kNodeCount;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRScene* scene = context->getSceneManager()->createScene("bench_node_find");
+
+  // A randomly branching hierarchy, as imported scenes with skeletons and groups have
+  std::mt19937 random(1234);
+  std::vector<TreeNode> tree;
+  tree.reserve(node_count + 1);
+  tree.push_back({ scene->getRootNode(), {} });
+  for (size_t i = 0; i < node_count; i++) {
+    std::uniform_int_distribution<size_t> pick_parent(tree.size() > 64 ? tree.size() - 64 : 0, tree.size() - 1);
+    size_t parent = pick_parent(random);
+    KRBone* bone = new KRBone(*scene, "node" + std::to_string(i));
+    tree[parent].node->appendChild(bone);
+    tree[parent].children.push_back(tree.size());
+    tree.push_back({ bone, {} });
+  }
+
+  std::uniform_int_distribution<size_t> pick_node(0, node_count - 1);
+  std::vector<std::string> names(kLookupCount);
+  for (std::string& name : names) {
+    name = "node" + std::to_string(pick_node(random));
+  }
+  printf("%zu scene nodes, %zu lookups\n", node_count, kLookupCount);
+
+  size_t search_count = benchmark::IsQuick(argc, argv) ? kLookupCount : kLookupCount / 10;
+  std::vector<KRNode*> searched(search_count);
+  double search_seconds = benchmark::Time(1, [&]() {
+    for (size_t i = 0; i < search_count; i++) {
+      searched[i] = SearchSubtree<KRBone>(tree, 0, names[i]);
+    }
+  });
+
+  std::vector<KRNode*> found(kLookupCount);
+  double index_seconds = benchmark::Time(kRepeat, [&]() {
+    for (size_t i = 0; i < kLookupCount; i++) {
+      found[i] = scene->getRootNode()->find<KRBone>(names[i]);
+    }
+  });
+
+  int result = 0;
+  for (size_t i = 0; i < search_count; i++) {
+    if (searched[i] == nullptr || searched[i] != found[i]) {
+      printf("find<KRBone>(\"%s\") does not match the depth-first search\n", names[i].c_str());
+      result = 1;
+    }
+  }
+
+  benchmark::Report("find: depth-first search", search_seconds, (double)search_count, "lookups");
+  benchmark::Report("find: name index", index_seconds, (double)kLookupCount, "lookups");
+  benchmark::ReportSpeedup("find: speedup", search_seconds / search_count, index_seconds / kLookupCount);
+  return result;
+}
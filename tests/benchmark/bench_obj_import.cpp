@@ -0,0 +1,145 @@
+//
+//  bench_obj_import.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "resources/KRResource.h"
+#include "resources/mesh/KRMesh.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace hydra;
+
+// Measures KRResource::LoadObj throughput in MB/s on a generated height field shaped like a
+// photogrammetry scan: one vertex, texcoord and normal per grid point and a quad per cell,
+// with bands of cells using different materials.  The file is imported in chunks parsed in
+// parallel, then as a single chunk.
+
+namespace {
+
+const int kGridSize = 800;
+const int kQuickGridSize = 100;
+const int kMaterialCount = 8;
+const int kRepeat = 3;
+
+float Height(int x, int z)
+{
+  return sinf((float)x * 0.05f) * cosf((float)z * 0.07f) * 4.0f + (float)((x * 7919 + z * 104729) % 1000) * 0.0001f;
+}
+
+std::string GenerateObj(int grid_size)
+{
+  std::string text;
+  char line[128];
+  text += "# Generated by bench_obj_import\n";
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", (float)x * 0.1f, Height(x, z), (float)z * 0.1f);
+      text += line;
+    }
+  }
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      snprintf(line, sizeof(line), "vt %.6f %.6f\n", (float)x / (grid_size - 1), (float)z / (grid_size - 1));
+      text += line;
+    }
+  }
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      Vector3 normal = Vector3::Normalize(Vector3::Create(Height(x - 1, z) - Height(x + 1, z), 0.2f, Height(x, z - 1) - Height(x, z + 1)));
+      snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", normal.x, normal.y, normal.z);
+      text += line;
+    }
+  }
+  int band_size = std::max(1, (grid_size - 1) / kMaterialCount);
+  for (int z = 0; z < grid_size - 1; z++) {
+    if (z % band_size == 0) {
+      snprintf(line, sizeof(line), "usemtl material_%i\n", (z / band_size) % kMaterialCount);
+      text += line;
+    }
+    for (int x = 0; x < grid_size - 1; x++) {
+      int i = z * grid_size + x + 1;
+      int j = i + grid_size;
+      snprintf(line, sizeof(line), "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i\n", i, i, i, j, j, j, j + 1, j + 1, j + 1, i + 1, i + 1, i + 1);
+      text += line;
+    }
+  }
+  return text;
+}
+
+size_t CountTriangles(KRMesh& mesh)
+{
+  size_t index_count = 0;
+  for (int i = 0; i < mesh.getSubmeshCount(); i++) {
+    index_count += mesh.getVertexCount(i);
+  }
+  return index_count / 3;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  int grid_size = benchmark::IsQuick(argc, argv) ? kQuickGridSize : kGridSize;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+
+  std::string text = GenerateObj(grid_size);
+  std::filesystem::path path = std::filesystem::temp_directory_path() / "kraken_bench_obj_import.obj";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(text.data(), text.size());
+  }
+  double megabytes = text.size() / (1024.0 * 1024.0);
+  size_t expected_triangles = (size_t)(grid_size - 1) * (grid_size - 1) * 2;
+  printf("%.1f MB, %i x %i grid, %zu triangles\n", megabytes, grid_size, grid_size, expected_triangles);
+
+  size_t chunked_triangles = 0;
+  size_t single_triangles = 0;
+  double chunked_seconds = benchmark::Time(kRepeat, [&]() {
+    std::unique_ptr<KRMesh> mesh(KRResource::LoadObj(*context, path.string()));
+    chunked_triangles = CountTriangles(*mesh);
+  });
+  double single_seconds = benchmark::Time(kRepeat, [&]() {
+    std::unique_ptr<KRMesh> mesh(KRResource::LoadObj(*context, path.string(), SIZE_MAX));
+    single_triangles = CountTriangles(*mesh);
+  });
+  std::filesystem::remove(path);
+
+  benchmark::Report("LoadObj: single chunk", single_seconds, megabytes, "MB");
+  benchmark::Report("LoadObj: parallel chunks", chunked_seconds, megabytes, "MB");
+  benchmark::ReportSpeedup("LoadObj: speedup", single_seconds, chunked_seconds);
+
+  if (chunked_triangles != expected_triangles || single_triangles != expected_triangles) {
+    fprintf(stderr, "Imported %zu and %zu triangles, expected %zu\n", chunked_triangles, single_triangles, expected_triangles);
+    return 1;
+  }
+  return 0;
+}
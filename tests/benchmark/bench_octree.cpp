@@ -0,0 +1,180 @@
+//
+//  bench_octree.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KROctree.h"
+#include "KRLinearOctree.h"
+#include "KRViewport.h"
+#include "nodes/KRBone.h"
+#include "resources/scene/KRScene.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Compares KROctree with KRLinearOctree on a scene of scattered nodes: building the index,
+// incrementally updating it as nodes move and culling it against view frusta.
+
+namespace {
+
+const size_t kNodeCount = 100000;
+const size_t kQuickNodeCount = 5000;
+const float kWorldSize = 4000.0f;
+const int kRepeat = 5;
+const int kViewCount = 16;
+
+// The traversal KRScene::render performs: cull octree cells, then visit their scene nodes
+void FindVisible(KROctreeNode* octree_node, const KRViewport& viewport, std::vector<KRNode*>& visible)
+{
+  if (octree_node == nullptr || !viewport.visible(octree_node->getBounds())) {
+    return;
+  }
+  for (KRNode* node : octree_node->getSceneNodes()) {
+    if (node) {
+      visible.push_back(node);
+    }
+  }
+  for (int i = 0; i < 8; i++) {
+    FindVisible(octree_node->getChildren()[i], viewport, visible);
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  size_t node_count = benchmark::IsQuick(argc, argv) ? kQuickNodeCount : kNodeCount;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRScene* scene = context->getSceneManager()->createScene("bench_octree");
+
+  // Bones have unit bounds around their transform, without needing any resources
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(-kWorldSize * 0.5f, kWorldSize * 0.5f);
+  std::uniform_real_distribution<float> scale(0.5f, 20.0f);
+  std::vector<KRNode*> nodes;
+  nodes.reserve(node_count);
+  for (size_t i = 0; i < node_count; i++) {
+    KRBone* bone = new KRBone(*scene, "bone" + std::to_string(i));
+    bone->setLocalTranslation(Vector3::Create(position(random), position(random) * 0.1f, position(random)));
+    bone->setLocalScale(Vector3::Create(scale(random)));
+    scene->getRootNode()->appendChild(bone);
+    nodes.push_back(bone);
+  }
+  for (KRNode* node : nodes) {
+    node->getBounds();
+  }
+  printf("%zu scene nodes\n", node_count);
+
+  std::unique_ptr<KROctree> octree;
+  std::unique_ptr<KRLinearOctree> linear_octree;
+  double octree_seconds = benchmark::Time(kRepeat, [&]() {
+    octree = std::make_unique<KROctree>();
+    for (KRNode* node : nodes) {
+      octree->add(node);
+    }
+  });
+  double linear_seconds = benchmark::Time(kRepeat, [&]() {
+    linear_octree = std::make_unique<KRLinearOctree>();
+    for (KRNode* node : nodes) {
+      linear_octree->add(node);
+    }
+    linear_octree->rebuild();
+  });
+  benchmark::Report("build: KROctree", octree_seconds, (double)node_count, "nodes");
+  benchmark::Report("build: KRLinearOctree", linear_seconds, (double)node_count, "nodes");
+  benchmark::ReportSpeedup("build: speedup", octree_seconds, linear_seconds);
+
+  // Each round moves 1% of the nodes a short distance, as animated objects would
+  std::uniform_int_distribution<size_t> pick(0, node_count - 1);
+  std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+  size_t moved_count = std::max<size_t>(1, node_count / 100);
+  std::vector<KRNode*> moved(moved_count);
+  octree_seconds = 0.0;
+  linear_seconds = 0.0;
+  for (int round = 0; round < kRepeat; round++) {
+    for (KRNode*& node : moved) {
+      node = nodes[pick(random)];
+      node->setLocalTranslation(node->getLocalTranslation() + Vector3::Create(step(random), step(random), step(random)));
+      node->getBounds();
+    }
+    octree_seconds += benchmark::Time(1, [&]() {
+      for (KRNode* node : moved) {
+        octree->update(node);
+      }
+    });
+    linear_seconds += benchmark::Time(1, [&]() {
+      for (KRNode* node : moved) {
+        linear_octree->update(node);
+      }
+    });
+  }
+  benchmark::Report("update: KROctree", octree_seconds, (double)(moved_count * kRepeat), "nodes");
+  benchmark::Report("update: KRLinearOctree", linear_seconds, (double)(moved_count * kRepeat), "nodes");
+  benchmark::ReportSpeedup("update: speedup", octree_seconds, linear_seconds);
+
+  // Views from the center of the scene, turning around the vertical axis
+  std::vector<KRViewport> viewports;
+  for (int i = 0; i < kViewCount; i++) {
+    float angle = (float)i * 2.0f * (float)M_PI / (float)kViewCount;
+    Matrix4 view = Matrix4::LookAt(Vector3::Zero(), Vector3::Create(cosf(angle), 0.0f, sinf(angle)), Vector3::Create(0.0f, 1.0f, 0.0f));
+    Matrix4 projection{};
+    projection.perspective(45.0f * (float)M_PI / 180.0f, 16.0f / 9.0f, 0.3f, kWorldSize * 0.5f);
+    viewports.push_back(KRViewport(Vector2::Create(1920.0f, 1080.0f), view, projection));
+  }
+  std::vector<KRNode*> visible;
+  size_t octree_visible = 0;
+  size_t linear_visible = 0;
+  octree_seconds = benchmark::Time(kRepeat, [&]() {
+    octree_visible = 0;
+    for (const KRViewport& viewport : viewports) {
+      visible.clear();
+      FindVisible(octree->getRootNode(), viewport, visible);
+      octree_visible += visible.size();
+    }
+  });
+  linear_seconds = benchmark::Time(kRepeat, [&]() {
+    linear_visible = 0;
+    for (const KRViewport& viewport : viewports) {
+      visible.clear();
+      linear_octree->findVisible(viewport, visible);
+      linear_visible += visible.size();
+    }
+  });
+  printf("visible nodes per view: KROctree %zu, KRLinearOctree %zu\n", octree_visible / kViewCount, linear_visible / kViewCount);
+  benchmark::Report("frustum: KROctree", octree_seconds, (double)kViewCount, "views");
+  benchmark::Report("frustum: KRLinearOctree", linear_seconds, (double)kViewCount, "views");
+  benchmark::ReportSpeedup("frustum: speedup", octree_seconds, linear_seconds);
+
+  // The indexes refer to the scene's nodes, so they go first
+  octree.reset();
+  linear_octree.reset();
+  return 0;
+}
@@ -0,0 +1,200 @@
+//
+//  bench_png.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRInflate.h"
+#include "resources/texture/KRTexturePNG.h"
+
+#include <fstream>
+#include <random>
+
+// Measures KRInflate on a dynamic Huffman zlib stream, and KRTexturePNG decoding of large
+// images.  The images are written with stored deflate blocks, as the engine has no deflate
+// compressor, so their decoding time is dominated by unfiltering and expanding to RGBA8.
+// Rows cycle through all five filter types.
+
+namespace {
+
+const int kImageSize = 2048;
+const int kQuickImageSize = 256;
+const int kRepeat = 5;
+
+uint32_t Crc32(const uint8_t* data, size_t length)
+{
+  static uint32_t table[256] = {};
+  if (table[1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      }
+      table[i] = c;
+    }
+  }
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < length; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffff;
+}
+
+void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+  out.push_back((uint8_t)(value >> 24));
+  out.push_back((uint8_t)(value >> 16));
+  out.push_back((uint8_t)(value >> 8));
+  out.push_back((uint8_t)value);
+}
+
+void AppendChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data)
+{
+  AppendBigEndian(png, (uint32_t)data.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  AppendBigEndian(png, Crc32(png.data() + start, png.size() - start));
+}
+
+uint8_t Paeth(int a, int b, int c)
+{
+  int pa = abs(b - c);
+  int pb = abs(a - c);
+  int pc = abs(a + b - 2 * c);
+  return (uint8_t)((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+}
+
+// A noisy gradient image of the given color type, filtered and stored in a zlib stream
+std::vector<uint8_t> CreatePNG(int size, uint8_t color_type, int channels)
+{
+  std::mt19937 random(1234);
+  size_t row_bytes = (size_t)size * channels;
+  std::vector<uint8_t> prior(row_bytes, 0);
+  std::vector<uint8_t> row(row_bytes);
+  std::vector<uint8_t> filtered;
+  filtered.reserve((row_bytes + 1) * size);
+  for (int y = 0; y < size; y++) {
+    for (size_t i = 0; i < row_bytes; i++) {
+      row[i] = (uint8_t)((i / channels) + y * 3 + (i % channels) * 50 + (random() & 7));
+    }
+    uint8_t filter = (uint8_t)(y % 5);
+    filtered.push_back(filter);
+    for (size_t i = 0; i < row_bytes; i++) {
+      int a = i >= (size_t)channels ? row[i - channels] : 0;
+      int b = prior[i];
+      int c = i >= (size_t)channels ? prior[i - channels] : 0;
+      int predictor[5] = { 0, a, b, (a + b) >> 1, Paeth(a, b, c) };
+      filtered.push_back((uint8_t)(row[i] - predictor[filter]));
+    }
+    std::swap(row, prior);
+  }
+
+  std::vector<uint8_t> zlib = { 0x78, 0x01 };
+  for (size_t offset = 0; offset < filtered.size(); offset += 0xffff) {
+    size_t length = std::min<size_t>(0xffff, filtered.size() - offset);
+    zlib.push_back(offset + length == filtered.size() ? 1 : 0);
+    zlib.push_back((uint8_t)length);
+    zlib.push_back((uint8_t)(length >> 8));
+    zlib.push_back((uint8_t)~length);
+    zlib.push_back((uint8_t)(~length >> 8));
+    zlib.insert(zlib.end(), filtered.begin() + offset, filtered.begin() + offset + length);
+  }
+  uint32_t s1 = 1, s2 = 0;
+  for (uint8_t value : filtered) {
+    s1 = (s1 + value) % 65521;
+    s2 = (s2 + s1) % 65521;
+  }
+  AppendBigEndian(zlib, (s2 << 16) | s1);
+
+  std::vector<uint8_t> png = { 137, 80, 78, 71, 13, 10, 26, 10 };
+  std::vector<uint8_t> ihdr;
+  AppendBigEndian(ihdr, (uint32_t)size);
+  AppendBigEndian(ihdr, (uint32_t)size);
+  ihdr.insert(ihdr.end(), { 8, color_type, 0, 0, 0 });
+  AppendChunk(png, "IHDR", ihdr);
+  if (color_type == 3) {
+    std::vector<uint8_t> palette(256 * 3);
+    for (size_t i = 0; i < palette.size(); i++) {
+      palette[i] = (uint8_t)(i * 7);
+    }
+    AppendChunk(png, "PLTE", palette);
+  }
+  AppendChunk(png, "IDAT", zlib);
+  AppendChunk(png, "IEND", {});
+  return png;
+}
+
+void BenchmarkPNG(KRContext& context, const char* name, int size, uint8_t color_type, int channels)
+{
+  std::vector<uint8_t> png = CreatePNG(size, color_type, channels);
+  mimir::Block* data = new mimir::Block();
+  data->append(png.data(), png.size());
+  KRTexturePNG texture(context, data, name);
+
+  // Mipmaps are always generated along with the full size level
+  std::vector<uint8_t> rgba(texture.getMemRequiredForLodRange(0, texture.getLodCount() - 1));
+  bool success = true;
+  double seconds = benchmark::Time(kRepeat, [&]() {
+    success &= texture.getLodData(rgba.data(), 0);
+  });
+  if (!success) {
+    printf("%s: decoding failed\n", name);
+  }
+  char label[96];
+  snprintf(label, sizeof(label), "PNG %s %ix%i, decode + mipmaps", name, size, size);
+  benchmark::Report(label, seconds, (double)size * size * 4 / (1024.0 * 1024.0), "MB RGBA8");
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  int size = benchmark::IsQuick(argc, argv) ? kQuickImageSize : kImageSize;
+
+  std::ifstream file(std::string(KRAKEN_TEST_DATA_DIR) + "/inflate_dynamic.zlib", std::ios::binary);
+  std::vector<uint8_t> compressed((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<uint8_t> output(1 << 20);
+  size_t output_size = 0;
+  int repeat = benchmark::IsQuick(argc, argv) ? 10 : 200;
+  double seconds = benchmark::Time(kRepeat, [&]() {
+    for (int i = 0; i < repeat; i++) {
+      KRInflate inflate;
+      inflate.addInput(compressed.data(), compressed.size());
+      output_size = inflate.read(output.data(), output.size());
+    }
+  });
+  benchmark::Report("KRInflate: dynamic Huffman", seconds, (double)output_size * repeat / (1024.0 * 1024.0), "MB out");
+
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  BenchmarkPNG(*context, "RGB8", size, 2, 3);
+  BenchmarkPNG(*context, "RGBA8", size, 6, 4);
+  BenchmarkPNG(*context, "palette8", size, 3, 1);
+  return 0;
+}
@@ -0,0 +1,228 @@
+//
+//  bench_push_constants.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRModelView.h"
+#include "KRRenderSettings.h"
+#include "KRShaderReflection.h"
+#include "KRViewport.h"
+#include "nodes/KRLocator.h"
+#include "resources/scene/KRScene.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Compares the per-draw cost of writing push constants by searching the reflected objects
+// for each value, as KRPipeline::setPushConstants used to, with KRPushConstantPlanner, which
+// KRPipeline now uses to resolve the suppliers once for each sequence of object types.
+// Draws that include an object with conditional shader values check that the planner still
+// takes each value from the first object that supplies it.
+
+namespace {
+
+const size_t kDrawCount = 1000000;
+const size_t kQuickDrawCount = 20000;
+const size_t kModelCount = 256;
+const size_t kConditionalDrawCount = 1000;
+const int kRepeat = 5;
+
+struct PushConstant
+{
+  ShaderValue value;
+  ShaderValueType type;
+  size_t size;
+};
+
+// The push constants of a typical lit, fogged object shader
+const PushConstant kPushConstants[] = {
+  { ShaderValue::mvp, ShaderValueType::type_matrix4, sizeof(Matrix4) },
+  { ShaderValue::model_matrix, ShaderValueType::type_matrix4, sizeof(Matrix4) },
+  { ShaderValue::model_view_inverse_transpose, ShaderValueType::type_matrix4, sizeof(Matrix4) },
+  { ShaderValue::projection_matrix, ShaderValueType::type_matrix4, sizeof(Matrix4) },
+  { ShaderValue::camerapos_model_space, ShaderValueType::type_vector3, sizeof(Vector3) },
+  { ShaderValue::view_space_model_origin, ShaderValueType::type_vector3, sizeof(Vector3) },
+  { ShaderValue::viewport, ShaderValueType::type_vector4, sizeof(Vector4) },
+  { ShaderValue::fog_near, ShaderValueType::type_float32, sizeof(float) },
+  { ShaderValue::fog_far, ShaderValueType::type_float32, sizeof(float) },
+  { ShaderValue::fog_density, ShaderValueType::type_float32, sizeof(float) },
+  { ShaderValue::fog_color, ShaderValueType::type_vector3, sizeof(Vector3) },
+};
+const size_t kPushConstantCount = sizeof(kPushConstants) / sizeof(kPushConstants[0]);
+
+// Push constant offsets in the buffer, as reflected from a shader
+struct PushConstantLayout
+{
+  size_t offset[kPushConstantCount];
+  size_t size;
+
+  PushConstantLayout()
+  {
+    size = 0;
+    for (size_t i = 0; i < kPushConstantCount; i++) {
+      offset[i] = size;
+      size += (kPushConstants[i].size + 15) & ~(size_t)15;
+    }
+  }
+};
+
+// The previous KRPipeline::setPushConstants, including its by-value copy of the objects
+bool SearchPushConstants(const PushConstantLayout& layout, uint8_t* buffer, const KRCamera* camera, const std::vector<const KRReflectedObject*> objects)
+{
+  bool success = true;
+  for (size_t i = 0; i < kPushConstantCount; i++) {
+    bool found = false;
+    for (const KRReflectedObject* object : objects) {
+      if (object->getShaderValue(camera, kPushConstants[i].value, kPushConstants[i].type, buffer + layout.offset[i])) {
+        found = true;
+        break;
+      }
+    }
+    success &= found;
+  }
+  return success;
+}
+
+// Supplies the fog colour only while enabled, ahead of KRRenderSettings which always does
+class FogOverride : public KRReflectedObject
+{
+public:
+  bool enabled = false;
+
+  bool hasConditionalShaderValues() const override
+  {
+    return true;
+  }
+
+protected:
+  using KRReflectedObject::getShaderValue;
+
+  bool getShaderValue(const KRCamera* camera, ShaderValue value, Vector3* output) const override
+  {
+    if (enabled && value == ShaderValue::fog_color) {
+      *output = Vector3::Create(1.0f, 0.5f, 0.25f);
+      return true;
+    }
+    return false;
+  }
+};
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  size_t draw_count = benchmark::IsQuick(argc, argv) ? kQuickDrawCount : kDrawCount;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRScene* scene = context->getSceneManager()->createScene("bench_push_constants");
+
+  Matrix4 view = Matrix4::LookAt(Vector3::Create(0.0f, 10.0f, 20.0f), Vector3::Zero(), Vector3::Create(0.0f, 1.0f, 0.0f));
+  Matrix4 projection{};
+  projection.perspective(45.0f * (float)M_PI / 180.0f, 16.0f / 9.0f, 0.3f, 1000.0f);
+  KRViewport viewport(Vector2::Create(1920.0f, 1080.0f), view, projection);
+  KRRenderSettings settings;
+
+  // Each draw passes the node being drawn ahead of the per-draw and per-pass objects, as
+  // KRScene::render and KRPipeline::bind do
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+  std::vector<KRLocator*> nodes;
+  std::vector<std::unique_ptr<KRModelView>> model_views;
+  for (size_t i = 0; i < kModelCount; i++) {
+    KRLocator* node = new KRLocator(*scene, "node" + std::to_string(i));
+    scene->getRootNode()->appendChild(node);
+    nodes.push_back(node);
+    Matrix4 model = Matrix4::Translation(Vector3::Create(position(random), position(random), position(random)));
+    model_views.push_back(std::make_unique<KRModelView>(&viewport, model, nullptr));
+  }
+
+  PushConstantLayout layout;
+  std::vector<uint8_t> search_buffer(layout.size);
+  std::vector<uint8_t> planned_buffer(layout.size);
+  KRPushConstantPlanner planner;
+  for (size_t i = 0; i < kPushConstantCount; i++) {
+    planner.addPushConstant(kPushConstants[i].value, kPushConstants[i].type, planned_buffer.data() + layout.offset[i]);
+  }
+  std::vector<const KRReflectedObject*> objects;
+
+  auto SetObjects = [&](size_t draw) {
+    objects.clear();
+    objects.push_back(nodes[draw % kModelCount]);
+    objects.push_back(model_views[draw % kModelCount].get());
+    objects.push_back(&viewport);
+    objects.push_back(&settings);
+  };
+
+  bool search_success = true;
+  double search_seconds = benchmark::Time(kRepeat, [&]() {
+    for (size_t draw = 0; draw < draw_count; draw++) {
+      SetObjects(draw);
+      search_success &= SearchPushConstants(layout, search_buffer.data(), nullptr, objects);
+    }
+  });
+  benchmark::Report("setPushConstants: search each draw", search_seconds, (double)draw_count, "draws");
+
+  bool planned_success = true;
+  double planned_seconds = benchmark::Time(kRepeat, [&]() {
+    for (size_t draw = 0; draw < draw_count; draw++) {
+      SetObjects(draw);
+      planned_success &= planner.write(nullptr, objects);
+    }
+  });
+  benchmark::Report("setPushConstants: resolved plan", planned_seconds, (double)draw_count, "draws");
+  benchmark::ReportSpeedup("setPushConstants: speedup", search_seconds, planned_seconds);
+
+  // Both leave the last draw's values in their buffers
+  if (!search_success || !planned_success || search_buffer != planned_buffer) {
+    printf("The planned push constants do not match the searched push constants\n");
+    return 1;
+  }
+
+  // The fog override answers on alternate draws, starting with a draw where it declines, so
+  // the plan is made while KRRenderSettings supplies the fog colour
+  FogOverride fog_override;
+  size_t mismatch_count = 0;
+  for (size_t draw = 0; draw < kConditionalDrawCount; draw++) {
+    fog_override.enabled = (draw % 2) == 1;
+    SetObjects(draw);
+    objects.insert(objects.begin() + 2, &fog_override);
+    search_success &= SearchPushConstants(layout, search_buffer.data(), nullptr, objects);
+    planned_success &= planner.write(nullptr, objects);
+    if (search_buffer != planned_buffer) {
+      mismatch_count++;
+    }
+  }
+  printf("%zu draws with a conditional object, %zu mismatched\n", kConditionalDrawCount, mismatch_count);
+  if (!search_success || !planned_success || mismatch_count > 0) {
+    printf("The planned push constants do not match the searched push constants when an earlier object answers conditionally\n");
+    return 1;
+  }
+  return 0;
+}
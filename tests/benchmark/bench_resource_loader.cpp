@@ -0,0 +1,264 @@
+//
+//  bench_resource_loader.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRResourceLoader.h"
+#include "nodes/KRLocator.h"
+#include "resources/scene/KRScene.h"
+#include "resources/mesh/KRMesh.h"
+#include "resources/animation_curve/KRAnimationCurve.h"
+#include "resources/texture/KRTextureKTX.h"
+
+#include <fstream>
+#include <random>
+
+using namespace hydra;
+
+// Compares loading a batch of resources one at a time through KRContext::loadResource, as
+// bundles used to, with KRResourceLoader, which decodes them on the worker pool before
+// registering them in order.  Scenes, mesh packs, mtl materials, animation curves and KTX
+// and KTX2 textures are measured separately.
+
+namespace {
+
+const int kRepeat = 3;
+const int kNodesPerScene = 500;
+const int kMeshGridSize = 64;
+const int kMaterialsPerFile = 200;
+const int kCurveFrameCount = 4096;
+const int kTextureSize = 256;
+
+struct ResourceType
+{
+  const char* extension;
+  const char* unit_name;
+  std::string data; // Serialized resource, copied into each request
+  int count;
+  int quick_count;
+};
+
+std::string Serialize(KRResource& resource)
+{
+  mimir::Block data;
+  resource.save(data);
+  data.lock();
+  std::string bytes((const char*)data.getStart(), data.getSize());
+  data.unlock();
+  return bytes;
+}
+
+// A scene of randomly placed locators, standing in for level content
+std::string CreateScene(KRContext& context)
+{
+  KRScene* scene = context.getSceneManager()->createScene("bench_template");
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+  for (int i = 0; i < kNodesPerScene; i++) {
+    KRLocator* locator = new KRLocator(*scene, "locator" + std::to_string(i));
+    locator->setLocalTranslation(Vector3::Create(position(random), position(random), position(random)));
+    scene->getRootNode()->appendChild(locator);
+  }
+  return Serialize(*scene);
+}
+
+// A flat grid of kMeshGridSize x kMeshGridSize quads
+std::string CreateMesh(KRContext& context)
+{
+  KRMesh::mesh_info mi;
+  for (int z = 0; z < kMeshGridSize; z++) {
+    for (int x = 0; x < kMeshGridSize; x++) {
+      mi.vertices.push_back(Vector3::Create((float)x, 0.0f, (float)z));
+      mi.vertices.push_back(Vector3::Create((float)x, 0.0f, (float)z + 1.0f));
+      mi.vertices.push_back(Vector3::Create((float)x + 1.0f, 0.0f, (float)z));
+      mi.vertices.push_back(Vector3::Create((float)x + 1.0f, 0.0f, (float)z));
+      mi.vertices.push_back(Vector3::Create((float)x, 0.0f, (float)z + 1.0f));
+      mi.vertices.push_back(Vector3::Create((float)x + 1.0f, 0.0f, (float)z + 1.0f));
+    }
+  }
+  mi.submesh_starts.push_back(0);
+  mi.submesh_lengths.push_back((int)mi.vertices.size());
+  mi.material_names.push_back("__white");
+  mi.format = Topology::Triangles;
+  KRMesh* mesh = new KRMesh(context, "bench_template");
+  mesh->LoadData(mi, true, false);
+  return Serialize(*mesh);
+}
+
+std::string CreateMaterials()
+{
+  std::string mtl = "# Benchmark materials\n";
+  for (int i = 0; i < kMaterialsPerFile; i++) {
+    mtl += "newmtl material" + std::to_string(i) + "\n";
+    mtl += "kd 0.8 0.4 0.2\nks 0.5 0.5 0.5\nkr 0.25\nns 32\ntr 1.0\n";
+    mtl += "alpha_mode blendoneside\n";
+    mtl += "map_kd base" + std::to_string(i) + ".ktx2 -s 2 2 -o 0.5 0.5\n";
+    mtl += "map_normal normal" + std::to_string(i) + ".ktx2\n";
+  }
+  return mtl;
+}
+
+std::string CreateCurve(KRContext& context)
+{
+  std::vector<float> values(kCurveFrameCount);
+  for (int i = 0; i < kCurveFrameCount; i++) {
+    values[i] = sinf((float)i * 0.01f);
+  }
+  KRAnimationCurve* curve = new KRAnimationCurve(context, "bench_template");
+  curve->setFrames(0, kCurveFrameCount, values.data());
+  return Serialize(*curve);
+}
+
+// An RGBA8 texture with a full mipmap chain
+std::string CreateKTX(KRContext& context)
+{
+  std::list<mimir::Block*> blocks;
+  for (int size = kTextureSize; size > 0; size /= 2) {
+    mimir::Block* level = new mimir::Block();
+    level->expand(size * size * 4);
+    blocks.push_back(level);
+  }
+  const unsigned int GL_RGBA8 = 0x8058;
+  const unsigned int GL_RGBA = 0x1908;
+  KRTextureKTX* texture = new KRTextureKTX(context, "bench_template", GL_RGBA8, GL_RGBA, kTextureSize, kTextureSize, blocks);
+  for (mimir::Block* level : blocks) {
+    delete level;
+  }
+  return Serialize(*texture);
+}
+
+std::string ReadFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+std::vector<KRResourceLoader::Request> CreateRequests(const ResourceType& type, int count)
+{
+  std::vector<KRResourceLoader::Request> requests(count);
+  for (int i = 0; i < count; i++) {
+    requests[i].fileName = std::string("bench_resource") + std::to_string(i) + "." + type.extension;
+    requests[i].data = new mimir::Block();
+    requests[i].data->append((void*)type.data.data(), type.data.size());
+    requests[i].resource = nullptr;
+  }
+  return requests;
+}
+
+// Times one load per repeat, each into a new context so the resources are not replaced
+double TimeLoad(const ResourceType& type, int count, const std::function<int(KRContext&, std::vector<KRResourceLoader::Request>&)>& load, int& loaded)
+{
+  double best = 0.0;
+  for (int i = 0; i < kRepeat; i++) {
+    std::unique_ptr<KRContext> context = benchmark::CreateContext();
+    std::vector<KRResourceLoader::Request> requests = CreateRequests(type, count);
+    double seconds = benchmark::Time(1, [&]() {
+      loaded = load(*context, requests);
+    });
+    if (i == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+// Returns false if either path loaded fewer resources than requested
+bool Compare(const ResourceType& type, int count)
+{
+  printf("%i %s of %zu bytes each\n", count, type.unit_name, type.data.size());
+  char name[128];
+
+  int serial_loaded = 0;
+  double serial_seconds = TimeLoad(type, count, [](KRContext& context, std::vector<KRResourceLoader::Request>& requests) {
+    int loaded = 0;
+    for (KRResourceLoader::Request& request : requests) {
+      if (context.loadResource(request.fileName, request.data)) {
+        loaded++;
+      }
+      request.data = nullptr;
+    }
+    return loaded;
+  }, serial_loaded);
+  snprintf(name, sizeof(name), "%s: KRContext::loadResource, one at a time", type.extension);
+  benchmark::Report(name, serial_seconds, (double)count, type.unit_name);
+
+  int batch_loaded = 0;
+  double batch_seconds = TimeLoad(type, count, [](KRContext& context, std::vector<KRResourceLoader::Request>& requests) {
+    context.getResourceLoader()->load(requests);
+    int loaded = 0;
+    for (KRResourceLoader::Request& request : requests) {
+      if (request.resource) {
+        loaded++;
+      }
+    }
+    return loaded;
+  }, batch_loaded);
+  snprintf(name, sizeof(name), "%s: KRResourceLoader::load, parallel decode", type.extension);
+  benchmark::Report(name, batch_seconds, (double)count, type.unit_name);
+  snprintf(name, sizeof(name), "%s: speedup", type.extension);
+  benchmark::ReportSpeedup(name, serial_seconds, batch_seconds);
+
+  if (serial_loaded != count || batch_loaded != count) {
+    printf("Loaded %i %s one at a time and %i in a batch, expected %i\n", serial_loaded, type.unit_name, batch_loaded, count);
+    return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  bool quick = benchmark::IsQuick(argc, argv);
+
+  std::vector<ResourceType> types;
+  {
+    std::unique_ptr<KRContext> context = benchmark::CreateContext();
+    types.push_back({ "krscene", "scenes", CreateScene(*context), 400, 40 });
+    types.push_back({ "krmesh", "meshes", CreateMesh(*context), 2000, 100 });
+    types.push_back({ "mtl", "mtl files", CreateMaterials(), 400, 40 });
+    types.push_back({ "kranimationcurve", "curves", CreateCurve(*context), 4000, 200 });
+    types.push_back({ "ktx", "textures", CreateKTX(*context), 4000, 200 });
+    types.push_back({ "ktx2", "textures", ReadFile(std::string(KRAKEN_TEST_DATA_DIR) + "/ktx2_zstd.ktx2"), 4000, 200 });
+  }
+
+  bool passed = true;
+  for (const ResourceType& type : types) {
+    if (type.data.empty()) {
+      printf("Unable to create %s data\n", type.extension);
+      passed = false;
+      continue;
+    }
+    if (!Compare(type, quick ? type.quick_count : type.count)) {
+      passed = false;
+    }
+  }
+  return passed ? 0 : 1;
+}
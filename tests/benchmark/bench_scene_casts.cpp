@@ -0,0 +1,142 @@
+//
+//  bench_scene_casts.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KROctree.h"
+#include "KRWorkerPool.h"
+#include "nodes/KRCollider.h"
+#include "resources/scene/KRScene.h"
+
+#include <random>
+
+using namespace hydra;
+
+// Measures batched ray casts against a field of sphere colliders, compared with issuing the
+// same casts one at a time, and how the batch scales with the number of worker threads.
+
+namespace {
+
+const int kGridSize = 64;
+const int kQuickGridSize = 8;
+const size_t kRayCount = 200000;
+const size_t kQuickRayCount = 2000;
+const int kRepeat = 3;
+const unsigned int kLayerMask = 0xffffffff;
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  bool quick = benchmark::IsQuick(argc, argv);
+  int grid_size = quick ? kQuickGridSize : kGridSize;
+  size_t ray_count = quick ? kQuickRayCount : kRayCount;
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  KRScene* scene = context->getSceneManager()->createScene("bench_scene_casts");
+
+  // Spheres of varying size on a jittered grid
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> jitter(-2.0f, 2.0f);
+  std::uniform_real_distribution<float> scale(0.5f, 3.0f);
+  std::vector<KRCollider*> colliders;
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      KRCollider* collider = new KRCollider(*scene, "collider" + std::to_string(colliders.size()), "__sphere", kLayerMask, 1.0f);
+      collider->setLocalTranslation(Vector3::Create((float)x * 8.0f + jitter(random), jitter(random), (float)z * 8.0f + jitter(random)));
+      collider->setLocalScale(Vector3::Create(scale(random)));
+      scene->getRootNode()->appendChild(collider);
+      colliders.push_back(collider);
+    }
+  }
+
+  KROctree octree;
+  for (KRCollider* collider : colliders) {
+    octree.add(collider);
+  }
+
+  // Rays from random points above the field, heading down and across it
+  float extent = (float)grid_size * 8.0f;
+  std::uniform_real_distribution<float> position(0.0f, extent);
+  std::uniform_real_distribution<float> slope(-1.0f, 1.0f);
+  std::vector<KROctree::Ray> rays(ray_count);
+  for (KROctree::Ray& ray : rays) {
+    ray.v0 = Vector3::Create(position(random), 10.0f, position(random));
+    ray.dir = Vector3::Normalize(Vector3::Create(slope(random), -0.25f, slope(random)));
+  }
+  printf("%zu colliders, %zu rays\n", colliders.size(), ray_count);
+
+  // Prepares the colliders and builds the mesh BVH outside of the timings
+  std::vector<HitInfo> hitinfo(ray_count);
+  octree.rayCastBatch(rays, hitinfo, kLayerMask, nullptr);
+
+  size_t single_hits = 0;
+  double single_seconds = benchmark::Time(kRepeat, [&]() {
+    single_hits = 0;
+    for (size_t i = 0; i < ray_count; i++) {
+      HitInfo single_hitinfo;
+      if (octree.rayCast(rays[i].v0, rays[i].dir, single_hitinfo, kLayerMask)) {
+        single_hits++;
+      }
+    }
+  });
+  benchmark::Report("rayCast: one at a time", single_seconds, (double)ray_count, "rays");
+
+  int result = 0;
+  size_t hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  for (size_t thread_count = 1; thread_count <= hardware_threads; thread_count *= 2) {
+    // A pool of 0 workers would select one per hardware thread, so one thread runs without one
+    std::unique_ptr<KRWorkerPool> pool;
+    if (thread_count > 1) {
+      pool = std::make_unique<KRWorkerPool>(thread_count - 1);
+    }
+    size_t batch_hits = 0;
+    double batch_seconds = benchmark::Time(kRepeat, [&]() {
+      for (HitInfo& h : hitinfo) {
+        h = HitInfo();
+      }
+      batch_hits = octree.rayCastBatch(rays, hitinfo, kLayerMask, pool.get());
+    });
+    if (batch_hits != single_hits) {
+      printf("rayCastBatch found %zu hits, single casts found %zu\n", batch_hits, single_hits);
+      result = 1;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "rayCastBatch: %zu thread(s)", thread_count);
+    benchmark::Report(name, batch_seconds, (double)ray_count, "rays");
+    snprintf(name, sizeof(name), "rayCastBatch: %zu thread(s) speedup", thread_count);
+    benchmark::ReportSpeedup(name, single_seconds, batch_seconds);
+  }
+
+  // The octree refers to the scene's nodes, so it goes first
+  for (KRCollider* collider : colliders) {
+    octree.remove(collider);
+  }
+  return result;
+}
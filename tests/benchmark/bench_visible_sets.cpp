@@ -0,0 +1,157 @@
+//
+//  bench_visible_sets.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRRenderPass.h"
+#include "KRViewport.h"
+#include "nodes/KRBone.h"
+#include "nodes/KRCamera.h"
+#include "resources/scene/KRScene.h"
+
+#include <deque>
+#include <random>
+
+using namespace hydra;
+
+// Measures KRScene::render over the passes of a frame when the culling results are shared by
+// the passes, compared with culling again for every pass.  The scene nodes draw nothing, so
+// the time is spent culling and visiting the scene.
+
+namespace {
+
+const size_t kNodeCount = 100000;
+const size_t kQuickNodeCount = 5000;
+const float kWorldSize = 4000.0f;
+const int kRepeat = 5;
+const int kViewCount = 8;
+
+// Scene passes of a frame that draw geometry, in the order KRRenderGraph runs them
+const RenderPassType kPasses[] = {
+  RenderPassType::RENDER_PASS_PRESTREAM,
+  RenderPassType::RENDER_PASS_DEFERRED_GBUFFER,
+  RenderPassType::RENDER_PASS_FORWARD_OPAQUE,
+  RenderPassType::RENDER_PASS_FORWARD_TRANSPARENT,
+};
+const int kPassCount = sizeof(kPasses) / sizeof(kPasses[0]);
+
+void RunScene(KrSpatialIndex spatial_index, const char* index_name, size_t node_count)
+{
+  KrInitializeInfo init_info = {};
+  init_info.sType = KR_STRUCTURE_TYPE_INITIALIZE;
+  init_info.resourceMapSize = 1024;
+  init_info.nodeMapSize = 1024;
+  init_info.spatialIndex = spatial_index;
+  std::unique_ptr<KRContext> context = std::make_unique<KRContext>(&init_info);
+  KRScene* scene = context->getSceneManager()->createScene("bench_visible_sets");
+
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> position(-kWorldSize * 0.5f, kWorldSize * 0.5f);
+  std::uniform_real_distribution<float> scale(0.5f, 20.0f);
+  for (size_t i = 0; i < node_count; i++) {
+    KRBone* bone = new KRBone(*scene, "bone" + std::to_string(i));
+    bone->setLocalTranslation(Vector3::Create(position(random), position(random) * 0.1f, position(random)));
+    bone->setLocalScale(Vector3::Create(scale(random)));
+    scene->getRootNode()->appendChild(bone);
+  }
+  scene->addDefaultLights();
+
+  // The camera only supplies render settings, so it is kept out of the scene graph
+  KRCamera* camera = new KRCamera(*scene, "bench_camera");
+
+  std::vector<KRViewport> viewports;
+  for (int i = 0; i < kViewCount; i++) {
+    float angle = (float)i * 2.0f * (float)M_PI / (float)kViewCount;
+    Matrix4 view = Matrix4::LookAt(Vector3::Zero(), Vector3::Create(cosf(angle), 0.0f, sinf(angle)), Vector3::Create(0.0f, 1.0f, 0.0f));
+    Matrix4 projection{};
+    projection.perspective(45.0f * (float)M_PI / 180.0f, 16.0f / 9.0f, 0.3f, kWorldSize * 0.5f);
+    viewports.push_back(KRViewport(Vector2::Create(1920.0f, 1080.0f), view, projection));
+  }
+  scene->updateOctree(viewports[0]);
+
+  KRRenderPass render_pass(*context);
+  VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+  auto render = [&](const KRViewport& viewport, RenderPassType pass) {
+    KRNode::RenderInfo ri(command_buffer);
+    ri.camera = camera;
+    ri.surface = nullptr;
+    ri.viewport = &viewport;
+    ri.renderPass = &render_pass;
+    ri.pipeline = nullptr;
+    render_pass.m_info.type = pass;
+    scene->render(ri);
+  };
+
+  // Culling results are keyed by viewport, so passing each pass its own copy of the
+  // viewport culls the scene again, as every pass did before the results were shared.
+  // The copies live until the end, so that their addresses are not reused.
+  std::deque<KRViewport> viewport_copies;
+  double uncached_seconds = benchmark::Time(kRepeat, [&]() {
+    for (const KRViewport& viewport : viewports) {
+      for (RenderPassType pass : kPasses) {
+        viewport_copies.push_back(viewport);
+        render(viewport_copies.back(), pass);
+      }
+    }
+  });
+
+  // Sharing a copy between the passes of a view culls it in the first pass, and the other
+  // passes reuse the result
+  double cached_seconds = benchmark::Time(kRepeat, [&]() {
+    for (const KRViewport& viewport : viewports) {
+      viewport_copies.push_back(viewport);
+      for (RenderPassType pass : kPasses) {
+        render(viewport_copies.back(), pass);
+      }
+    }
+  });
+
+  char name[96];
+  double pass_count = (double)(kViewCount * kPassCount);
+  snprintf(name, sizeof(name), "%s: cull every pass", index_name);
+  benchmark::Report(name, uncached_seconds, pass_count, "passes");
+  snprintf(name, sizeof(name), "%s: cull once per view", index_name);
+  benchmark::Report(name, cached_seconds, pass_count, "passes");
+  snprintf(name, sizeof(name), "%s: speedup", index_name);
+  benchmark::ReportSpeedup(name, uncached_seconds, cached_seconds);
+
+  delete camera;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  size_t node_count = benchmark::IsQuick(argc, argv) ? kQuickNodeCount : kNodeCount;
+  printf("%zu scene nodes, %i views, %i passes per view\n", node_count, kViewCount, kPassCount);
+  RunScene(KR_SPATIAL_INDEX_OCTREE, "KROctree", node_count);
+  RunScene(KR_SPATIAL_INDEX_LINEAR_OCTREE, "KRLinearOctree", node_count);
+  return 0;
+}
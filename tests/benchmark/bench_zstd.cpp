@@ -0,0 +1,156 @@
+//
+//  bench_zstd.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "benchmark.h"
+#include "KRZstdDecoder.h"
+#include "resources/texture/KRTextureKTX2.h"
+
+#include <atomic>
+#include <fstream>
+#include <new>
+
+// Measures KRZstdDecoder throughput on frames written by the zstd command line tool, and
+// the time and peak heap use of streaming in a KTX2 texture uncompressed, with zstd and
+// with zlib supercompression.  The fixtures are shared with test_zstd.
+
+namespace {
+
+std::atomic<size_t> g_heapInUse(0);
+std::atomic<size_t> g_heapPeak(0);
+
+std::vector<uint8_t> ReadFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+std::string DataPath(const std::string& file_name)
+{
+  return std::string(KRAKEN_TEST_DATA_DIR) + "/" + file_name;
+}
+
+void BenchmarkFrames(const char* name, int repeat)
+{
+  std::vector<uint8_t> compressed = ReadFile(DataPath(std::string(name) + ".zst"));
+  std::vector<uint8_t> expected = ReadFile(DataPath(std::string(name) + ".raw"));
+  std::vector<uint8_t> output(expected.size());
+  bool success = true;
+  double seconds = benchmark::Time(5, [&]() {
+    KRZstdDecoder decoder;
+    for (int i = 0; i < repeat; i++) {
+      size_t length = 0;
+      success &= decoder.decompress(compressed.data(), compressed.size(), output.data(), output.size(), &length);
+    }
+  });
+  if (!success || output != expected) {
+    printf("%s: decompression failed\n", name);
+  }
+  char label[96];
+  snprintf(label, sizeof(label), "KRZstdDecoder: %s (ratio %.1f)", name, (double)expected.size() / compressed.size());
+  benchmark::Report(label, seconds, (double)expected.size() * repeat / (1024.0 * 1024.0), "MB out");
+}
+
+void BenchmarkKTX2(KRContext& context, const char* name, int repeat)
+{
+  mimir::Block* data = new mimir::Block();
+  if (!data->load(DataPath(std::string(name) + ".ktx2"))) {
+    delete data;
+    printf("%s: missing fixture\n", name);
+    return;
+  }
+  KRTextureKTX2 texture(context, data, name);
+  std::vector<uint8_t> levels(texture.getMemRequiredForLodRange(0, texture.getLodCount() - 1));
+
+  // Heap use above what is in use before the call, such as decoder tables and scratch space
+  size_t baseline = g_heapInUse.load();
+  g_heapPeak = baseline;
+  bool success = texture.getLodData(levels.data(), 0);
+  size_t peak = g_heapPeak.load() - baseline;
+
+  double seconds = benchmark::Time(5, [&]() {
+    for (int i = 0; i < repeat; i++) {
+      success &= texture.getLodData(levels.data(), 0);
+    }
+  });
+  if (!success) {
+    printf("%s: decoding failed\n", name);
+  }
+  char label[96];
+  snprintf(label, sizeof(label), "KTX2 %s (%zu bytes), peak heap %zu KB", name, (size_t)data->getSize(), peak / 1024);
+  benchmark::Report(label, seconds, (double)levels.size() * repeat / (1024.0 * 1024.0), "MB out");
+}
+
+} // anonymous namespace
+
+// Heap use is tracked through the global allocation functions.  Each block is prefixed
+// with its size, keeping the 16 byte alignment of the default allocator.
+void* operator new(size_t size)
+{
+  size_t* block = (size_t*)malloc(size + 16);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  block[0] = size;
+  size_t in_use = g_heapInUse.fetch_add(size) + size;
+  size_t peak = g_heapPeak.load();
+  while (in_use > peak && !g_heapPeak.compare_exchange_weak(peak, in_use)) {
+  }
+  return (uint8_t*)block + 16;
+}
+
+void operator delete(void* p) noexcept
+{
+  if (p != nullptr) {
+    size_t* block = (size_t*)((uint8_t*)p - 16);
+    g_heapInUse.fetch_sub(block[0]);
+    free(block);
+  }
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  operator delete(p);
+}
+
+int main(int argc, char* argv[])
+{
+  int repeat = benchmark::IsQuick(argc, argv) ? 1 : 20;
+  BenchmarkFrames("zstd_text", repeat);
+  BenchmarkFrames("zstd_records", repeat);
+  BenchmarkFrames("zstd_rle", repeat);
+  BenchmarkFrames("zstd_raw", repeat);
+
+  std::unique_ptr<KRContext> context = benchmark::CreateContext();
+  BenchmarkKTX2(*context, "ktx2_none", repeat * 50);
+  BenchmarkKTX2(*context, "ktx2_zstd", repeat * 50);
+  BenchmarkKTX2(*context, "ktx2_zlib", repeat * 50);
+  return 0;
+}
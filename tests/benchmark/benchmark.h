@@ -0,0 +1,91 @@
+//
+//  benchmark.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+#include "KRContext.h"
+
+#include <chrono>
+#include <functional>
+
+// Helpers shared by the benchmark executables.  Each benchmark runs at full size by
+// default, or at a reduced size with "--quick" so that ctest can check that it still runs.
+namespace benchmark {
+
+inline bool IsQuick(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the fastest of repeat runs of fn, in seconds
+inline double Time(int repeat, const std::function<void()>& fn)
+{
+  double best = 0.0;
+  for (int i = 0; i < repeat; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+// Prints the time taken and the rate at which units were processed
+inline void Report(const char* name, double seconds, double units, const char* unit_name)
+{
+  printf("%-52s %10.3f ms %14.1f %s/s\n", name, seconds * 1000.0, seconds > 0.0 ? units / seconds : 0.0, unit_name);
+}
+
+// Prints a comparison of two measurements of the same work
+inline void ReportSpeedup(const char* name, double before_seconds, double after_seconds)
+{
+  printf("%-52s %10.2fx\n", name, after_seconds > 0.0 ? before_seconds / after_seconds : 0.0);
+}
+
+// A context for benchmarks that exercise the engine without a window surface
+inline std::unique_ptr<KRContext> CreateContext()
+{
+  KrInitializeInfo init_info = {};
+  init_info.sType = KR_STRUCTURE_TYPE_INITIALIZE;
+  init_info.resourceMapSize = 1024;
+  init_info.nodeMapSize = 1024;
+  return std::make_unique<KRContext>(&init_info);
+}
+
+} // namespace benchmark
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+#
+#  make_gltf_fixtures.py
+#  Kraken Engine
+#
+#  Writes the glTF fixtures used by test_gltf.  gltf_fixture.glb holds its geometry in the
+#  GLB BIN chunk and gltf_fixture.gltf refers to the same bytes in gltf_fixture.bin.  The
+#  document covers primitives without normals, sparse accessors, node matrices, a skin and
+#  an animation with LINEAR, STEP and CUBICSPLINE samplers.
+#
+
+import json
+import math
+import os
+import struct
+
+OUT = os.path.dirname(os.path.abspath(__file__))
+
+FLOAT = 5126
+UNSIGNED_BYTE = 5121
+UNSIGNED_SHORT = 5123
+TRIANGLES = 4
+TRIANGLE_STRIP = 5
+
+
+class Document:
+    def __init__(self):
+        self.data = bytearray()
+        self.views = []
+        self.accessors = []
+
+    def view(self, blob):
+        while len(self.data) % 4:
+            self.data.append(0)
+        self.views.append({"buffer": 0, "byteOffset": len(self.data), "byteLength": len(blob)})
+        self.data += blob
+        return len(self.views) - 1
+
+    def accessor(self, fmt, component_type, type_name, values, bounds=False, **extra):
+        accessor = {"componentType": component_type, "count": len(values), "type": type_name}
+        if values and values[0] is not None:
+            accessor["bufferView"] = self.view(b"".join(struct.pack(fmt, *v) for v in values))
+        if bounds:
+            accessor["min"] = [min(v[i] for v in bounds) for i in range(len(bounds[0]))]
+            accessor["max"] = [max(v[i] for v in bounds) for i in range(len(bounds[0]))]
+        accessor.update(extra)
+        self.accessors.append(accessor)
+        return len(self.accessors) - 1
+
+    def sparse(self, indexes, fmt, values):
+        return {
+            "count": len(indexes),
+            "indices": {"bufferView": self.view(bytes(indexes)), "componentType": UNSIGNED_BYTE},
+            "values": {"bufferView": self.view(b"".join(struct.pack(fmt, *v) for v in values))},
+        }
+
+
+def column_major(translation, rotation, scale):
+    # rotation is an [x, y, z, w] quaternion, as in glTF
+    x, y, z, w = rotation
+    r = [
+        [1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)],
+        [2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)],
+        [2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)],
+    ]
+    m = []
+    for column in range(3):
+        m += [r[row][column] * scale[column] for row in range(3)] + [0.0]
+    return m + list(translation) + [1.0]
+
+
+def normalized(q):
+    length = math.sqrt(sum(c * c for c in q))
+    return [c / length for c in q]
+
+
+def rotation_z(degrees):
+    half = math.radians(degrees) / 2
+    return (0.0, 0.0, math.sin(half), math.cos(half))
+
+
+def rotation_x(degrees):
+    half = math.radians(degrees) / 2
+    return (math.sin(half), 0.0, 0.0, math.cos(half))
+
+
+def rotation_y(degrees):
+    half = math.radians(degrees) / 2
+    return (0.0, math.sin(half), 0.0, math.cos(half))
+
+
+def animation(doc, first_node):
+    samplers = []
+    channels = []
+
+    def channel(node, path, interpolation, times, fmt, type_name, values):
+        channels.append({"sampler": len(samplers), "target": {"node": node, "path": path}})
+        samplers.append({
+            "input": doc.accessor("<f", FLOAT, "SCALAR", [(t,) for t in times], bounds=[(t,) for t in times]),
+            "output": doc.accessor(fmt, FLOAT, type_name, values),
+            "interpolation": interpolation,
+        })
+
+    linear, step, cubic = first_node, first_node + 1, first_node + 2
+
+    # Linear keys over one second.  The second rotation key is in the opposite hemisphere
+    # to the first, so the shortest path turns from 170 through 180 to 190 degrees and
+    # the euler angles wrap across +-180.
+    channel(linear, "translation", "LINEAR", [0.0, 1.0], "<3f", "VEC3", [(0.0, 0.0, 0.0), (3.0, -6.0, 9.0)])
+    channel(linear, "rotation", "LINEAR", [0.0, 1.0], "<4f", "VEC4", [rotation_z(170.0), rotation_z(-170.0)])
+
+    # Step keys hold their value until the next key time, including a jump from 170 to
+    # -170 degrees that must be unwrapped to 190
+    channel(step, "translation", "STEP", [0.0, 0.5, 1.0], "<3f", "VEC3", [(0.0, 0.0, 0.0), (1.0, 2.0, 3.0), (4.0, 5.0, 6.0)])
+    channel(step, "rotation", "STEP", [0.0, 0.5, 1.0], "<4f", "VEC4", [rotation_x(30.0), rotation_x(170.0), rotation_x(-170.0)])
+
+    # Cubic keys hold [in-tangent, value, out-tangent].  The tangents outside the curve
+    # are never used, so they are set to values that would show if they were.
+    unused = (100.0, 100.0, 100.0)
+    channel(cubic, "translation", "CUBICSPLINE", [0.0, 0.5], "<3f", "VEC3", [
+        unused, (0.0, 0.0, 0.0), (0.0, 0.0, 3.0),
+        (0.0, 0.0, -3.0), (1.0, 2.0, 0.0), unused,
+    ])
+    zero = (0.0, 0.0, 0.0, 0.0)
+    channel(cubic, "rotation", "CUBICSPLINE", [0.0, 0.5], "<4f", "VEC4", [
+        (1.0, 1.0, 1.0, 1.0), rotation_y(0.0), zero,
+        zero, rotation_y(60.0), (1.0, 1.0, 1.0, 1.0),
+    ])
+
+    return {"name": "fixture_motion", "samplers": samplers, "channels": channels}
+
+
+def build():
+    doc = Document()
+
+    # Two triangles folded along their shared edge, without normals.  The first primitive
+    # is an indexed triangle list and the second a non-indexed strip of the same faces.
+    tent = [(0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0), (1.0, 1.0, 1.0)]
+    tent_positions = doc.accessor("<3f", FLOAT, "VEC3", tent, bounds=tent)
+    tent_texcoords = doc.accessor("<2f", FLOAT, "VEC2", [(p[0], p[1]) for p in tent])
+    tent_indexes = doc.accessor("<H", UNSIGNED_SHORT, "SCALAR", [(0,), (1,), (2,), (2,), (1,), (3,)])
+    flat_tent = {
+        "name": "flat_tent",
+        "primitives": [
+            {"attributes": {"POSITION": tent_positions, "TEXCOORD_0": tent_texcoords}, "indices": tent_indexes, "mode": TRIANGLES},
+            {"attributes": {"POSITION": tent_positions, "TEXCOORD_0": tent_texcoords}, "mode": TRIANGLE_STRIP},
+        ],
+    }
+
+    # The sparse position replaces the third vertex of a buffer view.  The normals have no
+    # buffer view, so every value comes from the sparse substitution.
+    triangle = [(0.0, 0.0, 0.0), (1.0, 0.0, 0.0), (0.0, 1.0, 0.0)]
+    moved = [(0.0, 2.0, 0.0)]
+    sparse_positions = doc.accessor("<3f", FLOAT, "VEC3", triangle, bounds=triangle[:2] + moved)
+    doc.accessors[sparse_positions]["sparse"] = doc.sparse([2], "<3f", moved)
+    sparse_normals = doc.accessor("<3f", FLOAT, "VEC3", [None] * 3)
+    doc.accessors[sparse_normals]["sparse"] = doc.sparse([0, 1, 2], "<3f", [(0.0, 0.0, 1.0)] * 3)
+    sparse_triangle = {
+        "name": "sparse_triangle",
+        "primitives": [{"attributes": {"POSITION": sparse_positions, "NORMAL": sparse_normals}}],
+    }
+
+    # Skinned to a chain of two joints one unit apart
+    skin_positions = doc.accessor("<3f", FLOAT, "VEC3", [(0.0, 1.0, 0.0), (0.5, 1.5, 0.0), (0.0, 2.0, 0.0)], bounds=[(0.0, 1.0, 0.0), (0.5, 2.0, 0.0)])
+    skin_normals = doc.accessor("<3f", FLOAT, "VEC3", [(0.0, 0.0, 1.0)] * 3)
+    skin_joints = doc.accessor("<4B", UNSIGNED_BYTE, "VEC4", [(0, 0, 0, 0), (0, 1, 0, 0), (1, 0, 0, 0)])
+    skin_weights = doc.accessor("<4f", FLOAT, "VEC4", [(1.0, 0.0, 0.0, 0.0), (0.5, 0.5, 0.0, 0.0), (1.0, 0.0, 0.0, 0.0)])
+    skinned = {
+        "name": "skinned",
+        "primitives": [{"attributes": {"POSITION": skin_positions, "NORMAL": skin_normals, "JOINTS_0": skin_joints, "WEIGHTS_0": skin_weights}}],
+    }
+    inverse_bind = doc.accessor("<16f", FLOAT, "MAT4", [
+        column_major((0.0, -1.0, 0.0), (0.0, 0.0, 0.0, 1.0), (1.0, 1.0, 1.0)),
+        column_major((0.0, -2.0, 0.0), (0.0, 0.0, 0.0, 1.0), (1.0, 1.0, 1.0)),
+    ])
+
+    nodes = [
+        {"name": "flat_tent_model", "mesh": 0},
+        {"name": "matrix_node", "mesh": 1, "matrix": column_major((1.0, 2.0, 3.0), normalized([0.3, -0.5, 0.2, 0.8]), (2.0, 3.0, 4.0))},
+        {"name": "matrix_flip_node", "mesh": 1, "matrix": column_major((-4.0, 0.5, 2.0), (0.0, 0.0, 1.0, 0.0), (1.5, 1.5, 0.5))},
+        {"name": "joint_root", "translation": [0.0, 1.0, 0.0], "children": [4]},
+        {"name": "joint_child", "translation": [0.0, 1.0, 0.0]},
+        {"name": "skinned_model", "mesh": 2, "skin": 0},
+        {"name": "anim_linear"},
+        {"name": "anim_step"},
+        {"name": "anim_cubic"},
+    ]
+
+    document = {
+        "asset": {"version": "2.0"},
+        "scene": 0,
+        "scenes": [{"nodes": [0, 1, 2, 3, 5, 6, 7, 8]}],
+        "nodes": nodes,
+        "meshes": [flat_tent, sparse_triangle, skinned],
+        "skins": [{"inverseBindMatrices": inverse_bind, "joints": [3, 4]}],
+        "animations": [animation(doc, 6)],
+        "accessors": doc.accessors,
+        "bufferViews": doc.views,
+    }
+    return document, bytes(doc.data)
+
+
+def pad(data, fill):
+    return data + fill * (-len(data) % 4)
+
+
+def main():
+    document, data = build()
+
+    document["buffers"] = [{"uri": "gltf_fixture.bin", "byteLength": len(data)}]
+    with open(os.path.join(OUT, "gltf_fixture.gltf"), "w") as f:
+        json.dump(document, f, indent=1)
+    with open(os.path.join(OUT, "gltf_fixture.bin"), "wb") as f:
+        f.write(data)
+
+    # The first buffer of a .glb file has no uri and refers to the BIN chunk
+    document["buffers"] = [{"byteLength": len(data)}]
+    json_chunk = pad(json.dumps(document, separators=(",", ":")).encode(), b" ")
+    bin_chunk = pad(data, b"\0")
+    glb = struct.pack("<2I", len(json_chunk), 0x4E4F534A) + json_chunk
+    glb += struct.pack("<2I", len(bin_chunk), 0x004E4942) + bin_chunk
+    with open(os.path.join(OUT, "gltf_fixture.glb"), "wb") as f:
+        f.write(struct.pack("<3I", 0x46546C67, 2, 12 + len(glb)) + glb)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+#
+#  make_png_fixtures.py
+#  Kraken Engine
+#
+#  Writes the PNG fixtures used by test_png, along with the RGBA8 pixels that the
+#  decoder is expected to produce for each of them (<name>.rgba).  inflate.raw is also
+#  written compressed with stored, fixed Huffman and dynamic Huffman deflate blocks.  The encoder below is
+#  deliberately simple, so that every filter type, bit depth and Adam7 pass is exercised
+#  in a known way.  Pillow, when installed, is used to check the fixtures independently.
+#
+
+import os
+import struct
+import zlib
+
+OUT = os.path.dirname(os.path.abspath(__file__))
+WIDTH = 37
+HEIGHT = 29
+
+ADAM7 = [(0, 0, 8, 8), (4, 0, 8, 8), (0, 4, 4, 8), (2, 0, 4, 4), (0, 2, 2, 4), (1, 0, 2, 2), (0, 1, 1, 2)]
+
+
+def chunk(kind, data):
+    return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xffffffff)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def filter_row(kind, row, prior, bpp):
+    out = bytearray([kind])
+    for i, x in enumerate(row):
+        a = row[i - bpp] if i >= bpp else 0
+        b = prior[i]
+        c = prior[i - bpp] if i >= bpp else 0
+        predictor = [0, a, b, (a + b) >> 1, paeth(a, b, c)][kind] if kind <= 4 else 0
+        out.append((x - predictor) & 0xff)
+    return out
+
+
+def pack_row(samples, depth):
+    # samples is a flat list of sample values for one scanline
+    if depth == 8:
+        return bytearray(samples)
+    if depth == 16:
+        return bytearray(b"".join(struct.pack(">H", s) for s in samples))
+    out = bytearray()
+    bits = 0
+    count = 0
+    for s in samples:
+        bits = (bits << depth) | s
+        count += depth
+        if count == 8:
+            out.append(bits)
+            bits = count = 0
+    if count:
+        out.append(bits << (8 - count))
+    return out
+
+
+def encode(pixels, width, height, channels, depth, color_type, interlace, extra_chunks=b"", filters=(0, 1, 2, 3, 4)):
+    bpp = max(1, channels * depth // 8)
+    passes = ADAM7 if interlace else [(0, 0, 1, 1)]
+    raw = bytearray()
+    row_index = 0
+    for (sx, sy, dx, dy) in passes:
+        xs = list(range(sx, width, dx))
+        ys = list(range(sy, height, dy))
+        if not xs or not ys:
+            continue
+        prior = None
+        for y in ys:
+            samples = []
+            for x in xs:
+                samples.extend(pixels[y][x])
+            row = pack_row(samples, depth)
+            if prior is None:
+                prior = bytearray(len(row))
+            raw += filter_row(filters[row_index % len(filters)], row, prior, bpp)
+            row_index += 1
+            prior = row
+    ihdr = struct.pack(">IIBBBBB", width, height, depth, color_type, 0, 0, 1 if interlace else 0)
+    return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", ihdr) + extra_chunks
+            + chunk(b"IDAT", zlib.compress(bytes(raw), 9)) + chunk(b"IEND", b""))
+
+
+def write(name, png, expected):
+    with open(os.path.join(OUT, name + ".png"), "wb") as f:
+        f.write(png)
+    if expected is not None:
+        with open(os.path.join(OUT, name + ".rgba"), "wb") as f:
+            for row in expected:
+                for p in row:
+                    f.write(bytes(p))
+        check_with_pillow(name, expected)
+
+
+def check_with_pillow(name, expected):
+    try:
+        from PIL import Image
+    except ImportError:
+        return
+    image = Image.open(os.path.join(OUT, name + ".png"))
+    if image.mode in ("I", "I;16", "I;16B"):
+        return  # Pillow clamps 16-bit greyscale rather than taking the high byte
+    rgba = image.convert("RGBA")
+    for y, row in enumerate(expected):
+        for x, p in enumerate(row):
+            assert tuple(rgba.getpixel((x, y))) == tuple(p), (name, x, y, rgba.getpixel((x, y)), p)
+
+
+def gradient(x, y, channel):
+    return (x * 7 + y * 13 + channel * 61 + (x * y) % 11) & 0xff
+
+
+def main():
+    w, h = WIDTH, HEIGHT
+
+    rgba = [[[gradient(x, y, c) for c in range(4)] for x in range(w)] for y in range(h)]
+    write("rgba8_filters", encode(rgba, w, h, 4, 8, 6, False), rgba)
+
+    rgb = [[[gradient(x, y, c) for c in range(3)] for x in range(w)] for y in range(h)]
+    write("rgb8_adam7", encode(rgb, w, h, 3, 8, 2, True), [[p + [255] for p in row] for row in rgb])
+
+    # Colour key transparency on an RGB image
+    key = rgb[3][5]
+    trns = chunk(b"tRNS", struct.pack(">HHH", *key))
+    write("rgb8_trns", encode(rgb, w, h, 3, 8, 2, False, trns),
+          [[p + [0 if p == key else 255] for p in row] for row in rgb])
+
+    # 4-bit palette with partial alpha
+    palette = [[(i * 17) & 0xff, (255 - i * 13) & 0xff, (i * 29 + 40) & 0xff] for i in range(16)]
+    alpha = [(i * 16) & 0xff for i in range(12)]
+    indexed = [[[(x + y * 3) % 16] for x in range(w)] for y in range(h)]
+    extra = chunk(b"PLTE", bytes(sum(palette, []))) + chunk(b"tRNS", bytes(alpha))
+    expected = [[palette[p[0]] + [alpha[p[0]] if p[0] < len(alpha) else 255] for p in row] for row in indexed]
+    write("palette4_trns", encode(indexed, w, h, 1, 4, 3, False, extra), expected)
+    write("palette4_adam7", encode(indexed, w, h, 1, 4, 3, True, extra), expected)
+
+    # 2-bit greyscale, scaled to 8 bits
+    grey2 = [[[(x + y) % 4] for x in range(w)] for y in range(h)]
+    write("grey2", encode(grey2, w, h, 1, 2, 0, False), [[[p[0] * 85] * 3 + [255] for p in row] for row in grey2])
+
+    grey_alpha = [[[gradient(x, y, 0), gradient(x, y, 3)] for x in range(w)] for y in range(h)]
+    write("grey_alpha8", encode(grey_alpha, w, h, 2, 8, 4, False),
+          [[[p[0]] * 3 + [p[1]] for p in row] for row in grey_alpha])
+
+    # 16-bit samples are reduced to their high byte
+    grey16 = [[[(gradient(x, y, 0) << 8) | gradient(x, y, 1)] for x in range(w)] for y in range(h)]
+    write("grey16", encode(grey16, w, h, 1, 16, 0, False), [[[p[0] >> 8] * 3 + [255] for p in row] for row in grey16])
+
+    rgba16 = [[[(gradient(x, y, c) << 8) | gradient(y, x, c) for c in range(4)] for x in range(w)] for y in range(h)]
+    write("rgba16_adam7", encode(rgba16, w, h, 4, 16, 6, True), [[[s >> 8 for s in p] for p in row] for row in rgba16])
+
+    # Invalid files, which must be rejected without crashing
+    valid = encode(rgba, w, h, 4, 8, 6, False)
+    write("truncated", valid[:len(valid) // 2], None)
+    idat = valid.index(b"IDAT") + 4
+    corrupt = bytearray(valid)
+    corrupt[idat + 2] |= 0x06  # Reserved deflate block type
+    write("corrupt_deflate", bytes(corrupt), None)
+    write("bad_filter", encode(rgba, w, h, 4, 8, 6, False, filters=(0, 1, 5)), None)
+    write("zero_width", encode([[]] * h, 0, h, 4, 8, 6, False), None)
+    huge = bytearray(valid)
+    ihdr = valid.index(b"IHDR") + 4
+    huge[ihdr:ihdr + 8] = struct.pack(">II", 100000, 100000)
+    write("huge", bytes(huge), None)
+
+
+def write_inflate():
+    # Repetitive text followed by noise, so that matches reach across the 32KB window and
+    # some literals are incompressible
+    data = bytearray()
+    words = [b"kraken ", b"engine ", b"texture ", b"deflate ", b"window "]
+    seed = 1
+    while len(data) < 40000:
+        seed = (seed * 1103515245 + 12345) & 0x7fffffff
+        data += words[seed % len(words)]
+    for i in range(8000):
+        seed = (seed * 1103515245 + 12345) & 0x7fffffff
+        data.append(seed >> 16 & 0xff)
+    data += data[:20000]
+    with open(os.path.join(OUT, "inflate.raw"), "wb") as f:
+        f.write(data)
+    for name, level, strategy in (("stored", 0, zlib.Z_DEFAULT_STRATEGY), ("fixed", 9, zlib.Z_FIXED), ("dynamic", 9, zlib.Z_DEFAULT_STRATEGY)):
+        compressor = zlib.compressobj(level, zlib.DEFLATED, 15, 9, strategy)
+        with open(os.path.join(OUT, "inflate_" + name + ".zlib"), "wb") as f:
+            f.write(compressor.compress(bytes(data)) + compressor.flush())
+
+
+if __name__ == "__main__":
+    main()
+    write_inflate()
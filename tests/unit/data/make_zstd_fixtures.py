@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+#  make_zstd_fixtures.py
+#  Kraken Engine
+#
+#  Writes the Zstandard fixtures used by test_zstd.  Each <name>.zst is produced by the
+#  zstd command line tool from <name>.raw, so the decoder is checked against frames from
+#  the reference encoder.  The KTX2 fixtures hold the same mip chain uncompressed, with
+#  zstd supercompression and with zlib supercompression.
+#
+
+import os
+import shutil
+import struct
+import subprocess
+import zlib
+
+OUT = os.path.dirname(os.path.abspath(__file__))
+ZSTD = shutil.which("zstd")
+
+
+def lcg(seed):
+    while True:
+        seed = (seed * 1103515245 + 12345) & 0x7fffffff
+        yield seed >> 8
+
+
+def zstd(data, *args):
+    return subprocess.run([ZSTD, "-c", "-q", *args], input=data, stdout=subprocess.PIPE, check=True).stdout
+
+
+def write(name, data, *frames):
+    with open(os.path.join(OUT, name + ".raw"), "wb") as f:
+        f.write(data)
+    with open(os.path.join(OUT, name + ".zst"), "wb") as f:
+        for frame in frames:
+            f.write(frame)
+
+
+def main():
+    random = lcg(7)
+
+    # Incompressible input is stored in raw blocks
+    noise = bytes(next(random) & 0xff for _ in range(20000))
+    write("zstd_raw", noise, zstd(noise, "-19"))
+
+    # A single repeated byte is stored in RLE blocks, 128KB at a time
+    rle = b"K" * 300000
+    write("zstd_rle", rle, zstd(rle, "-3"))
+
+    # Text spanning several 128KB compressed blocks, with Huffman coded literals and FSE
+    # coded sequences, and a content checksum
+    words = [b"kraken ", b"engine ", b"texture ", b"zstandard ", b"block ", b"sequence ", b"\n"]
+    text = bytearray()
+    while len(text) < 400000:
+        text += words[next(random) % len(words)]
+        if next(random) % 13 == 0:
+            text += b"%d " % (next(random) % 100000)
+    text = bytes(text)
+    write("zstd_text", text, zstd(text, "-19", "--check"))
+
+    # Fixed size records with changing fields, which are matched with repeat offsets
+    records = bytearray()
+    for i in range(6000):
+        records += struct.pack("<IHHf", i, next(random) % 4, 0x1234, 1.5) + b"record__"
+    records = bytes(records)
+    write("zstd_records", records, zstd(records, "-9", "--no-check"))
+
+    # Two frames in one stream
+    write("zstd_multi_frame", text[:50000] + records, zstd(text[:50000], "-1"), zstd(records, "-1", "--no-check"))
+
+    # A stream cut short, which must be rejected
+    with open(os.path.join(OUT, "zstd_truncated.zst"), "wb") as f:
+        frame = zstd(text, "-19")
+        f.write(frame[:len(frame) // 2])
+
+    write_ktx2()
+
+
+def write_ktx2():
+    # A 64x64 RGBA8 mip chain of smooth gradients with a little noise
+    random = lcg(11)
+    levels = []
+    size = 64
+    while size >= 1:
+        level = bytearray()
+        for y in range(size):
+            for x in range(size):
+                level += bytes([(x * 4) & 0xff, (y * 4) & 0xff, (x + y) & 0xff, 0xff - (next(random) & 3)])
+        levels.append(bytes(level))
+        size //= 2
+
+    with open(os.path.join(OUT, "ktx2_levels.raw"), "wb") as f:
+        f.write(b"".join(levels))
+    for name, scheme, compress in (("none", 0, lambda d: d), ("zstd", 2, lambda d: zstd(d, "-19")), ("zlib", 3, lambda d: zlib.compress(d, 9))):
+        data = [compress(level) for level in levels]
+        header_size = 80 + 24 * len(levels)
+        header = b"\xabKTX 20\xbb\r\n\x1a\n" + struct.pack("<13I", 37, 1, 64, 64, 0, 0, 1, len(levels), scheme, 0, 0, 0, 0) + struct.pack("<2Q", 0, 0)
+        index = b""
+        offset = header_size
+        for compressed, level in zip(data, levels):
+            index += struct.pack("<3Q", offset, len(compressed), len(level))
+            offset += len(compressed)
+        with open(os.path.join(OUT, "ktx2_" + name + ".ktx2"), "wb") as f:
+            f.write(header + index + b"".join(data))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+//
+//  test.h
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#pragma once
+
+#include "KREngine-common.h"
+#include "KRContext.h"
+
+#include <fstream>
+
+// Minimal checks shared by the unit test executables.  A failed check is reported and the
+// test continues; main returns test::Finish() so that ctest sees the failure.
+namespace test {
+
+inline int& FailureCount()
+{
+  static int failure_count = 0;
+  return failure_count;
+}
+
+inline bool Check(bool condition, const char* expression, const char* file, int line)
+{
+  if (!condition) {
+    printf("%s(%i): check failed: %s\n", file, line, expression);
+    FailureCount()++;
+  }
+  return condition;
+}
+
+inline int Finish(const char* test_name)
+{
+  if (FailureCount() > 0) {
+    printf("%s: %i check(s) failed\n", test_name, FailureCount());
+    return 1;
+  }
+  printf("%s: passed\n", test_name);
+  return 0;
+}
+
+// Path of a file in tests/unit/data
+inline std::string DataPath(const std::string& file_name)
+{
+  return std::string(KRAKEN_TEST_DATA_DIR) + "/" + file_name;
+}
+
+inline std::vector<uint8_t> ReadFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+inline std::unique_ptr<KRContext> CreateContext(KrSpatialIndex spatial_index = KR_SPATIAL_INDEX_OCTREE)
+{
+  KrInitializeInfo init_info = {};
+  init_info.sType = KR_STRUCTURE_TYPE_INITIALIZE;
+  init_info.resourceMapSize = 1024;
+  init_info.nodeMapSize = 1024;
+  init_info.spatialIndex = spatial_index;
+  return std::make_unique<KRContext>(&init_info);
+}
+
+} // namespace test
+
+#define TEST_CHECK(condition) test::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,253 @@
+//
+//  test_gltf.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "resources/KRResource.h"
+#include "resources/animation/KRAnimation.h"
+#include "resources/animation/KRAnimationManager.h"
+#include "resources/animation_curve/KRAnimationCurve.h"
+#include "resources/animation_curve/KRAnimationCurveManager.h"
+#include "resources/bundle/KRBundle.h"
+#include "resources/mesh/KRMesh.h"
+#include "resources/mesh/KRMeshManager.h"
+#include "resources/scene/KRScene.h"
+#include "resources/scene/KRSceneManager.h"
+#include "nodes/KRBone.h"
+#include "nodes/KRModel.h"
+
+using namespace hydra;
+
+// Imports the fixtures written by data/make_gltf_fixtures.py, once from the .glb file with
+// its BIN chunk and once from the .gltf file with an external buffer, and checks the meshes,
+// nodes and animation curves that result.
+
+namespace {
+
+const float kTolerance = 1e-4f;
+
+bool Near(const Vector3& a, const Vector3& b)
+{
+  return fabsf(a.x - b.x) < kTolerance && fabsf(a.y - b.y) < kTolerance && fabsf(a.z - b.z) < kTolerance;
+}
+
+// Both primitives of flat_tent draw the same two faces without normals, which must be
+// expanded to one vertex per corner carrying the face normal and tangent
+void CheckFlatNormals(KRContext& context)
+{
+  KRMesh* mesh = context.getMeshManager()->getMesh("flat_tent");
+  if (!TEST_CHECK(mesh != nullptr) || !TEST_CHECK(mesh->getSubmeshCount() == 2)) {
+    return;
+  }
+  const Vector3 tent[] = {
+    Vector3::Create(0.0f, 0.0f, 0.0f), Vector3::Create(1.0f, 0.0f, 0.0f),
+    Vector3::Create(0.0f, 1.0f, 0.0f), Vector3::Create(1.0f, 1.0f, 1.0f)
+  };
+  // Corners of the indexed triangle list, then of the strip with its second triangle reversed
+  const int corners[2][6] = { { 0, 1, 2, 2, 1, 3 }, { 0, 1, 2, 1, 3, 2 } };
+  const Vector3 normals[2] = { Vector3::Create(0.0f, 0.0f, 1.0f), Vector3::Normalize(Vector3::Create(-1.0f, -1.0f, 1.0f)) };
+  const Vector3 tangents[2] = { Vector3::Create(1.0f, 0.0f, 0.0f), Vector3::Normalize(Vector3::Create(1.0f, 0.0f, 1.0f)) };
+  for (int submesh = 0; submesh < 2; submesh++) {
+    if (!TEST_CHECK(mesh->getVertexCount(submesh) == 6)) {
+      continue;
+    }
+    for (int i = 0; i < 6; i++) {
+      int vertex = mesh->getVertexIndex(submesh, i);
+      TEST_CHECK(Near(mesh->getVertexPosition(vertex), tent[corners[submesh][i]]));
+      TEST_CHECK(Near(mesh->getVertexNormal(vertex), normals[i / 3]));
+      TEST_CHECK(Near(mesh->getVertexTangent(vertex), tangents[i / 3]));
+    }
+  }
+}
+
+void CheckSparse(KRContext& context)
+{
+  KRMesh* mesh = context.getMeshManager()->getMesh("sparse_triangle");
+  if (!TEST_CHECK(mesh != nullptr) || !TEST_CHECK(mesh->getVertexCount(0) == 3)) {
+    return;
+  }
+  const Vector3 positions[] = {
+    Vector3::Create(0.0f, 0.0f, 0.0f), Vector3::Create(1.0f, 0.0f, 0.0f), Vector3::Create(0.0f, 2.0f, 0.0f)
+  };
+  for (int i = 0; i < 3; i++) {
+    int vertex = mesh->getVertexIndex(0, i);
+    TEST_CHECK(Near(mesh->getVertexPosition(vertex), positions[i]));
+    // The normal accessor has no buffer view, so these only come from its sparse values
+    TEST_CHECK(Near(mesh->getVertexNormal(vertex), Vector3::Create(0.0f, 0.0f, 1.0f)));
+  }
+}
+
+// Node matrices are decomposed to translation, rotation and scale, which must rebuild them
+void CheckMatrix(KRScene& scene, const char* name, const float* expected)
+{
+  KRNode* node = scene.getRootNode()->find<KRNode>(name);
+  if (!TEST_CHECK(node != nullptr)) {
+    return;
+  }
+  const Matrix4& matrix = node->getModelMatrix();
+  for (int i = 0; i < 16; i++) {
+    if (!TEST_CHECK(fabsf(matrix.c[i] - expected[i]) < kTolerance)) {
+      printf("%s: element %i is %f, expected %f\n", name, i, matrix.c[i], expected[i]);
+    }
+  }
+}
+
+void CheckSkin(KRContext& context, KRScene& scene)
+{
+  TEST_CHECK(scene.getRootNode()->find<KRBone>("joint_root") != nullptr);
+  TEST_CHECK(scene.getRootNode()->find<KRBone>("joint_child") != nullptr);
+  TEST_CHECK(scene.getRootNode()->find<KRModel>("skinned_model") != nullptr);
+
+  KRMesh* mesh = context.getMeshManager()->getMesh("skinned");
+  if (!TEST_CHECK(mesh != nullptr) || !TEST_CHECK(mesh->getBoneCount() == 2)) {
+    return;
+  }
+  TEST_CHECK(strcmp(mesh->getBoneName(0), "joint_root") == 0);
+  TEST_CHECK(strcmp(mesh->getBoneName(1), "joint_child") == 0);
+  // The pack holds the bind poses, which invert the skin's inverseBindMatrices
+  TEST_CHECK(fabsf(mesh->getBoneBindPose(0).c[13] - 1.0f) < kTolerance);
+  TEST_CHECK(fabsf(mesh->getBoneBindPose(1).c[13] - 2.0f) < kTolerance);
+  TEST_CHECK(fabsf(mesh->getBoneInverseBindPose(1).c[13] + 2.0f) < kTolerance);
+
+  int vertex = mesh->getVertexIndex(0, 1);
+  TEST_CHECK(fabsf(mesh->getBoneWeight(vertex, 0) - 0.5f) < kTolerance);
+  TEST_CHECK(fabsf(mesh->getBoneWeight(vertex, 1) - 0.5f) < kTolerance);
+}
+
+struct CurveFrame
+{
+  int frame;
+  float value;
+};
+
+// Checks the curve for one component of an animated node at frames of the 30 fps timeline
+void CheckCurve(KRContext& context, const char* name, int frameCount, std::initializer_list<CurveFrame> frames)
+{
+  KRAnimationCurve* curve = context.getAnimationCurveManager()->getAnimationCurve(std::string("fixture_motion_") + name);
+  if (!TEST_CHECK(curve != nullptr)) {
+    printf("%s: curve missing\n", name);
+    return;
+  }
+  TEST_CHECK(curve->getFrameRate() == 30.0f);
+  TEST_CHECK(curve->getFrameStart() == 0);
+  if (!TEST_CHECK(curve->getFrameCount() == frameCount)) {
+    printf("%s: %i frames, expected %i\n", name, curve->getFrameCount(), frameCount);
+  }
+  for (const CurveFrame& expected : frames) {
+    float value = curve->getValue(expected.frame);
+    if (!TEST_CHECK(fabsf(value - expected.value) < 1e-2f)) {
+      printf("%s: frame %i is %f, expected %f\n", name, expected.frame, value, expected.value);
+    }
+  }
+}
+
+// The sampler keys are described in make_gltf_fixtures.py.  Components that do not change
+// are kept as a single frame.
+void CheckAnimation(KRContext& context)
+{
+  KRAnimation* animation = context.getAnimationManager()->getAnimation("fixture_motion");
+  if (!TEST_CHECK(animation != nullptr)) {
+    return;
+  }
+  TEST_CHECK(fabsf(animation->getDuration() - 1.0f) < kTolerance);
+
+  CheckCurve(context, "anim_linear_translate_x", 31, { { 0, 0.0f }, { 10, 1.0f }, { 30, 3.0f } });
+  CheckCurve(context, "anim_linear_translate_y", 31, { { 0, 0.0f }, { 10, -2.0f }, { 30, -6.0f } });
+  CheckCurve(context, "anim_linear_translate_z", 31, { { 0, 0.0f }, { 10, 3.0f }, { 30, 9.0f }, { 40, 9.0f } });
+  // The keys are in opposite hemispheres, so the slerp takes the 20 degree path through
+  // 180 and the euler angles continue past it instead of wrapping to -180
+  CheckCurve(context, "anim_linear_rotate_x", 1, { { 15, 0.0f } });
+  CheckCurve(context, "anim_linear_rotate_y", 1, { { 15, 0.0f } });
+  CheckCurve(context, "anim_linear_rotate_z", 31, { { 0, 170.0f }, { 6, 174.0f }, { 15, 180.0f }, { 24, 188.0f }, { 30, 190.0f } });
+
+  CheckCurve(context, "anim_step_translate_x", 31, { { 14, 0.0f }, { 15, 1.0f }, { 29, 1.0f }, { 30, 4.0f } });
+  CheckCurve(context, "anim_step_translate_y", 31, { { 14, 0.0f }, { 15, 2.0f }, { 29, 2.0f }, { 30, 5.0f } });
+  CheckCurve(context, "anim_step_translate_z", 31, { { 14, 0.0f }, { 15, 3.0f }, { 29, 3.0f }, { 30, 6.0f } });
+  // The step from 170 to -170 degrees is unwrapped to 190
+  CheckCurve(context, "anim_step_rotate_x", 31, { { 0, 30.0f }, { 14, 30.0f }, { 15, 170.0f }, { 29, 170.0f }, { 30, 190.0f } });
+  CheckCurve(context, "anim_step_rotate_z", 1, { { 0, 0.0f } });
+
+  // Hermite interpolation between keys half a second apart.  At frame 5, t = 1/3, where
+  // h00 = 20/27, h10 = 4/27, h01 = 7/27 and h11 = -2/27, with the tangents scaled by 0.5.
+  CheckCurve(context, "anim_cubic_translate_x", 16, { { 0, 0.0f }, { 5, 7.0f / 27.0f }, { 15, 1.0f } });
+  CheckCurve(context, "anim_cubic_translate_y", 16, { { 0, 0.0f }, { 5, 14.0f / 27.0f }, { 15, 2.0f } });
+  CheckCurve(context, "anim_cubic_translate_z", 16, { { 0, 0.0f }, { 5, 1.0f / 3.0f }, { 10, 1.0f / 3.0f }, { 15, 0.0f } });
+  // With zero tangents the rotation blends 20/27 of the first key with 7/27 of the second,
+  // normalized, rather than following the slerp
+  float half = 30.0f * (float)M_PI / 180.0f;
+  float blended = 2.0f * atan2f(7.0f * sinf(half), 20.0f + 7.0f * cosf(half)) * 180.0f / (float)M_PI;
+  CheckCurve(context, "anim_cubic_rotate_y", 16, { { 0, 0.0f }, { 5, blended }, { 15, 60.0f } });
+  CheckCurve(context, "anim_cubic_rotate_z", 1, { { 5, 0.0f } });
+}
+
+void CheckImport(const std::string& file_name)
+{
+  std::unique_ptr<KRContext> context = test::CreateContext();
+  std::unique_ptr<KRBundle> bundle(KRResource::LoadGltf(*context, test::DataPath(file_name)));
+  if (!TEST_CHECK(bundle != nullptr)) {
+    printf("%s: import failed\n", file_name.c_str());
+    return;
+  }
+  KRScene* scene = context->getSceneManager()->getScene("gltf_fixture_scene");
+  if (!TEST_CHECK(scene != nullptr)) {
+    return;
+  }
+
+  CheckFlatNormals(*context);
+  CheckSparse(*context);
+
+  // Column major, as written by make_gltf_fixtures.py
+  const float matrix[16] = {
+    0.862745f, 0.039216f, 1.803922f, 0.0f,
+    -1.823529f, 2.235294f, 0.823529f, 0.0f,
+    -2.666667f, -2.666667f, 1.333333f, 0.0f,
+    1.0f, 2.0f, 3.0f, 1.0f
+  };
+  const float flip_matrix[16] = {
+    -1.5f, 0.0f, 0.0f, 0.0f,
+    0.0f, -1.5f, 0.0f, 0.0f,
+    0.0f, 0.0f, 0.5f, 0.0f,
+    -4.0f, 0.5f, 2.0f, 1.0f
+  };
+  CheckMatrix(*scene, "matrix_node", matrix);
+  CheckMatrix(*scene, "matrix_flip_node", flip_matrix);
+
+  CheckSkin(*context, *scene);
+  CheckAnimation(*context);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  CheckImport("gltf_fixture.glb");
+  CheckImport("gltf_fixture.gltf");
+  return test::Finish("test_gltf");
+}
@@ -0,0 +1,170 @@
+//
+//  test_krbundle.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "resources/unknown/KRUnknown.h"
+#include "resources/unknown/KRUnknownManager.h"
+
+#include <filesystem>
+
+// Loads a version 2 krbundle from a sparse file with a resource stored past 4GB, checking
+// that the table of contents and the resource data are addressed with 64-bit offsets.
+
+namespace {
+
+const uint64_t kFarOffset = 0x100000040ULL; // 4GB + 64
+
+struct BundleHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_count;
+  uint64_t toc_offset;
+  uint64_t toc_size;
+};
+
+struct TocEntry
+{
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint64_t content_hash;
+  uint32_t name_offset;
+  uint16_t name_length;
+  uint16_t extension_length;
+};
+
+struct Resource
+{
+  std::string name;
+  std::string extension;
+  std::string contents;
+  uint64_t offset;
+};
+
+uint64_t ContentHash(const std::string& data)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Writes the resources at their offsets, leaving the gaps between them unallocated
+bool WriteSparseBundle(const std::string& path, const std::vector<Resource>& resources)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  uint64_t data_end = sizeof(BundleHeader);
+  std::string strings;
+  std::vector<TocEntry> toc;
+  for (const Resource& resource : resources) {
+    file.seekp((std::streamoff)resource.offset);
+    file.write(resource.contents.data(), resource.contents.size());
+    data_end = std::max(data_end, resource.offset + resource.contents.size());
+
+    TocEntry entry = {};
+    entry.data_offset = resource.offset;
+    entry.data_size = resource.contents.size();
+    entry.content_hash = ContentHash(resource.contents);
+    entry.name_offset = (uint32_t)strings.size();
+    entry.name_length = (uint16_t)resource.name.size();
+    entry.extension_length = (uint16_t)resource.extension.size();
+    toc.push_back(entry);
+    strings += resource.name + resource.extension;
+  }
+
+  BundleHeader header = {};
+  memcpy(header.magic, "KRBUNDLE", sizeof(header.magic));
+  header.version = 2;
+  header.entry_count = (uint32_t)toc.size();
+  header.toc_offset = (data_end + 7) & ~7ULL;
+  header.toc_size = toc.size() * sizeof(TocEntry) + strings.size();
+
+  file.seekp((std::streamoff)header.toc_offset);
+  file.write((const char*)toc.data(), toc.size() * sizeof(TocEntry));
+  file.write(strings.data(), strings.size());
+  file.seekp(0);
+  file.write((const char*)&header, sizeof(header));
+  return (bool)file;
+}
+
+void CheckResource(KRContext& context, const Resource& expected)
+{
+  KRUnknown* unknown = context.getUnknownManager()->get(expected.name, expected.extension);
+  if (!TEST_CHECK(unknown != nullptr)) {
+    printf("%s.%s: not loaded from bundle\n", expected.name.c_str(), expected.extension.c_str());
+    return;
+  }
+  mimir::Block* data = unknown->getData();
+  if (!TEST_CHECK(data->getSize() == expected.contents.size())) {
+    return;
+  }
+  data->lock();
+  TEST_CHECK(memcmp(data->getStart(), expected.contents.data(), expected.contents.size()) == 0);
+  data->unlock();
+}
+
+} // anonymous namespace
+
+int main()
+{
+  std::filesystem::path path = std::filesystem::temp_directory_path() / "kraken_test_sparse.krbundle";
+  std::vector<Resource> resources = {
+    { "near", "txt", "Stored after the bundle header", 64 },
+    { "far", "txt", "Stored past the first 4GB of the bundle", kFarOffset }
+  };
+
+  if (TEST_CHECK(WriteSparseBundle(path.string(), resources))) {
+    TEST_CHECK(std::filesystem::file_size(path) > kFarOffset);
+
+    std::unique_ptr<KRContext> context = test::CreateContext();
+    mimir::Block* data = new mimir::Block();
+    if (TEST_CHECK(data->load(path.string()))) {
+      TEST_CHECK(data->getSize() > kFarOffset);
+      TEST_CHECK(context->loadResource("sparse.krbundle", data) != nullptr);
+      for (const Resource& resource : resources) {
+        CheckResource(*context, resource);
+      }
+    } else {
+      delete data;
+    }
+    // The bundle's file mapping is released with the context
+    context.reset();
+  }
+
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  return test::Finish("test_krbundle");
+}
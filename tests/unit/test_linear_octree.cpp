@@ -0,0 +1,163 @@
+//
+//  test_linear_octree.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "KRLinearOctree.h"
+#include "KRViewport.h"
+#include "nodes/KRBone.h"
+#include "resources/scene/KRScene.h"
+
+#include <random>
+
+using namespace hydra;
+
+// KRLinearOctree must find exactly the scene nodes that a linear scan finds, through
+// rebuilds, pending additions, in-place refits and removals.
+
+namespace {
+
+const size_t kNodeCount = 3000;
+
+std::vector<KRNode*> Sorted(std::vector<KRNode*> nodes)
+{
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+void CheckQueries(KRLinearOctree& octree, const std::vector<KRNode*>& nodes, const std::vector<KRViewport>& viewports)
+{
+  for (const KRViewport& viewport : viewports) {
+    std::vector<KRNode*> expected;
+    for (KRNode* node : nodes) {
+      if (viewport.visible(node->getBounds())) {
+        expected.push_back(node);
+      }
+    }
+    std::vector<KRNode*> found;
+    octree.findVisible(viewport, found);
+    TEST_CHECK(Sorted(found) == Sorted(expected));
+  }
+
+  AABB region = AABB::Create(Vector3::Create(-300.0f, -50.0f, -300.0f), Vector3::Create(200.0f, 50.0f, 100.0f));
+  std::vector<KRNode*> expected;
+  for (KRNode* node : nodes) {
+    if (node->getBounds().intersects(region)) {
+      expected.push_back(node);
+    }
+  }
+  std::vector<KRNode*> found;
+  octree.findIntersecting(region, found);
+  TEST_CHECK(Sorted(found) == Sorted(expected));
+  TEST_CHECK(octree.getSceneNodeCount() == nodes.size());
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  std::unique_ptr<KRContext> context = test::CreateContext();
+  KRScene* scene = context->getSceneManager()->createScene("test_linear_octree");
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+  std::uniform_real_distribution<float> scale(0.1f, 50.0f);
+  std::vector<KRNode*> nodes;
+  for (size_t i = 0; i < kNodeCount; i++) {
+    KRBone* bone = new KRBone(*scene, "bone" + std::to_string(i));
+    bone->setLocalTranslation(Vector3::Create(position(random), position(random) * 0.1f, position(random)));
+    bone->setLocalScale(Vector3::Create(scale(random)));
+    scene->getRootNode()->appendChild(bone);
+    nodes.push_back(bone);
+  }
+
+  std::vector<KRViewport> viewports;
+  for (int i = 0; i < 8; i++) {
+    float angle = (float)i * (float)M_PI / 4.0f;
+    Matrix4 view = Matrix4::LookAt(Vector3::Create(0.0f, 10.0f, 0.0f), Vector3::Create(cosf(angle), 10.0f, sinf(angle)), Vector3::Create(0.0f, 1.0f, 0.0f));
+    Matrix4 projection{};
+    projection.perspective(60.0f * (float)M_PI / 180.0f, 1.5f, 0.3f, 800.0f);
+    viewports.push_back(KRViewport(Vector2::Create(1500.0f, 1000.0f), view, projection));
+  }
+
+  KRLinearOctree octree;
+  // Before the first rebuild, every scene node is pending
+  for (size_t i = 0; i < nodes.size() / 2; i++) {
+    octree.add(nodes[i]);
+  }
+  std::vector<KRNode*> added(nodes.begin(), nodes.begin() + nodes.size() / 2);
+  CheckQueries(octree, added, viewports);
+
+  octree.rebuild();
+  CheckQueries(octree, added, viewports);
+
+  // A mix of pending and built scene nodes
+  for (size_t i = nodes.size() / 2; i < nodes.size(); i++) {
+    octree.add(nodes[i]);
+  }
+  CheckQueries(octree, nodes, viewports);
+  octree.rebuild();
+  CheckQueries(octree, nodes, viewports);
+
+  // Small moves are refit in place; large moves change cells
+  std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+  for (size_t i = 0; i < nodes.size(); i += 3) {
+    float distance = (i % 2) ? 0.5f : 400.0f;
+    nodes[i]->setLocalTranslation(nodes[i]->getLocalTranslation() + Vector3::Create(step(random), step(random), step(random)) * distance);
+    octree.update(nodes[i]);
+  }
+  CheckQueries(octree, nodes, viewports);
+
+  // Removed scene nodes leave holes until the next rebuild
+  std::vector<KRNode*> remaining;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (i % 5 == 0) {
+      octree.remove(nodes[i]);
+    } else {
+      remaining.push_back(nodes[i]);
+    }
+  }
+  CheckQueries(octree, remaining, viewports);
+  octree.rebuild();
+  CheckQueries(octree, remaining, viewports);
+
+  // A scene using the linear octree gathers its nodes into it
+  std::unique_ptr<KRContext> linear_context = test::CreateContext(KR_SPATIAL_INDEX_LINEAR_OCTREE);
+  KRScene* linear_scene = linear_context->getSceneManager()->createScene("test_linear_octree");
+  KRBone* bone = new KRBone(*linear_scene, "bone");
+  bone->setLocalTranslation(Vector3::Create(100.0f, 20.0f, -30.0f));
+  linear_scene->getRootNode()->appendChild(bone);
+  linear_scene->buildOctreeForTheFirstTime();
+  HitInfo hitinfo;
+  TEST_CHECK(!linear_scene->rayCast(Vector3::Zero(), Vector3::Create(1.0f, 0.0f, 0.0f), hitinfo, 0xffffffff));
+  TEST_CHECK(linear_scene->getRootOctreeBounds().contains(bone->getBounds()));
+
+  return test::Finish("test_linear_octree");
+}
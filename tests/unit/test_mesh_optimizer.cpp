@@ -0,0 +1,198 @@
+//
+//  test_mesh_optimizer.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "resources/mesh/KRMeshOptimizer.h"
+
+#include <array>
+
+// Runs the KRMesh::optimizeIndexes steps of KRMeshOptimizer on height field grids, once
+// with the triangles in row order and once shuffled along with the vertexes.  The
+// optimized mesh must draw the same triangles from in range indexes, the vertex remap must
+// be a permutation and the simulated vertex cache must miss no more often than before.
+
+namespace {
+
+typedef std::array<float, 3> Position;
+// A triangle as the positions of its corners, rotated to start at the least corner so that
+// the winding is kept but the starting corner is not significant
+typedef std::array<Position, 3> Triangle;
+
+struct Grid
+{
+  std::vector<Position> positions;
+  std::vector<uint32_t> indexes;
+};
+
+uint32_t Random(uint32_t& seed)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return seed >> 8;
+}
+
+// A width x width grid of vertexes, with two triangles per cell in row order.  When
+// shuffled, the vertexes are renumbered and the triangles reordered at random, and a vertex
+// that no triangle references is added.
+Grid MakeGrid(int width, bool shuffled)
+{
+  Grid grid;
+  for (int y = 0; y < width; y++) {
+    for (int x = 0; x < width; x++) {
+      grid.positions.push_back({ (float)x, (float)y, sinf((float)x * 0.4f) * cosf((float)y * 0.3f) * 2.f });
+    }
+  }
+  for (int y = 0; y + 1 < width; y++) {
+    for (int x = 0; x + 1 < width; x++) {
+      uint32_t v = (uint32_t)(y * width + x);
+      uint32_t cell[6] = { v, v + 1, v + width, v + width, v + 1, v + width + 1 };
+      grid.indexes.insert(grid.indexes.end(), cell, cell + 6);
+    }
+  }
+  if (shuffled) {
+    uint32_t seed = 42;
+    grid.positions.push_back({ -1.f, -1.f, -1.f });
+    std::vector<uint32_t> order(grid.positions.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    for (size_t i = order.size() - 1; i > 0; i--) {
+      std::swap(order[i], order[Random(seed) % (i + 1)]);
+    }
+    std::vector<Position> positions(grid.positions.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      positions[order[i]] = grid.positions[i];
+    }
+    grid.positions.swap(positions);
+    for (uint32_t& index : grid.indexes) {
+      index = order[index];
+    }
+    size_t triangleCount = grid.indexes.size() / 3;
+    for (size_t t = triangleCount - 1; t > 0; t--) {
+      size_t other = Random(seed) % (t + 1);
+      for (int c = 0; c < 3; c++) {
+        std::swap(grid.indexes[t * 3 + c], grid.indexes[other * 3 + c]);
+      }
+    }
+  }
+  return grid;
+}
+
+std::multiset<Triangle> Triangles(const std::vector<uint32_t>& indexes, const std::vector<Position>& positions)
+{
+  std::multiset<Triangle> triangles;
+  for (size_t t = 0; t < indexes.size() / 3; t++) {
+    Triangle triangle = { positions[indexes[t * 3]], positions[indexes[t * 3 + 1]], positions[indexes[t * 3 + 2]] };
+    std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+    triangles.insert(triangle);
+  }
+  return triangles;
+}
+
+bool InRange(const std::vector<uint32_t>& indexes, size_t vertexCount)
+{
+  for (uint32_t index : indexes) {
+    if (index >= vertexCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CheckOptimize(int width, bool shuffled, int cacheSize)
+{
+  Grid grid = MakeGrid(width, shuffled);
+  size_t vertexCount = grid.positions.size();
+  std::vector<uint32_t> indexes = grid.indexes;
+  std::multiset<Triangle> triangles = Triangles(indexes, grid.positions);
+
+  KRMeshOptimizer::CacheStatistics before = KRMeshOptimizer::AnalyzeVertexCache(indexes.data(), indexes.size(), vertexCount, cacheSize);
+
+  std::vector<size_t> clusters;
+  KRMeshOptimizer::OptimizeVertexCache(indexes.data(), indexes.size(), vertexCount, cacheSize, clusters);
+  TEST_CHECK(InRange(indexes, vertexCount));
+  TEST_CHECK(Triangles(indexes, grid.positions) == triangles);
+  TEST_CHECK(!clusters.empty() && clusters.front() == 0);
+  for (size_t c = 1; c < clusters.size(); c++) {
+    TEST_CHECK(clusters[c] > clusters[c - 1] && clusters[c] < indexes.size() / 3);
+  }
+  KRMeshOptimizer::CacheStatistics tipsify = KRMeshOptimizer::AnalyzeVertexCache(indexes.data(), indexes.size(), vertexCount, cacheSize);
+
+  std::vector<float> positions;
+  for (const Position& position : grid.positions) {
+    positions.insert(positions.end(), position.begin(), position.end());
+  }
+  KRMeshOptimizer::OptimizeOverdraw(indexes.data(), indexes.size(), positions.data(), clusters);
+  TEST_CHECK(InRange(indexes, vertexCount));
+  TEST_CHECK(Triangles(indexes, grid.positions) == triangles);
+
+  // The vertexes are moved as KRMesh::optimizeIndexes moves the vertex data
+  std::vector<uint32_t> remap;
+  KRMeshOptimizer::OptimizeVertexFetch(indexes.data(), indexes.size(), vertexCount, remap);
+  TEST_CHECK(InRange(indexes, vertexCount));
+  std::vector<bool> assigned(vertexCount, false);
+  bool permutation = remap.size() == vertexCount;
+  for (size_t v = 0; v < remap.size() && permutation; v++) {
+    permutation = remap[v] < vertexCount && !assigned[remap[v]];
+    assigned[remap[v]] = true;
+  }
+  if (!TEST_CHECK(permutation)) {
+    return;
+  }
+  std::vector<Position> remapped(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    remapped[remap[v]] = grid.positions[v];
+  }
+  TEST_CHECK(Triangles(indexes, remapped) == triangles);
+  // Vertexes are numbered in order of first use
+  uint32_t nextVertex = 0;
+  for (uint32_t index : indexes) {
+    TEST_CHECK(index <= nextVertex);
+    nextVertex = std::max(nextVertex, index + 1);
+  }
+
+  KRMeshOptimizer::CacheStatistics after = KRMeshOptimizer::AnalyzeVertexCache(indexes.data(), indexes.size(), vertexCount, cacheSize);
+  TEST_CHECK(after.triangleCount == before.triangleCount && after.vertexCount == before.vertexCount);
+  if (!TEST_CHECK(tipsify.getACMR() <= before.getACMR()) || !TEST_CHECK(after.getACMR() <= before.getACMR())) {
+    printf("%ix%i grid%s, cache %i: ACMR %.3f before, %.3f after Tipsify, %.3f after overdraw ordering\n",
+      width, width, shuffled ? " (shuffled)" : "", cacheSize, before.getACMR(), tipsify.getACMR(), after.getACMR());
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  for (int cacheSize : { 12, 16, 32 }) {
+    CheckOptimize(48, false, cacheSize);
+    CheckOptimize(48, true, cacheSize);
+  }
+  return test::Finish("test_mesh_optimizer");
+}
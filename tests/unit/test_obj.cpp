@@ -0,0 +1,140 @@
+//
+//  test_obj.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "resources/KRResource.h"
+#include "resources/mesh/KRMesh.h"
+
+#include <filesystem>
+
+using namespace hydra;
+
+// Imports the same OBJ text as one chunk and with every line in a chunk of its own, so that
+// relative indexes and usemtl statements have to be carried across chunk boundaries.  The
+// file uses CRLF line endings and the v, v/vt, v//vn and v/vt/vn face vertex forms.
+
+namespace {
+
+const float kTolerance = 1e-3f; // Normals are stored as half floats
+
+const char* kObjText =
+  "# Chunk boundary fixture\r\n"
+  "v 0 0 0\r\n"
+  "v 1 0 0\r\n"
+  "v 0 1 0\r\n"
+  "v 1 1 0\r\n"
+  "vt 0 0\r\n"
+  "vt 1 0\r\n"
+  "vt 0 1\r\n"
+  "vt 1 1\r\n"
+  "vn 0 0 2\r\n"
+  "usemtl red\r\n"
+  "f -4/-4/-1 -3/-3/-1 -2/-2/-1\r\n"
+  "f 2/2/1 4/4/1 3/3/1\r\n"
+  "usemtl green\r\n"
+  "f 1/1 2/2 4/4\r\n"
+  "v 0 0 1\r\n"
+  "f 1//1 -1//1 2//1\r\n"
+  "usemtl red\r\n"
+  "f -5/-4/-1 -4/-3/-1 -3/-2/-1\r\n";
+
+struct ExpectedVertex
+{
+  float position[3];
+  float texcoord[2];
+  float normal[3];
+};
+
+// Triangle corners of each submesh, in the order the faces appear in the file
+const ExpectedVertex kRed[] = {
+  { { 0, 0, 0 }, { 0, 0 }, { 0, 0, 1 } }, { { 1, 0, 0 }, { 1, 0 }, { 0, 0, 1 } }, { { 0, 1, 0 }, { 0, 1 }, { 0, 0, 1 } },
+  { { 1, 0, 0 }, { 1, 0 }, { 0, 0, 1 } }, { { 1, 1, 0 }, { 1, 1 }, { 0, 0, 1 } }, { { 0, 1, 0 }, { 0, 1 }, { 0, 0, 1 } },
+  { { 0, 0, 0 }, { 0, 0 }, { 0, 0, 1 } }, { { 1, 0, 0 }, { 1, 0 }, { 0, 0, 1 } }, { { 0, 1, 0 }, { 0, 1 }, { 0, 0, 1 } },
+};
+// The first face has no normals, so it gets the flat normal of the face
+const ExpectedVertex kGreen[] = {
+  { { 0, 0, 0 }, { 0, 0 }, { 0, 0, 1 } }, { { 1, 0, 0 }, { 1, 0 }, { 0, 0, 1 } }, { { 1, 1, 0 }, { 1, 1 }, { 0, 0, 1 } },
+  { { 0, 0, 0 }, { 0, 0 }, { 0, 0, 1 } }, { { 0, 0, 1 }, { 0, 0 }, { 0, 0, 1 } }, { { 1, 0, 0 }, { 0, 0 }, { 0, 0, 1 } },
+};
+
+bool Near(const Vector3& a, const float* b)
+{
+  return fabsf(a.x - b[0]) < kTolerance && fabsf(a.y - b[1]) < kTolerance && fabsf(a.z - b[2]) < kTolerance;
+}
+
+void CheckSubmesh(KRMesh& mesh, int submesh, const ExpectedVertex* expected, int count, size_t weldedCount)
+{
+  if (!TEST_CHECK(mesh.getVertexCount(submesh) == count)) {
+    return;
+  }
+  std::set<int> vertexes;
+  for (int i = 0; i < count; i++) {
+    int vertex = mesh.getVertexIndex(submesh, i);
+    vertexes.insert(vertex);
+    TEST_CHECK(Near(mesh.getVertexPosition(vertex), expected[i].position));
+    TEST_CHECK(Near(mesh.getVertexNormal(vertex), expected[i].normal));
+    Vector2 texcoord = mesh.getVertexTexCoord(0, vertex);
+    TEST_CHECK(fabsf(texcoord.x - expected[i].texcoord[0]) < kTolerance && fabsf(texcoord.y - expected[i].texcoord[1]) < kTolerance);
+  }
+  // Corners with the same position, texcoord and normal share one vertex
+  TEST_CHECK(vertexes.size() == weldedCount);
+}
+
+void CheckImport(KRContext& context, const std::string& path, size_t chunkSize)
+{
+  std::unique_ptr<KRMesh> mesh(KRResource::LoadObj(context, path, chunkSize));
+  if (!TEST_CHECK(mesh != nullptr) || !TEST_CHECK(mesh->getSubmeshCount() == 2)) {
+    printf("chunk size %zu: import failed\n", chunkSize);
+    return;
+  }
+  // Submeshes are ordered by the first use of their material
+  CheckSubmesh(*mesh, 0, kRed, 9, 4);
+  CheckSubmesh(*mesh, 1, kGreen, 6, 5);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  std::filesystem::path path = std::filesystem::temp_directory_path() / "kraken_test_obj.obj";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << kObjText;
+  }
+
+  std::unique_ptr<KRContext> context = test::CreateContext();
+  // The whole file in one chunk, then every line in its own chunk
+  CheckImport(*context, path.string(), 0x400000);
+  CheckImport(*context, path.string(), 1);
+
+  std::filesystem::remove(path);
+  return test::Finish("test_obj");
+}
@@ -0,0 +1,167 @@
+//
+//  test_png.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "KRInflate.h"
+#include "resources/texture/KRTexturePNG.h"
+
+// Decodes the fixtures written by data/make_png_fixtures.py and compares them with the
+// RGBA8 pixels expected for each.  Invalid files must be rejected without crashing.
+
+namespace {
+
+const int kFixtureWidth = 37;
+const int kFixtureHeight = 29;
+
+std::unique_ptr<KRTexturePNG> LoadPNG(KRContext& context, const std::string& name)
+{
+  mimir::Block* data = new mimir::Block();
+  if (!data->load(test::DataPath(name + ".png"))) {
+    delete data;
+    return nullptr;
+  }
+  return std::make_unique<KRTexturePNG>(context, data, name);
+}
+
+void CheckDecode(KRContext& context, const std::string& name)
+{
+  std::vector<uint8_t> expected = test::ReadFile(test::DataPath(name + ".rgba"));
+  std::unique_ptr<KRTexturePNG> texture = LoadPNG(context, name);
+  if (!TEST_CHECK(texture != nullptr) || !TEST_CHECK(expected.size() == (size_t)kFixtureWidth * kFixtureHeight * 4)) {
+    return;
+  }
+  TEST_CHECK(texture->getDimensions().x == kFixtureWidth);
+  TEST_CHECK(texture->getDimensions().y == kFixtureHeight);
+  TEST_CHECK(texture->getLodCount() == 6);
+
+  std::vector<uint8_t> levels(texture->getMemRequiredForLodRange(0, texture->getLodCount() - 1));
+  if (!TEST_CHECK(texture->getLodData(levels.data(), 0))) {
+    printf("%s: decoding failed\n", name.c_str());
+    return;
+  }
+  for (size_t i = 0; i < expected.size(); i++) {
+    if (levels[i] != expected[i]) {
+      size_t pixel = i / 4;
+      printf("%s: pixel (%zu, %zu) channel %zu is %i, expected %i\n", name.c_str(), pixel % kFixtureWidth, pixel / kFixtureWidth, i % 4, levels[i], expected[i]);
+      TEST_CHECK(levels[i] == expected[i]);
+      break;
+    }
+  }
+
+  // Requesting a smaller level decodes the image and returns the mipmaps from that level on
+  std::vector<uint8_t> smaller(texture->getMemRequiredForLodRange(2, texture->getLodCount() - 1));
+  TEST_CHECK(texture->getLodData(smaller.data(), 2));
+  TEST_CHECK(memcmp(smaller.data(), levels.data() + texture->getMemRequiredForLodRange(0, 1), smaller.size()) == 0);
+}
+
+void CheckRejected(KRContext& context, const std::string& name)
+{
+  std::unique_ptr<KRTexturePNG> texture = LoadPNG(context, name);
+  if (!TEST_CHECK(texture != nullptr)) {
+    return;
+  }
+  if (texture->getLodCount() == 0) {
+    return; // Rejected from the header
+  }
+  std::vector<uint8_t> levels(texture->getMemRequiredForLodRange(0, texture->getLodCount() - 1));
+  if (texture->getLodData(levels.data(), 0)) {
+    printf("%s: invalid file was decoded\n", name.c_str());
+    TEST_CHECK(false);
+  }
+}
+
+// Inflates a stream split over several segments, reading it in uneven pieces
+void CheckInflate(const std::string& name, const std::vector<uint8_t>& expected)
+{
+  std::vector<uint8_t> compressed = test::ReadFile(test::DataPath(name));
+  if (!TEST_CHECK(compressed.size() > 16)) {
+    return;
+  }
+  KRInflate inflate;
+  size_t split0 = compressed.size() / 3;
+  size_t split1 = split0 + 1;
+  inflate.addInput(compressed.data(), split0);
+  inflate.addInput(compressed.data() + split0, split1 - split0);
+  inflate.addInput(compressed.data() + split1, compressed.size() - split1);
+
+  std::vector<uint8_t> output(expected.size() + 16);
+  size_t total = 0;
+  const size_t pieces[] = { 1, 7, 4096, 33000, 3 };
+  for (int i = 0; total < output.size(); i++) {
+    size_t piece = std::min(pieces[i % 5], output.size() - total);
+    size_t read = inflate.read(output.data() + total, piece);
+    total += read;
+    if (read < piece) {
+      break;
+    }
+  }
+  TEST_CHECK(!inflate.failed());
+  TEST_CHECK(inflate.finished());
+  TEST_CHECK(total == expected.size());
+  TEST_CHECK(memcmp(output.data(), expected.data(), std::min(total, expected.size())) == 0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  std::vector<uint8_t> raw = test::ReadFile(test::DataPath("inflate.raw"));
+  CheckInflate("inflate_stored.zlib", raw);
+  CheckInflate("inflate_fixed.zlib", raw);
+  CheckInflate("inflate_dynamic.zlib", raw);
+
+  std::unique_ptr<KRContext> context = test::CreateContext();
+
+  CheckDecode(*context, "rgba8_filters");
+  CheckDecode(*context, "rgb8_adam7");
+  CheckDecode(*context, "rgb8_trns");
+  CheckDecode(*context, "palette4_trns");
+  CheckDecode(*context, "palette4_adam7");
+  CheckDecode(*context, "grey2");
+  CheckDecode(*context, "grey_alpha8");
+  CheckDecode(*context, "grey16");
+  CheckDecode(*context, "rgba16_adam7");
+
+  CheckRejected(*context, "truncated");
+  CheckRejected(*context, "corrupt_deflate");
+  CheckRejected(*context, "bad_filter");
+
+  // Zero and oversized dimensions are rejected before anything is allocated
+  std::unique_ptr<KRTexturePNG> zero_width = LoadPNG(*context, "zero_width");
+  TEST_CHECK(zero_width && zero_width->getLodCount() == 0);
+  std::unique_ptr<KRTexturePNG> huge = LoadPNG(*context, "huge");
+  TEST_CHECK(huge && huge->getLodCount() == 0);
+  TEST_CHECK(huge && huge->getDimensions().x == 0);
+  zero_width.reset();
+  huge.reset();
+
+  return test::Finish("test_png");
+}
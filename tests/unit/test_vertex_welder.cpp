@@ -0,0 +1,194 @@
+//
+//  test_vertex_welder.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "resources/mesh/KRMesh.h"
+#include "resources/mesh/KRVertexWelder.h"
+
+#include <map>
+
+using namespace hydra;
+
+// Welds vertexes that are exact and near duplicates, and checks the unique vertexes and
+// indexes against golden arrays and against the std::map de-duplication that
+// KRMesh::convertToIndexed used before KRVertexWelder.  The order must match, as it
+// determines the vertex and index data written to imported meshes.
+
+namespace {
+
+// 20 bytes, so that the hash covers both whole words and trailing bytes
+struct Vertex
+{
+  float position[3];
+  float texcoord[2];
+};
+
+// The previous implementation, kept as the reference for vertex and index order
+void MapWeld(const std::vector<Vertex>& vertexes, std::vector<std::byte>& uniqueVertexes, std::vector<__uint32_t>& indexes)
+{
+  typedef std::vector<std::byte> vertex_data_t;
+  std::map<vertex_data_t, int> prevIndices;
+  int newVertexCount = 0;
+  for (const Vertex& vertex : vertexes) {
+    const std::byte* vertexBytes = reinterpret_cast<const std::byte*>(&vertex);
+    vertex_data_t vertexData(vertexBytes, vertexBytes + sizeof(Vertex));
+    int found_index = -1;
+    if (prevIndices.count(vertexData) == 0) {
+      found_index = newVertexCount;
+      prevIndices[vertexData] = found_index;
+      uniqueVertexes.insert(uniqueVertexes.end(), vertexData.begin(), vertexData.end());
+      newVertexCount++;
+    } else {
+      found_index = prevIndices[vertexData];
+    }
+    indexes.push_back(found_index);
+  }
+}
+
+void Weld(const std::vector<Vertex>& vertexes, std::vector<std::byte>& uniqueVertexes, std::vector<__uint32_t>& indexes)
+{
+  KRVertexWelder welder(sizeof(Vertex), vertexes.size());
+  for (const Vertex& vertex : vertexes) {
+    indexes.push_back(welder.weld(reinterpret_cast<const std::byte*>(&vertex)));
+  }
+  uniqueVertexes = welder.getVertexData();
+  TEST_CHECK(welder.getVertexCount() * sizeof(Vertex) == uniqueVertexes.size());
+}
+
+const float kAboveOne = 1.00000012f; // The next float after 1.0f
+
+const Vertex kA = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f } };
+const Vertex kB = { { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f } };
+const Vertex kC = { { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } };
+const Vertex kD = { { 1.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } };
+// Near duplicates differ from kD or kB in a single bit and must not be welded
+const Vertex kNearD = { { kAboveOne, 1.0f, 0.0f }, { 1.0f, 1.0f } };
+const Vertex kNearB = { { 1.0f, 0.0f, 0.0f }, { 1.0f, -0.0f } };
+
+void CheckGolden()
+{
+  const std::vector<Vertex> vertexes = { kA, kB, kC, kA, kC, kD, kNearD, kNearB, kA, kB, kD, kNearD };
+  const __uint32_t expectedIndexes[] = { 0, 1, 2, 0, 2, 3, 4, 5, 0, 1, 3, 4 };
+  const Vertex expectedVertexes[] = { kA, kB, kC, kD, kNearD, kNearB };
+
+  std::vector<std::byte> uniqueVertexes;
+  std::vector<__uint32_t> indexes;
+  Weld(vertexes, uniqueVertexes, indexes);
+  TEST_CHECK(indexes.size() == vertexes.size() && memcmp(indexes.data(), expectedIndexes, sizeof(expectedIndexes)) == 0);
+  TEST_CHECK(uniqueVertexes.size() == sizeof(expectedVertexes) && memcmp(uniqueVertexes.data(), expectedVertexes, sizeof(expectedVertexes)) == 0);
+}
+
+// Draws many vertexes from a small pool, with every pool entry also present as a near
+// duplicate, so that the open-addressing table sees long probe sequences
+void CheckAgainstMap()
+{
+  std::vector<Vertex> pool;
+  for (int i = 0; i < 200; i++) {
+    Vertex vertex = { { (float)(i % 10), (float)(i / 10), 1.0f }, { (float)i * 0.25f, 0.5f } };
+    pool.push_back(vertex);
+    vertex.position[2] = kAboveOne;
+    pool.push_back(vertex);
+  }
+  std::vector<Vertex> vertexes;
+  uint32_t seed = 12345;
+  for (int i = 0; i < 5000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    vertexes.push_back(pool[(seed >> 8) % pool.size()]);
+  }
+
+  std::vector<std::byte> mapVertexes, weldedVertexes;
+  std::vector<__uint32_t> mapIndexes, weldedIndexes;
+  MapWeld(vertexes, mapVertexes, mapIndexes);
+  Weld(vertexes, weldedVertexes, weldedIndexes);
+  TEST_CHECK(mapIndexes == weldedIndexes);
+  TEST_CHECK(mapVertexes == weldedVertexes);
+  TEST_CHECK(mapVertexes.size() == pool.size() * sizeof(Vertex));
+}
+
+// Welds a non-indexed mesh of two submeshes through KRMesh::convertToIndexed.  The
+// triangles are then reordered for the vertex cache, so the corners are compared by value.
+void CheckMesh(KRContext& context)
+{
+  const std::vector<Vertex> corners[2] = {
+    { kA, kB, kC, kC, kB, kD, kNearD, kB, kC },
+    { kD, kC, kB, kNearB, kC, kD }
+  };
+  const size_t uniqueCounts[2] = { 5, 4 };
+
+  KRMesh::mesh_info mi;
+  mi.format = Topology::Triangles;
+  for (int submesh = 0; submesh < 2; submesh++) {
+    mi.submesh_starts.push_back((int)mi.vertices.size());
+    mi.submesh_lengths.push_back((int)corners[submesh].size());
+    mi.material_names.push_back(submesh == 0 ? "first" : "second");
+    for (const Vertex& vertex : corners[submesh]) {
+      mi.vertices.push_back(Vector3::Create(vertex.position[0], vertex.position[1], vertex.position[2]));
+      mi.texcoord[0].push_back(Vector2::Create(vertex.texcoord[0], vertex.texcoord[1]));
+    }
+  }
+  KRMesh mesh(context, "welded");
+  mesh.LoadData(mi, false, false);
+  if (!TEST_CHECK(mesh.getSubmeshCount() == 2) || !TEST_CHECK(mesh.getIndexCount(0) > 0)) {
+    return;
+  }
+
+  for (int submesh = 0; submesh < 2; submesh++) {
+    const std::vector<Vertex>& expected = corners[submesh];
+    if (!TEST_CHECK(mesh.getVertexCount(submesh) == (int)expected.size())) {
+      continue;
+    }
+    std::multiset<std::vector<float>> expectedCorners, meshCorners;
+    std::set<int> vertexes;
+    for (int i = 0; i < (int)expected.size(); i++) {
+      const Vertex& vertex = expected[i];
+      expectedCorners.insert({ vertex.position[0], vertex.position[1], vertex.position[2], vertex.texcoord[0], vertex.texcoord[1] });
+      int index = mesh.getVertexIndex(submesh, i);
+      vertexes.insert(index);
+      Vector3 position = mesh.getVertexPosition(index);
+      Vector2 texcoord = mesh.getVertexTexCoord(0, index);
+      meshCorners.insert({ position.x, position.y, position.z, texcoord.x, texcoord.y });
+    }
+    TEST_CHECK(meshCorners == expectedCorners);
+    TEST_CHECK(vertexes.size() == uniqueCounts[submesh]);
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  CheckGolden();
+  CheckAgainstMap();
+
+  std::unique_ptr<KRContext> context = test::CreateContext();
+  CheckMesh(*context);
+  return test::Finish("test_vertex_welder");
+}
@@ -0,0 +1,125 @@
+//
+//  test_zstd.cpp
+//  Kraken Engine
+//
+//  Copyright 2026 Kearwood Gilbert. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//  
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//  conditions and the following disclaimer.
+//  
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//  of conditions and the following disclaimer in the documentation and/or other materials
+//  provided with the distribution.
+//  
+//  THIS SOFTWARE IS PROVIDED BY KEARWOOD GILBERT ''AS IS'' AND ANY EXPRESS OR IMPLIED
+//  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL KEARWOOD GILBERT OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+//  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+//  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//  The views and conclusions contained in the software and documentation are those of the
+//  authors and should not be interpreted as representing official policies, either expressed
+//  or implied, of Kearwood Gilbert.
+//
+
+#include "test.h"
+#include "KRZstdDecoder.h"
+#include "resources/texture/KRTextureKTX2.h"
+
+// Decodes frames written by the zstd command line tool (see data/make_zstd_fixtures.py)
+// and supercompressed KTX2 textures, comparing them with the uncompressed data.
+
+namespace {
+
+void CheckFrames(const std::string& name)
+{
+  std::vector<uint8_t> compressed = test::ReadFile(test::DataPath(name + ".zst"));
+  std::vector<uint8_t> expected = test::ReadFile(test::DataPath(name + ".raw"));
+  if (!TEST_CHECK(!compressed.empty() && !expected.empty())) {
+    return;
+  }
+
+  // Output space beyond the decompressed size is left alone
+  std::vector<uint8_t> output(expected.size() + 64, 0xcd);
+  size_t decompressed_length = 0;
+  KRZstdDecoder decoder;
+  if (!TEST_CHECK(decoder.decompress(compressed.data(), compressed.size(), output.data(), output.size(), &decompressed_length))) {
+    printf("%s: decompression failed\n", name.c_str());
+    return;
+  }
+  TEST_CHECK(decompressed_length == expected.size());
+  if (!TEST_CHECK(memcmp(output.data(), expected.data(), expected.size()) == 0)) {
+    printf("%s: decompressed data does not match\n", name.c_str());
+  }
+  TEST_CHECK(output[expected.size()] == 0xcd);
+
+  // The decoder is reused for the next stream, and refuses to overflow the output
+  TEST_CHECK(!decoder.decompress(compressed.data(), compressed.size(), output.data(), expected.size() - 1, &decompressed_length));
+}
+
+std::unique_ptr<KRTextureKTX2> LoadKTX2(KRContext& context, const std::string& name)
+{
+  mimir::Block* data = new mimir::Block();
+  if (!data->load(test::DataPath(name + ".ktx2"))) {
+    delete data;
+    return nullptr;
+  }
+  return std::make_unique<KRTextureKTX2>(context, data, name);
+}
+
+void CheckKTX2(KRContext& context, const std::string& name, const std::vector<uint8_t>& expected)
+{
+  std::unique_ptr<KRTextureKTX2> texture = LoadKTX2(context, name);
+  if (!TEST_CHECK(texture != nullptr) || !TEST_CHECK(texture->getLodCount() == 7)) {
+    return;
+  }
+  TEST_CHECK(texture->getDimensions().x == 64 && texture->getDimensions().y == 64);
+
+  std::vector<uint8_t> levels(texture->getMemRequiredForLodRange(0, texture->getLodCount() - 1));
+  if (!TEST_CHECK(levels.size() == expected.size())) {
+    return;
+  }
+  if (!TEST_CHECK(texture->getLodData(levels.data(), 0)) || !TEST_CHECK(levels == expected)) {
+    printf("%s: levels do not match the uncompressed texture\n", name.c_str());
+  }
+
+  // Streaming in from a smaller level only decodes the levels from there on
+  size_t offset = texture->getMemRequiredForLodRange(0, 2);
+  std::vector<uint8_t> smaller(texture->getMemRequiredForLodRange(3, texture->getLodCount() - 1));
+  TEST_CHECK(texture->getLodData(smaller.data(), 3));
+  TEST_CHECK(memcmp(smaller.data(), expected.data() + offset, smaller.size()) == 0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  CheckFrames("zstd_raw");
+  CheckFrames("zstd_rle");
+  CheckFrames("zstd_text");
+  CheckFrames("zstd_records");
+  CheckFrames("zstd_multi_frame");
+
+  std::vector<uint8_t> truncated = test::ReadFile(test::DataPath("zstd_truncated.zst"));
+  std::vector<uint8_t> output(1 << 20);
+  size_t decompressed_length = 0;
+  KRZstdDecoder decoder;
+  TEST_CHECK(!truncated.empty());
+  TEST_CHECK(!decoder.decompress(truncated.data(), truncated.size(), output.data(), output.size(), &decompressed_length));
+
+  // The fixtures hold the same 64x64 RGBA8 mip chain
+  std::unique_ptr<KRContext> context = test::CreateContext();
+  std::vector<uint8_t> levels = test::ReadFile(test::DataPath("ktx2_levels.raw"));
+  CheckKTX2(*context, "ktx2_none", levels);
+  CheckKTX2(*context, "ktx2_zstd", levels);
+  CheckKTX2(*context, "ktx2_zlib", levels);
+
+  return test::Finish("test_zstd");
+}
@@ -31,6 +31,7 @@
 #include "main.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -50,28 +51,6 @@ int main(int argc, char* argv[])
 {
   bool failed = false;
   printf("Kraken Convert\n");
-  printf("Initializing Kraken...\n");
-  KrInitializeInfo init_info = {};
-  init_info.sType = KR_STRUCTURE_TYPE_INITIALIZE;
-  init_info.resourceMapSize = 1024;
-  init_info.nodeMapSize = 1024;
-  KrResult res = KrInitialize(&init_info);
-  if (res != KR_SUCCESS) {
-    printf("Failed to initialize Kraken!\n");
-    return 1;
-  }
-
-  KrCreateBundleInfo create_bundle_info = {};
-  create_bundle_info.sType = KR_STRUCTURE_TYPE_CREATE_BUNDLE;
-  create_bundle_info.resourceHandle = ResourceMapping::output_bundle;
-  create_bundle_info.pBundleName = "output";
-  res = KrCreateBundle(&create_bundle_info);
-  if (res != KR_SUCCESS) {
-    printf("Failed to create bundle.\n");
-    KrShutdown();
-    return 1;
-  }
-
   KrLoadResourceInfo load_resource_info = {};
   load_resource_info.sType = KR_STRUCTURE_TYPE_LOAD_RESOURCE;
   load_resource_info.resourceHandle = ResourceMapping::loaded_resource;
@@ -82,7 +61,9 @@ int main(int argc, char* argv[])
 
   char* output_bundle = nullptr;
   bool compile_shaders = false;
+  bool bake_hrtf = false;
   char* input_list_file = nullptr;
+  int vertex_cache_size = 0;
 
   std::vector<std::string> input_files;
 
@@ -114,10 +95,18 @@ int main(int argc, char* argv[])
         compile_shaders = true;
         command = '\0';
         break;
+      case 'h':
+        // Bake the HRTF impulse responses into a single pre-transformed bank
+        bake_hrtf = true;
+        command = '\0';
+        break;
       case 'i':
       case 'o':
         // Next arg will be the output path
         break;
+      case 'v':
+        // Next arg will be the post-transform vertex cache size that meshes are optimized for
+        break;
       default:
         printf("Unknown command: '%s'\n", arg);
         failed = true;
@@ -136,11 +125,42 @@ int main(int argc, char* argv[])
       output_bundle = arg;
       command = '\0';
       continue;
+    case 'v':
+      vertex_cache_size = atoi(arg);
+      if (vertex_cache_size <= 0) {
+        printf("Invalid vertex cache size: '%s'\n", arg);
+        failed = true;
+      }
+      command = '\0';
+      continue;
     }
 
     input_files.push_back(arg);
   }
 
+  printf("Initializing Kraken...\n");
+  KrInitializeInfo init_info = {};
+  init_info.sType = KR_STRUCTURE_TYPE_INITIALIZE;
+  init_info.resourceMapSize = 1024;
+  init_info.nodeMapSize = 1024;
+  init_info.vertexCacheSize = vertex_cache_size;
+  KrResult res = KrInitialize(&init_info);
+  if (res != KR_SUCCESS) {
+    printf("Failed to initialize Kraken!\n");
+    return 1;
+  }
+
+  KrCreateBundleInfo create_bundle_info = {};
+  create_bundle_info.sType = KR_STRUCTURE_TYPE_CREATE_BUNDLE;
+  create_bundle_info.resourceHandle = ResourceMapping::output_bundle;
+  create_bundle_info.pBundleName = "output";
+  res = KrCreateBundle(&create_bundle_info);
+  if (res != KR_SUCCESS) {
+    printf("Failed to create bundle.\n");
+    KrShutdown();
+    return 1;
+  }
+
   if (input_list_file != nullptr) {
     printf("Reading %s... ", input_list_file);
     std::ifstream in(input_list_file);
@@ -208,6 +228,20 @@ int main(int argc, char* argv[])
     });
   }
 
+  if (bake_hrtf && !failed) {
+    printf("Baking HRTF bank... ");
+    KrBakeHRTFBankInfo bake_hrtf_bank_info = {};
+    bake_hrtf_bank_info.sType = KR_STRUCTURE_TYPE_BAKE_HRTF_BANK;
+    bake_hrtf_bank_info.bundleHandle = ResourceMapping::output_bundle;
+    res = KrBakeHRTFBank(&bake_hrtf_bank_info);
+    if (res != KR_SUCCESS) {
+      printf("[FAIL] (Error %i)\n", res);
+      failed = true;
+    } else {
+      printf("[GOOD]\n");
+    }
+  }
+
   if (output_bundle && !failed) {
     printf("Bundling %s... ", output_bundle);
     KrSaveResourceInfo save_resource_info = {};